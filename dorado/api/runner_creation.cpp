@@ -1,8 +1,10 @@
 #include "runner_creation.h"
 
 #include "basecall/ModelRunner.h"
+#include "basecall/TuningProfile.h"
 #include "basecall/crf_utils.h"
 #include "modbase/ModBaseModelConfig.h"
+#include "utils/dev_utils.h"
 
 #if DORADO_METAL_BUILD
 #include "basecall/MetalModelRunner.h"
@@ -15,6 +17,7 @@
 #include <cxxpool.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <thread>
 
 namespace dorado::api {
@@ -41,12 +44,62 @@ std::pair<std::vector<basecall::RunnerPtr>, size_t> create_basecall_runners(
         spdlog::warn("CPU basecalling is not supported on this platform. Results may be incorrect");
 #endif  // #ifdef DORADO_TX2
 
-        if (num_cpu_runners == 0) {
-            num_cpu_runners = basecall::auto_calculate_num_runners(model_config, memory_fraction);
+        // A profile from `dorado benchmark --tune` replaces the default batch and chunk sizes,
+        // runner count and decode threads. Settings given on the command line still win.
+        auto cpu_config = model_config;
+        const auto profile =
+                basecall::load_tuning_profile(basecall::default_tuning_dir(),
+                                              basecall::tuning_model_name(model_config),
+                                              basecall::tuning_host_id());
+        if (profile) {
+            spdlog::debug("- CPU calling: using tuning profile, {:.0f} samples/s when measured",
+                          profile->samples_per_second);
+            basecall::apply_tuning_profile(*profile, cpu_config);
         }
-        spdlog::debug("- CPU calling: set num_cpu_runners to {}", num_cpu_runners);
-        for (size_t i = 0; i < num_cpu_runners; i++) {
-            runners.push_back(std::make_unique<basecall::ModelRunner>(model_config, device));
+
+        if (utils::get_dev_opt<bool>("cpu_shared_weights", true)) {
+            // Load the weights once. The first runner's probe batch sizes the others, and also
+            // gets the module ready to be shared.
+            auto first_runner = std::make_unique<basecall::ModelRunner>(cpu_config, device);
+            const size_t working_memory = first_runner->measure_working_memory();
+            spdlog::debug("- CPU calling: measured {} MB working memory per runner",
+                          working_memory / (1024 * 1024));
+            if (num_cpu_runners == 0) {
+                num_cpu_runners = basecall::auto_calculate_num_runners(
+                        cpu_config, memory_fraction, working_memory);
+                if (profile) {
+                    // The memory estimate still caps the tuned count.
+                    num_cpu_runners = std::min(num_cpu_runners, size_t(profile->num_runners));
+                }
+            }
+            spdlog::debug("- CPU calling: set num_cpu_runners to {}, sharing weights",
+                          num_cpu_runners);
+            const auto shared_module = first_runner->module();
+            runners.push_back(std::move(first_runner));
+            for (size_t i = 1; i < num_cpu_runners; i++) {
+                runners.push_back(std::make_unique<basecall::ModelRunner>(cpu_config, device,
+                                                                          shared_module));
+            }
+        } else {
+            if (num_cpu_runners == 0) {
+                num_cpu_runners = basecall::auto_calculate_num_runners(cpu_config, memory_fraction);
+                if (profile) {
+                    num_cpu_runners = std::min(num_cpu_runners, size_t(profile->num_runners));
+                }
+            }
+            spdlog::debug("- CPU calling: set num_cpu_runners to {}", num_cpu_runners);
+            for (size_t i = 0; i < num_cpu_runners; i++) {
+                runners.push_back(std::make_unique<basecall::ModelRunner>(cpu_config, device));
+            }
+        }
+        const int num_pipeline_stages = utils::get_dev_opt<int>("cpu_pipeline_stages", 1);
+        const int num_decode_threads = utils::get_dev_opt<int>(
+                "cpu_decode_threads",
+                profile ? profile->decode_threads : basecall::decode::DecoderOptions{}.num_threads);
+        for (auto& runner : runners) {
+            auto& cpu_runner = static_cast<basecall::ModelRunner&>(*runner);
+            cpu_runner.set_num_pipeline_stages(num_pipeline_stages);
+            cpu_runner.set_num_decode_threads(num_decode_threads);
         }
         if (runners.back()->batch_size() != (size_t)model_config.basecaller.batch_size()) {
             spdlog::debug("- CPU calling: set batch_size to {}", runners.back()->batch_size());
@@ -91,11 +91,13 @@ void BasecallerParams::update(const BasecallerParams &other) {
 }
 
 void BasecallerParams::normalise(size_t chunk_size_divisor, size_t overlap_divisor) {
-    // Apply normalised value with FORCE
+    // Apply normalised value keeping its priority, so that a higher priority source such as a
+    // tuning profile can still replace a rounded default
     auto normalise_param = [&](Value &self, const std::string &name, int div) {
         const int before_val = self.val;
         const int new_val = (self.val / div) * div;
-        if (set_value(self, Value{new_val, Priority::FORCE})) {
+        if (new_val != before_val) {
+            self.val = new_val;
             spdlog::info("Normalised: {} {} -> {}", name, before_val, new_val);
         }
     };
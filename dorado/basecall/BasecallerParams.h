@@ -10,15 +10,17 @@
 namespace dorado::basecall {
 
 // Stores basecaller parameters and manages the overwrite priority from various setters
-// where Default < Config < CLI Argument < Forced.
+// where Default < Config < Tuned < CLI Argument < Forced.
 class BasecallerParams {
 public:
     // Overwrite priority
     enum class Priority : int {
         DEFAULT = 0,
         CONFIG = 1,
-        CLI_ARG = 2,
-        FORCE = 3,
+        // From a tuning profile written by `dorado benchmark --tune`.
+        TUNED = 2,
+        CLI_ARG = 3,
+        FORCE = 4,
     };
 
     BasecallerParams(){};
@@ -3,15 +3,30 @@
 #include "crf_utils.h"
 #include "decode/Decoder.h"
 #include "nn/CRFModel.h"
+#include "utils/memory_utils.h"
+
+#include <ATen/TensorIndexing.h>
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
 
 namespace dorado::basecall {
 
 ModelRunner::ModelRunner(const CRFModelConfig &model_config, const std::string &device)
+        : ModelRunner(model_config,
+                      device,
+                      torch::nn::ModuleHolder<torch::nn::AnyModule>{nullptr}) {}
+
+ModelRunner::ModelRunner(const CRFModelConfig &model_config,
+                         const std::string &device,
+                         torch::nn::ModuleHolder<torch::nn::AnyModule> shared_module)
         : m_config(model_config),
           m_decoder(decode::create_decoder(device, model_config)),
           // TODO: m_options.dtype() depends on the device as TxModel uses kHalf in cuda which is not supported on CPU
           m_options(at::TensorOptions().dtype(m_decoder->dtype()).device(device)),
-          m_module(load_crf_model(model_config, m_options)) {
+          m_module(shared_module ? std::move(shared_module)
+                                 : load_crf_model(model_config, m_options)) {
     assert(model_config.has_normalised_basecaller_params());
 
     m_decoder_options.q_shift = model_config.qbias;
@@ -28,6 +43,10 @@ ModelRunner::ModelRunner(const CRFModelConfig &model_config, const std::string &
 }
 
 std::vector<decode::DecodedChunk> ModelRunner::call_chunks(int num_chunks) {
+    if (!m_batches_in_flight.empty()) {
+        throw std::runtime_error("ModelRunner can't call a batch while others are in flight.");
+    }
+
     at::InferenceMode guard;
     dorado::stats::Timer timer;
     auto scores_TNC =
@@ -42,6 +61,135 @@ std::vector<decode::DecodedChunk> ModelRunner::call_chunks(int num_chunks) {
     return decoded_chunks;
 }
 
+ModelRunner::~ModelRunner() { stop_decode_thread(); }
+
+void ModelRunner::set_num_pipeline_stages(int num_stages) {
+    if (num_stages < 1) {
+        throw std::runtime_error("ModelRunner needs at least one pipeline stage, got " +
+                                 std::to_string(num_stages));
+    }
+    if (!m_batches_in_flight.empty()) {
+        throw std::runtime_error(
+                "ModelRunner can't change pipeline stages with batches in flight.");
+    }
+    stop_decode_thread();
+    m_num_pipeline_stages = num_stages;
+    if (m_num_pipeline_stages > 1) {
+        m_decode_queue = std::make_unique<utils::AsyncQueue<DecodeJob>>(m_num_pipeline_stages);
+        m_decode_thread = std::thread(&ModelRunner::decode_thread_fn, this);
+    }
+}
+
+void ModelRunner::stop_decode_thread() {
+    if (m_decode_thread.joinable()) {
+        m_decode_queue->terminate();
+        m_decode_thread.join();
+    }
+    m_decode_queue.reset();
+}
+
+void ModelRunner::decode_thread_fn() {
+    at::InferenceMode guard;
+    DecodeJob job;
+    while (m_decode_queue->try_pop(job) == utils::AsyncQueueStatus::Success) {
+        try {
+            DecodeResult result;
+            result.start = std::chrono::steady_clock::now();
+            result.chunks = m_decoder->beam_search_part_2(m_decoder->beam_search_part_1(
+                    {job.scores_TNC, job.num_chunks, m_decoder_options}));
+            result.end = std::chrono::steady_clock::now();
+            job.result.set_value(std::move(result));
+        } catch (...) {
+            job.result.set_exception(std::current_exception());
+        }
+    }
+}
+
+void ModelRunner::set_num_decode_threads(int num_threads) {
+    if (num_threads < 1) {
+        throw std::runtime_error("ModelRunner needs at least one decode thread, got " +
+                                 std::to_string(num_threads));
+    }
+    m_decoder_options.num_threads = num_threads;
+}
+
+void ModelRunner::submit_chunks(int num_chunks) {
+    if (!m_decode_thread.joinable()) {
+        throw std::runtime_error(
+                "ModelRunner needs more than one pipeline stage to submit batches.");
+    }
+    if (int(m_batches_in_flight.size()) == m_num_pipeline_stages) {
+        throw std::runtime_error("ModelRunner already has " +
+                                 std::to_string(m_num_pipeline_stages) + " batches in flight.");
+    }
+
+    at::InferenceMode guard;
+    dorado::stats::Timer timer;
+    BatchInFlight batch;
+    batch.forward_start = std::chrono::steady_clock::now();
+    // The forward pass is done with the input buffer once it returns, so the next batch can be
+    // accepted while this one's scores are decoded.
+    auto scores_TNC =
+            m_module->forward(m_input_NCT.to(m_options.device())).transpose(0, 1).contiguous();
+    batch.forward_end = std::chrono::steady_clock::now();
+    m_model_ms += timer.GetElapsedMS();
+
+    DecodeJob job{std::move(scores_TNC), num_chunks, {}};
+    batch.result = job.result.get_future();
+    if (m_decode_queue->try_push(std::move(job)) != utils::AsyncQueueStatus::Success) {
+        throw std::runtime_error("ModelRunner decode thread has stopped.");
+    }
+    m_batches_in_flight.push_back(std::move(batch));
+}
+
+std::vector<decode::DecodedChunk> ModelRunner::collect_chunks() {
+    if (m_batches_in_flight.empty()) {
+        throw std::runtime_error("ModelRunner has no batches in flight.");
+    }
+    auto batch = std::move(m_batches_in_flight.front());
+    m_batches_in_flight.pop_front();
+    auto result = batch.result.get();
+
+    // Only the forward passes of batches submitted after this one can have run while it was
+    // being decoded, and they're all still in flight.
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    int64_t overlapped_decode_us = 0;
+    for (const auto &later_batch : m_batches_in_flight) {
+        const auto overlap_start = std::max(result.start, later_batch.forward_start);
+        const auto overlap_end = std::min(result.end, later_batch.forward_end);
+        if (overlap_start < overlap_end) {
+            overlapped_decode_us +=
+                    duration_cast<microseconds>(overlap_end - overlap_start).count();
+        }
+    }
+
+    const int64_t decode_us = duration_cast<microseconds>(result.end - result.start).count();
+    ++m_num_batches_called;
+    m_decode_ms += decode_us / 1000;
+    m_pipelined_decode_us += decode_us;
+    m_overlapped_decode_us += overlapped_decode_us;
+    return std::move(result.chunks);
+}
+
+size_t ModelRunner::measure_working_memory() {
+    at::InferenceMode guard;
+    const size_t baseline_bytes = utils::process_memory_bytes();
+    const bool can_measure = baseline_bytes > 0 && utils::reset_peak_process_memory();
+    {
+        auto scores_TNC =
+                m_module->forward(m_input_NCT.to(m_options.device())).transpose(0, 1).contiguous();
+        m_decoder->beam_search_part_2(m_decoder->beam_search_part_1(
+                {scores_TNC, int(batch_size()), m_decoder_options}));
+    }
+    const size_t peak_bytes = utils::peak_process_memory_bytes();
+    if (!can_measure || peak_bytes <= baseline_bytes) {
+        return 0;
+    }
+    // The input buffer was allocated before the baseline was taken.
+    return peak_bytes - baseline_bytes + m_input_NCT.nbytes();
+}
+
 void ModelRunner::accept_chunk(int chunk_idx, const at::Tensor &chunk_CT) {
     m_input_NCT.index_put_({chunk_idx, at::indexing::Ellipsis}, chunk_CT);
 }
@@ -51,6 +199,12 @@ stats::NamedStats ModelRunner::sample_stats() const {
     stats["batches_called"] = double(m_num_batches_called);
     stats["model_ms"] = double(m_model_ms);
     stats["decode_ms"] = double(m_decode_ms);
+    if (m_num_pipeline_stages > 1) {
+        // Fraction of pipelined decode time hidden behind forward passes.
+        const auto decode_us = m_pipelined_decode_us.load();
+        stats["forward_decode_overlap"] =
+                decode_us > 0 ? double(m_overlapped_decode_us) / double(decode_us) : 0.0;
+    }
     return stats;
 }
 
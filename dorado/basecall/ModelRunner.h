@@ -3,20 +3,35 @@
 #include "CRFModelConfig.h"
 #include "ModelRunnerBase.h"
 #include "decode/Decoder.h"
+#include "utils/AsyncQueue.h"
 #include "utils/stats.h"
 
 #include <torch/nn.h>
 
 #include <atomic>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <memory>
 #include <string>
+#include <thread>
 
 namespace dorado::basecall {
 
 class ModelRunner final : public ModelRunnerBase {
 public:
     ModelRunner(const CRFModelConfig &model_config, const std::string &device);
+    // Creates a runner which uses |shared_module| instead of loading its own copy of the weights.
+    // Only the input and decode buffers are per-runner, so the module must not be modified.
+    ModelRunner(const CRFModelConfig &model_config,
+                const std::string &device,
+                torch::nn::ModuleHolder<torch::nn::AnyModule> shared_module);
+    ~ModelRunner();
     void accept_chunk(int chunk_idx, const at::Tensor &chunk) final;
     std::vector<decode::DecodedChunk> call_chunks(int num_chunks) final;
+    int max_batches_in_flight() const final { return m_num_pipeline_stages; }
+    void submit_chunks(int num_chunks) final;
+    std::vector<decode::DecodedChunk> collect_chunks() final;
     const CRFModelConfig &config() const final { return m_config; };
     size_t chunk_size() const final { return m_input_NCT.size(2); }
     size_t batch_size() const final { return m_input_NCT.size(0); }
@@ -25,7 +40,40 @@ public:
     std::string get_name() const final { return "ModelRunner"; }
     stats::NamedStats sample_stats() const final;
 
+    const torch::nn::ModuleHolder<torch::nn::AnyModule> &module() const { return m_module; }
+
+    // Runs a full batch through the model and decoder, and returns the extra host memory this
+    // needed in bytes, i.e. what each additional runner sharing the weights will need.
+    // This also completes any preparation modules do on their first forward pass, so it must be
+    // called before the module is shared. Returns 0 if memory use can't be measured here.
+    size_t measure_working_memory();
+
+    // Pipelined mode: with more than one stage, up to that many batches can be in flight through
+    // submit_chunks(). Each batch's forward pass runs as it's submitted, while a persistent decode
+    // thread decodes the batches before it. call_chunks() can't be used while batches are in
+    // flight.
+    void set_num_pipeline_stages(int num_stages);
+    // Number of threads the decoder splits each batch across.
+    void set_num_decode_threads(int num_threads);
+
 private:
+    struct DecodeResult {
+        std::vector<decode::DecodedChunk> chunks;
+        std::chrono::steady_clock::time_point start, end;
+    };
+    struct DecodeJob {
+        at::Tensor scores_TNC;
+        int num_chunks{0};
+        std::promise<DecodeResult> result;
+    };
+    struct BatchInFlight {
+        std::future<DecodeResult> result;
+        std::chrono::steady_clock::time_point forward_start, forward_end;
+    };
+
+    void decode_thread_fn();
+    void stop_decode_thread();
+
     const CRFModelConfig m_config;
     std::unique_ptr<decode::Decoder> m_decoder;
     at::TensorOptions m_options;
@@ -37,6 +85,16 @@ private:
     std::atomic<int64_t> m_num_batches_called = 0;
     std::atomic<int64_t> m_model_ms = 0;
     std::atomic<int64_t> m_decode_ms = 0;
+    // Decode time of batches called through submit_chunks(), and the part of it spent while a
+    // later batch's forward pass was running. Microseconds, since small batches decode quickly.
+    std::atomic<int64_t> m_pipelined_decode_us = 0;
+    std::atomic<int64_t> m_overlapped_decode_us = 0;
+
+    int m_num_pipeline_stages = 1;
+    // Submitted batches, oldest first. Each holds its scores until it's decoded.
+    std::deque<BatchInFlight> m_batches_in_flight;
+    std::unique_ptr<utils::AsyncQueue<DecodeJob>> m_decode_queue;
+    std::thread m_decode_thread;
 };
 
 }  // namespace dorado::basecall
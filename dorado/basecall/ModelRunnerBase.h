@@ -3,6 +3,7 @@
 #include "decode/Decoder.h"
 #include "utils/stats.h"
 
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -20,6 +21,16 @@ public:
     virtual ~ModelRunnerBase() = default;
     virtual void accept_chunk(int chunk_idx, const at::Tensor &chunk) = 0;
     virtual std::vector<decode::DecodedChunk> call_chunks(int num_chunks) = 0;
+    // Pipelined calling, used instead of call_chunks() when max_batches_in_flight() > 1.
+    // submit_chunks() starts calling the accepted batch and returns once the next batch can be
+    // accepted. collect_chunks() waits for the oldest submitted batch and returns its results.
+    virtual int max_batches_in_flight() const { return 1; }
+    virtual void submit_chunks(int /*num_chunks*/) {
+        throw std::runtime_error(get_name() + " does not support pipelined calling");
+    }
+    virtual std::vector<decode::DecodedChunk> collect_chunks() {
+        throw std::runtime_error(get_name() + " does not support pipelined calling");
+    }
     virtual const CRFModelConfig &config() const = 0;
     virtual size_t chunk_size() const = 0;
     virtual size_t batch_size() const = 0;
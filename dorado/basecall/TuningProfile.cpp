@@ -0,0 +1,145 @@
+#include "TuningProfile.h"
+
+#include "CRFModelConfig.h"
+#include "utils/fs_utils.h"
+#include "utils/memory_utils.h"
+
+#include <spdlog/spdlog.h>
+#include <toml.hpp>
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <thread>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::string host_name() {
+#ifdef _WIN32
+    const char *name = std::getenv("COMPUTERNAME");
+    return name ? name : "";
+#else
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) != 0) {
+        return "";
+    }
+    return name;
+#endif
+}
+
+// Keeps names usable as path components on every platform.
+std::string sanitise(const std::string &name) {
+    std::string result = name;
+    for (auto &c : result) {
+        const bool allowed = std::isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '-' ||
+                             c == '_' || c == '@';
+        if (!allowed) {
+            c = '_';
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+namespace dorado::basecall {
+
+std::string tuning_host_id() {
+    auto name = sanitise(host_name());
+    if (name.empty()) {
+        name = "host";
+    }
+    return name + "_" + std::to_string(std::thread::hardware_concurrency()) + "t_" +
+           std::to_string(utils::total_host_memory_GB()) + "G";
+}
+
+std::string tuning_model_name(const CRFModelConfig &model_config) {
+    return std::filesystem::weakly_canonical(model_config.model_path).filename().string();
+}
+
+std::filesystem::path default_tuning_dir() {
+    if (const char *dir = std::getenv("DORADO_TUNING_DIR")) {
+        return dir;
+    }
+    return utils::get_user_data_dir() / "tuning";
+}
+
+std::filesystem::path tuning_profile_path(const std::filesystem::path &dir,
+                                          const std::string &model,
+                                          const std::string &host) {
+    return dir / sanitise(host) / (sanitise(model) + ".toml");
+}
+
+std::filesystem::path save_tuning_profile(const TuningProfile &profile,
+                                          const std::filesystem::path &dir) {
+    const auto path = tuning_profile_path(dir, profile.model, profile.host);
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    std::ofstream out(path);
+    // Names are sanitised, so they can be written as TOML strings without escaping.
+    out << "[tuning]\n"
+        << "model = \"" << sanitise(profile.model) << "\"\n"
+        << "host = \"" << sanitise(profile.host) << "\"\n"
+        << "chunksize = " << profile.chunk_size << '\n'
+        << "batchsize = " << profile.batch_size << '\n'
+        << "runners = " << profile.num_runners << '\n'
+        << "decode_threads = " << profile.decode_threads << '\n'
+        << "samples_per_second = " << std::fixed << std::setprecision(1)
+        << profile.samples_per_second << '\n'
+        << "peak_memory_bytes = " << profile.peak_memory_bytes << '\n';
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Failed to write tuning profile " + path.string());
+    }
+    return path;
+}
+
+std::optional<TuningProfile> load_tuning_profile(const std::filesystem::path &dir,
+                                                 const std::string &model,
+                                                 const std::string &host) {
+    const auto path = tuning_profile_path(dir, model, host);
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+        return std::nullopt;
+    }
+
+    try {
+        const auto t = toml::find(toml::parse(path), "tuning");
+        TuningProfile profile;
+        profile.model = toml::find<std::string>(t, "model");
+        profile.host = toml::find<std::string>(t, "host");
+        profile.chunk_size = toml::find<int>(t, "chunksize");
+        profile.batch_size = toml::find<int>(t, "batchsize");
+        profile.num_runners = toml::find<int>(t, "runners");
+        profile.decode_threads = toml::find<int>(t, "decode_threads");
+        profile.samples_per_second = toml::find<double>(t, "samples_per_second");
+        profile.peak_memory_bytes = toml::find<size_t>(t, "peak_memory_bytes");
+        if (profile.chunk_size <= 0 || profile.batch_size <= 0 || profile.num_runners <= 0 ||
+            profile.decode_threads <= 0) {
+            throw std::runtime_error("settings must be positive");
+        }
+        return profile;
+    } catch (const std::exception &e) {
+        spdlog::warn("Ignoring tuning profile {}: {}", path.string(), e.what());
+        return std::nullopt;
+    }
+}
+
+void apply_tuning_profile(const TuningProfile &profile, CRFModelConfig &model_config) {
+    // Chunks must still be longer than the overlap, which isn't tuned.
+    const auto chunk_size = profile.chunk_size > model_config.basecaller.overlap()
+                                    ? std::optional<int>(profile.chunk_size)
+                                    : std::nullopt;
+    model_config.basecaller.update(BasecallerParams::Priority::TUNED, chunk_size, std::nullopt,
+                                   profile.batch_size);
+    model_config.normalise_basecaller_params();
+}
+
+}  // namespace dorado::basecall
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace dorado::basecall {
+
+struct CRFModelConfig;
+
+// CPU basecalling settings picked by `dorado benchmark --tune` for one model on one host.
+struct TuningProfile {
+    std::string model;
+    std::string host;
+    int chunk_size{0};
+    int batch_size{0};
+    int num_runners{0};
+    int decode_threads{0};
+    // Throughput and peak resident memory measured with these settings.
+    double samples_per_second{0};
+    size_t peak_memory_bytes{0};
+};
+
+// Identifies this machine by host name, hardware thread count and memory size, so a profile isn't
+// reused on other hardware.
+std::string tuning_host_id();
+
+// Profiles are keyed by the name of the model directory.
+std::string tuning_model_name(const CRFModelConfig& model_config);
+
+// $DORADO_TUNING_DIR if set, otherwise .dorado/tuning in the home directory.
+std::filesystem::path default_tuning_dir();
+
+// Location of the profile for |model| on |host|: <dir>/<host>/<model>.toml
+std::filesystem::path tuning_profile_path(const std::filesystem::path& dir,
+                                          const std::string& model,
+                                          const std::string& host);
+
+// Writes |profile| under |dir|, creating directories as needed, and returns its path.
+// Throws std::runtime_error if the file can't be written.
+std::filesystem::path save_tuning_profile(const TuningProfile& profile,
+                                          const std::filesystem::path& dir);
+
+// Reads the profile for |model| on |host| from |dir|, if there is one. Profiles which can't be
+// parsed are ignored with a warning.
+std::optional<TuningProfile> load_tuning_profile(const std::filesystem::path& dir,
+                                                 const std::string& model,
+                                                 const std::string& host);
+
+// Applies the chunk and batch sizes of |profile| to |model_config| with the TUNED priority, so
+// they replace defaults and model config values but not command line arguments.
+void apply_tuning_profile(const TuningProfile& profile, CRFModelConfig& model_config);
+
+}  // namespace dorado::basecall
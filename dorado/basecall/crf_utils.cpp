@@ -3,6 +3,7 @@
 #include "CRFModelConfig.h"
 #include "nn/CRFModel.h"
 #include "nn/TxModel.h"
+#include "utils/dev_utils.h"
 #include "utils/memory_utils.h"
 #include "utils/tensor_utils.h"
 
@@ -254,6 +255,9 @@ ModuleHolder<AnyModule> load_lstm_model(const CRFModelConfig &model_config,
     model->to(options.dtype().toScalarType());
     model->to(options.device());
     model->eval();
+    if (options.device().is_cpu() && utils::get_dev_opt<bool>("cpu_int8_lstm", false)) {
+        model->rnns->quantize_for_cpu();
+    }
 
     auto module = AnyModule(model);
     auto holder = ModuleHolder<AnyModule>(module);
@@ -308,4 +312,18 @@ size_t auto_calculate_num_runners(const CRFModelConfig &model_config, float memo
     return std::clamp(num_runners, size_t(1), std::size_t(std::thread::hardware_concurrency()));
 }
 
+size_t auto_calculate_num_runners(const CRFModelConfig &model_config,
+                                  float memory_fraction,
+                                  size_t bytes_per_runner) {
+    if (bytes_per_runner == 0) {
+        return auto_calculate_num_runners(model_config, memory_fraction);
+    }
+
+    // The weights are already loaded, so free memory only needs to cover the working memory.
+    const auto free_ram_bytes =
+            double(utils::available_host_memory_GB()) * utils::BYTES_PER_GB * memory_fraction;
+    auto num_runners = static_cast<size_t>(free_ram_bytes / double(bytes_per_runner));
+    return std::clamp(num_runners, size_t(1), std::size_t(std::thread::hardware_concurrency()));
+}
+
 }  // namespace dorado::basecall
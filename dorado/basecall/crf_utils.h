@@ -16,4 +16,11 @@ torch::nn::ModuleHolder<torch::nn::AnyModule> load_crf_model(const CRFModelConfi
 
 size_t auto_calculate_num_runners(const CRFModelConfig& model_config, float memory_fraction);
 
+// As above, for runners which share one copy of the weights. |bytes_per_runner| is the measured
+// working memory of a runner, see ModelRunner::measure_working_memory(). Falls back to the
+// estimate above if this is 0.
+size_t auto_calculate_num_runners(const CRFModelConfig& model_config,
+                                  float memory_fraction,
+                                  size_t bytes_per_runner);
+
 }  // namespace dorado::basecall
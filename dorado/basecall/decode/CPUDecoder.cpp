@@ -8,6 +8,7 @@
 #include <math.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <vector>
 
 namespace {
@@ -101,7 +102,7 @@ std::vector<DecodedChunk> CPUDecoder::beam_search_part_2(DecodeData data) const
     const auto scores_cpu = data.data.to(at::kCPU);
     const auto num_chunks = data.num_chunks;
     const auto& options = data.options;
-    int num_threads = std::min(num_chunks, 4);
+    int num_threads = std::max(1, std::min(num_chunks, options.num_threads));
     int chunks_per_thread = num_chunks / num_threads;
     int num_threads_with_one_more_chunk = num_chunks % num_threads;
 
@@ -27,6 +27,8 @@ struct DecoderOptions {
     float q_scale = 1.0;
     float temperature = 1.0;
     bool move_pad = false;
+    // Threads the CPU decoder splits a batch across.
+    int num_threads = 4;
 };
 
 struct DecodeData {
@@ -1,5 +1,6 @@
 #include "CRFModel.h"
 
+#include "utils/dev_utils.h"
 #include "utils/gpu_profiling.h"
 #include "utils/math_utils.h"
 #include "utils/module_utils.h"
@@ -16,8 +17,12 @@ extern "C" {
 }
 #endif
 
+#include <ATen/Parallel.h>
 #include <torch/torch.h>
 
+#include <algorithm>
+#include <unordered_map>
+
 using namespace torch::nn;
 namespace F = torch::nn::functional;
 using Slice = torch::indexing::Slice;
@@ -256,6 +261,42 @@ public:
 
 #endif  // if DORADO_CUDA_BUILD
 
+namespace {
+
+// Output timesteps per im2col block in ConvStackImpl::forward_cpu().
+constexpr int64_t CPU_CONV_TIME_BLOCK = 256;
+
+// Scratch space for ConvStackImpl::forward_cpu(), kept per calling thread so runners sharing a
+// module don't share it. Plain buffers, so the tensor views made over them per call don't depend
+// on whether the previous call was in inference mode.
+struct CpuConvWorkspace {
+    // Intermediate layer outputs, alternating between layers.
+    std::vector<float> ping, pong;
+    // One im2col block per intra-op thread.
+    std::vector<float> cols;
+};
+
+float *reserve(std::vector<float> &buffer, int64_t numel) {
+    if (buffer.size() < size_t(numel)) {
+        buffer.resize(numel);
+    }
+    return buffer.data();
+}
+
+void activation_(at::Tensor &x, Activation activation) {
+    if (activation == Activation::SWISH) {
+        torch::silu_(x);
+    } else if (activation == Activation::SWISH_CLAMP) {
+        torch::silu_(x).clamp_(c10::nullopt, 3.5f);
+    } else if (activation == Activation::TANH) {
+        x.tanh_();
+    } else {
+        throw std::logic_error("Unrecognised activation function id.");
+    }
+}
+
+}  // namespace
+
 ConvStackImpl::ConvStackImpl(const std::vector<ConvParams> &layer_params) {
     for (size_t i = 0; i < layer_params.size(); ++i) {
         auto &layer = layers.emplace_back(layer_params[i]);
@@ -289,24 +330,130 @@ void ConvStackImpl::run_koi(WorkingMemory &wm) {
 #endif  // if DORADO_CUDA_BUILD
 
 at::Tensor ConvStackImpl::forward(at::Tensor x) {
+    if (x.is_cpu() && utils::get_dev_opt<bool>("cpu_fused_conv", true)) {
+        return forward_cpu(x);
+    }
+    return forward_torch(x);
+}
+
+at::Tensor ConvStackImpl::forward_torch(at::Tensor x) {
     // Input x is [N, C_in, T_in], contiguity optional
     for (auto &layer : layers) {
         utils::ScopedProfileRange spr("conv", 2);
         x = layer.conv(x);
-        if (layer.params.activation == Activation::SWISH) {
-            torch::silu_(x);
-        } else if (layer.params.activation == Activation::SWISH_CLAMP) {
-            torch::silu_(x).clamp_(c10::nullopt, 3.5f);
-        } else if (layer.params.activation == Activation::TANH) {
-            x.tanh_();
-        } else {
-            throw std::logic_error("Unrecognised activation function id.");
-        }
+        activation_(x, layer.params.activation);
     }
     // Output is [N, T_out, C_out], non-contiguous
     return x.transpose(1, 2);
 }
 
+at::Tensor ConvStackImpl::forward_cpu(const at::Tensor &x) {
+    {
+        std::lock_guard lock(cpu_weights_mutex);
+        for (auto &layer : layers) {
+            if (!layer.w_cpu.defined()) {
+                // conv->weight is [C_out, C_in, W], we want [W, C_in, C_out]
+                layer.w_cpu = layer.conv->weight.detach()
+                                      .permute({2, 1, 0})
+                                      .flatten(0, 1)
+                                      .to(torch::kFloat)
+                                      .contiguous();
+                if (layer.conv->bias.defined()) {
+                    layer.b_cpu = layer.conv->bias.detach().to(torch::kFloat).contiguous();
+                }
+            }
+        }
+    }
+
+    // Keyed by module, for threads running more than one model.
+    thread_local std::unordered_map<const ConvStackImpl *, CpuConvWorkspace> workspaces;
+    auto &ws = workspaces[this];
+
+    // Input x is [N, C_in, T_in], contiguity optional. It's read in place by the first layer.
+    const auto x_f32 = x.to(torch::kFloat);
+    const float *in_ptr = x_f32.data_ptr<float>();
+    const int64_t N = x_f32.size(0);
+    int64_t T_in = x_f32.size(2);
+    int64_t in_stride_n = x_f32.stride(0);
+    int64_t in_stride_t = x_f32.stride(2);
+    int64_t in_stride_c = x_f32.stride(1);
+
+    const int num_threads = at::get_num_threads();
+    const auto options = at::TensorOptions().dtype(torch::kFloat);
+    at::Tensor out;
+    for (size_t i = 0; i < layers.size(); ++i) {
+        utils::ScopedProfileRange spr("conv", 2);
+        const auto &layer = layers[i];
+        const int64_t C_in = layer.params.insize;
+        const int64_t C_out = layer.params.size;
+        const int64_t W = layer.params.winlen;
+        const int64_t stride = layer.params.stride;
+        const int64_t padding = W / 2;
+        const int64_t T_out = (T_in + 2 * padding - W) / stride + 1;
+        const int64_t K = W * C_in;
+
+        if (i + 1 == layers.size()) {
+            // The caller owns the final output.
+            out = torch::empty({N, T_out, C_out}, options);
+        } else {
+            auto &buffer = (i % 2 == 0) ? ws.ping : ws.pong;
+            out = torch::from_blob(reserve(buffer, N * T_out * C_out), {N, T_out, C_out}, options);
+        }
+        const int64_t time_block = std::min(T_out, CPU_CONV_TIME_BLOCK);
+        const auto cols = torch::from_blob(reserve(ws.cols, num_threads * time_block * K),
+                                           {num_threads, time_block, K}, options);
+        const int64_t blocks_per_read = (T_out + time_block - 1) / time_block;
+
+        at::parallel_for(0, N * blocks_per_read, 1, [&](int64_t begin, int64_t end) {
+            const auto thread_cols = cols[at::get_thread_num()];
+            float *const cols_ptr = thread_cols.data_ptr<float>();
+            for (int64_t task = begin; task < end; ++task) {
+                const int64_t n = task / blocks_per_read;
+                const int64_t t_begin = (task % blocks_per_read) * time_block;
+                const int64_t rows = std::min(time_block, T_out - t_begin);
+
+                // Each row holds the W input timesteps one output timestep sees, zero padded.
+                for (int64_t r = 0; r < rows; ++r) {
+                    const int64_t t_first = (t_begin + r) * stride - padding;
+                    for (int64_t w = 0; w < W; ++w) {
+                        float *dst = cols_ptr + r * K + w * C_in;
+                        const int64_t t = t_first + w;
+                        if (t < 0 || t >= T_in) {
+                            std::fill(dst, dst + C_in, 0.f);
+                            continue;
+                        }
+                        const float *src = in_ptr + n * in_stride_n + t * in_stride_t;
+                        if (in_stride_c == 1) {
+                            std::copy(src, src + C_in, dst);
+                        } else {
+                            for (int64_t c = 0; c < C_in; ++c) {
+                                dst[c] = src[c * in_stride_c];
+                            }
+                        }
+                    }
+                }
+
+                auto out_block = out[n].narrow(0, t_begin, rows);
+                const auto cols_block = thread_cols.narrow(0, 0, rows);
+                if (layer.b_cpu.defined()) {
+                    at::addmm_out(out_block, layer.b_cpu, cols_block, layer.w_cpu);
+                } else {
+                    at::mm_out(out_block, cols_block, layer.w_cpu);
+                }
+                activation_(out_block, layer.params.activation);
+            }
+        });
+
+        in_ptr = out.data_ptr<float>();
+        T_in = T_out;
+        in_stride_n = T_out * C_out;
+        in_stride_t = C_out;
+        in_stride_c = 1;
+    }
+    // Output is [N, T_out, C_out], contiguous
+    return out;
+}
+
 ConvStackImpl::ConvLayer::ConvLayer(const ConvParams &conv_params) : params(conv_params) {}
 
 #if DORADO_CUDA_BUILD
@@ -524,6 +671,15 @@ LSTMStackImpl::LSTMStackImpl(int num_layers, int size) : layer_size(size) {
 
 at::Tensor LSTMStackImpl::forward(at::Tensor x) {
     // Input is [N, T, C], contiguity optional
+    if (!cpu_int8_rnns.empty() && x.is_cpu()) {
+        // Each layer iterates time in its own direction, so no flips are needed.
+        utils::ScopedProfileRange spr("lstm_stack_int8", 2);
+        for (const auto &rnn : cpu_int8_rnns) {
+            x = rnn.forward(x);
+        }
+        return x;
+    }
+
     for (auto &rnn : rnns) {
         x = std::get<0>(rnn(x.flip(1)));
     }
@@ -532,6 +688,17 @@ at::Tensor LSTMStackImpl::forward(at::Tensor x) {
     return (rnns.size() & 1) ? x.flip(1) : x;
 }
 
+void LSTMStackImpl::quantize_for_cpu() {
+    cpu_int8_rnns.clear();
+    for (size_t i = 0; i < rnns.size(); ++i) {
+        const auto &params = rnns[i]->named_parameters();
+        // Even layers see time reversed, as with the flips in forward().
+        const bool reverse = (i & 1) == 0;
+        cpu_int8_rnns.emplace_back(params["weight_ih_l0"], params["weight_hh_l0"],
+                                   params["bias_ih_l0"], params["bias_hh_l0"], reverse);
+    }
+}
+
 #if DORADO_CUDA_BUILD
 void LSTMStackImpl::reserve_working_memory(WorkingMemory &wm) {
     if (wm.layout == TensorLayout::NTC) {
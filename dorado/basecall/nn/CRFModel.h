@@ -1,9 +1,11 @@
 #pragma once
 
 #include "basecall/CRFModelConfig.h"
+#include "basecall/nn/QuantizedLSTM.h"
 
 #include <torch/nn.h>
 
+#include <mutex>
 #include <vector>
 
 namespace dorado::basecall::nn {
@@ -21,11 +23,22 @@ struct ConvStackImpl : torch::nn::Module {
 #endif  // if DORADO_CUDA_BUILD
 
     at::Tensor forward(at::Tensor x);
+    // Each layer's Conv1d followed by a separate in-place activation.
+    // Output is [N, T_out, C_out], non-contiguous.
+    at::Tensor forward_torch(at::Tensor x);
+    // Convolutions as GEMMs over blocks of im2col rows, writing NTC directly, with bias and
+    // activation applied to each output block while it's still in cache. Intermediate layers use
+    // workspaces which are kept per calling thread and reused between batches of the same shape.
+    // Output is [N, T_out, C_out], contiguous.
+    at::Tensor forward_cpu(const at::Tensor &x);
 
     struct ConvLayer {
         explicit ConvLayer(const ConvParams &params);
         const ConvParams params;
         torch::nn::Conv1d conv{nullptr};
+        // conv->weight as [W * C_in, C_out] and the bias, for forward_cpu().
+        at::Tensor w_cpu;
+        at::Tensor b_cpu;
 #if DORADO_CUDA_BUILD
         TensorLayout output_layout{TensorLayout::NTC};
         bool cutlass_conv{false};
@@ -39,6 +52,8 @@ struct ConvStackImpl : torch::nn::Module {
     };
 
     std::vector<ConvLayer> layers;
+    // Runners can share this module, so building the CPU weights is guarded.
+    std::mutex cpu_weights_mutex;
 };
 
 struct LinearCRFImpl : torch::nn::Module {
@@ -59,6 +74,8 @@ struct LinearCRFImpl : torch::nn::Module {
 struct LSTMStackImpl : torch::nn::Module {
     LSTMStackImpl(int num_layers, int size);
     at::Tensor forward(at::Tensor x);
+    // Builds int8 copies of the loaded LSTM weights, which forward() then uses for CPU input.
+    void quantize_for_cpu();
 #if DORADO_CUDA_BUILD
     void reserve_working_memory(WorkingMemory &wm);
     void run_koi(WorkingMemory &wm);
@@ -76,6 +93,7 @@ private:
 #endif  // if DORADO_CUDA_BUILD
     int layer_size;
     std::vector<torch::nn::LSTM> rnns;
+    std::vector<QuantizedLSTMLayer> cpu_int8_rnns;
 };
 
 struct ClampImpl : torch::nn::Module {
@@ -0,0 +1,307 @@
+#include "QuantizedLSTM.h"
+
+#include "utils/simd.h"
+
+#include <ATen/Parallel.h>
+#include <torch/torch.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+// AVX-VNNI can't be selected with target("default") multiversioning, so it's dispatched by hand.
+#if ENABLE_AVX2_IMPL && __GNUC__ >= 11
+#define ENABLE_AVX_VNNI_IMPL 1
+#else
+#define ENABLE_AVX_VNNI_IMPL 0
+#endif
+
+namespace {
+
+constexpr int QUANT_MAX = 127;
+// Timesteps per input projection GEMM, which bounds the working memory for long chunks.
+constexpr int TIME_BLOCK = 32;
+// Output channels handled by each pass of the vectorised kernels: 4 registers of 8 int32.
+constexpr int OUT_BLOCK = 32;
+
+int round_up(int x, int multiple) { return (x + multiple - 1) / multiple * multiple; }
+
+float sigmoid(float x) { return 1.f / (1.f + std::exp(-x)); }
+
+#if ENABLE_AVX2_IMPL
+__attribute__((target("default")))
+#endif
+void gemm_s8_impl(const int8_t *in,
+                  int num_rows,
+                  int padded_in,
+                  const int8_t *packed,
+                  int padded_out,
+                  int32_t *out) {
+    for (int m = 0; m < num_rows; ++m) {
+        const int8_t *a = in + size_t(m) * padded_in;
+        int32_t *c = out + size_t(m) * padded_out;
+        std::fill(c, c + padded_out, 0);
+        for (int k = 0; k < padded_in; k += 4) {
+            const int8_t *b = packed + size_t(k) * padded_out;
+            for (int n = 0; n < padded_out; ++n) {
+                for (int r = 0; r < 4; ++r) {
+                    c[n] += int32_t(a[k + r]) * int32_t(b[n * 4 + r]);
+                }
+            }
+        }
+    }
+}
+
+#if ENABLE_AVX2_IMPL
+// There is no signed * signed byte multiply, so the sign of each activation is moved onto the
+// weight and the dot product is taken with |a| as unsigned. With both in [-127, 127] the pairwise
+// sums produced by maddubs can't saturate, so the result is exact.
+__attribute__((target("avx2"))) inline __m256i load_signed_s8(const int8_t *b, __m256i a) {
+    return _mm256_sign_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(b)), a);
+}
+
+__attribute__((target("avx2"))) inline __m256i dot4_s8(__m256i acc,
+                                                       __m256i a_abs,
+                                                       __m256i a,
+                                                       const int8_t *b,
+                                                       __m256i ones) {
+    const __m256i pairs = _mm256_maddubs_epi16(a_abs, load_signed_s8(b, a));
+    return _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, ones));
+}
+
+__attribute__((target("avx2"))) void gemm_s8_impl(const int8_t *in,
+                                                  int num_rows,
+                                                  int padded_in,
+                                                  const int8_t *packed,
+                                                  int padded_out,
+                                                  int32_t *out) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    for (int m = 0; m < num_rows; ++m) {
+        const int8_t *a_row = in + size_t(m) * padded_in;
+        int32_t *c = out + size_t(m) * padded_out;
+        for (int n = 0; n < padded_out; n += OUT_BLOCK) {
+            __m256i acc0 = _mm256_setzero_si256();
+            __m256i acc1 = _mm256_setzero_si256();
+            __m256i acc2 = _mm256_setzero_si256();
+            __m256i acc3 = _mm256_setzero_si256();
+            for (int k = 0; k < padded_in; k += 4) {
+                int32_t a4;
+                std::memcpy(&a4, a_row + k, sizeof(a4));
+                const __m256i a = _mm256_set1_epi32(a4);
+                const __m256i a_abs = _mm256_abs_epi8(a);
+                // 4 input channels for each of 32 output channels.
+                const int8_t *b = packed + (size_t(k) * padded_out + size_t(n) * 4);
+                acc0 = dot4_s8(acc0, a_abs, a, b, ones);
+                acc1 = dot4_s8(acc1, a_abs, a, b + 32, ones);
+                acc2 = dot4_s8(acc2, a_abs, a, b + 64, ones);
+                acc3 = dot4_s8(acc3, a_abs, a, b + 96, ones);
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(c + n), acc0);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(c + n + 8), acc1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(c + n + 16), acc2);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(c + n + 24), acc3);
+        }
+    }
+}
+#endif
+
+#if ENABLE_AVX_VNNI_IMPL
+// As the AVX2 version, with the multiply and both adds fused into a single vpdpbusd.
+__attribute__((target("avx2,avxvnni"))) void gemm_s8_avx_vnni(const int8_t *in,
+                                                              int num_rows,
+                                                              int padded_in,
+                                                              const int8_t *packed,
+                                                              int padded_out,
+                                                              int32_t *out) {
+    for (int m = 0; m < num_rows; ++m) {
+        const int8_t *a_row = in + size_t(m) * padded_in;
+        int32_t *c = out + size_t(m) * padded_out;
+        for (int n = 0; n < padded_out; n += OUT_BLOCK) {
+            __m256i acc0 = _mm256_setzero_si256();
+            __m256i acc1 = _mm256_setzero_si256();
+            __m256i acc2 = _mm256_setzero_si256();
+            __m256i acc3 = _mm256_setzero_si256();
+            for (int k = 0; k < padded_in; k += 4) {
+                int32_t a4;
+                std::memcpy(&a4, a_row + k, sizeof(a4));
+                const __m256i a = _mm256_set1_epi32(a4);
+                const __m256i a_abs = _mm256_abs_epi8(a);
+                const int8_t *b = packed + (size_t(k) * padded_out + size_t(n) * 4);
+                acc0 = _mm256_dpbusd_avx_epi32(acc0, a_abs, load_signed_s8(b, a));
+                acc1 = _mm256_dpbusd_avx_epi32(acc1, a_abs, load_signed_s8(b + 32, a));
+                acc2 = _mm256_dpbusd_avx_epi32(acc2, a_abs, load_signed_s8(b + 64, a));
+                acc3 = _mm256_dpbusd_avx_epi32(acc3, a_abs, load_signed_s8(b + 96, a));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(c + n), acc0);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(c + n + 8), acc1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(c + n + 16), acc2);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(c + n + 24), acc3);
+        }
+    }
+}
+#endif
+
+}  // namespace
+
+namespace dorado::basecall::nn {
+
+QuantizedWeights::QuantizedWeights(const at::Tensor &weight) {
+    if (weight.dim() != 2) {
+        throw std::runtime_error("QuantizedWeights: expected a 2D weight tensor.");
+    }
+    const auto w = weight.detach().to(torch::kCPU, torch::kFloat).contiguous();
+    out_features = int(w.size(0));
+    in_features = int(w.size(1));
+    padded_in = round_up(in_features, 4);
+    padded_out = round_up(out_features, OUT_BLOCK);
+    packed.assign(size_t(padded_in) * padded_out, 0);
+    inv_scale.assign(out_features, 0.f);
+
+    const float *w_ptr = w.data_ptr<float>();
+    std::vector<int8_t> row_q(padded_in);
+    for (int n = 0; n < out_features; ++n) {
+        inv_scale[n] = quantize_row(w_ptr + size_t(n) * in_features, in_features, padded_in,
+                                    row_q.data());
+        for (int k = 0; k < padded_in; ++k) {
+            packed[(size_t(k / 4) * padded_out + n) * 4 + k % 4] = row_q[k];
+        }
+    }
+}
+
+void gemm_s8(const int8_t *in, int num_rows, const QuantizedWeights &weights, int32_t *out) {
+#if ENABLE_AVX_VNNI_IMPL
+    static const bool has_avx_vnni = __builtin_cpu_supports("avxvnni");
+    if (has_avx_vnni) {
+        gemm_s8_avx_vnni(in, num_rows, weights.padded_in, weights.packed.data(),
+                         weights.padded_out, out);
+        return;
+    }
+#endif
+    gemm_s8_impl(in, num_rows, weights.padded_in, weights.packed.data(), weights.padded_out, out);
+}
+
+float quantize_row(const float *row, int size, int padded_size, int8_t *out) {
+    float max_abs = 0.f;
+    for (int i = 0; i < size; ++i) {
+        max_abs = std::max(max_abs, std::abs(row[i]));
+    }
+    const float scale = max_abs > 0.f ? QUANT_MAX / max_abs : 0.f;
+    for (int i = 0; i < size; ++i) {
+        out[i] = int8_t(std::clamp(std::nearbyint(row[i] * scale), float(-QUANT_MAX),
+                                   float(QUANT_MAX)));
+    }
+    std::fill(out + size, out + padded_size, int8_t(0));
+    return max_abs / QUANT_MAX;
+}
+
+QuantizedLSTMLayer::QuantizedLSTMLayer(const at::Tensor &weight_ih,
+                                       const at::Tensor &weight_hh,
+                                       const at::Tensor &bias_ih,
+                                       const at::Tensor &bias_hh,
+                                       bool reverse)
+        : m_w_ih(weight_ih),
+          m_w_hh(weight_hh),
+          m_layer_size(int(weight_hh.size(1))),
+          m_reverse(reverse) {
+    if (m_w_ih.out_features != 4 * m_layer_size || m_w_hh.out_features != 4 * m_layer_size) {
+        throw std::runtime_error("QuantizedLSTMLayer: unexpected LSTM weight shapes.");
+    }
+    const auto bias = (bias_ih.detach() + bias_hh.detach()).to(torch::kCPU, torch::kFloat);
+    m_bias.assign(bias.data_ptr<float>(), bias.data_ptr<float>() + 4 * m_layer_size);
+    m_hh_scale.resize(m_bias.size());
+    for (size_t i = 0; i < m_hh_scale.size(); ++i) {
+        m_hh_scale[i] = m_w_hh.inv_scale[i] / QUANT_MAX;
+    }
+}
+
+at::Tensor QuantizedLSTMLayer::forward(const at::Tensor &x) const {
+    if (!x.device().is_cpu() || x.dim() != 3 || x.size(2) != m_w_ih.in_features) {
+        throw std::runtime_error("QuantizedLSTMLayer: expected [N, T, C] input on the CPU.");
+    }
+    const auto in = x.to(torch::kFloat).contiguous();
+    const int64_t N = in.size(0);
+    const int T = int(in.size(1));
+    auto out = torch::empty({N, T, m_layer_size}, in.options());
+    const float *in_ptr = in.data_ptr<float>();
+    float *out_ptr = out.data_ptr<float>();
+    // Batch entries are independent, so each thread takes a slice for the whole sequence.
+    at::parallel_for(0, N, 1, [&](int64_t n_begin, int64_t n_end) {
+        forward_range(in_ptr, out_ptr, T, n_begin, n_end);
+    });
+    return out;
+}
+
+void QuantizedLSTMLayer::forward_range(const float *in,
+                                       float *out,
+                                       int T,
+                                       int64_t n_begin,
+                                       int64_t n_end) const {
+    const int C_in = m_w_ih.in_features;
+    const int C = m_layer_size;
+    const int gates_stride = m_w_ih.padded_out;
+    const int nb = int(n_end - n_begin);
+    const int time_block = std::min(T, TIME_BLOCK);
+
+    std::vector<int8_t> in_q(size_t(nb) * time_block * m_w_ih.padded_in);
+    std::vector<float> in_scale(size_t(nb) * time_block);
+    std::vector<int32_t> ih_acc(size_t(nb) * time_block * gates_stride);
+    std::vector<int8_t> h_q(size_t(nb) * m_w_hh.padded_in, 0);
+    std::vector<int32_t> hh_acc(size_t(nb) * m_w_hh.padded_out);
+    std::vector<float> c_state(size_t(nb) * C, 0.f);
+
+    const float *w_ih_scale = m_w_ih.inv_scale.data();
+    const float *hh_scale = m_hh_scale.data();
+    const float *bias = m_bias.data();
+
+    const int num_blocks = (T + time_block - 1) / time_block;
+    for (int block = 0; block < num_blocks; ++block) {
+        // Blocks, and timesteps within them, are visited in the order this layer consumes them.
+        // A reverse layer's last block is the short one when T isn't a multiple of time_block.
+        const int t_end = m_reverse ? T - block * time_block
+                                    : std::min(T, (block + 1) * time_block);
+        const int t_begin = m_reverse ? std::max(0, t_end - time_block) : block * time_block;
+        const int tb = t_end - t_begin;
+
+        for (int n = 0; n < nb; ++n) {
+            for (int ti = 0; ti < tb; ++ti) {
+                const size_t row = size_t(n) * tb + ti;
+                const float *x = in + ((n_begin + n) * T + t_begin + ti) * C_in;
+                in_scale[row] = quantize_row(x, C_in, m_w_ih.padded_in,
+                                             in_q.data() + row * m_w_ih.padded_in);
+            }
+        }
+        gemm_s8(in_q.data(), nb * tb, m_w_ih, ih_acc.data());
+
+        for (int step = 0; step < tb; ++step) {
+            const int ti = m_reverse ? tb - 1 - step : step;
+            gemm_s8(h_q.data(), nb, m_w_hh, hh_acc.data());
+
+            for (int n = 0; n < nb; ++n) {
+                const size_t row = size_t(n) * tb + ti;
+                const int32_t *ih = ih_acc.data() + row * gates_stride;
+                const int32_t *hh = hh_acc.data() + size_t(n) * m_w_hh.padded_out;
+                const float x_scale = in_scale[row];
+                float *c = c_state.data() + size_t(n) * C;
+                float *h = out + ((n_begin + n) * T + t_begin + ti) * C;
+                int8_t *hq = h_q.data() + size_t(n) * m_w_hh.padded_in;
+                const auto gate = [&](int idx) {
+                    return float(ih[idx]) * x_scale * w_ih_scale[idx] +
+                           float(hh[idx]) * hh_scale[idx] + bias[idx];
+                };
+                // Gate order matches torch: input, forget, cell, output.
+                for (int j = 0; j < C; ++j) {
+                    const float i_gate = sigmoid(gate(j));
+                    const float f_gate = sigmoid(gate(C + j));
+                    const float g_gate = std::tanh(gate(2 * C + j));
+                    const float o_gate = sigmoid(gate(3 * C + j));
+                    c[j] = f_gate * c[j] + i_gate * g_gate;
+                    h[j] = o_gate * std::tanh(c[j]);
+                    hq[j] = int8_t(std::nearbyint(h[j] * QUANT_MAX));
+                }
+            }
+        }
+    }
+}
+
+}  // namespace dorado::basecall::nn
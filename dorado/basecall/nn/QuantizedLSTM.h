@@ -0,0 +1,72 @@
+#pragma once
+
+#include <ATen/core/TensorBody.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace dorado::basecall::nn {
+
+// Weights of y = x W^T quantised to int8 with one scale per output channel, packed in groups of
+// 4 input channels ([padded_in / 4, padded_out, 4]), which is the layout the int8 dot product
+// instructions consume.
+struct QuantizedWeights {
+    QuantizedWeights() = default;
+    // |weight| is [out_features, in_features], as stored by torch::nn::Linear and LSTM.
+    explicit QuantizedWeights(const at::Tensor &weight);
+
+    int in_features{0};
+    int out_features{0};
+    // in_features rounded up to a multiple of 4, out_features to a multiple of 32.
+    int padded_in{0};
+    int padded_out{0};
+    std::vector<int8_t> packed;
+    // Converts the int32 result for each output channel back to the float scale of W.
+    std::vector<float> inv_scale;
+};
+
+// out[m, n] = sum_k in[m, k] * W[n, k], exactly, in int32. |in| is [num_rows, padded_in] with
+// values in [-127, 127] and zero padding, |out| is [num_rows, padded_out].
+// Uses AVX-VNNI or AVX2 when the CPU has them, all variants give identical results.
+void gemm_s8(const int8_t *in, int num_rows, const QuantizedWeights &weights, int32_t *out);
+
+// Unidirectional LSTM layer, with the same maths and gate order as torch::nn::LSTM, computed
+// with int8 weights and activations and float gates and state.
+//
+// The input projection for a block of timesteps is a single GEMM, with each input row given its
+// own scale. Since |h| < 1, the hidden state is quantised with a fixed scale.
+// A reverse layer iterates time backwards, rather than running on a flipped copy of its input.
+class QuantizedLSTMLayer {
+public:
+    QuantizedLSTMLayer(const at::Tensor &weight_ih,
+                       const at::Tensor &weight_hh,
+                       const at::Tensor &bias_ih,
+                       const at::Tensor &bias_hh,
+                       bool reverse);
+
+    // Input is [N, T, C_in] kFloat on the CPU, contiguity optional.
+    // Output is [N, T, C] kFloat, contiguous.
+    at::Tensor forward(const at::Tensor &x) const;
+
+    int layer_size() const { return m_layer_size; }
+    bool reverse() const { return m_reverse; }
+
+private:
+    // Runs batch entries [n_begin, n_end) over all timesteps.
+    void forward_range(const float *in, float *out, int T, int64_t n_begin, int64_t n_end) const;
+
+    QuantizedWeights m_w_ih;
+    QuantizedWeights m_w_hh;
+    // bias_ih + bias_hh, [4 * C].
+    std::vector<float> m_bias;
+    // Dequantisation scale for each recurrent gate output, including the fixed scale of h.
+    std::vector<float> m_hh_scale;
+    int m_layer_size;
+    bool m_reverse;
+};
+
+// Quantises |row| to int8 with a single scale, writing |padded_size| values (zero padded).
+// Returns the scale which converts the quantised values back, or 0 for an all-zero row.
+float quantize_row(const float *row, int size, int padded_size, int8_t *out);
+
+}  // namespace dorado::basecall::nn
@@ -2,6 +2,7 @@
 
 #include "basecall/CRFModelConfig.h"
 #include "basecall/nn/CRFModel.h"
+#include "basecall/nn/WindowedAttention.h"
 #include "utils/dev_utils.h"
 #include "utils/gpu_profiling.h"
 
@@ -243,6 +244,7 @@ MultiHeadAttentionImpl::MultiHeadAttentionImpl(int d_model_,
 
 at::Tensor MultiHeadAttentionImpl::get_attn_window_mask(const int64_t size) {
     const auto key = MaskKey{size, options.device()};
+    std::lock_guard lock(mask_cache_mutex);
     if (mask_cache.find(key) == mask_cache.end()) {
         mask_cache[key] = build_attn_window_mask(size);
     }
@@ -292,6 +294,18 @@ at::Tensor MultiHeadAttentionImpl::forward(at::Tensor x) {
         // in_feat=512, out_feat=1536 (3*in), nhead=8, head_dim=64=(512/8), dim_ff=2048
         qkv = wqkv(x).view({N, T, 3, nhead, head_dim});
     }
+    if (x.is_cpu() && utils::get_dev_opt<bool>("cpu_windowed_attention", true)) {
+        {
+            // Rotary embedding and attention in one pass, only computing the attn_window band.
+            utils::ScopedProfileRange spr("WINDOWED_MEA", 3);
+            rotary_emb->assert_forward_dims(qkv);
+            auto buffers = rotary_emb->named_buffers();
+            attn_output_ntc = windowed_attention_cpu(qkv, buffers["cos_freqs"],
+                                                     buffers["sin_freqs"], attn_window);
+        }
+        utils::ScopedProfileRange spr("OUTP", 3);
+        return out_proj(attn_output_ntc);
+    }
     {
         utils::ScopedProfileRange spr("ROTE", 3);
 #if DORADO_CUDA_BUILD
@@ -11,6 +11,7 @@
 #include <torch/nn.h>
 
 #include <cstdint>
+#include <mutex>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -95,6 +96,8 @@ struct MultiHeadAttentionImpl : torch::nn::Module {
     const at::TensorOptions options;
     bool wqkv_transposed = false;
 
+    // Runners can share this module, so the cache is guarded.
+    std::mutex mask_cache_mutex;
     std::unordered_map<MaskKey, at::Tensor, MaskKeyHash> mask_cache{};
 
     torch::nn::Linear wqkv{nullptr}, out_proj{nullptr};
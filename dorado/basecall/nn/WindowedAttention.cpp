@@ -0,0 +1,212 @@
+#include "WindowedAttention.h"
+
+#include "utils/simd.h"
+
+#include <ATen/Parallel.h>
+#include <torch/torch.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// scores[j] = sum_d q[d] * k_t[d * stride + j], for j in [0, count).
+#if ENABLE_AVX2_IMPL
+__attribute__((target("default")))
+#endif
+void band_scores(const float *q,
+                 const float *k_t,
+                 int64_t stride,
+                 int D,
+                 int count,
+                 float *scores) {
+    std::fill(scores, scores + count, 0.f);
+    for (int d = 0; d < D; ++d) {
+        const float *k_row = k_t + d * stride;
+        for (int j = 0; j < count; ++j) {
+            scores[j] += q[d] * k_row[j];
+        }
+    }
+}
+
+#if ENABLE_AVX2_IMPL
+__attribute__((target("avx2,fma"))) void band_scores(const float *q,
+                                                     const float *k_t,
+                                                     int64_t stride,
+                                                     int D,
+                                                     int count,
+                                                     float *scores) {
+    // Keys are contiguous in the transposed K, so each pass scores 8 of them at once.
+    int j = 0;
+    for (; j + 8 <= count; j += 8) {
+        __m256 acc = _mm256_setzero_ps();
+        for (int d = 0; d < D; ++d) {
+            const __m256 k = _mm256_loadu_ps(k_t + d * stride + j);
+            acc = _mm256_fmadd_ps(_mm256_set1_ps(q[d]), k, acc);
+        }
+        _mm256_storeu_ps(scores + j, acc);
+    }
+    for (; j < count; ++j) {
+        float acc = 0.f;
+        for (int d = 0; d < D; ++d) {
+            acc += q[d] * k_t[d * stride + j];
+        }
+        scores[j] = acc;
+    }
+}
+#endif
+
+// out[d] = sum_j p[j] * v[j * stride + d], for d in [0, D).
+#if ENABLE_AVX2_IMPL
+__attribute__((target("default")))
+#endif
+void weighted_sum(const float *p, const float *v, int64_t stride, int D, int count, float *out) {
+    std::fill(out, out + D, 0.f);
+    for (int j = 0; j < count; ++j) {
+        const float *v_row = v + j * stride;
+        for (int d = 0; d < D; ++d) {
+            out[d] += p[j] * v_row[d];
+        }
+    }
+}
+
+#if ENABLE_AVX2_IMPL
+__attribute__((target("avx2,fma"))) void weighted_sum(const float *p,
+                                                      const float *v,
+                                                      int64_t stride,
+                                                      int D,
+                                                      int count,
+                                                      float *out) {
+    int d = 0;
+    for (; d + 8 <= D; d += 8) {
+        __m256 acc = _mm256_setzero_ps();
+        for (int j = 0; j < count; ++j) {
+            const __m256 v_row = _mm256_loadu_ps(v + j * stride + d);
+            acc = _mm256_fmadd_ps(_mm256_set1_ps(p[j]), v_row, acc);
+        }
+        _mm256_storeu_ps(out + d, acc);
+    }
+    for (; d < D; ++d) {
+        float acc = 0.f;
+        for (int j = 0; j < count; ++j) {
+            acc += p[j] * v[j * stride + d];
+        }
+        out[d] = acc;
+    }
+}
+#endif
+
+// Applies the rotary embedding to one head, as RotaryEmbeddingImpl does: the first and second
+// halves of the head dimension are rotated as pairs.
+inline void rotate(const float *in,
+                   const float *cos,
+                   const float *sin,
+                   int half_D,
+                   float scale,
+                   float *out_even,
+                   float *out_odd) {
+    for (int d = 0; d < half_D; ++d) {
+        const float even = in[d];
+        const float odd = in[half_D + d];
+        out_even[d] = scale * (cos[d] * even - sin[d] * odd);
+        out_odd[d] = scale * (sin[d] * even + cos[d] * odd);
+    }
+}
+
+}  // namespace
+
+namespace dorado::basecall::nn {
+
+at::Tensor windowed_attention_cpu(const at::Tensor &qkv,
+                                  const at::Tensor &cos_freqs,
+                                  const at::Tensor &sin_freqs,
+                                  const std::pair<int, int> &attn_window) {
+    if (!qkv.is_cpu() || qkv.dim() != 5 || qkv.size(2) != 3 || qkv.size(4) % 2 != 0) {
+        throw std::runtime_error("windowed_attention_cpu: expected [N, T, 3, H, D] CPU input.");
+    }
+    const auto in = qkv.to(torch::kFloat).contiguous();
+    const int64_t N = in.size(0);
+    const int64_t T = in.size(1);
+    const int64_t H = in.size(3);
+    const int D = int(in.size(4));
+    const int half_D = D / 2;
+    if (cos_freqs.numel() < T * half_D || sin_freqs.numel() < T * half_D) {
+        throw std::runtime_error("windowed_attention_cpu: rotary tables are too short.");
+    }
+    const auto cos_table = cos_freqs.to(torch::kFloat).contiguous();
+    const auto sin_table = sin_freqs.to(torch::kFloat).contiguous();
+
+    auto out = torch::empty({N, T, H * D}, in.options());
+    const float *qkv_ptr = in.data_ptr<float>();
+    const float *cos_ptr = cos_table.data_ptr<float>();
+    const float *sin_ptr = sin_table.data_ptr<float>();
+    float *out_ptr = out.data_ptr<float>();
+
+    // Consecutive timesteps of one of q, k or v for a single head are this far apart.
+    const int64_t t_stride = 3 * H * D;
+    const auto [win_upper, win_lower] = attn_window;
+    // The softmax scale is folded into q.
+    const float scale = 1.f / std::sqrt(float(D));
+
+    at::parallel_for(0, N * H, 1, [&](int64_t begin, int64_t end) {
+        // K for one head, rotated and transposed to [D, T].
+        std::vector<float> k_t(size_t(D) * T);
+        std::vector<float> q(D);
+        const int64_t window = std::max<int64_t>(0, int64_t(win_upper) + win_lower + 1);
+        std::vector<float> scores(std::min(T, window));
+        std::vector<float> rotated(D);
+
+        for (int64_t nh = begin; nh < end; ++nh) {
+            const int64_t n = nh / H;
+            const int64_t h = nh % H;
+            const float *q_base = qkv_ptr + n * T * t_stride + h * D;
+            const float *k_base = q_base + H * D;
+            const float *v_base = k_base + H * D;
+
+            for (int64_t t = 0; t < T; ++t) {
+                rotate(k_base + t * t_stride, cos_ptr + t * half_D, sin_ptr + t * half_D, half_D,
+                       1.f, rotated.data(), rotated.data() + half_D);
+                for (int d = 0; d < D; ++d) {
+                    k_t[d * T + t] = rotated[d];
+                }
+            }
+
+            for (int64_t t = 0; t < T; ++t) {
+                float *out_row = out_ptr + (n * T + t) * H * D + h * D;
+                const int64_t key_begin = std::max<int64_t>(0, t - win_upper);
+                const int64_t key_end = std::min<int64_t>(T, t + win_lower + 1);
+                const int count = int(key_end - key_begin);
+                if (count <= 0) {
+                    std::fill(out_row, out_row + D, 0.f);
+                    continue;
+                }
+
+                rotate(q_base + t * t_stride, cos_ptr + t * half_D, sin_ptr + t * half_D, half_D,
+                       scale, q.data(), q.data() + half_D);
+                band_scores(q.data(), k_t.data() + key_begin, T, D, count, scores.data());
+
+                float max_score = -std::numeric_limits<float>::infinity();
+                for (int j = 0; j < count; ++j) {
+                    max_score = std::max(max_score, scores[j]);
+                }
+                float sum = 0.f;
+                for (int j = 0; j < count; ++j) {
+                    scores[j] = std::exp(scores[j] - max_score);
+                    sum += scores[j];
+                }
+                const float inv_sum = 1.f / sum;
+                for (int j = 0; j < count; ++j) {
+                    scores[j] *= inv_sum;
+                }
+                weighted_sum(scores.data(), v_base + key_begin * t_stride, t_stride, D, count,
+                             out_row);
+            }
+        }
+    });
+    return out;
+}
+
+}  // namespace dorado::basecall::nn
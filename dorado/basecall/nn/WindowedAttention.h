@@ -0,0 +1,23 @@
+#pragma once
+
+#include <ATen/core/TensorBody.h>
+
+#include <utility>
+
+namespace dorado::basecall::nn {
+
+// Sliding window multi-head attention for the CPU, with the rotary embedding of Q and K fused in.
+//
+// |qkv| is the [N, T, 3, H, D] kFloat output of the QKV projection, before rotary embedding.
+// |cos_freqs| and |sin_freqs| hold the rotary embedding tables for at least T positions, with D/2
+// values per position. Query t attends to keys [t - attn_window.first, t + attn_window.second],
+// the same band as MultiHeadAttentionImpl's window mask, and scores outside it are never
+// computed. No mask is built.
+//
+// Returns the attention output as [N, T, H * D] kFloat, contiguous.
+at::Tensor windowed_attention_cpu(const at::Tensor &qkv,
+                                  const at::Tensor &cos_freqs,
+                                  const at::Tensor &sin_freqs,
+                                  const std::pair<int, int> &attn_window);
+
+}  // namespace dorado::basecall::nn
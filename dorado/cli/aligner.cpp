@@ -223,6 +223,7 @@ int aligner(int argc, char* argv[]) {
         spdlog::info("processing {} -> {}", file_info.input, file_info.output);
         auto reader = std::make_unique<HtsReader>(file_info.input, std::nullopt);
         reader->set_client_info(client_info);
+        reader->enable_threads(writer_threads);
         if (file_info.output != "-" &&
             !create_output_folder(std::filesystem::path(file_info.output).parent_path())) {
             return EXIT_FAILURE;
@@ -3,6 +3,7 @@
 #include "basecall/CRFModelConfig.h"
 #include "cli/cli_utils.h"
 #include "data_loader/DataLoader.h"
+#include "data_loader/DirectoryWatcher.h"
 #include "demux/adapter_info.h"
 #include "demux/barcoding_info.h"
 #include "demux/parse_custom_sequences.h"
@@ -18,8 +19,12 @@
 #include "read_pipeline/PolyACalculatorNode.h"
 #include "read_pipeline/ProgressTracker.h"
 #include "read_pipeline/ReadFilterNode.h"
+#include "read_pipeline/ReadPool.h"
 #include "read_pipeline/ReadToBamTypeNode.h"
+#include "read_pipeline/ReadTracer.h"
 #include "read_pipeline/ResumeLoaderNode.h"
+#include "read_pipeline/ShardedHtsWriter.h"
+#include "summary/summary.h"
 #include "utils/SampleSheet.h"
 #include "utils/bam_utils.h"
 #include "utils/barcode_kits.h"
@@ -95,9 +100,10 @@ void set_basecaller_params(const argparse::ArgumentParser& arg,
                                    get_opt("--batchsize"));
 
     if (device == "cpu" && model_config.basecaller.batch_size() == 0) {
-        // Force the batch size to 128
+        // Default the batch size to 128, below the priority of a tuning profile.
         // TODO: This is tuned for LSTM models - investigate Tx
-        model_config.basecaller.set_batch_size(128);
+        model_config.basecaller.update(basecall::BasecallerParams::Priority::CONFIG, std::nullopt,
+                                       std::nullopt, 128);
     }
 #if DORADO_METAL_BUILD
     else if (device == "metal" && model_config.is_tx_model() &&
@@ -146,27 +152,35 @@ void setup(const std::vector<std::string>& args,
            const std::string& polya_config,
            const ModelSelection& model_selection,
            std::shared_ptr<const dorado::demux::BarcodingInfo> barcoding_info,
-           std::unique_ptr<const utils::SampleSheet> sample_sheet) {
+           std::unique_ptr<const utils::SampleSheet> sample_sheet,
+           std::optional<ShardedHtsWriter::Options> sharded_output,
+           bool emit_summary,
+           std::optional<DataLoader::DirectoryWatchOptions> watch_options) {
     spdlog::debug(model_config.to_string());
     const std::string model_name = models::extract_model_name_from_path(model_config.model_path);
     const std::string modbase_model_names = models::extract_model_names_from_paths(remora_models);
 
-    if (!DataLoader::is_read_data_present(data_path, recursive_file_loading)) {
+    // A watched directory can start out empty, and the number of reads isn't known up front.
+    const bool data_present = DataLoader::is_read_data_present(data_path, recursive_file_loading);
+    if (!data_present && !watch_options) {
         std::string err = "No POD5 or FAST5 data found in path: " + data_path;
         throw std::runtime_error(err);
     }
 
     auto read_list = utils::load_read_list(read_list_file_path);
-    size_t num_reads = DataLoader::get_num_reads(
-            data_path, read_list, {} /*reads_already_processed*/, recursive_file_loading);
-    if (num_reads == 0) {
-        spdlog::error("No POD5 or FAST5 reads found in path: " + data_path);
-        std::exit(EXIT_FAILURE);
+    size_t num_reads = 0;
+    if (!watch_options) {
+        num_reads = DataLoader::get_num_reads(data_path, read_list, {} /*reads_already_processed*/,
+                                              recursive_file_loading);
+        if (num_reads == 0) {
+            spdlog::error("No POD5 or FAST5 reads found in path: " + data_path);
+            std::exit(EXIT_FAILURE);
+        }
+        num_reads = max_reads == 0 ? num_reads : std::min(num_reads, max_reads);
     }
-    num_reads = max_reads == 0 ? num_reads : std::min(num_reads, max_reads);
 
     // Sampling rate is checked by ModelFinder when a complex is given, only test for a path
-    if (model_selection.is_path() && !skip_model_compatibility_check) {
+    if (model_selection.is_path() && !skip_model_compatibility_check && data_present) {
         check_sampling_rates_compatible(model_name, data_path, model_config.sample_rate,
                                         recursive_file_loading);
     }
@@ -178,6 +192,9 @@ void setup(const std::vector<std::string>& args,
     }
 
     const bool enable_aligner = !ref.empty();
+    // Watching a run feeds reads as they're acquired, so the runners favour latency.
+    const auto pipeline_type =
+            watch_options ? api::PipelineType::simplex_low_latency : api::PipelineType::simplex;
 
 #if DORADO_CUDA_BUILD
     auto initial_device_info = utils::get_cuda_device_info(device, false);
@@ -215,7 +232,7 @@ void setup(const std::vector<std::string>& args,
             BasecallerRunners basecaller_runners;
             std::tie(basecaller_runners.runners, basecaller_runners.num_devices) =
                     api::create_basecall_runners(model_config, device_id, num_runners, 0, fraction,
-                                                 api::PipelineType::simplex, 0.f);
+                                                 pipeline_type, 0.f);
             return basecaller_runners;
         };
 
@@ -238,7 +255,7 @@ void setup(const std::vector<std::string>& args,
 #endif
     {
         std::tie(runners, num_devices) = api::create_basecall_runners(
-                model_config, device, num_runners, 0, 1.f, api::PipelineType::simplex, 0.f);
+                model_config, device, num_runners, 0, 1.f, pipeline_type, 0.f);
     }
 
     auto read_groups = DataLoader::load_read_groups(data_path, model_name, modbase_model_names,
@@ -270,14 +287,25 @@ void setup(const std::vector<std::string>& args,
         utils::add_rg_headers(hdr.get(), read_groups);
     }
 
-    utils::HtsFile hts_file("-", output_mode, thread_allocations.writer_threads, false);
-
     PipelineDescriptor pipeline_desc;
     std::string gpu_names{};
 #if DORADO_CUDA_BUILD
     gpu_names = utils::get_cuda_gpu_names(device);
 #endif
-    auto hts_writer = pipeline_desc.add_node<HtsWriter>({}, hts_file, gpu_names);
+    std::unique_ptr<utils::HtsFile> hts_file;
+    auto hts_writer = PipelineDescriptor::InvalidNodeHandle;
+    if (sharded_output) {
+        // Split the writer threads between the shards, each shard compresses independently.
+        sharded_output->htslib_threads_per_shard = std::max(
+                size_t(1), size_t(thread_allocations.writer_threads) / sharded_output->num_shards);
+        sharded_output->sort_bam = enable_aligner;
+        sharded_output->gpu_names = gpu_names;
+        hts_writer = pipeline_desc.add_node<ShardedHtsWriter>({}, std::move(*sharded_output));
+    } else {
+        hts_file = std::make_unique<utils::HtsFile>("-", output_mode,
+                                                    thread_allocations.writer_threads, false);
+        hts_writer = pipeline_desc.add_node<HtsWriter>({}, *hts_file, gpu_names);
+    }
     auto aligner = PipelineDescriptor::InvalidNodeHandle;
     auto current_sink_node = hts_writer;
     if (enable_aligner) {
@@ -328,7 +356,12 @@ void setup(const std::vector<std::string>& args,
             PipelineDescriptor::InvalidNodeHandle);
 
     // Create the Pipeline from our description.
-    std::vector<dorado::stats::StatsReporter> stats_reporters{dorado::stats::sys_stats_report};
+    std::vector<dorado::stats::StatsReporter> stats_reporters{
+            dorado::stats::sys_stats_report,
+            dorado::stats::make_stats_reporter(ReadPool::instance())};
+    if (ReadTracer::is_enabled()) {
+        stats_reporters.push_back(dorado::stats::make_stats_reporter(ReadTracer::instance()));
+    }
     auto pipeline = Pipeline::create(std::move(pipeline_desc), &stats_reporters);
     if (pipeline == nullptr) {
         spdlog::error("Failed to create pipeline");
@@ -337,14 +370,19 @@ void setup(const std::vector<std::string>& args,
 
     // At present, header output file header writing relies on direct node method calls
     // rather than the pipeline framework.
-    auto& hts_writer_ref = dynamic_cast<HtsWriter&>(pipeline->get_node_ref(hts_writer));
+    auto& hts_writer_ref = pipeline->get_node_ref(hts_writer);
     if (enable_aligner) {
         const auto& aligner_ref = dynamic_cast<AlignerNode&>(pipeline->get_node_ref(aligner));
         utils::add_sq_hdr(hdr.get(), aligner_ref.get_sequence_records_for_header());
     }
-    hts_file.set_header(hdr.get());
+    auto* sharded_writer = dynamic_cast<ShardedHtsWriter*>(&hts_writer_ref);
+    if (sharded_writer) {
+        sharded_writer->set_header(hdr.get());
+    } else {
+        hts_file->set_header(hdr.get());
+    }
 
-    std::unordered_set<std::string> reads_already_processed;
+    utils::ReadIdSet reads_already_processed;
     if (!resume_from_file.empty()) {
         spdlog::info("> Inspecting resume file...");
         // Turn off warning logging as header info is fetched.
@@ -385,7 +423,8 @@ void setup(const std::vector<std::string>& args,
     }
 
     // If we're doing alignment, post-processing takes longer due to bam file sorting.
-    float post_processing_percentage = (hts_file.finalise_is_noop() || ref.empty()) ? 0.0f : 0.5f;
+    const bool finalise_is_noop = sharded_writer ? !enable_aligner : hts_file->finalise_is_noop();
+    float post_processing_percentage = (finalise_is_noop || ref.empty()) ? 0.0f : 0.5f;
 
     ProgressTracker tracker(int(num_reads), false, post_processing_percentage);
     tracker.set_description("Basecalling");
@@ -398,14 +437,18 @@ void setup(const std::vector<std::string>& args,
     auto stats_sampler = std::make_unique<dorado::stats::StatsSampler>(
             kStatsPeriod, stats_reporters, stats_callables, max_stats_records);
 
-    DataLoader loader(*pipeline, "cpu", thread_allocations.loader_threads, max_reads, read_list,
-                      reads_already_processed);
+    DataLoader loader(*pipeline, "cpu", thread_allocations.loader_threads, max_reads,
+                      std::move(read_list), std::move(reads_already_processed));
 
     auto func = [client_info](ReadCommon& read) { read.client_info = client_info; };
     loader.add_read_initialiser(func);
 
     // Run pipeline.
-    loader.load_reads(data_path, recursive_file_loading, ReadOrder::UNRESTRICTED);
+    if (watch_options) {
+        loader.watch_reads(data_path, *watch_options);
+    } else {
+        loader.load_reads(data_path, recursive_file_loading, ReadOrder::UNRESTRICTED);
+    }
 
     // Wait for the pipeline to complete.  When it does, we collect
     // final stats to allow accurate summarisation.
@@ -419,12 +462,35 @@ void setup(const std::vector<std::string>& args,
 
     // Report progress during output file finalisation.
     tracker.set_description("Sorting output files");
-    hts_file.finalise([&](size_t progress) {
+    auto update_progress = [&](size_t progress) {
         tracker.update_post_processing_progress(static_cast<float>(progress));
-    });
+    };
+    if (sharded_writer) {
+        sharded_writer->finalise_hts_files(update_progress);
+    } else {
+        hts_file->finalise(update_progress);
+    }
 
     // Give the user a nice summary.
     tracker.summarize();
+    if (const auto it = final_stats.find("ReadToBamType.file_arrival_latency_p50_ms");
+        it != final_stats.end()) {
+        spdlog::info("> File arrival to output latency: p50 {:.0f}ms, p90 {:.0f}ms, p99 {:.0f}ms",
+                     it->second, final_stats.at("ReadToBamType.file_arrival_latency_p90_ms"),
+                     final_stats.at("ReadToBamType.file_arrival_latency_p99_ms"));
+    }
+    if (emit_summary && sharded_writer) {
+        // One summary per output file, so each shard file can be handled on its own.
+        spdlog::info("> generating summary files");
+        for (const auto& output_file : sharded_writer->get_output_files()) {
+            auto summary_path = output_file;
+            summary_path.replace_filename(output_file.stem().string() + "_summary.txt");
+            std::ofstream summary_out(summary_path);
+            SummaryData summary;
+            summary.process_file(output_file.string(), summary_out);
+        }
+        spdlog::info("> summary files complete.");
+    }
     if (!dump_stats_file.empty()) {
         std::ofstream stats_file(dump_stats_file);
         stats_sampler->dump_stats(stats_file,
@@ -496,6 +562,21 @@ int basecaller(int argc, char* argv[]) {
             .implicit_value(true)
             .help("Recursively scan through directories to load FAST5 and POD5 files");
 
+    parser.visible.add_argument("--watch")
+            .help("Keep basecalling POD5 files as they're completed in the data directory, for "
+                  "runs which are still acquiring. Stops on --watch-timeout or --watch-stop-file.")
+            .default_value(false)
+            .implicit_value(true)
+            .nargs(0);
+    parser.visible.add_argument("--watch-timeout")
+            .help("Stop watching once no POD5 file has arrived for this many seconds. 0 for no "
+                  "timeout.")
+            .default_value(0)
+            .scan<'i', int>();
+    parser.visible.add_argument("--watch-stop-file")
+            .help("Stop watching once a file with this name is written to the data directory.")
+            .default_value(std::string{});
+
     parser.visible.add_argument("--modified-bases")
             .nargs(argparse::nargs_pattern::at_least_one)
             .action([](const std::string& value) {
@@ -533,6 +614,30 @@ int basecaller(int argc, char* argv[]) {
 
     parser.visible.add_argument("--emit-moves").default_value(false).implicit_value(true);
 
+    parser.visible.add_argument("--output-dir")
+            .help("If specified, output files are written to the given folder as a set of shards, "
+                  "otherwise output is to stdout.")
+            .default_value(std::string{});
+    parser.visible.add_argument("--output-shards")
+            .help("Number of output files written in parallel. Requires --output-dir.")
+            .default_value(1)
+            .scan<'i', int>();
+    parser.visible.add_argument("--shard-max-reads")
+            .help("Start a new file once a shard file holds this many records. 0 for no limit.")
+            .default_value(0)
+            .scan<'i', int>();
+    parser.visible.add_argument("--shard-max-mb")
+            .help("Start a new file once a shard file holds this many MB of uncompressed record "
+                  "data. 0 for no limit.")
+            .default_value(0)
+            .scan<'i', int>();
+    parser.visible.add_argument("--emit-summary")
+            .help("If specified, a summary file is written next to each output file. Requires "
+                  "--output-dir.")
+            .default_value(false)
+            .implicit_value(true)
+            .nargs(0);
+
     parser.visible.add_argument("--reference")
             .help("Path to reference for alignment.")
             .default_value(std::string(""));
@@ -619,6 +724,7 @@ int basecaller(int argc, char* argv[]) {
 
     auto emit_fastq = parser.visible.get<bool>("--emit-fastq");
     auto emit_sam = parser.visible.get<bool>("--emit-sam");
+    const auto output_dir = parser.visible.get<std::string>("--output-dir");
 
     if (emit_fastq && emit_sam) {
         spdlog::error("Only one of --emit-{fastq, sam} can be set (or none).");
@@ -640,12 +746,56 @@ int basecaller(int argc, char* argv[]) {
         }
         spdlog::info(" - Note: FASTQ output is not recommended as not all data can be preserved.");
         output_mode = OutputMode::FASTQ;
-    } else if (emit_sam || utils::is_fd_tty(stdout)) {
+    } else if (emit_sam || (output_dir.empty() && utils::is_fd_tty(stdout))) {
         output_mode = OutputMode::SAM;
-    } else if (utils::is_fd_pipe(stdout)) {
+    } else if (output_dir.empty() && utils::is_fd_pipe(stdout)) {
         output_mode = OutputMode::UBAM;
     }
 
+    std::optional<ShardedHtsWriter::Options> sharded_output;
+    const auto emit_summary = parser.visible.get<bool>("--emit-summary");
+
+    std::optional<DataLoader::DirectoryWatchOptions> watch_options;
+    if (parser.visible.get<bool>("--watch")) {
+        if (!DirectoryWatcher::is_supported()) {
+            spdlog::error("--watch is not supported on this platform.");
+            return EXIT_FAILURE;
+        }
+        const auto watch_timeout = parser.visible.get<int>("--watch-timeout");
+        if (recursive || watch_timeout < 0) {
+            spdlog::error("--watch can't be used with --recursive, and --watch-timeout must be 0 "
+                          "or more.");
+            return EXIT_FAILURE;
+        }
+        watch_options = DataLoader::DirectoryWatchOptions{
+                std::chrono::seconds(watch_timeout),
+                parser.visible.get<std::string>("--watch-stop-file")};
+    } else if (parser.visible.is_used("--watch-timeout") ||
+               parser.visible.is_used("--watch-stop-file")) {
+        spdlog::error("--watch-timeout and --watch-stop-file require --watch to be set.");
+        return EXIT_FAILURE;
+    }
+    if (!output_dir.empty()) {
+        const auto num_shards = parser.visible.get<int>("--output-shards");
+        const auto shard_max_reads = parser.visible.get<int>("--shard-max-reads");
+        const auto shard_max_mb = parser.visible.get<int>("--shard-max-mb");
+        if (num_shards < 1 || shard_max_reads < 0 || shard_max_mb < 0) {
+            spdlog::error(
+                    "--output-shards must be at least 1, and --shard-max-{reads, mb} can't be "
+                    "negative.");
+            return EXIT_FAILURE;
+        }
+        sharded_output.emplace();
+        sharded_output->output_dir = output_dir;
+        sharded_output->num_shards = size_t(num_shards);
+        sharded_output->output_mode = output_mode;
+        sharded_output->max_reads_per_file = size_t(shard_max_reads);
+        sharded_output->max_bytes_per_file = size_t(shard_max_mb) * 1024 * 1024;
+    } else if (emit_summary || parser.visible.is_used("--output-shards")) {
+        spdlog::error("--emit-summary and --output-shards require --output-dir to be set.");
+        return EXIT_FAILURE;
+    }
+
     bool no_trim_barcodes = false, no_trim_primers = false, no_trim_adapters = false;
     auto trim_options = parser.visible.get<std::string>("--trim");
     if (parser.visible.get<bool>("--no-trim")) {
@@ -744,6 +894,7 @@ int basecaller(int argc, char* argv[]) {
     spdlog::info("> Creating basecall pipeline");
 
     try {
+        cli::start_read_tracing(parser);
         setup(args, model_config, data, mods_model_paths, device,
               parser.visible.get<std::string>("--reference"), default_parameters.num_runners,
               default_parameters.remora_batchsize, default_parameters.remora_threads,
@@ -756,7 +907,9 @@ int basecaller(int argc, char* argv[]) {
               parser.hidden.get<std::string>("--dump_stats_filter"),
               parser.visible.get<std::string>("--resume-from"), no_trim_adapters, no_trim_primers,
               custom_primer_file, resume_parser, parser.visible.get<bool>("--estimate-poly-a"),
-              polya_config, model_selection, std::move(barcoding_info), std::move(sample_sheet));
+              polya_config, model_selection, std::move(barcoding_info), std::move(sample_sheet),
+              std::move(sharded_output), emit_summary, std::move(watch_options));
+        cli::finish_read_tracing(parser);
     } catch (const std::exception& e) {
         spdlog::error("{}", e.what());
         utils::clean_temporary_models(temp_download_paths);
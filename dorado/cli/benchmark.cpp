@@ -1,25 +1,407 @@
+#include "../api/pipeline_creation.h"
+#include "../basecall/CRFModelConfig.h"
+#include "../basecall/ModelRunner.h"
+#include "../basecall/TuningProfile.h"
+#include "../basecall/crf_utils.h"
+#include "../basecall/nn/CRFModel.h"
+#include "../data_loader/DataLoader.h"
+#include "../modbase/ModBaseRunner.h"
+#include "../read_pipeline/ReadForwarderNode.h"
+#include "../read_pipeline/ReadPipeline.h"
+#include "../splitter/splitter_utils.h"
+#include "../utils/memory_utils.h"
+#include "../utils/read_id_set.h"
+#include "../utils/string_utils.h"
 #include "../utils/tensor_utils.h"
 #include "dorado_version.h"
 
 #include <ATen/ATen.h>
 #include <argparse.hpp>
+#include <edlib.h>
+#include <torch/torch.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace dorado {
 
+namespace {
+
+// Runs |rnns| in fp32 and then quantised to int8, and reports the difference. The input is
+// noise, so the error is relative to fp32 rather than to any ground truth.
+void compare_int8_lstm(const std::string& name, basecall::nn::LSTMStack rnns, const at::Tensor& x) {
+    torch::NoGradGuard no_grad;
+    auto start = std::chrono::system_clock::now();
+    const auto expected = rnns->forward(x);
+    auto end = std::chrono::system_clock::now();
+    const auto fp32_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    rnns->quantize_for_cpu();
+    start = std::chrono::system_clock::now();
+    const auto actual = rnns->forward(x);
+    end = std::chrono::system_clock::now();
+    const auto int8_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    const auto error = (actual - expected).abs();
+    std::cerr << name << " fp32=" << fp32_ms << "ms int8=" << int8_ms << "ms"
+              << " max_abs_err=" << error.max().item<float>()
+              << " mean_abs_err=" << error.mean().item<float>() << '\n';
+}
+
+// Basecalls the reads in |reads_path| on the CPU with |module|, like the basecaller does but
+// without read splitting, and returns the sequence of each read by read ID.
+std::unordered_map<std::string, std::string> basecall_reads(
+        const basecall::CRFModelConfig& model_config,
+        const torch::nn::ModuleHolder<torch::nn::AnyModule>& module,
+        const std::string& reads_path) {
+    std::vector<basecall::RunnerPtr> runners;
+    runners.push_back(std::make_unique<basecall::ModelRunner>(model_config, "cpu", module));
+
+    // The forwarder has a single thread, so the map needs no lock.
+    std::unordered_map<std::string, std::string> sequences;
+    auto store_sequence = [&sequences](Message&& message) {
+        const auto& read_common = get_read_common_data(message);
+        sequences[read_common.read_id] = read_common.seq;
+    };
+    PipelineDescriptor pipeline_desc;
+    auto sink = pipeline_desc.add_node<ReadForwarderNode>({}, 1000, store_sequence);
+    api::create_simplex_pipeline(pipeline_desc, std::move(runners), {},
+                                 uint32_t(model_config.mean_qscore_start_pos), false, 2, false, 1,
+                                 1, sink, PipelineDescriptor::InvalidNodeHandle);
+    auto pipeline = Pipeline::create(std::move(pipeline_desc), nullptr);
+    if (pipeline == nullptr) {
+        throw std::runtime_error("Failed to create basecalling pipeline");
+    }
+
+    DataLoader loader(*pipeline, "cpu", 2, 0, std::nullopt, {});
+    loader.load_reads(reads_path, false, ReadOrder::UNRESTRICTED);
+    pipeline->terminate(DefaultFlushOptions());
+    return sequences;
+}
+
+// Basecalls the reads in |reads_path| with the fp32 LSTMs of the model at |model_path|, and then
+// with them quantised to int8, and reports how much the calls differ.
+void compare_int8_basecalls(const std::string& model_path, const std::string& reads_path) {
+    auto model_config = basecall::load_crf_model_config(model_path);
+    if (model_config.is_tx_model()) {
+        throw std::runtime_error("--lstm-model must be an LSTM model");
+    }
+    if (model_config.basecaller.batch_size() == 0) {
+        // The basecaller's CPU default.
+        model_config.basecaller.update(basecall::BasecallerParams::Priority::CONFIG, std::nullopt,
+                                       std::nullopt, 128);
+    }
+    model_config.normalise_basecaller_params();
+    std::cerr << "lstm model : " << model_path << '\n' << "reads : " << reads_path << '\n';
+
+    const auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCPU);
+    auto run = [&](const char* name, const torch::nn::ModuleHolder<torch::nn::AnyModule>& module) {
+        const auto start = std::chrono::steady_clock::now();
+        auto sequences = basecall_reads(model_config, module, reads_path);
+        const auto end = std::chrono::steady_clock::now();
+        std::cerr << name << " reads=" << sequences.size() << " "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()
+                  << "ms" << '\n';
+        return sequences;
+    };
+    const auto fp32_sequences =
+            run("fp32        ", basecall::load_crf_model(model_config, options));
+    auto int8_module = basecall::load_crf_model(model_config, options);
+    int8_module->get<basecall::nn::CRFModel>()->rnns->quantize_for_cpu();
+    const auto int8_sequences = run("int8        ", int8_module);
+
+    // Identity is 1 - edit distance / length of the longer call, with fp32 as the reference.
+    size_t num_compared = 0;
+    size_t num_identical = 0;
+    double total_identity = 0;
+    double min_identity = 1;
+    for (const auto& [read_id, fp32_seq] : fp32_sequences) {
+        const auto it = int8_sequences.find(read_id);
+        if (it == int8_sequences.end()) {
+            continue;
+        }
+        const auto& int8_seq = it->second;
+        ++num_compared;
+        if (int8_seq == fp32_seq) {
+            ++num_identical;
+            total_identity += 1;
+            continue;
+        }
+        auto result = edlibAlign(int8_seq.data(), int(int8_seq.size()), fp32_seq.data(),
+                                 int(fp32_seq.size()), edlibDefaultAlignConfig());
+        const double identity =
+                1.0 - double(result.editDistance) /
+                              double(std::max({int8_seq.size(), fp32_seq.size(), size_t(1)}));
+        edlibFreeAlignResult(result);
+        total_identity += identity;
+        min_identity = std::min(min_identity, identity);
+    }
+    if (num_compared == 0) {
+        throw std::runtime_error("No reads were basecalled from " + reads_path);
+    }
+    std::cerr << "int8 vs fp32 reads=" << num_compared << " identical=" << num_identical
+              << " mean_identity=" << total_identity / double(num_compared)
+              << " min_identity=" << min_identity << '\n';
+}
+
+struct TuningPoint {
+    int chunk_size{0};
+    int batch_size{0};
+    int num_runners{0};
+    int decode_threads{0};
+    double samples_per_second{0};
+    size_t peak_memory_bytes{0};
+};
+
+std::vector<int> parse_int_list(const std::string& arg) {
+    std::vector<int> values;
+    for (const auto& value : utils::split(arg, ',')) {
+        if (value.empty()) {
+            continue;
+        }
+        values.push_back(std::stoi(value));
+        if (values.back() <= 0) {
+            throw std::runtime_error("Expected positive values, got " + arg);
+        }
+    }
+    return values;
+}
+
+// Runs |point.num_runners| CPU runners sharing |module|, each on its own thread, through
+// |num_batches| full batches of noise, and fills in the throughput and peak process memory.
+// Returns false if the chunk size isn't usable with this model.
+bool measure_cpu_point(const basecall::CRFModelConfig& model_config,
+                       const torch::nn::ModuleHolder<torch::nn::AnyModule>& module,
+                       int num_batches,
+                       TuningPoint& point) {
+    auto config = model_config;
+    config.basecaller.set_chunk_size(point.chunk_size);
+    config.basecaller.set_batch_size(point.batch_size);
+    config.normalise_basecaller_params();
+    if (config.basecaller.chunk_size() <= config.basecaller.overlap()) {
+        return false;
+    }
+    point.chunk_size = config.basecaller.chunk_size();
+
+    utils::reset_peak_process_memory();
+    std::vector<std::unique_ptr<basecall::ModelRunner>> runners;
+    for (int i = 0; i < point.num_runners; ++i) {
+        auto runner = std::make_unique<basecall::ModelRunner>(config, "cpu", module);
+        runner->set_num_decode_threads(point.decode_threads);
+        for (int chunk = 0; chunk < point.batch_size; ++chunk) {
+            runner->accept_chunk(chunk, at::randn({config.num_features, point.chunk_size}));
+        }
+        runners.push_back(std::move(runner));
+    }
+
+    auto run_batches = [&runners](int batches) {
+        std::vector<std::thread> threads;
+        for (auto& runner : runners) {
+            threads.emplace_back([&runner, batches] {
+                for (int i = 0; i < batches; ++i) {
+                    runner->call_chunks(int(runner->batch_size()));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    };
+    // The first batch also allocates each runner's working memory.
+    run_batches(1);
+    const auto start = std::chrono::steady_clock::now();
+    run_batches(num_batches);
+    const auto end = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    const double samples =
+            double(point.num_runners) * num_batches * point.batch_size * point.chunk_size;
+    point.samples_per_second = samples / std::max(seconds, 1e-6);
+    point.peak_memory_bytes = utils::peak_process_memory_bytes();
+
+    std::cerr << "chunksize=" << point.chunk_size << " batchsize=" << point.batch_size
+              << " runners=" << point.num_runners << " decode_threads=" << point.decode_threads
+              << " samples/s=" << int64_t(point.samples_per_second)
+              << " peak_memory=" << point.peak_memory_bytes / (1024 * 1024) << "MB" << '\n';
+    return true;
+}
+
+// Sweeps one setting at a time, keeping the best value of each before moving on to the next:
+// chunk and batch size with a single runner first, then runner count, then decode threads.
+// A full grid would take hours for the larger models.
+int tune_cpu(const argparse::ArgumentParser& parser) {
+    const auto model_path = parser.get<std::string>("--tune");
+    auto model_config = basecall::load_crf_model_config(model_path);
+    model_config.normalise_basecaller_params();
+
+    auto chunk_sizes = parse_int_list(parser.get<std::string>("--chunksizes"));
+    if (chunk_sizes.empty()) {
+        chunk_sizes = {model_config.basecaller.chunk_size() / 2,
+                       model_config.basecaller.chunk_size()};
+    }
+    const auto batch_sizes = parse_int_list(parser.get<std::string>("--batchsizes"));
+    auto runner_counts = parse_int_list(parser.get<std::string>("--runners"));
+    if (runner_counts.empty()) {
+        const int max_runners = int(std::max(1u, std::thread::hardware_concurrency() / 2));
+        for (int n = 1; n <= max_runners; n *= 2) {
+            runner_counts.push_back(n);
+        }
+    }
+    const auto decode_threads = parse_int_list(parser.get<std::string>("--decode-threads"));
+    const int num_batches = parser.get<int>("--batches");
+    if (batch_sizes.empty() || decode_threads.empty() || num_batches < 1) {
+        std::cerr << "--batchsizes and --decode-threads must not be empty, and --batches must be "
+                     "positive"
+                  << '\n';
+        return EXIT_FAILURE;
+    }
+
+    // Load the weights once, and share them between all the runners like basecalling does.
+    const auto module = [&] {
+        auto config = model_config;
+        config.basecaller.set_batch_size(batch_sizes.front());
+        basecall::ModelRunner runner(config, "cpu");
+        runner.measure_working_memory();
+        return runner.module();
+    }();
+
+    std::cerr << "tuning : " << model_path << '\n';
+    TuningPoint best;
+    best.num_runners = 1;
+    best.decode_threads = basecall::decode::DecoderOptions{}.num_threads;
+    auto try_point = [&](TuningPoint point) {
+        if (measure_cpu_point(model_config, module, num_batches, point) &&
+            point.samples_per_second > best.samples_per_second) {
+            best = point;
+        }
+    };
+
+    for (int chunk_size : chunk_sizes) {
+        for (int batch_size : batch_sizes) {
+            try_point({chunk_size, batch_size, best.num_runners, best.decode_threads});
+        }
+    }
+    if (best.samples_per_second == 0) {
+        std::cerr << "No usable chunk size for this model" << '\n';
+        return EXIT_FAILURE;
+    }
+    const auto tuned_batch = best;
+    for (int num_runners : runner_counts) {
+        if (num_runners != tuned_batch.num_runners) {
+            try_point({tuned_batch.chunk_size, tuned_batch.batch_size, num_runners,
+                       tuned_batch.decode_threads});
+        }
+    }
+    const auto tuned_runners = best;
+    for (int threads : decode_threads) {
+        if (threads != tuned_runners.decode_threads) {
+            try_point({tuned_runners.chunk_size, tuned_runners.batch_size,
+                       tuned_runners.num_runners, threads});
+        }
+    }
+
+    basecall::TuningProfile profile;
+    profile.model = basecall::tuning_model_name(model_config);
+    profile.host = basecall::tuning_host_id();
+    profile.chunk_size = best.chunk_size;
+    profile.batch_size = best.batch_size;
+    profile.num_runners = best.num_runners;
+    profile.decode_threads = best.decode_threads;
+    profile.samples_per_second = best.samples_per_second;
+    profile.peak_memory_bytes = best.peak_memory_bytes;
+
+    const auto tuning_dir = parser.get<std::string>("--tuning-dir");
+    const auto path = basecall::save_tuning_profile(
+            profile, tuning_dir.empty() ? basecall::default_tuning_dir()
+                                        : std::filesystem::path(tuning_dir));
+    std::cerr << "best : chunksize=" << best.chunk_size << " batchsize=" << best.batch_size
+              << " runners=" << best.num_runners << " decode_threads=" << best.decode_threads
+              << " samples/s=" << int64_t(best.samples_per_second) << '\n'
+              << "wrote tuning profile " << path.string() << '\n';
+    return EXIT_SUCCESS;
+}
+
+}  // namespace
+
 int benchmark(int argc, char* argv[]) {
     argparse::ArgumentParser parser("dorado", DORADO_VERSION, argparse::default_arguments::help);
+    parser.add_argument("--lstm-model")
+            .help("LSTM model directory to also compare int8 and fp32 CPU basecalls with, on "
+                  "the reads given by --reads.")
+            .default_value(std::string());
+    parser.add_argument("--reads")
+            .help("POD5 or FAST5 file or directory of reads to basecall for --lstm-model, e.g. "
+                  "tests/data/pod5/dna_r10.4.1_e8.2_400bps_5khz in a dorado checkout.")
+            .default_value(std::string());
+    parser.add_argument("--tune")
+            .help("Model directory to tune CPU basecalling for. Sweeps the settings below on "
+                  "random signal, writes the fastest as a tuning profile for this host and "
+                  "skips the other benchmarks. Later CPU basecalling with the model uses it.")
+            .default_value(std::string());
+    parser.add_argument("--chunksizes")
+            .help("Comma separated chunk sizes to try. Defaults to the model's chunk size and "
+                  "half of it.")
+            .default_value(std::string());
+    parser.add_argument("--batchsizes")
+            .help("Comma separated batch sizes to try.")
+            .default_value(std::string("32,64,128,256"));
+    parser.add_argument("--runners")
+            .help("Comma separated runner counts to try. Defaults to powers of 2 up to half "
+                  "the hardware threads.")
+            .default_value(std::string());
+    parser.add_argument("--decode-threads")
+            .help("Comma separated decode thread counts to try.")
+            .default_value(std::string("1,2,4,8"));
+    parser.add_argument("--batches")
+            .help("Number of batches each runner calls per measurement.")
+            .default_value(3)
+            .scan<'i', int>();
+    parser.add_argument("--tuning-dir")
+            .help("Directory to write the tuning profile to. Defaults to where basecalling looks "
+                  "for profiles: $DORADO_TUNING_DIR, or .dorado/tuning in the home directory.")
+            .default_value(std::string());
+    parser.add_argument("--read-ids")
+            .help("Comma separated read ID counts to benchmark read ID sets with, e.g. "
+                  "1000000,10000000,50000000. Skipped by default, as large counts take minutes "
+                  "and several GB of memory.")
+            .default_value(std::string());
 
+    std::vector<int> read_id_counts;
     try {
         parser.parse_args(argc, argv);
+        read_id_counts = parse_int_list(parser.get<std::string>("--read-ids"));
+        if (!parser.get<std::string>("--lstm-model").empty() &&
+            parser.get<std::string>("--reads").empty()) {
+            throw std::runtime_error("--lstm-model needs reads to basecall, given by --reads");
+        }
     } catch (const std::exception& e) {
         std::cerr << e.what() << '\n';
         std::cerr << parser;
         return EXIT_FAILURE;
     }
 
+    if (!parser.get<std::string>("--tune").empty()) {
+        try {
+            return tune_cpu(parser);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
     std::vector<size_t> sizes{1000, 1000, 2000, 3000, 4000, 10000, 100000, 1000000, 10000000};
 
     for (auto n : sizes) {
@@ -65,6 +447,168 @@ int benchmark(int argc, char* argv[]) {
                   << '\n';
     }
 
+    // Pore signal detection, as used by the duplex read splitter.
+    for (auto n : sizes) {
+        std::cerr << "pore detection samples : " << n << '\n';
+
+        // Scaled signal with sparse open pore spikes, as float16 like ScalerNode output.
+        auto x = at::randn(n);
+        x.index_put_({at::rand(n) < 1e-4}, 4.f);
+        x = x.to(at::ScalarType::Half);
+        constexpr float threshold = 2.4f;
+        constexpr uint64_t cluster_dist = 500;
+
+        // Float32 conversion + scalar scan
+        auto start = std::chrono::system_clock::now();
+        auto float_ranges =
+                splitter::detect_pore_signal<float>(x.to(at::kFloat), threshold, cluster_dist, 0);
+        auto end = std::chrono::system_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        std::cerr << "float32      "
+                  << " clusters=" << float_ranges.size() << " " << duration << "us ("
+                  << n / std::max<int64_t>(duration, 1) << " Msamples/s)" << '\n';
+
+        // 16 bit raw scan
+        start = std::chrono::system_clock::now();
+        auto ranges_16bit = splitter::detect_pore_signal_16bit(x, threshold, cluster_dist, 0);
+        end = std::chrono::system_clock::now();
+        duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        std::cerr << "16bit        "
+                  << " clusters=" << ranges_16bit.size() << " " << duration << "us ("
+                  << n / std::max<int64_t>(duration, 1) << " Msamples/s)" << '\n'
+                  << '\n';
+    }
+
+    // Read ID tracking, as used for resume and read lists, at the sizes given by --read-ids.
+    // IDs are generated on the fly so that only the sets themselves take up memory.
+    auto make_read_id = [](uint64_t i) {
+        auto mix = [](uint64_t x) {
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            return x ^ (x >> 31);
+        };
+        const uint64_t hi = mix(2 * i + 1);
+        const uint64_t lo = mix(2 * i + 2);
+        char read_id[37];
+        std::snprintf(read_id, sizeof(read_id), "%08x-%04x-%04x-%04x-%012llx", uint32_t(hi >> 32),
+                      uint32_t(hi >> 16) & 0xffff, uint32_t(hi) & 0xffff, uint32_t(lo >> 48),
+                      (unsigned long long)(lo & 0xffffffffffffull));
+        return std::string(read_id);
+    };
+    for (const uint64_t n : read_id_counts) {
+        std::cerr << "read ids : " << n << '\n';
+
+        {
+            auto start = std::chrono::system_clock::now();
+            std::unordered_set<std::string> read_ids;
+            for (uint64_t i = 0; i < n; ++i) {
+                read_ids.insert(make_read_id(i));
+            }
+            auto end = std::chrono::system_clock::now();
+            auto insert_ms =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+            start = std::chrono::system_clock::now();
+            size_t found = 0;
+            for (uint64_t i = 0; i < n; ++i) {
+                found += read_ids.count(make_read_id(i));
+            }
+            end = std::chrono::system_clock::now();
+            auto lookup_ms =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+            // Buckets, plus a node holding the next pointer, cached hash and heap allocated string.
+            const size_t bytes = read_ids.bucket_count() * sizeof(void*) +
+                                 read_ids.size() * (2 * sizeof(void*) + sizeof(std::string) + 48);
+            std::cerr << "unordered_set"
+                      << " found=" << found << " insert=" << insert_ms << "ms"
+                      << " lookup=" << lookup_ms << "ms"
+                      << " memory~" << bytes / (1024 * 1024) << "MB" << '\n';
+        }
+        {
+            auto start = std::chrono::system_clock::now();
+            utils::ReadIdSet read_ids;
+            for (uint64_t i = 0; i < n; ++i) {
+                read_ids.insert(make_read_id(i));
+            }
+            auto end = std::chrono::system_clock::now();
+            auto insert_ms =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+            start = std::chrono::system_clock::now();
+            size_t found = 0;
+            for (uint64_t i = 0; i < n; ++i) {
+                found += read_ids.count(make_read_id(i));
+            }
+            end = std::chrono::system_clock::now();
+            auto lookup_ms =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+            std::cerr << "ReadIdSet    "
+                      << " found=" << found << " insert=" << insert_ms << "ms"
+                      << " lookup=" << lookup_ms << "ms"
+                      << " memory=" << read_ids.memory_bytes() / (1024 * 1024) << "MB" << '\n'
+                      << '\n';
+        }
+    }
+
+    // CPU conv layers: Conv1d plus a separate activation, then the NTC copy the next stack makes,
+    // against the fused CPU conv engine.
+    {
+        using basecall::Activation;
+        const std::vector<std::pair<std::string, basecall::ConvParams>> conv_layers{
+                {"hac conv1    ", {1, 16, 5, 1, Activation::SWISH}},
+                {"hac conv3    ", {16, 384, 19, 6, Activation::TANH}},
+                {"sup conv2    ", {64, 64, 5, 1, Activation::SWISH}},
+                {"sup conv3    ", {64, 128, 9, 3, Activation::SWISH}},
+                {"sup conv5    ", {128, 512, 5, 2, Activation::SWISH_CLAMP}},
+        };
+        torch::NoGradGuard no_grad;
+        std::cerr << "conv layers : N=16 T=6000" << '\n';
+        for (const auto& [name, params] : conv_layers) {
+            basecall::nn::ConvStack conv(std::vector<basecall::ConvParams>{params});
+            const auto x = at::randn({16, params.insize, 6000});
+            // Warm up both, which also builds the engine's weights and workspaces.
+            conv->forward_torch(x).contiguous();
+            conv->forward_cpu(x);
+
+            auto start = std::chrono::system_clock::now();
+            conv->forward_torch(x).contiguous();
+            auto end = std::chrono::system_clock::now();
+            const auto torch_us =
+                    std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+            start = std::chrono::system_clock::now();
+            conv->forward_cpu(x);
+            end = std::chrono::system_clock::now();
+            const auto fused_us =
+                    std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+            std::cerr << name << " torch=" << torch_us << "us fused=" << fused_us << "us" << '\n';
+        }
+        std::cerr << '\n';
+    }
+
+    // Int8 CPU LSTM against fp32, with random weights at fast and hac layer sizes.
+    for (int layer_size : {96, 384}) {
+        std::cerr << "lstm layer size : " << layer_size << '\n';
+        torch::manual_seed(0);
+        basecall::nn::LSTMStack rnns(5, layer_size);
+        rnns->eval();
+        compare_int8_lstm("LSTMStack   ", rnns, at::randn({16, 1000, layer_size}));
+        std::cerr << '\n';
+    }
+
+    const auto lstm_model_path = parser.get<std::string>("--lstm-model");
+    if (!lstm_model_path.empty()) {
+        try {
+            compare_int8_basecalls(lstm_model_path, parser.get<std::string>("--reads"));
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
     return EXIT_SUCCESS;
 }
 
@@ -3,6 +3,7 @@
 
 #include "dorado_version.h"
 #include "models/kits.h"
+#include "read_pipeline/ReadTracer.h"
 #include "utils/bam_utils.h"
 #include "utils/dev_utils.h"
 
@@ -186,6 +187,39 @@ inline void add_internal_arguments(ArgParser& parser) {
     parser.hidden.add_argument("--dump_stats_filter")
             .help("Internal processing stats. name filter regex.")
             .default_value(std::string(""));
+    parser.hidden.add_argument("--trace_reads_fraction")
+            .help("Internal per-read latency tracing. Fraction of reads traced, 0 to disable.")
+            .default_value(0.f)
+            .scan<'g', float>();
+    parser.hidden.add_argument("--trace_reads_file")
+            .help("Internal per-read latency tracing. Chrome trace output filename.")
+            .default_value(std::string(""));
+}
+
+// The number of traced reads written to the --trace_reads_file.
+constexpr size_t MAX_EXPORTED_READ_TRACES = 1000;
+
+// Starts tracing reads if --trace_reads_fraction was given. Call before loading any reads.
+inline void start_read_tracing(ArgParser& parser) {
+    ReadTracer::instance().configure(parser.hidden.get<float>("--trace_reads_fraction"),
+                                     MAX_EXPORTED_READ_TRACES);
+}
+
+// Logs the latency of the traced reads, and writes the --trace_reads_file if given.
+inline void finish_read_tracing(ArgParser& parser) {
+    if (!ReadTracer::is_enabled()) {
+        return;
+    }
+    const auto stats = ReadTracer::instance().sample_stats();
+    if (stats.count("end_to_end_count") > 0) {
+        spdlog::info("> Traced {} reads, latency p50 {:.0f}ms, p90 {:.0f}ms, p99 {:.0f}ms",
+                     stats.at("end_to_end_count"), stats.at("end_to_end_p50_ms"),
+                     stats.at("end_to_end_p90_ms"), stats.at("end_to_end_p99_ms"));
+    }
+    const auto trace_file = parser.hidden.get<std::string>("--trace_reads_file");
+    if (!trace_file.empty()) {
+        ReadTracer::instance().write_chrome_trace(trace_file);
+    }
 }
 
 inline void add_minimap2_arguments(ArgParser& parser, const std::string& default_preset) {
@@ -250,6 +250,7 @@ int demuxer(int argc, char* argv[]) {
 
     auto client_info = std::make_shared<DefaultClientInfo>();
     reader.set_client_info(client_info);
+    reader.enable_threads(demux_writer_threads);
 
     PipelineDescriptor pipeline_desc;
     auto demux_writer = pipeline_desc.add_node<BarcodeDemuxerNode>(
@@ -318,6 +319,7 @@ int demuxer(int argc, char* argv[]) {
     for (size_t input_idx = 1; input_idx < all_files.size(); input_idx++) {
         HtsReader input_reader(all_files[input_idx].input, read_list);
         input_reader.set_client_info(client_info);
+        input_reader.enable_threads(demux_writer_threads);
         if (!strip_alignment) {
             input_reader.set_record_mutator([&sq_mapping, input_idx](BamPtr& record) {
                 adjust_tid(sq_mapping[input_idx], record);
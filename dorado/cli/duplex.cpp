@@ -15,7 +15,9 @@
 #include "read_pipeline/HtsWriter.h"
 #include "read_pipeline/ProgressTracker.h"
 #include "read_pipeline/ReadFilterNode.h"
+#include "read_pipeline/ReadPool.h"
 #include "read_pipeline/ReadToBamTypeNode.h"
+#include "read_pipeline/ReadTracer.h"
 #include "utils/SampleSheet.h"
 #include "utils/bam_utils.h"
 #include "utils/basecaller_utils.h"
@@ -176,8 +178,9 @@ DuplexModels load_models(const std::string& model_arg,
     model_config.normalise_basecaller_params();
 
     if (device == "cpu" && model_config.basecaller.batch_size() == 0) {
-        // Force the batch size to 128
-        model_config.basecaller.set_batch_size(128);
+        // Default the batch size to 128, below the priority of a tuning profile.
+        model_config.basecaller.update(basecall::BasecallerParams::Priority::CONFIG, std::nullopt,
+                                       std::nullopt, 128);
     }
 #if DORADO_METAL_BUILD
     else if (device == "metal" && model_config.is_tx_model() &&
@@ -205,7 +208,8 @@ DuplexModels load_models(const std::string& model_arg,
     }
 #endif
     if (device == "cpu" && stereo_model_config.basecaller.batch_size() == 0) {
-        stereo_model_config.basecaller.set_batch_size(128);
+        stereo_model_config.basecaller.update(basecall::BasecallerParams::Priority::CONFIG,
+                                              std::nullopt, std::nullopt, 128);
     }
 
     return DuplexModels{model_path,          model_name,
@@ -454,7 +458,13 @@ int duplex(int argc, char* argv[]) {
                 [&tracker](const stats::NamedStats& stats) { tracker.update_progress_bar(stats); });
         stats::NamedStats final_stats;
         std::unique_ptr<dorado::stats::StatsSampler> stats_sampler;
-        std::vector<dorado::stats::StatsReporter> stats_reporters{dorado::stats::sys_stats_report};
+        std::vector<dorado::stats::StatsReporter> stats_reporters{
+                dorado::stats::sys_stats_report,
+                dorado::stats::make_stats_reporter(ReadPool::instance())};
+        cli::start_read_tracing(parser);
+        if (ReadTracer::is_enabled()) {
+            stats_reporters.push_back(dorado::stats::make_stats_reporter(ReadTracer::instance()));
+        }
 
         constexpr auto kStatsPeriod = 100ms;
 
@@ -682,6 +692,7 @@ int duplex(int argc, char* argv[]) {
         });
 
         tracker.summarize();
+        cli::finish_read_tracing(parser);
         if (!dump_stats_file.empty()) {
             std::ofstream stats_file(dump_stats_file);
             stats_sampler->dump_stats(stats_file,
@@ -12,6 +12,7 @@
 #include <cctype>
 #include <csignal>
 #include <filesystem>
+#include <thread>
 
 namespace dorado {
 
@@ -21,6 +22,11 @@ int summary(int argc, char *argv[]) {
     argparse::ArgumentParser parser("dorado", DORADO_VERSION, argparse::default_arguments::help);
     parser.add_argument("reads").help("SAM/BAM file produced by dorado basecaller.");
     parser.add_argument("-s", "--separator").default_value(std::string("\t"));
+    parser.add_argument("-t", "--threads")
+            .help("Number of threads for decompressing BAM input. Default uses all available "
+                  "threads.")
+            .default_value(0)
+            .scan<'i', int>();
     int verbosity = 0;
     parser.add_argument("-v", "--verbose")
             .default_value(false)
@@ -45,8 +51,12 @@ int summary(int argc, char *argv[]) {
     auto reads(parser.get<std::string>("reads"));
     auto separator(parser.get<std::string>("separator"));
 
+    auto threads(parser.get<int>("threads"));
+    threads = threads == 0 ? std::thread::hardware_concurrency() : threads;
+
     SummaryData summary;
     summary.set_separator(separator[0]);
+    summary.set_threads(threads);
     summary.process_file(reads, std::cout);
 
     return EXIT_SUCCESS;
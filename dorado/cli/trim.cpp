@@ -149,6 +149,7 @@ int trim(int argc, char* argv[]) {
     auto client_info = std::make_shared<DefaultClientInfo>();
     client_info->contexts().register_context<const demux::AdapterInfo>(adapter_info);
     reader.set_client_info(client_info);
+    reader.enable_threads(trim_writer_threads);
 
     pipeline_desc.add_node<AdapterDetectorNode>({hts_writer}, trim_threads);
 
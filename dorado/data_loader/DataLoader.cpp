@@ -1,18 +1,24 @@
 #include "DataLoader.h"
 
+#include "DatasetManifest.h"
+#include "DirectoryWatcher.h"
+#include "Fast5ProcessPool.h"
+#include "Fast5Reader.h"
 #include "models/kits.h"
 #include "models/models.h"
 #include "read_pipeline/ReadPipeline.h"
+#include "read_pipeline/ReadPool.h"
+#include "read_pipeline/ReadTracer.h"
 #include "read_pipeline/messages.h"
 #include "utils/PostCondition.h"
+#include "utils/dev_utils.h"
+#include "utils/fs_utils.h"
 #include "utils/time_utils.h"
 #include "utils/types.h"
 #include "vbz_plugin_user_utils.h"
 
 #include <ATen/Functions.h>
 #include <cxxpool.h>
-#include <highfive/H5Easy.hpp>
-#include <highfive/H5File.hpp>
 #include <pod5_format/c_api.h>
 #include <spdlog/spdlog.h>
 
@@ -23,89 +29,25 @@
 #include <mutex>
 #include <optional>
 #include <stdexcept>
+#include <unordered_set>
 #include <vector>
 
 namespace dorado {
 
 namespace {
 
-/**
- * @brief Fetches directory entries from a specified path.
- *
- * This function fetches all directory entries from the specified path. If the path is not a directory,
- * it will return a vector containing a single entry representing the specified file.
- * It can operate in two modes: recursive and non-recursive. In recursive mode, it fetches entries from
- * all subdirectories recursively. In non-recursive mode, it only fetches entries from the top-level directory.
- *
- * @param path The path from which to fetch the directory entries. It can be a path to a file or a directory.
- * @param recursive A boolean flag indicating whether to operate in recursive mode.
- *                  True for recursive mode, false for non-recursive mode.
- * @return A vector of directory entries fetched from the specified path.
- */
-auto fetch_directory_entries(const std::filesystem::path& path, bool recursive) {
-    using DirEntry = std::filesystem::directory_entry;
-
-    std::vector<DirEntry> entries;
-
-    if (std::filesystem::is_directory(path)) {
-        if (recursive) {
-            for (const auto& entry : std::filesystem::recursive_directory_iterator(path)) {
-                entries.push_back(entry);
-            }
-        } else {
-            for (const auto& entry : std::filesystem::directory_iterator(path)) {
-                entries.push_back(entry);
-            }
-        }
-    } else {
-        entries.push_back(DirEntry(path));
-    }
-
-    return entries;
-}
-
 // ReadID should be a drop-in replacement for read_id_t
 static_assert(sizeof(dorado::ReadID) == sizeof(read_id_t));
 
-// 37 = number of bytes in UUID (32 hex digits + 4 dashes + null terminator)
-const uint32_t POD5_READ_ID_LEN = 37;
-
-void string_reader(HighFive::Attribute& attribute, std::string& target_str) {
-    // Load as a variable string if possible
-    if (attribute.getDataType().isVariableStr()) {
-        attribute.read(target_str);
-        return;
-    }
+// Signal held in memory while loading a group of channels in channel order: 512MB of int16
+// samples, on top of what's queued in the pipeline.
+const uint64_t DEFAULT_CHANNEL_GROUP_SAMPLES = uint64_t(1) << 28;
 
-    // Process as a fixed length string
-    // Create landing buffer and H5 datatype
-    size_t size = attribute.getDataType().getSize();
-    std::vector<char> target_array(size);
-    hid_t dtype = H5Tcopy(H5T_C_S1);
-    H5Tset_size(dtype, size);
+// Shared memory between each FAST5 worker process and the loader.
+const size_t DEFAULT_FAST5_WORKER_RING_MB = 64;
 
-    // Copy to landing buffer
-    if (H5Aread(attribute.getId(), dtype, target_array.data()) < 0) {
-        throw std::runtime_error("Error during H5Aread of fixed length string");
-    }
-
-    // Extract to string
-    target_str = std::string(target_array.data(), size);
-    // It's possible the null terminator appears before the end of the string
-    size_t eol_pos = target_str.find(char(0));
-    if (eol_pos < target_str.size()) {
-        target_str.resize(eol_pos);
-    }
-}
-
-std::string get_string_attribute(const HighFive::Group& group, const std::string& attr_name) {
-    std::string attribute_string;
-    if (group.hasAttribute(attr_name)) {
-        HighFive::Attribute attribute = group.getAttribute(attr_name);
-        string_reader(attribute, attribute_string);
-    }
-    return attribute_string;
-}
+// 37 = number of bytes in UUID (32 hex digits + 4 dashes + null terminator)
+const uint32_t POD5_READ_ID_LEN = 37;
 
 std::vector<std::filesystem::directory_entry> filter_fast5_for_mixed_datasets(
         const std::vector<std::filesystem::directory_entry>& files) {
@@ -161,6 +103,14 @@ models::ChemistryKey get_chemistry_key(const RunInfoDictData_t* const run_info_d
     return key;
 }
 
+// As above, for run info collected by the dataset manifest.
+models::ChemistryKey get_chemistry_key(const DatasetFile::RunInfo& run_info) {
+    const auto fc = models::flowcell_code(run_info.flow_cell_product_code);
+    const auto kit = models::kit_code(run_info.sequencing_kit);
+    const auto key = models::ChemistryKey(fc, kit, run_info.sample_rate);
+    return key;
+}
+
 SimplexReadPtr process_pod5_read(
         size_t row,
         Pod5ReadRecordBatch* batch,
@@ -197,7 +147,7 @@ SimplexReadPtr process_pod5_read(
         spdlog::error("Failed to get read {} signal: {}", row, pod5_get_error_string());
     }
 
-    auto new_read = std::make_unique<SimplexRead>();
+    auto new_read = ReadPool::instance().acquire();
     new_read->read_common.raw_data = samples;
     new_read->read_common.sample_rate = run_sample_rate;
 
@@ -268,10 +218,38 @@ SimplexReadPtr process_pod5_read(
     return new_read;
 }
 
+SimplexReadPtr create_fast5_read(Fast5Read&& fast5_read) {
+    // The tensor takes ownership of the decoded signal rather than copying it.
+    auto* signal = new std::vector<int16_t>(std::move(fast5_read.signal));
+    auto samples = at::from_blob(
+            signal->data(), {int64_t(signal->size())}, [signal](void*) { delete signal; },
+            at::TensorOptions().dtype(at::kShort));
+
+    auto new_read = ReadPool::instance().acquire();
+    new_read->read_common.sample_rate = uint64_t(fast5_read.sampling_rate);
+    new_read->read_common.raw_data = samples;
+    new_read->digitisation = fast5_read.digitisation;
+    new_read->range = fast5_read.range;
+    new_read->offset = fast5_read.offset;
+    new_read->scaling = fast5_read.range / fast5_read.digitisation;
+    new_read->read_common.read_id = std::move(fast5_read.read_id);
+    new_read->read_common.num_trimmed_samples = 0;
+    new_read->read_common.attributes.mux = fast5_read.mux;
+    new_read->read_common.attributes.read_number = fast5_read.read_number;
+    new_read->read_common.attributes.channel_number = fast5_read.channel_number;
+    new_read->read_common.attributes.start_time = std::move(fast5_read.start_time);
+    new_read->read_common.attributes.fast5_filename = std::move(fast5_read.fast5_filename);
+    new_read->read_common.flowcell_id = std::move(fast5_read.flow_cell_id);
+    new_read->read_common.position_id = std::move(fast5_read.device_id);
+    new_read->read_common.experiment_id = std::move(fast5_read.group_protocol_id);
+    new_read->read_common.is_duplex = false;
+    return new_read;
+}
+
 bool can_process_pod5_row(Pod5ReadRecordBatch_t* batch,
                           int row,
-                          const std::optional<std::unordered_set<std::string>>& allowed_read_ids,
-                          const std::unordered_set<std::string>& ignored_read_ids) {
+                          const std::optional<utils::ReadIdSet>& allowed_read_ids,
+                          const utils::ReadIdSet& ignored_read_ids) {
     uint16_t read_table_version = 0;
     ReadBatchRowInfo_t read_data;
     if (pod5_get_read_batch_row_info_data(batch, row, READ_BATCH_ROW_INFO_VERSION, &read_data,
@@ -280,15 +258,9 @@ bool can_process_pod5_row(Pod5ReadRecordBatch_t* batch,
         return false;
     }
 
-    char read_id_tmp[POD5_READ_ID_LEN];
-    if (pod5_format_read_id(read_data.read_id, read_id_tmp) != POD5_OK) {
-        spdlog::error("Failed to format read id");
-    }
-
-    std::string read_id_str(read_id_tmp);
-    bool read_in_ignore_list = ignored_read_ids.find(read_id_str) != ignored_read_ids.end();
-    bool read_in_read_list =
-            !allowed_read_ids || (allowed_read_ids->find(read_id_str) != allowed_read_ids->end());
+    // POD5 read ids are binary UUIDs, which can be looked up without formatting them.
+    bool read_in_ignore_list = ignored_read_ids.contains(read_data.read_id);
+    bool read_in_read_list = !allowed_read_ids || allowed_read_ids->contains(read_data.read_id);
     if (!read_in_ignore_list && read_in_read_list) {
         return true;
     }
@@ -309,7 +281,7 @@ void DataLoader::load_reads(const std::filesystem::path& path,
 
     auto iterate_directory = [&](const auto& iterator) {
         switch (traversal_order) {
-        case ReadOrder::BY_CHANNEL:
+        case ReadOrder::BY_CHANNEL: {
             // If traversal in channel order is required, the following algorithm
             // is used -
             // 1. iterate through all the read metadata to collect channel information
@@ -318,56 +290,49 @@ void DataLoader::load_reads(const std::filesystem::path& path,
             spdlog::info("> Reading read channel info");
             load_read_channels(path, recursive_file_loading);
             spdlog::info("> Processed read channel info");
-            // 3. for each channel, iterate through all files and in each iteration
-            // only load the reads that correspond to that channel.
-            for (int channel = 0; channel <= m_max_channel; channel++) {
-                if (m_reads_by_channel.find(channel) != m_reads_by_channel.end()) {
-                    // Sort the read ids within a channel by its mux
-                    // and start time.
-                    spdlog::debug("Sort channel {}", channel);
-                    auto& reads = m_reads_by_channel.at(channel);
-                    std::sort(reads.begin(), reads.end(), [](ReadSortInfo& a, ReadSortInfo& b) {
-                        if (a.mux != b.mux) {
-                            return a.mux < b.mux;
-                        } else {
-                            return a.read_number < b.read_number;
-                        }
-                    });
-                    // Once sorted, create a hash table from read id
-                    // to index in the sorted list to quickly fetch the
-                    // read location and its neighbors.
-                    for (size_t i = 0; i < reads.size(); i++) {
-                        m_read_id_to_index[reads[i].read_id] = i;
-                    }
-                    spdlog::debug("Sorted channel {}", channel);
+            std::vector<std::string> pod5_paths;
+            for (const auto& entry : iterator) {
+                auto entry_path = std::filesystem::path(entry);
+                std::string ext = entry_path.extension().string();
+                std::transform(ext.begin(), ext.end(), ext.begin(),
+                               [](unsigned char c) { return std::tolower(c); });
+                if (ext == ".fast5") {
+                    throw std::runtime_error(
+                            "Traversing reads by channel is only available for POD5. "
+                            "Encountered FAST5 at " +
+                            entry_path.string());
+                } else if (ext == ".pod5") {
+                    pod5_paths.push_back(entry_path.string());
                 }
-                for (const auto& entry : iterator) {
-                    if (m_loaded_read_count == m_max_reads) {
-                        break;
-                    }
-                    auto entry_path = std::filesystem::path(entry);
-                    std::string ext = entry_path.extension().string();
-                    std::transform(ext.begin(), ext.end(), ext.begin(),
-                                   [](unsigned char c) { return std::tolower(c); });
-                    if (ext == ".fast5") {
-                        throw std::runtime_error(
-                                "Traversing reads by channel is only available for POD5. "
-                                "Encountered FAST5 at " +
-                                entry_path.string());
-                    } else if (ext == ".pod5") {
-                        auto& channel_to_read_ids =
-                                m_file_channel_read_order_map.at(entry_path.string());
-                        auto& read_ids = channel_to_read_ids[channel];
-                        if (!read_ids.empty()) {
-                            load_pod5_reads_from_file_by_read_ids(entry_path.string(), read_ids);
-                        }
-                    }
+            }
+            // 3. split the channels into groups holding at most max_group_samples of signal,
+            // and load each group with one pass over the files. A channel larger than that is
+            // loaded on its own.
+            const auto max_group_samples = utils::get_dev_opt<uint64_t>(
+                    "channel_group_samples", DEFAULT_CHANNEL_GROUP_SAMPLES);
+            int first_channel = 0;
+            uint64_t group_samples = 0;
+            for (int channel = 0; channel <= m_max_channel; channel++) {
+                const auto it = m_samples_by_channel.find(channel);
+                const uint64_t channel_samples = it == m_samples_by_channel.end() ? 0 : it->second;
+                if (channel > first_channel &&
+                    group_samples + channel_samples > max_group_samples) {
+                    load_pod5_channel_group(pod5_paths, first_channel, channel - 1);
+                    first_channel = channel;
+                    group_samples = 0;
                 }
-                // Erase sorted list as it's not needed anymore.
-                m_reads_by_channel.erase(channel);
+                group_samples += channel_samples;
             }
+            load_pod5_channel_group(pod5_paths, first_channel, m_max_channel);
             break;
-        case ReadOrder::UNRESTRICTED:
+        }
+        case ReadOrder::UNRESTRICTED: {
+            // FAST5 files can be handed to worker processes, since HDF5 can't be read from more
+            // than one thread at a time.
+            const auto num_fast5_workers = utils::get_dev_opt<size_t>("fast5_worker_processes", 0);
+            const bool use_fast5_workers =
+                    num_fast5_workers > 0 && Fast5ProcessPool::is_supported();
+            std::vector<std::string> fast5_paths;
             for (const auto& entry : iterator) {
                 if (m_loaded_read_count == m_max_reads) {
                     break;
@@ -376,61 +341,152 @@ void DataLoader::load_reads(const std::filesystem::path& path,
                 std::string ext = std::filesystem::path(entry).extension().string();
                 std::transform(ext.begin(), ext.end(), ext.begin(),
                                [](unsigned char c) { return std::tolower(c); });
-                if (ext == ".fast5") {
+                if (ext == ".fast5" && use_fast5_workers) {
+                    fast5_paths.push_back(entry.path().string());
+                } else if (ext == ".fast5") {
                     load_fast5_reads_from_file(entry.path().string());
                 } else if (ext == ".pod5") {
                     load_pod5_reads_from_file(entry.path().string());
                 }
             }
+            if (!fast5_paths.empty() && m_loaded_read_count < m_max_reads) {
+                spdlog::debug("Load reads from {} FAST5 files with {} worker processes",
+                              fast5_paths.size(), num_fast5_workers);
+                load_fast5_reads_with_workers(fast5_paths, num_fast5_workers);
+            }
             break;
+        }
         default:
             throw std::runtime_error("Unsupported traversal order detected: " +
                                      dorado::to_string(traversal_order));
         }
     };
 
-    auto filtered_entries =
-            filter_fast5_for_mixed_datasets(fetch_directory_entries(path, recursive_file_loading));
+    auto filtered_entries = filter_fast5_for_mixed_datasets(
+            utils::fetch_directory_entries(path, recursive_file_loading));
     iterate_directory(filtered_entries);
 }
 
-int DataLoader::get_num_reads(const std::filesystem::path& data_path,
-                              std::optional<std::unordered_set<std::string>> read_list,
-                              const std::unordered_set<std::string>& ignore_read_list,
-                              bool recursive_file_loading) {
-    size_t num_reads = 0;
+void DataLoader::watch_reads(const std::filesystem::path& path,
+                             const DirectoryWatchOptions& options) {
+    if (!std::filesystem::is_directory(path)) {
+        throw std::runtime_error("Watched input path " + path.string() + " is not a directory");
+    }
 
-    auto iterate_directory = [&](const auto& iterator) {
-        for (const auto& entry : iterator) {
-            std::string ext = std::filesystem::path(entry).extension().string();
-            std::transform(ext.begin(), ext.end(), ext.begin(),
-                           [](unsigned char c) { return std::tolower(c); });
-            if (ext == ".pod5") {
-                pod5_init();
-
-                // Open the file ready for walking:
-                Pod5FileReader_t* file = pod5_open_file(entry.path().string().c_str());
-
-                size_t read_count;
-                pod5_get_read_count(file, &read_count);
-                if (!file) {
-                    spdlog::error("Failed to open file {}: {}", entry.path().string().c_str(),
-                                  pod5_get_error_string());
-                }
+    // Start watching before listing the directory, so no file is missed in between. A file
+    // which is both listed and reported by the watcher is only loaded once.
+    DirectoryWatcher watcher(path);
+    {
+        std::lock_guard lock(m_watcher_mutex);
+        m_watcher = &watcher;
+    }
+    auto clear_watcher = utils::PostCondition([this] {
+        std::lock_guard lock(m_watcher_mutex);
+        m_watcher = nullptr;
+    });
 
-                num_reads += read_count;
-                if (pod5_close_and_free_reader(file) != POD5_OK) {
-                    spdlog::error("Failed to close and free POD5 reader");
-                }
-            } else if (ext == ".fast5") {
-                H5Easy::File file(entry.path().string(), H5Easy::File::ReadOnly);
-                HighFive::Group reads = file.getGroup("/");
-                num_reads += reads.getNumberObjects();
+    auto is_pod5 = [](const std::filesystem::path& file_path) {
+        std::string ext = file_path.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        return ext == ".pod5";
+    };
+    auto is_stop_file = [&options](const std::filesystem::path& file_path) {
+        return !options.stop_file_name.empty() &&
+               file_path.filename().string() == options.stop_file_name;
+    };
+
+    // A POD5 file can't be opened until its writer has finished it, so one which is still
+    // being written is left for the watcher to report once it's closed or moved into place.
+    auto can_open_pod5 = [](const std::filesystem::path& file_path) {
+        pod5_init();
+        return Pod5Ptr(pod5_open_file(file_path.string().c_str())) != nullptr;
+    };
+
+    std::unordered_set<std::string> loaded_paths;
+    bool stop_file_seen = false;
+    for (const auto& entry : utils::fetch_directory_entries(path, false)) {
+        if (m_stop_watching || m_loaded_read_count >= m_max_reads) {
+            return;
+        }
+        stop_file_seen |= is_stop_file(entry.path());
+        if (!is_pod5(entry.path()) || loaded_paths.count(entry.path().string()) != 0) {
+            continue;
+        }
+        if (!can_open_pod5(entry.path())) {
+            spdlog::debug("Deferring incomplete file {}", entry.path().string());
+            continue;
+        }
+        loaded_paths.insert(entry.path().string());
+        load_pod5_reads_from_file(entry.path().string());
+    }
+
+    spdlog::info("> Watching {} for new POD5 files", path.string());
+    auto last_arrival_time = std::chrono::steady_clock::now();
+    while (!m_stop_watching && m_loaded_read_count < m_max_reads) {
+        // Once the stop file is seen, only the files already completed are loaded.
+        auto timeout = std::chrono::milliseconds(0);
+        if (!stop_file_seen && options.idle_timeout.count() > 0) {
+            timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    last_arrival_time + options.idle_timeout - std::chrono::steady_clock::now());
+            if (timeout.count() <= 0) {
+                spdlog::info("> No POD5 files arrived for {}s, stopping",
+                             options.idle_timeout.count() / 1000.0);
+                break;
             }
+        } else if (!stop_file_seen) {
+            timeout = std::chrono::hours(1);
         }
-    };
 
-    iterate_directory(fetch_directory_entries(data_path, recursive_file_loading));
+        auto file = watcher.wait_for_file(timeout);
+        if (!file) {
+            if (stop_file_seen || watcher.is_stopped()) {
+                break;
+            }
+            continue;
+        }
+        if (is_stop_file(file->path)) {
+            spdlog::info("> Found stop file {}", file->path.string());
+            stop_file_seen = true;
+            continue;
+        }
+        if (!is_pod5(file->path) || loaded_paths.count(file->path.string()) != 0) {
+            continue;
+        }
+        if (!can_open_pod5(file->path)) {
+            // Not marked as loaded, so a later close or move of the file retries it.
+            spdlog::warn("Skipping watched file {} which can't be opened yet",
+                         file->path.string());
+            continue;
+        }
+        loaded_paths.insert(file->path.string());
+
+        spdlog::debug("Load reads from watched file {}", file->path.string());
+        last_arrival_time = file->arrival_time;
+        ++m_watched_file_count;
+        m_file_arrival_time = file->arrival_time;
+        load_pod5_reads_from_file(file->path.string());
+        m_file_arrival_time.reset();
+    }
+}
+
+void DataLoader::stop_watching() {
+    m_stop_watching = true;
+    std::lock_guard lock(m_watcher_mutex);
+    if (m_watcher) {
+        m_watcher->stop();
+    }
+}
+
+int DataLoader::get_num_reads(const std::filesystem::path& data_path,
+                              const std::optional<utils::ReadIdSet>& read_list,
+                              const utils::ReadIdSet& ignore_read_list,
+                              bool recursive_file_loading) {
+    size_t num_reads = 0;
+    const auto manifest = DatasetManifest::get(data_path, recursive_file_loading, false);
+    for (const auto& file : manifest->files()) {
+        num_reads += file.num_reads;
+    }
 
     // Remove the reads in the ignore list from the total dataset read count.
     num_reads -= ignore_read_list.size();
@@ -438,11 +494,7 @@ int DataLoader::get_num_reads(const std::filesystem::path& data_path,
     if (read_list) {
         // Get the unique read ids in the read list, since everything in the ignore
         // list will be skipped over.
-        std::vector<std::string> final_read_list;
-        std::set_difference(read_list->begin(), read_list->end(), ignore_read_list.begin(),
-                            ignore_read_list.end(),
-                            std::inserter(final_read_list, final_read_list.begin()));
-        num_reads = std::min(num_reads, final_read_list.size());
+        num_reads = std::min(num_reads, read_list->difference_size(ignore_read_list));
     }
 
     return int(num_reads);
@@ -450,87 +502,32 @@ int DataLoader::get_num_reads(const std::filesystem::path& data_path,
 
 void DataLoader::load_read_channels(const std::filesystem::path& data_path,
                                     bool recursive_file_loading) {
-    auto iterate_directory = [&](const auto& iterator) {
-        for (const auto& entry : iterator) {
-            auto file_path = std::filesystem::path(entry);
-            std::string ext = file_path.extension().string();
-            std::transform(ext.begin(), ext.end(), ext.begin(),
-                           [](unsigned char c) { return std::tolower(c); });
-            if (ext != ".pod5") {
-                continue;
-            }
-            pod5_init();
-
-            // Use a std::map to store by sorted channel order.
-            m_file_channel_read_order_map.emplace(file_path.string(), channel_to_read_id_t());
-            auto& channel_to_read_id = m_file_channel_read_order_map[file_path.string()];
-
-            // Open the file ready for walking:
-            Pod5FileReader_t* file = pod5_open_file(file_path.string().c_str());
-
-            if (!file) {
-                spdlog::error("Failed to open file {}: {}", file_path.string().c_str(),
-                              pod5_get_error_string());
-                continue;
-            }
-            std::size_t batch_count = 0;
-            if (pod5_get_read_batch_count(&batch_count, file) != POD5_OK) {
-                spdlog::error("Failed to query batch count: {}", pod5_get_error_string());
-            }
+    const auto manifest = DatasetManifest::get(data_path, recursive_file_loading, true);
+    for (const auto& file : manifest->files()) {
+        if (file.is_fast5) {
+            continue;
+        }
 
-            for (std::size_t batch_index = 0; batch_index < batch_count; ++batch_index) {
-                Pod5ReadRecordBatch_t* batch = nullptr;
-                if (pod5_get_read_batch(&batch, file, batch_index) != POD5_OK) {
-                    spdlog::error("Failed to get batch: {}", pod5_get_error_string());
-                    continue;
-                }
+        // Use a std::map to store by sorted channel order.
+        auto& channel_to_read_id = m_file_channel_read_order_map[file.path];
+        for (const auto& read : file.channel_reads) {
+            int channel = read.channel;
 
-                std::size_t batch_row_count = 0;
-                if (pod5_get_read_batch_row_count(&batch_row_count, batch) != POD5_OK) {
-                    spdlog::error("Failed to get batch row count");
-                    continue;
-                }
+            // Update maximum number of channels encountered.
+            m_max_channel = std::max(m_max_channel, channel);
 
-                for (std::size_t row = 0; row < batch_row_count; ++row) {
-                    uint16_t read_table_version = 0;
-                    ReadBatchRowInfo_t read_data;
-                    if (pod5_get_read_batch_row_info_data(batch, row, READ_BATCH_ROW_INFO_VERSION,
-                                                          &read_data,
-                                                          &read_table_version) != POD5_OK) {
-                        spdlog::error("Failed to get read {}", row);
-                        continue;
-                    }
-
-                    int channel = read_data.channel;
-
-                    // Update maximum number of channels encountered.
-                    m_max_channel = std::max(m_max_channel, channel);
-
-                    // Store the read_id in the channel's list.
-                    ReadID read_id;
-                    std::memcpy(read_id.data(), read_data.read_id, POD5_READ_ID_SIZE);
-                    channel_to_read_id[channel].push_back(read_id);
-
-                    char read_id_tmp[POD5_READ_ID_LEN];
-                    if (pod5_format_read_id(read_data.read_id, read_id_tmp) != POD5_OK) {
-                        spdlog::error("Failed to format read id");
-                    }
-                    std::string rid(read_id_tmp);
-                    m_reads_by_channel[channel].push_back(
-                            {rid, read_data.well, read_data.read_number});
-                }
+            // Store the read_id in the channel's list.
+            channel_to_read_id[channel].push_back(read.read_id);
 
-                if (pod5_free_read_batch(batch) != POD5_OK) {
-                    spdlog::error("Failed to release batch");
-                }
-            }
-            if (pod5_close_and_free_reader(file) != POD5_OK) {
-                spdlog::error("Failed to close and free POD5 reader");
+            char read_id_tmp[POD5_READ_ID_LEN];
+            if (pod5_format_read_id(read.read_id.data(), read_id_tmp) != POD5_OK) {
+                spdlog::error("Failed to format read id");
             }
+            std::string rid(read_id_tmp);
+            m_reads_by_channel[channel].push_back({rid, read.well, read.read_number});
+            m_samples_by_channel[channel] += read.num_samples;
         }
-    };
-
-    iterate_directory(fetch_directory_entries(data_path, recursive_file_loading));
+    }
 }
 
 std::unordered_map<std::string, ReadGroup> DataLoader::load_read_groups(
@@ -540,170 +537,41 @@ std::unordered_map<std::string, ReadGroup> DataLoader::load_read_groups(
         bool recursive_file_loading) {
     std::unordered_map<std::string, ReadGroup> read_groups;
 
-    auto iterate_directory = [&](const auto& iterator) {
-        for (const auto& entry : iterator) {
-            std::string ext = std::filesystem::path(entry).extension().string();
-            std::transform(ext.begin(), ext.end(), ext.begin(),
-                           [](unsigned char c) { return std::tolower(c); });
-            if (ext == ".pod5") {
-                pod5_init();
-
-                // Open the file ready for walking:
-                Pod5FileReader_t* file = pod5_open_file(entry.path().string().c_str());
-
-                if (!file) {
-                    spdlog::error("Failed to open file {}: {}", entry.path().string().c_str(),
-                                  pod5_get_error_string());
-                } else {
-                    // First get the run info count
-                    run_info_index_t run_info_count;
-                    pod5_get_file_run_info_count(file, &run_info_count);
-                    for (run_info_index_t idx = 0; idx < run_info_count; idx++) {
-                        RunInfoDictData_t* run_info_data;
-                        pod5_get_file_run_info(file, idx, &run_info_data);
-
-                        auto exp_start_time_ms = run_info_data->acquisition_start_time_ms;
-                        std::string flowcell_id = run_info_data->flow_cell_id;
-                        std::string device_id = run_info_data->system_name;
-                        std::string run_id = run_info_data->acquisition_id;
-                        std::string sample_id = run_info_data->sample_id;
-                        std::string position_id = run_info_data->sequencer_position;
-                        std::string experiment_id = run_info_data->experiment_name;
-
-                        if (pod5_free_run_info(run_info_data) != POD5_OK) {
-                            spdlog::error("Failed to free run info");
-                        }
-
-                        std::string id = std::string(run_id).append("_").append(model_name);
-                        read_groups[id] = ReadGroup{
-                                std::move(run_id),
-                                model_name,
-                                modbase_model_names,
-                                std::move(flowcell_id),
-                                std::move(device_id),
-                                utils::get_string_timestamp_from_unix_time(exp_start_time_ms),
-                                std::move(sample_id),
-                                std::move(position_id),
-                                std::move(experiment_id),
-                        };
-                    }
-                    if (pod5_close_and_free_reader(file) != POD5_OK) {
-                        spdlog::error("Failed to close and free POD5 reader");
-                    }
-                }
-            }
+    const auto manifest = DatasetManifest::get(data_path, recursive_file_loading, false);
+    for (const auto& file : manifest->files()) {
+        for (const auto& run_info : file.run_infos) {
+            std::string id = std::string(run_info.acquisition_id).append("_").append(model_name);
+            read_groups[id] = ReadGroup{
+                    run_info.acquisition_id,
+                    model_name,
+                    modbase_model_names,
+                    run_info.flow_cell_id,
+                    run_info.system_name,
+                    utils::get_string_timestamp_from_unix_time(run_info.acquisition_start_time_ms),
+                    run_info.sample_id,
+                    run_info.sequencer_position,
+                    run_info.experiment_name,
+            };
         }
-    };
-
-    iterate_directory(fetch_directory_entries(data_path, recursive_file_loading));
+    }
 
     return read_groups;
 }
 
 bool DataLoader::is_read_data_present(const std::filesystem::path& data_path,
                                       bool recursive_file_loading) {
-    auto check_directory = [&](const auto& iterator) {
-        for (const auto& entry : iterator) {
-            std::string ext = std::filesystem::path(entry).extension().string();
-            std::transform(ext.begin(), ext.end(), ext.begin(),
-                           [](unsigned char c) { return std::tolower(c); });
-            if (ext == ".pod5" || ext == ".fast5") {
-                return true;
-            }
-        }
-        return false;
-    };
-
-    return check_directory(fetch_directory_entries(data_path, recursive_file_loading));
+    return !DatasetManifest::get(data_path, recursive_file_loading, false)->files().empty();
 }
 
 uint16_t DataLoader::get_sample_rate(const std::filesystem::path& data_path,
                                      bool recursive_file_loading) {
-    std::optional<uint16_t> sample_rate = std::nullopt;
-
-    auto iterate_directory = [&](const auto& iterator) {
-        for (const auto& entry : iterator) {
-            std::string ext = std::filesystem::path(entry).extension().string();
-            std::transform(ext.begin(), ext.end(), ext.begin(),
-                           [](unsigned char c) { return std::tolower(c); });
-            auto file_path = entry.path().string();
-            if (ext == ".pod5") {
-                pod5_init();
-
-                // Open the file ready for walking:
-                Pod5FileReader_t* file = pod5_open_file(file_path.c_str());
-
-                if (!file) {
-                    spdlog::error("Failed to open file {}: {}", file_path.c_str(),
-                                  pod5_get_error_string());
-                } else {
-                    auto free_pod5 = [&]() {
-                        if (pod5_close_and_free_reader(file) != POD5_OK) {
-                            spdlog::error("Failed to close and free POD5 reader for file {}",
-                                          file_path.c_str());
-                        }
-                    };
-
-                    auto post = utils::PostCondition(free_pod5);
-
-                    // First get the run info count
-                    run_info_index_t run_info_count;
-                    if (pod5_get_file_run_info_count(file, &run_info_count) != POD5_OK) {
-                        spdlog::error("Failed to fetch POD5 run info count for file {} : {}",
-                                      file_path.c_str(), pod5_get_error_string());
-                        continue;
-                    }
-                    if (run_info_count > static_cast<run_info_index_t>(0)) {
-                        RunInfoDictData_t* run_info_data;
-                        if (pod5_get_file_run_info(file, 0, &run_info_data) != POD5_OK) {
-                            spdlog::error(
-                                    "Failed to fetch POD5 run info dict for file {} and run info "
-                                    "index 0: {}",
-                                    file_path.c_str(), pod5_get_error_string());
-                            continue;
-                        }
-                        sample_rate = run_info_data->sample_rate;
-
-                        if (pod5_free_run_info(run_info_data) != POD5_OK) {
-                            spdlog::error(
-                                    "Failed to free POD5 run info for file {} and run info index 0",
-                                    file_path.c_str());
-                        }
-                    }
-                }
-            } else if (ext == ".fast5") {
-                H5Easy::File file(entry.path().string(), H5Easy::File::ReadOnly);
-                HighFive::Group reads = file.getGroup("/");
-                int num_reads = int(reads.getNumberObjects());
-
-                if (num_reads > 0) {
-                    auto read_id = reads.getObjectName(0);
-                    HighFive::Group read = reads.getGroup(read_id);
-
-                    HighFive::Group channel_id_group = read.getGroup("channel_id");
-                    HighFive::Attribute sampling_rate_attr =
-                            channel_id_group.getAttribute("sampling_rate");
-
-                    float sampling_rate;
-                    sampling_rate_attr.read(sampling_rate);
-                    sample_rate = static_cast<uint16_t>(sampling_rate);
-                }
-            }
-
-            // Break out of loop if sample rate is found.
-            if (sample_rate) {
-                break;
-            }
+    const auto manifest = DatasetManifest::get(data_path, recursive_file_loading, false);
+    for (const auto& file : manifest->files()) {
+        if (file.sample_rate) {
+            return *file.sample_rate;
         }
-    };
-
-    iterate_directory(fetch_directory_entries(data_path, recursive_file_loading));
-
-    if (sample_rate) {
-        return *sample_rate;
-    } else {
-        throw std::runtime_error("Unable to determine sample rate for data.");
     }
+    throw std::runtime_error("Unable to determine sample rate for data.");
 }
 
 std::set<models::ChemistryKey> DataLoader::get_sequencing_chemistry(
@@ -711,76 +579,24 @@ std::set<models::ChemistryKey> DataLoader::get_sequencing_chemistry(
         bool recursive_file_loading) {
     std::set<models::ChemistryKey> chemistries;
 
-    auto iterate_directory = [&](const auto& iterator) {
-        for (const auto& entry : iterator) {
-            std::string ext = std::filesystem::path(entry).extension().string();
-            std::transform(ext.begin(), ext.end(), ext.begin(),
-                           [](unsigned char c) { return std::tolower(c); });
-            auto file_path = entry.path().string();
-            if (ext == ".fast5") {
-                throw std::runtime_error("Cannot automate model selection using fast5 files");
-                return;
-            }
-
-            if (ext != ".pod5") {
-                continue;
-            }
-
-            pod5_init();
-            // Open the file ready for walking:
-            Pod5FileReader_t* file = pod5_open_file(file_path.c_str());
-
-            if (!file) {
-                spdlog::error("Failed to open file {}: {}", file_path.c_str(),
-                              pod5_get_error_string());
-            } else {
-                auto free_pod5 = [&]() {
-                    if (pod5_close_and_free_reader(file) != POD5_OK) {
-                        spdlog::error("Failed to close and free POD5 reader for file {}",
-                                      file_path.c_str());
-                    }
-                };
-
-                auto post = utils::PostCondition(free_pod5);
-
-                // First get the run info count
-                run_info_index_t run_info_count;
-                if (pod5_get_file_run_info_count(file, &run_info_count) != POD5_OK) {
-                    spdlog::error("Failed to fetch POD5 run info count for file {} : {}",
-                                  file_path.c_str(), pod5_get_error_string());
-
-                    continue;
-                }
-
-                for (run_info_index_t ri_idx = 0; ri_idx < run_info_count; ri_idx++) {
-                    RunInfoDictData_t* run_info_data;
-                    if (pod5_get_file_run_info(file, ri_idx, &run_info_data) != POD5_OK) {
-                        spdlog::error(
-                                "Failed to fetch POD5 run info dict for file {} and run info "
-                                "index {}: {}",
-                                file_path.c_str(), ri_idx, pod5_get_error_string());
-                    } else {
-                        const auto chemistry_key = get_chemistry_key(run_info_data);
-                        spdlog::trace("POD5: {} {}", file_path.c_str(), to_string(chemistry_key));
-                        chemistries.insert(chemistry_key);
-                    }
-                    if (pod5_free_run_info(run_info_data) != POD5_OK) {
-                        spdlog::error(
-                                "Failed to free POD5 run info for file {} and run info index: "
-                                "{}",
-                                file_path.c_str(), ri_idx);
-                    }
-                }
-            };
+    const auto manifest = DatasetManifest::get(data_path, recursive_file_loading, false);
+    for (const auto& file : manifest->files()) {
+        if (file.is_fast5) {
+            throw std::runtime_error("Cannot automate model selection using fast5 files");
         }
-    };
-
-    iterate_directory(fetch_directory_entries(data_path, recursive_file_loading));
+        for (const auto& run_info : file.run_infos) {
+            const auto chemistry_key = get_chemistry_key(run_info);
+            spdlog::trace("POD5: {} {}", file.path, to_string(chemistry_key));
+            chemistries.insert(chemistry_key);
+        }
+    }
     return chemistries;
 }
 
-void DataLoader::load_pod5_reads_from_file_by_read_ids(const std::string& path,
-                                                       const std::vector<ReadID>& read_ids) {
+std::vector<SimplexReadPtr> DataLoader::load_pod5_reads_from_file_by_read_ids(
+        const std::string& path,
+        const std::vector<ReadID>& read_ids) {
+    std::vector<SimplexReadPtr> reads;
     pod5_init();
 
     // Open the file ready for walking:
@@ -793,7 +609,7 @@ void DataLoader::load_pod5_reads_from_file_by_read_ids(const std::string& path,
 
     if (!file) {
         spdlog::error("Failed to open file {}: {}", path, pod5_get_error_string());
-        return;
+        return reads;
     }
 
     auto free_pod5 = [&]() {
@@ -823,7 +639,7 @@ void DataLoader::load_pod5_reads_from_file_by_read_ids(const std::string& path,
                                            traversal_batch_rows.data(), &find_success_count);
     if (err != POD5_OK) {
         spdlog::error("Couldn't create plan for {} with reads {}", path, read_ids.size());
-        return;
+        return reads;
     }
 
     if (find_success_count != read_ids.size()) {
@@ -837,9 +653,6 @@ void DataLoader::load_pod5_reads_from_file_by_read_ids(const std::string& path,
 
     uint32_t row_offset = 0;
     for (std::size_t batch_index = 0; batch_index < batch_count; ++batch_index) {
-        if (m_loaded_read_count == m_max_reads) {
-            break;
-        }
         Pod5ReadRecordBatch_t* batch = nullptr;
         if (pod5_get_read_batch(&batch, file, batch_index) != POD5_OK) {
             spdlog::error("Failed to get batch: {}", pod5_get_error_string());
@@ -858,11 +671,7 @@ void DataLoader::load_pod5_reads_from_file_by_read_ids(const std::string& path,
         }
 
         for (auto& v : futures) {
-            auto read = v.get();
-            initialise_read(read->read_common);
-            check_read(read);
-            m_pipeline.push_message(std::move(read));
-            m_loaded_read_count++;
+            reads.push_back(v.get());
         }
 
         if (pod5_free_read_batch(batch) != POD5_OK) {
@@ -871,6 +680,93 @@ void DataLoader::load_pod5_reads_from_file_by_read_ids(const std::string& path,
 
         row_offset += traversal_batch_counts[batch_index];
     }
+    return reads;
+}
+
+void DataLoader::load_pod5_channel_group(const std::vector<std::string>& paths,
+                                         int first_channel,
+                                         int last_channel) {
+    if (m_loaded_read_count == m_max_reads) {
+        return;
+    }
+    spdlog::debug("Load channels {} to {}", first_channel, last_channel);
+
+    for (int channel = first_channel; channel <= last_channel; channel++) {
+        auto reads_it = m_reads_by_channel.find(channel);
+        if (reads_it == m_reads_by_channel.end()) {
+            continue;
+        }
+        // Sort the read ids within a channel by its mux
+        // and start time.
+        auto& reads = reads_it->second;
+        std::sort(reads.begin(), reads.end(), [](ReadSortInfo& a, ReadSortInfo& b) {
+            if (a.mux != b.mux) {
+                return a.mux < b.mux;
+            } else {
+                return a.read_number < b.read_number;
+            }
+        });
+        // Once sorted, create a hash table from read id
+        // to index in the sorted list to quickly fetch the
+        // read location and its neighbors.
+        for (size_t i = 0; i < reads.size(); i++) {
+            m_read_id_to_index[reads[i].read_id] = i;
+        }
+    }
+
+    // Each file is opened once for the whole group, and the files are read concurrently.
+    // Reads are kept per file and channel until every file is done, so they can be pushed
+    // in the same order as loading one channel at a time.
+    const size_t num_channels = size_t(last_channel - first_channel + 1);
+    std::vector<std::vector<std::vector<SimplexReadPtr>>> reads_by_file(paths.size());
+    {
+        cxxpool::thread_pool file_pool{std::clamp(paths.size(), size_t(1), m_num_worker_threads)};
+        std::vector<std::future<void>> futures;
+        for (size_t file_idx = 0; file_idx < paths.size(); file_idx++) {
+            const auto& channel_to_read_ids = m_file_channel_read_order_map.at(paths[file_idx]);
+            std::vector<ReadID> read_ids;
+            for (auto it = channel_to_read_ids.lower_bound(first_channel);
+                 it != channel_to_read_ids.end() && it->first <= last_channel; ++it) {
+                read_ids.insert(read_ids.end(), it->second.begin(), it->second.end());
+            }
+            if (read_ids.empty()) {
+                continue;
+            }
+            futures.push_back(file_pool.push([this, &paths, &reads_by_file, file_idx,
+                                              first_channel, num_channels,
+                                              read_ids = std::move(read_ids)] {
+                auto& file_reads = reads_by_file[file_idx];
+                file_reads.resize(num_channels);
+                for (auto& read : load_pod5_reads_from_file_by_read_ids(paths[file_idx],
+                                                                        read_ids)) {
+                    const int channel = read->read_common.attributes.channel_number;
+                    file_reads[channel - first_channel].push_back(std::move(read));
+                }
+            }));
+        }
+        for (auto& future : futures) {
+            future.get();
+        }
+    }
+
+    for (size_t channel_idx = 0; channel_idx < num_channels; channel_idx++) {
+        for (auto& file_reads : reads_by_file) {
+            if (file_reads.empty()) {
+                continue;
+            }
+            for (auto& read : file_reads[channel_idx]) {
+                if (m_loaded_read_count == m_max_reads) {
+                    break;
+                }
+                initialise_read(read->read_common);
+                check_read(read);
+                m_pipeline.push_message(std::move(read));
+                m_loaded_read_count++;
+            }
+        }
+        // Erase sorted list as it's not needed anymore.
+        m_reads_by_channel.erase(first_channel + int(channel_idx));
+    }
 }
 
 void DataLoader::load_pod5_reads_from_file(const std::string& path) {
@@ -935,106 +831,50 @@ void DataLoader::load_pod5_reads_from_file(const std::string& path) {
 }
 
 void DataLoader::load_fast5_reads_from_file(const std::string& path) {
-    // Read the file into a vector of torch tensors
-    H5Easy::File file(path, H5Easy::File::ReadOnly);
-    HighFive::Group reads = file.getGroup("/");
-    int num_reads = int(reads.getNumberObjects());
-
-    for (int i = 0; i < num_reads && m_loaded_read_count < m_max_reads; i++) {
-        auto read_id = reads.getObjectName(i);
-        HighFive::Group read = reads.getGroup(read_id);
-
-        // Fetch the digitisation parameters
-        HighFive::Group channel_id_group = read.getGroup("channel_id");
-        HighFive::Attribute digitisation_attr = channel_id_group.getAttribute("digitisation");
-        HighFive::Attribute range_attr = channel_id_group.getAttribute("range");
-        HighFive::Attribute offset_attr = channel_id_group.getAttribute("offset");
-        HighFive::Attribute sampling_rate_attr = channel_id_group.getAttribute("sampling_rate");
-        HighFive::Attribute channel_number_attr = channel_id_group.getAttribute("channel_number");
-
-        int32_t channel_number;
-        if (channel_number_attr.getDataType().string().substr(0, 6) == "String") {
-            std::string channel_number_string;
-            string_reader(channel_number_attr, channel_number_string);
-            std::istringstream channel_stream(channel_number_string);
-            channel_stream >> channel_number;
-        } else {
-            channel_number_attr.read(channel_number);
-        }
+    read_fast5_file(
+            path,
+            [this](const std::string& read_id) {
+                return !m_allowed_read_ids || m_allowed_read_ids->contains(read_id);
+            },
+            [this](Fast5Read&& fast5_read) {
+                auto new_read = create_fast5_read(std::move(fast5_read));
+                initialise_read(new_read->read_common);
+                m_pipeline.push_message(std::move(new_read));
+                m_loaded_read_count++;
+                return m_loaded_read_count < m_max_reads;
+            });
+}
 
-        float digitisation;
-        digitisation_attr.read(digitisation);
-        float range;
-        range_attr.read(range);
-        float offset;
-        offset_attr.read(offset);
-        float sampling_rate;
-        sampling_rate_attr.read(sampling_rate);
-
-        HighFive::Group raw = read.getGroup("Raw");
-        auto ds = raw.getDataSet("Signal");
-        if (ds.getDataType().string() != "Integer16") {
-            throw std::runtime_error("Invalid FAST5 Signal data type of " +
-                                     ds.getDataType().string());
+void DataLoader::load_fast5_reads_with_workers(const std::vector<std::string>& paths,
+                                               size_t num_workers) {
+    const auto ring_bytes =
+            utils::get_dev_opt<size_t>("fast5_worker_ring_mb", DEFAULT_FAST5_WORKER_RING_MB)
+            << 20;
+    Fast5ProcessPool pool(paths, num_workers, ring_bytes);
+
+    // The workers can't see the read list, so decode every read and leave filtering to here.
+    std::mutex push_mutex;
+    pool.run([this, &push_mutex](Fast5Read&& fast5_read) {
+        if (m_allowed_read_ids && !m_allowed_read_ids->contains(fast5_read.read_id)) {
+            return true;
         }
-
-        auto options = at::TensorOptions().dtype(at::kShort);
-        auto samples = at::empty(ds.getElementCount(), options);
-        ds.read(samples.data_ptr<int16_t>());
-
-        HighFive::Attribute mux_attr = raw.getAttribute("start_mux");
-        HighFive::Attribute read_number_attr = raw.getAttribute("read_number");
-        HighFive::Attribute start_time_attr = raw.getAttribute("start_time");
-        HighFive::Attribute read_id_attr = raw.getAttribute("read_id");
-        uint32_t mux;
-        uint32_t read_number;
-        uint64_t start_time;
-        mux_attr.read(mux);
-        read_number_attr.read(read_number);
-        start_time_attr.read(start_time);
-        string_reader(read_id_attr, read_id);
-
-        std::string fast5_filename = std::filesystem::path(path).filename().string();
-
-        HighFive::Group tracking_id_group = read.getGroup("tracking_id");
-        std::string exp_start_time = get_string_attribute(tracking_id_group, "exp_start_time");
-        std::string flow_cell_id = get_string_attribute(tracking_id_group, "flow_cell_id");
-        std::string device_id = get_string_attribute(tracking_id_group, "device_id");
-        std::string group_protocol_id =
-                get_string_attribute(tracking_id_group, "group_protocol_id");
-
-        auto start_time_str = utils::adjust_time(exp_start_time,
-                                                 static_cast<uint32_t>(start_time / sampling_rate));
-
-        auto new_read = std::make_unique<SimplexRead>();
-        new_read->read_common.sample_rate = uint64_t(sampling_rate);
-        new_read->read_common.raw_data = samples;
-        new_read->digitisation = digitisation;
-        new_read->range = range;
-        new_read->offset = offset;
-        new_read->scaling = range / digitisation;
-        new_read->read_common.read_id = read_id;
-        new_read->read_common.num_trimmed_samples = 0;
-        new_read->read_common.attributes.mux = mux;
-        new_read->read_common.attributes.read_number = read_number;
-        new_read->read_common.attributes.channel_number = channel_number;
-        new_read->read_common.attributes.start_time = start_time_str;
-        new_read->read_common.attributes.fast5_filename = fast5_filename;
-        new_read->read_common.flowcell_id = flow_cell_id;
-        new_read->read_common.position_id = device_id;
-        new_read->read_common.experiment_id = group_protocol_id;
-        new_read->read_common.is_duplex = false;
-
-        if (!m_allowed_read_ids || (m_allowed_read_ids->find(new_read->read_common.read_id) !=
-                                    m_allowed_read_ids->end())) {
-            initialise_read(new_read->read_common);
-            m_pipeline.push_message(std::move(new_read));
-            m_loaded_read_count++;
+        std::lock_guard lock(push_mutex);
+        if (m_loaded_read_count == m_max_reads) {
+            return false;
         }
-    }
+        auto new_read = create_fast5_read(std::move(fast5_read));
+        initialise_read(new_read->read_common);
+        m_pipeline.push_message(std::move(new_read));
+        m_loaded_read_count++;
+        return m_loaded_read_count < m_max_reads;
+    });
 }
 
 void DataLoader::initialise_read(ReadCommon& read_common) const {
+    read_common.file_arrival_time = m_file_arrival_time;
+    if (ReadTracer::is_enabled()) {
+        read_common.trace = ReadTracer::instance().start_trace(read_common.read_id);
+    }
     for (const auto& initialiser : m_read_initialisers) {
         initialiser(read_common);
     }
@@ -1053,8 +893,8 @@ DataLoader::DataLoader(Pipeline& pipeline,
                        const std::string& device,
                        size_t num_worker_threads,
                        size_t max_reads,
-                       std::optional<std::unordered_set<std::string>> read_list,
-                       std::unordered_set<std::string> read_ignore_list)
+                       std::optional<utils::ReadIdSet> read_list,
+                       utils::ReadIdSet read_ignore_list)
         : m_pipeline(pipeline),
           m_device(device),
           m_num_worker_threads(num_worker_threads),
@@ -1067,6 +907,8 @@ DataLoader::DataLoader(Pipeline& pipeline,
 }
 
 stats::NamedStats DataLoader::sample_stats() const {
-    return stats::NamedStats{{"loaded_read_count", static_cast<double>(m_loaded_read_count)}};
+    return stats::NamedStats{
+            {"loaded_read_count", static_cast<double>(m_loaded_read_count)},
+            {"watched_file_count", static_cast<double>(m_watched_file_count)}};
 }
 }  // namespace dorado
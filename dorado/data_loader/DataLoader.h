@@ -1,23 +1,27 @@
 #pragma once
 #include "models/models.h"
+#include "utils/read_id_set.h"
 #include "utils/stats.h"
 #include "utils/types.h"
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <filesystem>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 struct Pod5FileReader;
 
 namespace dorado {
 
+class DirectoryWatcher;
 class Pipeline;
 class ReadCommon;
 class SimplexRead;
@@ -38,13 +42,32 @@ public:
                const std::string& device,
                size_t num_worker_threads,
                size_t max_reads,
-               std::optional<std::unordered_set<std::string>> read_list,
-               std::unordered_set<std::string> read_ignore_list);
+               std::optional<utils::ReadIdSet> read_list,
+               utils::ReadIdSet read_ignore_list);
     ~DataLoader() = default;
     void load_reads(const std::filesystem::path& path,
                     bool recursive_file_loading,
                     ReadOrder traversal_order);
 
+    struct DirectoryWatchOptions {
+        // Stop once no POD5 file has arrived for this long. Zero waits until stopped otherwise.
+        std::chrono::milliseconds idle_timeout{0};
+        // Stop once a file with this name is completed in the directory. Unused if empty.
+        std::string stop_file_name;
+    };
+
+    /** Loads the POD5 files in the directory |path|, then each POD5 file completed in it, for
+     *  basecalling a run while it's still acquiring. Returns once stop_watching() is called, a
+     *  stop condition in |options| is met, the maximum number of reads has been loaded, or the
+     *  directory is removed. Subdirectories aren't watched. See DirectoryWatcher.
+     *
+     *  Reads of the files which arrive while watching have ReadCommon::file_arrival_time set.
+     *  Throws std::runtime_error if the directory can't be watched.
+     */
+    void watch_reads(const std::filesystem::path& path, const DirectoryWatchOptions& options);
+    /// Makes watch_reads() return after the file it's loading. Can be called from any thread.
+    void stop_watching();
+
     static std::unordered_map<std::string, ReadGroup> load_read_groups(
             const std::filesystem::path& data_path,
             std::string model_name,
@@ -52,8 +75,8 @@ public:
             bool recursive_file_loading);
 
     static int get_num_reads(const std::filesystem::path& data_path,
-                             std::optional<std::unordered_set<std::string>> read_list,
-                             const std::unordered_set<std::string>& ignore_read_list,
+                             const std::optional<utils::ReadIdSet>& read_list,
+                             const utils::ReadIdSet& ignore_read_list,
                              bool recursive_file_loading);
 
     static bool is_read_data_present(const std::filesystem::path& data_path,
@@ -82,10 +105,19 @@ public:
 
 private:
     void load_fast5_reads_from_file(const std::string& path);
+    // Reads the files in |num_workers| worker processes. See Fast5ProcessPool.
+    void load_fast5_reads_with_workers(const std::vector<std::string>& paths, size_t num_workers);
     void load_pod5_reads_from_file(const std::string& path);
-    void load_pod5_reads_from_file_by_read_ids(const std::string& path,
-                                               const std::vector<ReadID>& read_ids);
+    // Returns the reads in file order rather than pushing them, so they can be reordered.
+    std::vector<SimplexReadPtr> load_pod5_reads_from_file_by_read_ids(
+            const std::string& path,
+            const std::vector<ReadID>& read_ids);
     void load_read_channels(const std::filesystem::path& data_path, bool recursive_file_loading);
+    // Loads the reads of channels [first_channel, last_channel] from every file in one pass,
+    // reading the files concurrently, and pushes them in channel order.
+    void load_pod5_channel_group(const std::vector<std::string>& paths,
+                                 int first_channel,
+                                 int last_channel);
 
     void initialise_read(ReadCommon& read) const;
 
@@ -94,16 +126,24 @@ private:
     std::string m_device;
     size_t m_num_worker_threads{1};
     size_t m_max_reads{0};
-    std::optional<std::unordered_set<std::string>> m_allowed_read_ids;
-    std::unordered_set<std::string> m_ignored_read_ids;
+    std::optional<utils::ReadIdSet> m_allowed_read_ids;
+    utils::ReadIdSet m_ignored_read_ids;
 
     std::unordered_map<std::string, channel_to_read_id_t> m_file_channel_read_order_map;
     std::unordered_map<int, std::vector<ReadSortInfo>> m_reads_by_channel;
+    std::unordered_map<int, uint64_t> m_samples_by_channel;
     std::unordered_map<std::string, size_t> m_read_id_to_index;
     int m_max_channel{0};
 
     std::vector<ReadInitialiserF> m_read_initialisers;
 
+    // Set while loading a file picked up by watch_reads().
+    std::optional<std::chrono::steady_clock::time_point> m_file_arrival_time;
+    std::atomic<bool> m_stop_watching{false};
+    std::mutex m_watcher_mutex;
+    DirectoryWatcher* m_watcher{nullptr};
+    std::atomic<size_t> m_watched_file_count{0};
+
     // Issue warnings if read is potentially problematic
     void check_read(const SimplexReadPtr& read);
     // A flag to warn only once if the data chemsitry is known
@@ -0,0 +1,561 @@
+#include "DatasetManifest.h"
+
+#include "utils/PostCondition.h"
+#include "utils/dev_utils.h"
+#include "utils/fs_utils.h"
+
+#include <cxxpool.h>
+#include <highfive/H5Easy.hpp>
+#include <highfive/H5File.hpp>
+#include <pod5_format/c_api.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace dorado {
+
+namespace {
+
+static_assert(sizeof(DatasetFile::ChannelRead::read_id) == sizeof(read_id_t));
+
+constexpr char CACHE_MAGIC[8] = {'D', 'O', 'R', 'M', 'N', 'F', 'S', 'T'};
+// Bumped when caches stopped holding channel reads by default, so large old caches are replaced.
+constexpr uint32_t CACHE_VERSION = 3;
+
+// Scanning is dominated by file I/O, so more threads than this rarely helps.
+constexpr size_t MAX_SCAN_THREADS = 16;
+
+// HDF5 is not thread-safe, so FAST5 files are scanned one at a time.
+std::mutex g_hdf5_mutex;
+
+// Manifests built so far in this process, keyed by cache file name. They don't hold channel
+// reads, which are only needed once.
+std::mutex g_manifests_mutex;
+std::unordered_map<std::string, std::vector<DatasetFile>> g_manifests;
+
+std::string lowercase_extension(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return ext;
+}
+
+// The key of a file in the cache, which doesn't depend on the working directory.
+std::string absolute_key(const fs::path& path) {
+    std::error_code ec;
+    const auto absolute = fs::absolute(path, ec);
+    return (ec ? path : absolute).lexically_normal().string();
+}
+
+// FNV-1a, so cache file names are the same on every platform and build.
+uint64_t stable_hash(const std::string& str) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : str) {
+        hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+DatasetFile without_channel_reads(const DatasetFile& file) {
+    DatasetFile summary;
+    summary.path = file.path;
+    summary.size = file.size;
+    summary.mtime = file.mtime;
+    summary.is_fast5 = file.is_fast5;
+    summary.scanned = file.scanned;
+    summary.num_reads = file.num_reads;
+    summary.sample_rate = file.sample_rate;
+    summary.run_infos = file.run_infos;
+    return summary;
+}
+
+std::string copy_string(const char* str) { return str ? str : ""; }
+
+void scan_pod5(DatasetFile& file, bool with_channel_reads) {
+    Pod5FileReader_t* reader = pod5_open_file(file.path.c_str());
+    if (!reader) {
+        spdlog::error("Failed to open file {}: {}", file.path, pod5_get_error_string());
+        return;
+    }
+    auto free_pod5 = [&]() {
+        if (pod5_close_and_free_reader(reader) != POD5_OK) {
+            spdlog::error("Failed to close and free POD5 reader for file {}", file.path);
+        }
+    };
+    auto post = utils::PostCondition(free_pod5);
+
+    size_t read_count = 0;
+    if (pod5_get_read_count(reader, &read_count) != POD5_OK) {
+        spdlog::error("Failed to query read count for file {}: {}", file.path,
+                      pod5_get_error_string());
+        return;
+    }
+    file.num_reads = read_count;
+
+    run_info_index_t run_info_count = 0;
+    if (pod5_get_file_run_info_count(reader, &run_info_count) != POD5_OK) {
+        spdlog::error("Failed to fetch POD5 run info count for file {} : {}", file.path,
+                      pod5_get_error_string());
+        return;
+    }
+    for (run_info_index_t idx = 0; idx < run_info_count; ++idx) {
+        RunInfoDictData_t* run_info_data = nullptr;
+        if (pod5_get_file_run_info(reader, idx, &run_info_data) != POD5_OK) {
+            spdlog::error(
+                    "Failed to fetch POD5 run info dict for file {} and run info index {}: {}",
+                    file.path, idx, pod5_get_error_string());
+            return;
+        }
+        DatasetFile::RunInfo run_info;
+        run_info.acquisition_id = copy_string(run_info_data->acquisition_id);
+        run_info.flow_cell_id = copy_string(run_info_data->flow_cell_id);
+        run_info.system_name = copy_string(run_info_data->system_name);
+        run_info.sample_id = copy_string(run_info_data->sample_id);
+        run_info.sequencer_position = copy_string(run_info_data->sequencer_position);
+        run_info.experiment_name = copy_string(run_info_data->experiment_name);
+        run_info.flow_cell_product_code = copy_string(run_info_data->flow_cell_product_code);
+        run_info.sequencing_kit = copy_string(run_info_data->sequencing_kit);
+        run_info.acquisition_start_time_ms = run_info_data->acquisition_start_time_ms;
+        run_info.sample_rate = run_info_data->sample_rate;
+        if (pod5_free_run_info(run_info_data) != POD5_OK) {
+            spdlog::error("Failed to free POD5 run info for file {} and run info index {}",
+                          file.path, idx);
+        }
+        file.run_infos.push_back(std::move(run_info));
+    }
+    if (!file.run_infos.empty()) {
+        file.sample_rate = file.run_infos.front().sample_rate;
+    }
+
+    if (with_channel_reads) {
+        std::size_t batch_count = 0;
+        if (pod5_get_read_batch_count(&batch_count, reader) != POD5_OK) {
+            spdlog::error("Failed to query batch count: {}", pod5_get_error_string());
+            return;
+        }
+        file.channel_reads.reserve(read_count);
+        for (std::size_t batch_index = 0; batch_index < batch_count; ++batch_index) {
+            Pod5ReadRecordBatch_t* batch = nullptr;
+            if (pod5_get_read_batch(&batch, reader, batch_index) != POD5_OK) {
+                spdlog::error("Failed to get batch: {}", pod5_get_error_string());
+                return;
+            }
+            auto free_batch = [&]() {
+                if (pod5_free_read_batch(batch) != POD5_OK) {
+                    spdlog::error("Failed to release batch");
+                }
+            };
+            auto batch_post = utils::PostCondition(free_batch);
+
+            std::size_t batch_row_count = 0;
+            if (pod5_get_read_batch_row_count(&batch_row_count, batch) != POD5_OK) {
+                spdlog::error("Failed to get batch row count");
+                return;
+            }
+            for (std::size_t row = 0; row < batch_row_count; ++row) {
+                uint16_t read_table_version = 0;
+                ReadBatchRowInfo_t read_data;
+                if (pod5_get_read_batch_row_info_data(batch, row, READ_BATCH_ROW_INFO_VERSION,
+                                                      &read_data,
+                                                      &read_table_version) != POD5_OK) {
+                    spdlog::error("Failed to get read {}", row);
+                    continue;
+                }
+                DatasetFile::ChannelRead channel_read;
+                std::memcpy(channel_read.read_id.data(), read_data.read_id,
+                            channel_read.read_id.size());
+                channel_read.channel = read_data.channel;
+                channel_read.well = read_data.well;
+                channel_read.read_number = read_data.read_number;
+                channel_read.num_samples = read_data.num_samples;
+                file.channel_reads.push_back(channel_read);
+            }
+        }
+        file.has_channel_reads = true;
+    }
+
+    file.scanned = true;
+}
+
+void scan_fast5(DatasetFile& file) {
+    std::lock_guard lock(g_hdf5_mutex);
+    try {
+        H5Easy::File h5_file(file.path, H5Easy::File::ReadOnly);
+        HighFive::Group reads = h5_file.getGroup("/");
+        file.num_reads = reads.getNumberObjects();
+        if (file.num_reads > 0) {
+            HighFive::Group read = reads.getGroup(reads.getObjectName(0));
+            HighFive::Attribute sampling_rate_attr =
+                    read.getGroup("channel_id").getAttribute("sampling_rate");
+            float sampling_rate;
+            sampling_rate_attr.read(sampling_rate);
+            file.sample_rate = static_cast<uint16_t>(sampling_rate);
+        }
+        file.scanned = true;
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to read file {}: {}", file.path, e.what());
+    }
+}
+
+// Lays out the cache in native byte order. It's only ever read back on the same machine.
+class Writer {
+public:
+    template <typename T>
+    void write(T value) {
+        static_assert(std::is_arithmetic_v<T>);
+        m_buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    void write(const std::string& str) {
+        write(uint32_t(str.size()));
+        m_buffer.append(str);
+    }
+    void write_bytes(const void* data, size_t size) {
+        m_buffer.append(static_cast<const char*>(data), size);
+    }
+    const std::string& buffer() const { return m_buffer; }
+
+private:
+    std::string m_buffer;
+};
+
+class Reader {
+public:
+    explicit Reader(const std::string& buffer) : m_buffer(buffer) {}
+
+    template <typename T>
+    T read() {
+        static_assert(std::is_arithmetic_v<T>);
+        T value;
+        read_bytes(&value, sizeof(T));
+        return value;
+    }
+    std::string read_string() {
+        const auto size = read<uint32_t>();
+        check(size);
+        std::string str(m_buffer.data() + m_pos, size);
+        m_pos += size;
+        return str;
+    }
+    void read_bytes(void* data, size_t size) {
+        check(size);
+        std::memcpy(data, m_buffer.data() + m_pos, size);
+        m_pos += size;
+    }
+    bool at_end() const { return m_pos == m_buffer.size(); }
+
+private:
+    void check(size_t size) const {
+        if (size > m_buffer.size() - m_pos) {
+            throw std::runtime_error("truncated");
+        }
+    }
+
+    const std::string& m_buffer;
+    size_t m_pos = 0;
+};
+
+}  // namespace
+
+fs::path DatasetManifest::default_cache_dir() {
+    if (const char* dir = std::getenv("DORADO_MANIFEST_DIR")) {
+        return dir;
+    }
+    return utils::get_user_data_dir() / "manifests";
+}
+
+fs::path DatasetManifest::cache_path(const fs::path& cache_dir,
+                                     const fs::path& data_path,
+                                     bool recursive_file_loading) {
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0')
+         << stable_hash(absolute_key(data_path) + (recursive_file_loading ? "|r" : "|"))
+         << ".manifest";
+    return cache_dir / name.str();
+}
+
+bool DatasetManifest::save(const fs::path& path, const std::vector<DatasetFile>& files) {
+    Writer writer;
+    writer.write_bytes(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    writer.write(CACHE_VERSION);
+    const auto num_cached = std::count_if(files.begin(), files.end(),
+                                          [](const DatasetFile& file) { return file.scanned; });
+    writer.write(uint64_t(num_cached));
+    for (const auto& file : files) {
+        if (!file.scanned) {
+            continue;
+        }
+        writer.write(absolute_key(file.path));
+        writer.write(file.size);
+        writer.write(file.mtime);
+        writer.write(uint8_t(file.is_fast5));
+        writer.write(file.num_reads);
+        writer.write(uint8_t(file.sample_rate.has_value()));
+        writer.write(file.sample_rate.value_or(0));
+        writer.write(uint32_t(file.run_infos.size()));
+        for (const auto& run_info : file.run_infos) {
+            writer.write(run_info.acquisition_id);
+            writer.write(run_info.flow_cell_id);
+            writer.write(run_info.system_name);
+            writer.write(run_info.sample_id);
+            writer.write(run_info.sequencer_position);
+            writer.write(run_info.experiment_name);
+            writer.write(run_info.flow_cell_product_code);
+            writer.write(run_info.sequencing_kit);
+            writer.write(run_info.acquisition_start_time_ms);
+            writer.write(run_info.sample_rate);
+        }
+        writer.write(uint8_t(file.has_channel_reads));
+        writer.write(uint64_t(file.channel_reads.size()));
+        for (const auto& read : file.channel_reads) {
+            writer.write_bytes(read.read_id.data(), read.read_id.size());
+            writer.write(read.channel);
+            writer.write(read.well);
+            writer.write(read.read_number);
+            writer.write(read.num_samples);
+        }
+    }
+
+    // Written to the side and renamed, so concurrent runs never see a partial cache.
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+    const auto tmp_path = fs::path(path).concat(".tmp" + std::to_string(std::random_device{}()));
+    {
+        std::ofstream out(tmp_path, std::ios::binary);
+        out.write(writer.buffer().data(), writer.buffer().size());
+        out.close();
+        if (!out) {
+            spdlog::debug("Failed to write dataset manifest {}", tmp_path.string());
+            fs::remove(tmp_path, ec);
+            return false;
+        }
+    }
+    fs::rename(tmp_path, path, ec);
+    if (ec) {
+        spdlog::debug("Failed to write dataset manifest {}: {}", path.string(), ec.message());
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+std::vector<DatasetFile> DatasetManifest::load(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return {};
+    }
+    const std::string buffer((std::istreambuf_iterator<char>(in)),
+                             std::istreambuf_iterator<char>());
+
+    try {
+        Reader reader(buffer);
+        char magic[sizeof(CACHE_MAGIC)];
+        reader.read_bytes(magic, sizeof(magic));
+        if (std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0 ||
+            reader.read<uint32_t>() != CACHE_VERSION) {
+            throw std::runtime_error("unknown format");
+        }
+        std::vector<DatasetFile> files(reader.read<uint64_t>());
+        for (auto& file : files) {
+            file.path = reader.read_string();
+            file.size = reader.read<uint64_t>();
+            file.mtime = reader.read<int64_t>();
+            file.is_fast5 = reader.read<uint8_t>() != 0;
+            file.num_reads = reader.read<uint64_t>();
+            const bool has_sample_rate = reader.read<uint8_t>() != 0;
+            const auto sample_rate = reader.read<uint16_t>();
+            if (has_sample_rate) {
+                file.sample_rate = sample_rate;
+            }
+            file.run_infos.resize(reader.read<uint32_t>());
+            for (auto& run_info : file.run_infos) {
+                run_info.acquisition_id = reader.read_string();
+                run_info.flow_cell_id = reader.read_string();
+                run_info.system_name = reader.read_string();
+                run_info.sample_id = reader.read_string();
+                run_info.sequencer_position = reader.read_string();
+                run_info.experiment_name = reader.read_string();
+                run_info.flow_cell_product_code = reader.read_string();
+                run_info.sequencing_kit = reader.read_string();
+                run_info.acquisition_start_time_ms = reader.read<int64_t>();
+                run_info.sample_rate = reader.read<uint16_t>();
+            }
+            file.has_channel_reads = reader.read<uint8_t>() != 0;
+            const auto num_channel_reads = reader.read<uint64_t>();
+            // Guard the allocation against a corrupt count.
+            if (num_channel_reads > buffer.size()) {
+                throw std::runtime_error("invalid read count");
+            }
+            file.channel_reads.resize(num_channel_reads);
+            for (auto& read : file.channel_reads) {
+                reader.read_bytes(read.read_id.data(), read.read_id.size());
+                read.channel = reader.read<uint16_t>();
+                read.well = reader.read<uint8_t>();
+                read.read_number = reader.read<uint32_t>();
+                read.num_samples = reader.read<uint64_t>();
+            }
+            file.scanned = true;
+        }
+        if (!reader.at_end()) {
+            throw std::runtime_error("trailing data");
+        }
+        return files;
+    } catch (const std::exception& e) {
+        spdlog::debug("Ignoring dataset manifest {}: {}", path.string(), e.what());
+        return {};
+    }
+}
+
+std::shared_ptr<const DatasetManifest> DatasetManifest::get(const fs::path& data_path,
+                                                            bool recursive_file_loading,
+                                                            bool with_channel_reads) {
+    const bool use_cache = utils::get_dev_opt<int>("manifest_cache", 1) != 0;
+    return get(data_path, recursive_file_loading, with_channel_reads,
+               use_cache ? default_cache_dir() : fs::path());
+}
+
+std::shared_ptr<const DatasetManifest> DatasetManifest::get(const fs::path& data_path,
+                                                            bool recursive_file_loading,
+                                                            bool with_channel_reads,
+                                                            const fs::path& cache_dir) {
+    // Channel reads take a few dozen bytes per read, so by default only the per-file summaries
+    // are cached, and channel-ordered loading rescans its POD5 files.
+    const bool cache_channel_reads =
+            utils::get_dev_opt<int>("manifest_cache_channel_reads", 0) != 0;
+
+    std::vector<DatasetFile> files;
+    for (const auto& entry : utils::fetch_directory_entries(data_path, recursive_file_loading)) {
+        const auto ext = lowercase_extension(entry.path());
+        if (ext != ".pod5" && ext != ".fast5") {
+            continue;
+        }
+        DatasetFile file;
+        file.path = entry.path().string();
+        file.is_fast5 = ext == ".fast5";
+        std::error_code ec;
+        file.size = fs::file_size(entry.path(), ec);
+        file.mtime = ec ? 0 : fs::last_write_time(entry.path(), ec).time_since_epoch().count();
+        files.push_back(std::move(file));
+    }
+
+    const auto key = cache_path(cache_dir, data_path, recursive_file_loading);
+    std::vector<DatasetFile> known;
+    {
+        std::lock_guard lock(g_manifests_mutex);
+        if (auto it = g_manifests.find(key.string()); it != g_manifests.end()) {
+            known = it->second;
+        }
+    }
+    // Channel reads are only ever kept on disk.
+    const bool read_cache = !cache_dir.empty() &&
+                            (known.empty() || (with_channel_reads && cache_channel_reads));
+    if (read_cache) {
+        known = load(key);
+    }
+    std::unordered_map<std::string, const DatasetFile*> known_by_path;
+    for (const auto& file : known) {
+        known_by_path.emplace(absolute_key(file.path), &file);
+    }
+
+    std::vector<size_t> to_scan;
+    for (size_t i = 0; i < files.size(); ++i) {
+        auto& file = files[i];
+        const auto it = known_by_path.find(absolute_key(file.path));
+        const bool reusable = it != known_by_path.end() && it->second->scanned &&
+                              it->second->size == file.size && it->second->mtime == file.mtime &&
+                              (!with_channel_reads || file.is_fast5 ||
+                               it->second->has_channel_reads);
+        if (!reusable) {
+            to_scan.push_back(i);
+            continue;
+        }
+        auto path = std::move(file.path);
+        file = *it->second;
+        file.path = std::move(path);
+    }
+
+    if (!to_scan.empty()) {
+        pod5_init();
+        const size_t num_threads = std::min(
+                {to_scan.size(), size_t(std::max(1u, std::thread::hardware_concurrency())),
+                 MAX_SCAN_THREADS});
+        cxxpool::thread_pool pool{num_threads};
+        std::vector<std::future<void>> futures;
+        futures.reserve(to_scan.size());
+        for (auto i : to_scan) {
+            futures.push_back(pool.push([&file = files[i], with_channel_reads] {
+                if (file.is_fast5) {
+                    scan_fast5(file);
+                } else {
+                    scan_pod5(file, with_channel_reads);
+                }
+            }));
+        }
+        for (auto& future : futures) {
+            future.get();
+        }
+    }
+    spdlog::debug("> Dataset manifest for {}: {} files, {} scanned", data_path.string(),
+                  files.size(), to_scan.size());
+
+    std::vector<DatasetFile> summary;
+    summary.reserve(files.size());
+    for (const auto& file : files) {
+        summary.push_back(without_channel_reads(file));
+    }
+
+    if (!cache_dir.empty() && (!to_scan.empty() || known.size() != files.size())) {
+        if (!cache_channel_reads) {
+            save(key, summary);
+        } else {
+            if (!read_cache) {
+                // Entries from this process have no channel reads, so keep those of unchanged
+                // files which were scanned for them by an earlier run.
+                std::unordered_map<std::string, DatasetFile*> files_by_path;
+                for (auto& file : files) {
+                    files_by_path.emplace(absolute_key(file.path), &file);
+                }
+                for (auto& cached : load(key)) {
+                    const auto it = files_by_path.find(absolute_key(cached.path));
+                    if (it == files_by_path.end() || !cached.has_channel_reads) {
+                        continue;
+                    }
+                    auto& file = *it->second;
+                    if (!file.has_channel_reads && file.size == cached.size &&
+                        file.mtime == cached.mtime) {
+                        file.has_channel_reads = true;
+                        file.channel_reads = std::move(cached.channel_reads);
+                    }
+                }
+            }
+            save(key, files);
+        }
+    }
+
+    if (!with_channel_reads) {
+        files = summary;
+    }
+    {
+        std::lock_guard lock(g_manifests_mutex);
+        g_manifests[key.string()] = std::move(summary);
+    }
+
+    return std::shared_ptr<const DatasetManifest>(new DatasetManifest(std::move(files)));
+}
+
+}  // namespace dorado
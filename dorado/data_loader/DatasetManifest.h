@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace dorado {
+
+/** What the dataset queries need to know about the reads in one POD5 or FAST5 file.
+ *
+ *  Entries are identified by path, size and modification time. An entry found in the cache with
+ *  the same three values is used as-is, otherwise the file is opened and scanned again.
+ */
+struct DatasetFile {
+    // Fields of a POD5 run info table row.
+    struct RunInfo {
+        std::string acquisition_id;
+        std::string flow_cell_id;
+        std::string system_name;
+        std::string sample_id;
+        std::string sequencer_position;
+        std::string experiment_name;
+        std::string flow_cell_product_code;
+        std::string sequencing_kit;
+        int64_t acquisition_start_time_ms = 0;
+        uint16_t sample_rate = 0;
+    };
+
+    // Where a read sits in its channel, and its length for sizing channel-ordered loads. The
+    // read id is the POD5 binary UUID.
+    struct ChannelRead {
+        std::array<uint8_t, 16> read_id{};
+        uint16_t channel = 0;
+        uint8_t well = 0;
+        uint32_t read_number = 0;
+        uint64_t num_samples = 0;
+    };
+
+    std::string path;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    bool is_fast5 = false;
+    // False if the file couldn't be read. Such entries are never cached.
+    bool scanned = false;
+
+    uint64_t num_reads = 0;
+    // From the first run info of a POD5 file, or the first read of a FAST5 file.
+    std::optional<uint16_t> sample_rate;
+    std::vector<RunInfo> run_infos;
+
+    // POD5 only, and only if channel reads were requested when the file was scanned.
+    bool has_channel_reads = false;
+    std::vector<ChannelRead> channel_reads;
+};
+
+/** The POD5 and FAST5 files of a dataset, in directory iteration order, each scanned once.
+ *
+ *  Files are opened in parallel, one pass per file collecting everything the DataLoader queries
+ *  need. The result is kept for the rest of the process and written to an on-disk cache, so
+ *  repeated queries and later runs over the same data only stat the files.
+ */
+class DatasetManifest {
+public:
+    /** Lists |data_path| and returns the manifest of its POD5 and FAST5 files.
+     *
+     *  Unchanged files are served from the process-wide manifest or the cache in |cache_dir|,
+     *  the rest are scanned. The cache is disabled if |cache_dir| is empty. Per-read channel
+     *  information is only collected if |with_channel_reads| is set, and is only kept in memory
+     *  by the returned manifest. It's only written to the cache if the
+     *  "manifest_cache_channel_reads" dev option is set, since it's large for big datasets.
+     */
+    static std::shared_ptr<const DatasetManifest> get(const std::filesystem::path& data_path,
+                                                      bool recursive_file_loading,
+                                                      bool with_channel_reads,
+                                                      const std::filesystem::path& cache_dir);
+
+    /// As above, with the cache in default_cache_dir() unless the "manifest_cache" dev option
+    /// is 0.
+    static std::shared_ptr<const DatasetManifest> get(const std::filesystem::path& data_path,
+                                                      bool recursive_file_loading,
+                                                      bool with_channel_reads);
+
+    /// $DORADO_MANIFEST_DIR if set, otherwise ~/.dorado/manifests.
+    static std::filesystem::path default_cache_dir();
+
+    /// The cache file for |data_path| within |cache_dir|.
+    static std::filesystem::path cache_path(const std::filesystem::path& cache_dir,
+                                            const std::filesystem::path& data_path,
+                                            bool recursive_file_loading);
+
+    const std::vector<DatasetFile>& files() const { return m_files; }
+
+    /// Writes |files| to |path|. Returns false and logs on failure.
+    static bool save(const std::filesystem::path& path, const std::vector<DatasetFile>& files);
+    /// Reads a cache written by save(). Returns an empty list if it's missing or invalid.
+    static std::vector<DatasetFile> load(const std::filesystem::path& path);
+
+private:
+    explicit DatasetManifest(std::vector<DatasetFile> files) : m_files(std::move(files)) {}
+
+    std::vector<DatasetFile> m_files;
+};
+
+}  // namespace dorado
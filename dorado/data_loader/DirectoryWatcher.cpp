@@ -0,0 +1,142 @@
+#include "DirectoryWatcher.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace dorado {
+
+#ifndef __linux__
+
+bool DirectoryWatcher::is_supported() { return false; }
+
+DirectoryWatcher::DirectoryWatcher(const std::filesystem::path& directory)
+        : m_directory(directory) {
+    throw std::runtime_error("Watching directories is not supported on this platform");
+}
+
+DirectoryWatcher::~DirectoryWatcher() = default;
+
+std::optional<DirectoryWatcher::File> DirectoryWatcher::wait_for_file(std::chrono::milliseconds) {
+    return std::nullopt;
+}
+
+void DirectoryWatcher::stop() { m_stopped = true; }
+void DirectoryWatcher::read_events(std::chrono::milliseconds) {}
+void DirectoryWatcher::queue_all_files() {}
+
+#else  // __linux__
+
+bool DirectoryWatcher::is_supported() { return true; }
+
+DirectoryWatcher::DirectoryWatcher(const std::filesystem::path& directory)
+        : m_directory(directory) {
+    auto fail = [&](const std::string& what) {
+        const auto error = std::error_code(errno, std::generic_category());
+        for (int fd : {m_inotify_fd, m_wake_fds[0], m_wake_fds[1]}) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+        throw std::runtime_error(what + " " + m_directory.string() + ": " + error.message());
+    };
+
+    m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify_fd < 0) {
+        fail("Failed to create a watch for");
+    }
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+    if (inotify_add_watch(m_inotify_fd, m_directory.c_str(), mask | IN_ONLYDIR) < 0) {
+        fail("Failed to watch directory");
+    }
+    if (pipe2(m_wake_fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+        fail("Failed to create a watch for");
+    }
+}
+
+DirectoryWatcher::~DirectoryWatcher() {
+    close(m_inotify_fd);
+    close(m_wake_fds[0]);
+    close(m_wake_fds[1]);
+}
+
+std::optional<DirectoryWatcher::File> DirectoryWatcher::wait_for_file(
+        std::chrono::milliseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (m_files.empty() && !m_stopped) {
+        read_events(std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()));
+        if (std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+    }
+    if (m_stopped || m_files.empty()) {
+        return std::nullopt;
+    }
+    auto file = std::move(m_files.front());
+    m_files.pop_front();
+    return file;
+}
+
+void DirectoryWatcher::stop() {
+    m_stopped = true;
+    const char wake = 0;
+    [[maybe_unused]] auto written = write(m_wake_fds[1], &wake, 1);
+}
+
+void DirectoryWatcher::read_events(std::chrono::milliseconds timeout) {
+    pollfd fds[2] = {{m_inotify_fd, POLLIN, 0}, {m_wake_fds[0], POLLIN, 0}};
+    const auto timeout_ms = int(std::clamp<int64_t>(timeout.count(), 0, 60 * 60 * 1000));
+    if (poll(fds, 2, timeout_ms) <= 0 || !(fds[0].revents & POLLIN)) {
+        // Timed out, interrupted, or woken by stop().
+        return;
+    }
+
+    alignas(inotify_event) char buffer[16 * 1024];
+    for (;;) {
+        const auto length = read(m_inotify_fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            return;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        for (const char* ptr = buffer; ptr < buffer + length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                spdlog::warn("Missed events watching {}, rescanning it", m_directory.string());
+                queue_all_files();
+            } else if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                if (!m_stopped.exchange(true)) {
+                    spdlog::warn("Watched directory {} was removed", m_directory.string());
+                }
+            } else if ((event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) &&
+                       !(event->mask & IN_ISDIR) && event->len > 0) {
+                m_files.push_back({m_directory / event->name, now});
+            }
+        }
+    }
+}
+
+void DirectoryWatcher::queue_all_files() {
+    const auto now = std::chrono::steady_clock::now();
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(m_directory, error)) {
+        if (entry.is_regular_file(error)) {
+            m_files.push_back({entry.path(), now});
+        }
+    }
+}
+
+#endif  // __linux__
+
+}  // namespace dorado
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <optional>
+
+namespace dorado {
+
+/** Reports files as they're completed in a directory, using inotify.
+ *
+ *  A file is complete once it's closed after being written, or once it's moved into the
+ *  directory, which is how acquisition software publishes files written under a temporary
+ *  name. Only the directory itself is watched, not its subdirectories. If the kernel drops
+ *  events, every file in the directory is reported again, so callers must ignore repeats.
+ *
+ *  Only available on Linux.
+ */
+class DirectoryWatcher {
+public:
+    struct File {
+        std::filesystem::path path;
+        // When the file was seen to be complete.
+        std::chrono::steady_clock::time_point arrival_time;
+    };
+
+    static bool is_supported();
+
+    /// Starts watching |directory|. Throws std::runtime_error if it can't be watched.
+    explicit DirectoryWatcher(const std::filesystem::path& directory);
+    ~DirectoryWatcher();
+
+    DirectoryWatcher(const DirectoryWatcher&) = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+    /// Waits at most |timeout| for the next completed file. Returns nothing on timeout, once
+    /// stop() has been called, or once the directory is removed.
+    std::optional<File> wait_for_file(std::chrono::milliseconds timeout);
+
+    /// Wakes wait_for_file(), which returns nothing from then on. Can be called from any thread.
+    void stop();
+    bool is_stopped() const { return m_stopped.load(); }
+
+private:
+    // Reads the pending events into m_files, waiting at most |timeout| for some.
+    void read_events(std::chrono::milliseconds timeout);
+    // Queues every file in the directory, after the kernel has dropped events.
+    void queue_all_files();
+
+    const std::filesystem::path m_directory;
+    int m_inotify_fd = -1;
+    // Written to by stop() to wake read_events().
+    int m_wake_fds[2] = {-1, -1};
+    std::atomic<bool> m_stopped{false};
+    std::deque<File> m_files;
+};
+
+}  // namespace dorado
@@ -0,0 +1,491 @@
+#include "Fast5ProcessPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
+
+extern char** environ;
+#endif
+
+namespace {
+
+// Counts of bytes written to and read from a ring. They're shared between processes, so must
+// not need a lock.
+struct RingHeader {
+    alignas(64) std::atomic<uint64_t> head{0};
+    alignas(64) std::atomic<uint64_t> tail{0};
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(std::atomic<int>::is_always_lock_free);
+
+// The other side of a ring is another process, so waits spin briefly and then sleep.
+class Backoff {
+public:
+    void wait() {
+        if (++m_spins < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+    void reset() { m_spins = 0; }
+
+private:
+    int m_spins = 0;
+};
+
+}  // namespace
+
+namespace dorado {
+
+// The index of the next file to read, and a stop flag. It's followed by the paths to read, each
+// null terminated.
+struct Fast5ProcessPool::Control {
+    std::atomic<uint64_t> next_file{0};
+    std::atomic<int> stop{0};
+};
+
+struct Fast5ProcessPool::Worker {
+    RingHeader* ring = nullptr;
+    uint8_t* data = nullptr;
+    size_t capacity = 0;
+    size_t mapping_bytes = 0;
+#ifndef _WIN32
+    int fd = -1;
+    pid_t pid = -1;
+#endif
+    bool exited = false;
+};
+
+#ifdef _WIN32
+
+bool Fast5ProcessPool::is_supported() { return false; }
+
+int Fast5ProcessPool::worker_main(int, char*[]) { return EXIT_FAILURE; }
+
+Fast5ProcessPool::Fast5ProcessPool(std::vector<std::string> paths,
+                                   size_t num_workers,
+                                   size_t ring_bytes)
+        : m_paths(std::move(paths)), m_num_workers(num_workers), m_ring_bytes(ring_bytes) {}
+
+Fast5ProcessPool::~Fast5ProcessPool() = default;
+
+void Fast5ProcessPool::run(const std::function<bool(Fast5Read&&)>&) {
+    throw std::runtime_error("FAST5 worker processes are not supported on this platform");
+}
+
+void Fast5ProcessPool::write_reads(Control&, const std::vector<std::string>&, Worker&) {}
+void Fast5ProcessPool::start_worker(const std::string&, Worker&) {}
+void Fast5ProcessPool::read_worker(Worker&, const std::function<bool(Fast5Read&&)>&) {}
+void Fast5ProcessPool::stop_workers() {}
+
+#else  // _WIN32
+
+namespace {
+
+// Records in a worker's stream.
+enum class RecordType : uint8_t { READ = 1, ERROR = 2, DONE = 3 };
+
+// The descriptors that a worker finds its shared memory at.
+constexpr int WORKER_CONTROL_FD = 3;
+constexpr int WORKER_RING_FD = 4;
+
+// Creates an anonymous shared memory file of |bytes|. It's closed on exec, unless it's passed
+// on to a worker explicitly.
+int create_shared_memory(size_t bytes) {
+#ifdef __linux__
+    int fd = memfd_create("dorado_fast5_worker", MFD_CLOEXEC);
+#else
+    // The name is only needed until the file is open.
+    static std::atomic<int> counter{0};
+    const auto name = "/dorado_fast5." + std::to_string(getpid()) + "." + std::to_string(counter++);
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0) {
+        shm_unlink(name.c_str());
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+#endif
+    if (fd >= 0 && fd <= WORKER_RING_FD) {
+        // Keep clear of the descriptors the workers' memory is moved to.
+        const int high_fd = fcntl(fd, F_DUPFD_CLOEXEC, WORKER_RING_FD + 1);
+        close(fd);
+        fd = high_fd;
+    }
+    if (fd < 0 || ftruncate(fd, off_t(bytes)) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        throw std::runtime_error("Failed to create " + std::to_string(bytes) +
+                                 " bytes of shared memory for FAST5 workers");
+    }
+    return fd;
+}
+
+size_t shared_memory_bytes(int fd) {
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        throw std::runtime_error("Failed to find the size of FAST5 worker shared memory");
+    }
+    return size_t(info.st_size);
+}
+
+void* map_shared(int fd, size_t bytes) {
+    void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+        throw std::runtime_error("Failed to map " + std::to_string(bytes) +
+                                 " bytes of shared memory for FAST5 workers");
+    }
+    return ptr;
+}
+
+std::string executable_path() {
+#ifdef __APPLE__
+    uint32_t size = 0;
+    _NSGetExecutablePath(nullptr, &size);
+    std::string path(size, '\0');
+    if (_NSGetExecutablePath(path.data(), &size) != 0) {
+        throw std::runtime_error("Failed to find the executable for FAST5 workers");
+    }
+    path.resize(std::strlen(path.c_str()));
+    return path;
+#else
+    return std::filesystem::read_symlink("/proc/self/exe").string();
+#endif
+}
+
+}  // namespace
+
+bool Fast5ProcessPool::is_supported() { return true; }
+
+int Fast5ProcessPool::worker_main(int, char*[]) {
+    // The pool has no way to hear about errors which stop the worker from writing to its ring,
+    // beyond the worker exiting early.
+    try {
+        const size_t control_bytes = shared_memory_bytes(WORKER_CONTROL_FD);
+        void* control_mapping = map_shared(WORKER_CONTROL_FD, control_bytes);
+        auto* control = static_cast<Control*>(control_mapping);
+
+        std::vector<std::string> paths;
+        const char* path = static_cast<const char*>(control_mapping) + sizeof(Control);
+        const char* end = static_cast<const char*>(control_mapping) + control_bytes;
+        while (path < end) {
+            paths.emplace_back(path);
+            path += paths.back().size() + 1;
+        }
+
+        Worker worker;
+        worker.mapping_bytes = shared_memory_bytes(WORKER_RING_FD);
+        void* mapping = map_shared(WORKER_RING_FD, worker.mapping_bytes);
+        worker.ring = static_cast<RingHeader*>(mapping);
+        worker.data = static_cast<uint8_t*>(mapping) + sizeof(RingHeader);
+        worker.capacity = worker.mapping_bytes - sizeof(RingHeader);
+
+        write_reads(*control, paths, worker);
+    } catch (const std::exception&) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+Fast5ProcessPool::Fast5ProcessPool(std::vector<std::string> paths,
+                                   size_t num_workers,
+                                   size_t ring_bytes)
+        : m_paths(std::move(paths)),
+          m_num_workers(std::max(size_t(1), std::min(num_workers, m_paths.size()))),
+          m_ring_bytes(std::max(ring_bytes, size_t(4096))) {}
+
+Fast5ProcessPool::~Fast5ProcessPool() {
+    stop_workers();
+    for (auto& worker : m_workers) {
+        if (worker->ring) {
+            munmap(worker->ring, worker->mapping_bytes);
+        }
+        if (worker->fd >= 0) {
+            close(worker->fd);
+        }
+    }
+    if (m_control) {
+        munmap(m_control, m_control_bytes);
+    }
+    if (m_control_fd >= 0) {
+        close(m_control_fd);
+    }
+}
+
+void Fast5ProcessPool::stop_workers() {
+    if (m_control) {
+        m_control->stop.store(1, std::memory_order_release);
+    }
+    for (auto& worker : m_workers) {
+        if (worker->pid > 0 && !worker->exited) {
+            kill(worker->pid, SIGKILL);
+            waitpid(worker->pid, nullptr, 0);
+            worker->exited = true;
+        }
+    }
+}
+
+void Fast5ProcessPool::write_reads(Control& control,
+                                   const std::vector<std::string>& paths,
+                                   Worker& worker) {
+    // Nothing will read the ring if the pool's process has died.
+    const pid_t parent_pid = getppid();
+    auto stopping = [&] {
+        return control.stop.load(std::memory_order_acquire) || getppid() != parent_pid;
+    };
+
+    Backoff backoff;
+    // Returns false once the pool is stopping, after which nothing more is written.
+    auto write = [&](const void* src, size_t size) {
+        auto* bytes = static_cast<const uint8_t*>(src);
+        while (size > 0) {
+            const uint64_t head = worker.ring->head.load(std::memory_order_relaxed);
+            const uint64_t tail = worker.ring->tail.load(std::memory_order_acquire);
+            const size_t space = worker.capacity - size_t(head - tail);
+            if (space == 0) {
+                if (stopping()) {
+                    return false;
+                }
+                backoff.wait();
+                continue;
+            }
+            backoff.reset();
+            const size_t pos = size_t(head % worker.capacity);
+            const size_t chunk = std::min({size, space, worker.capacity - pos});
+            std::memcpy(worker.data + pos, bytes, chunk);
+            worker.ring->head.store(head + chunk, std::memory_order_release);
+            bytes += chunk;
+            size -= chunk;
+        }
+        return true;
+    };
+    auto write_value = [&](auto value) { return write(&value, sizeof(value)); };
+    auto write_string = [&](const std::string& str) {
+        return write_value(uint32_t(str.size())) && write(str.data(), str.size());
+    };
+
+    auto on_read = [&](Fast5Read&& read) {
+        if (control.stop.load(std::memory_order_acquire)) {
+            return false;
+        }
+        return write_value(RecordType::READ) && write_string(read.read_id) &&
+               write_string(read.fast5_filename) && write_string(read.start_time) &&
+               write_string(read.flow_cell_id) && write_string(read.device_id) &&
+               write_string(read.group_protocol_id) && write_value(read.digitisation) &&
+               write_value(read.range) && write_value(read.offset) &&
+               write_value(read.sampling_rate) && write_value(read.channel_number) &&
+               write_value(read.mux) && write_value(read.read_number) &&
+               write_value(uint64_t(read.signal.size())) &&
+               write(read.signal.data(), read.signal.size() * sizeof(int16_t));
+    };
+
+    // Any filtering by read id is left to the pool's caller.
+    auto want_read = [](const std::string&) { return true; };
+
+    uint64_t file_idx = 0;
+    try {
+        while (!control.stop.load(std::memory_order_acquire)) {
+            file_idx = control.next_file.fetch_add(1);
+            if (file_idx >= paths.size()) {
+                write_value(RecordType::DONE);
+                break;
+            }
+            read_fast5_file(paths[file_idx], want_read, on_read);
+        }
+    } catch (const std::exception& e) {
+        if (write_value(RecordType::ERROR)) {
+            write_string(paths[file_idx] + ": " + e.what());
+        }
+    }
+}
+
+void Fast5ProcessPool::start_worker(const std::string& executable, Worker& worker) {
+    posix_spawn_file_actions_t actions;
+    if (posix_spawn_file_actions_init(&actions) != 0) {
+        throw std::runtime_error("Failed to start FAST5 worker process");
+    }
+    // Everything else this process has open is closed on exec.
+    int result = posix_spawn_file_actions_adddup2(&actions, m_control_fd, WORKER_CONTROL_FD);
+    if (result == 0) {
+        result = posix_spawn_file_actions_adddup2(&actions, worker.fd, WORKER_RING_FD);
+    }
+    if (result == 0) {
+        std::string program = executable;
+        std::string command = WORKER_COMMAND;
+        char* argv[] = {program.data(), command.data(), nullptr};
+        result = posix_spawn(&worker.pid, executable.c_str(), &actions, nullptr, argv, environ);
+    }
+    posix_spawn_file_actions_destroy(&actions);
+    if (result != 0) {
+        worker.pid = -1;
+        throw std::runtime_error("Failed to start FAST5 worker process: " +
+                                 std::string(std::strerror(result)));
+    }
+}
+
+void Fast5ProcessPool::read_worker(Worker& worker,
+                                   const std::function<bool(Fast5Read&&)>& on_read) {
+    Backoff backoff;
+    // Returns false if the worker exited without writing |size| more bytes.
+    auto read = [&](void* dst, size_t size) {
+        auto* bytes = static_cast<uint8_t*>(dst);
+        while (size > 0) {
+            const uint64_t tail = worker.ring->tail.load(std::memory_order_relaxed);
+            const uint64_t head = worker.ring->head.load(std::memory_order_acquire);
+            const size_t available = size_t(head - tail);
+            if (available == 0) {
+                if (worker.exited) {
+                    return false;
+                }
+                if (waitpid(worker.pid, nullptr, WNOHANG) == worker.pid) {
+                    // Anything written before it exited is now visible.
+                    worker.exited = true;
+                    continue;
+                }
+                backoff.wait();
+                continue;
+            }
+            backoff.reset();
+            const size_t pos = size_t(tail % worker.capacity);
+            const size_t chunk = std::min({size, available, worker.capacity - pos});
+            std::memcpy(bytes, worker.data + pos, chunk);
+            worker.ring->tail.store(tail + chunk, std::memory_order_release);
+            bytes += chunk;
+            size -= chunk;
+        }
+        return true;
+    };
+    auto read_value = [&](auto& value) { return read(&value, sizeof(value)); };
+    auto read_string = [&](std::string& str) {
+        uint32_t size = 0;
+        if (!read_value(size)) {
+            return false;
+        }
+        str.resize(size);
+        return read(str.data(), size);
+    };
+
+    for (;;) {
+        RecordType type;
+        if (!read_value(type)) {
+            break;
+        }
+        if (type == RecordType::DONE) {
+            waitpid(worker.pid, nullptr, 0);
+            worker.exited = true;
+            return;
+        }
+        if (type == RecordType::ERROR) {
+            std::string message;
+            read_string(message);
+            throw std::runtime_error("FAST5 worker failed to read " + message);
+        }
+
+        Fast5Read fast5_read;
+        uint64_t num_samples = 0;
+        const bool complete =
+                read_string(fast5_read.read_id) && read_string(fast5_read.fast5_filename) &&
+                read_string(fast5_read.start_time) && read_string(fast5_read.flow_cell_id) &&
+                read_string(fast5_read.device_id) && read_string(fast5_read.group_protocol_id) &&
+                read_value(fast5_read.digitisation) && read_value(fast5_read.range) &&
+                read_value(fast5_read.offset) && read_value(fast5_read.sampling_rate) &&
+                read_value(fast5_read.channel_number) && read_value(fast5_read.mux) &&
+                read_value(fast5_read.read_number) && read_value(num_samples);
+        if (!complete) {
+            break;
+        }
+        fast5_read.signal.resize(num_samples);
+        if (!read(fast5_read.signal.data(), num_samples * sizeof(int16_t))) {
+            break;
+        }
+        if (!on_read(std::move(fast5_read))) {
+            m_control->stop.store(1, std::memory_order_release);
+            return;
+        }
+    }
+
+    // Workers which are told to stop exit without finishing their stream.
+    if (!m_control->stop.load(std::memory_order_acquire)) {
+        throw std::runtime_error("FAST5 worker process exited unexpectedly");
+    }
+}
+
+void Fast5ProcessPool::run(const std::function<bool(Fast5Read&&)>& on_read) {
+    if (m_paths.empty()) {
+        return;
+    }
+
+    m_control_bytes = sizeof(Control);
+    for (const auto& path : m_paths) {
+        m_control_bytes += path.size() + 1;
+    }
+    m_control_fd = create_shared_memory(m_control_bytes);
+    void* control_mapping = map_shared(m_control_fd, m_control_bytes);
+    m_control = new (control_mapping) Control();
+    char* path_data = static_cast<char*>(control_mapping) + sizeof(Control);
+    for (const auto& path : m_paths) {
+        std::memcpy(path_data, path.c_str(), path.size() + 1);
+        path_data += path.size() + 1;
+    }
+
+    for (size_t i = 0; i < m_num_workers; ++i) {
+        auto& worker = *m_workers.emplace_back(std::make_unique<Worker>());
+        worker.capacity = m_ring_bytes;
+        worker.mapping_bytes = sizeof(RingHeader) + m_ring_bytes;
+        worker.fd = create_shared_memory(worker.mapping_bytes);
+        void* mapping = map_shared(worker.fd, worker.mapping_bytes);
+        worker.ring = new (mapping) RingHeader();
+        worker.data = static_cast<uint8_t*>(mapping) + sizeof(RingHeader);
+    }
+
+    // Workers are separate programs, so nothing that's running in this process affects them.
+    const auto executable = executable_path();
+    for (auto& worker : m_workers) {
+        start_worker(executable, *worker);
+    }
+
+    std::vector<std::exception_ptr> errors(m_workers.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        threads.emplace_back([this, i, &on_read, &errors] {
+            try {
+                read_worker(*m_workers[i], on_read);
+            } catch (...) {
+                errors[i] = std::current_exception();
+                m_control->stop.store(1, std::memory_order_release);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    stop_workers();
+
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+#endif  // _WIN32
+
+}  // namespace dorado
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Fast5Reader.h"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dorado {
+
+/** Reads FAST5 files in a pool of local worker processes.
+ *
+ *  HDF5 serialises every call in a process behind one lock, so threads can't read FAST5 files in
+ *  parallel. Each worker is a fresh copy of the current executable, started with the hidden
+ *  WORKER_COMMAND subcommand, so it has its own HDF5 library state and none of the locks or
+ *  threads of this process. Workers take files from a shared counter, decode every read, and
+ *  stream them through a shared memory ring of |ring_bytes| to a reader thread in this process.
+ *  A full ring stalls its worker, which bounds the reads in flight.
+ *
+ *  Any executable which uses the pool must pass WORKER_COMMAND on to worker_main().
+ *
+ *  Only available on POSIX platforms.
+ */
+class Fast5ProcessPool {
+public:
+    static bool is_supported();
+
+    /// The subcommand which workers are started with.
+    static constexpr const char* WORKER_COMMAND = "fast5-worker";
+
+    /// Entry point of a worker process, with the arguments following WORKER_COMMAND.
+    static int worker_main(int argc, char* argv[]);
+
+    Fast5ProcessPool(std::vector<std::string> paths, size_t num_workers, size_t ring_bytes);
+    ~Fast5ProcessPool();
+
+    /** Reads every file, calling |on_read| for each read.
+     *
+     *  |on_read| is called from one thread per worker, so must be thread-safe. Once it returns
+     *  false the workers are stopped, and run() returns when every thread is done. Errors in a
+     *  worker, such as a malformed file, are rethrown as std::runtime_error.
+     */
+    void run(const std::function<bool(Fast5Read&&)>& on_read);
+
+private:
+    struct Control;
+    struct Worker;
+
+    static void write_reads(Control& control,
+                            const std::vector<std::string>& paths,
+                            Worker& worker);
+    void start_worker(const std::string& executable, Worker& worker);
+    void read_worker(Worker& worker, const std::function<bool(Fast5Read&&)>& on_read);
+    void stop_workers();
+
+    const std::vector<std::string> m_paths;
+    const size_t m_num_workers;
+    const size_t m_ring_bytes;
+
+    // Shared with the workers, along with the paths to read.
+    Control* m_control = nullptr;
+    size_t m_control_bytes = 0;
+    int m_control_fd = -1;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+};
+
+}  // namespace dorado
@@ -0,0 +1,118 @@
+#include "Fast5Reader.h"
+
+#include "utils/time_utils.h"
+
+#include <highfive/H5Easy.hpp>
+#include <highfive/H5File.hpp>
+
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+void string_reader(HighFive::Attribute& attribute, std::string& target_str) {
+    // Load as a variable string if possible
+    if (attribute.getDataType().isVariableStr()) {
+        attribute.read(target_str);
+        return;
+    }
+
+    // Process as a fixed length string
+    // Create landing buffer and H5 datatype
+    size_t size = attribute.getDataType().getSize();
+    std::vector<char> target_array(size);
+    hid_t dtype = H5Tcopy(H5T_C_S1);
+    H5Tset_size(dtype, size);
+
+    // Copy to landing buffer
+    if (H5Aread(attribute.getId(), dtype, target_array.data()) < 0) {
+        throw std::runtime_error("Error during H5Aread of fixed length string");
+    }
+
+    // Extract to string
+    target_str = std::string(target_array.data(), size);
+    // It's possible the null terminator appears before the end of the string
+    size_t eol_pos = target_str.find(char(0));
+    if (eol_pos < target_str.size()) {
+        target_str.resize(eol_pos);
+    }
+}
+
+std::string get_string_attribute(const HighFive::Group& group, const std::string& attr_name) {
+    std::string attribute_string;
+    if (group.hasAttribute(attr_name)) {
+        HighFive::Attribute attribute = group.getAttribute(attr_name);
+        string_reader(attribute, attribute_string);
+    }
+    return attribute_string;
+}
+
+}  // namespace
+
+namespace dorado {
+
+void read_fast5_file(const std::string& path,
+                     const std::function<bool(const std::string&)>& want_read,
+                     const std::function<bool(Fast5Read&&)>& on_read) {
+    H5Easy::File file(path, H5Easy::File::ReadOnly);
+    HighFive::Group reads = file.getGroup("/");
+    int num_reads = int(reads.getNumberObjects());
+    const std::string fast5_filename = std::filesystem::path(path).filename().string();
+
+    for (int i = 0; i < num_reads; i++) {
+        HighFive::Group read_group = reads.getGroup(reads.getObjectName(i));
+
+        // The read id comes from the signal group, and is checked before the signal is decoded.
+        HighFive::Group raw = read_group.getGroup("Raw");
+        Fast5Read read;
+        HighFive::Attribute read_id_attr = raw.getAttribute("read_id");
+        string_reader(read_id_attr, read.read_id);
+        if (!want_read(read.read_id)) {
+            continue;
+        }
+        raw.getAttribute("start_mux").read(read.mux);
+        raw.getAttribute("read_number").read(read.read_number);
+        uint64_t start_time;
+        raw.getAttribute("start_time").read(start_time);
+
+        // Fetch the digitisation parameters
+        HighFive::Group channel_id_group = read_group.getGroup("channel_id");
+        HighFive::Attribute channel_number_attr = channel_id_group.getAttribute("channel_number");
+        if (channel_number_attr.getDataType().string().substr(0, 6) == "String") {
+            std::string channel_number_string;
+            string_reader(channel_number_attr, channel_number_string);
+            std::istringstream channel_stream(channel_number_string);
+            channel_stream >> read.channel_number;
+        } else {
+            channel_number_attr.read(read.channel_number);
+        }
+        channel_id_group.getAttribute("digitisation").read(read.digitisation);
+        channel_id_group.getAttribute("range").read(read.range);
+        channel_id_group.getAttribute("offset").read(read.offset);
+        channel_id_group.getAttribute("sampling_rate").read(read.sampling_rate);
+
+        auto ds = raw.getDataSet("Signal");
+        if (ds.getDataType().string() != "Integer16") {
+            throw std::runtime_error("Invalid FAST5 Signal data type of " +
+                                     ds.getDataType().string());
+        }
+        read.signal.resize(ds.getElementCount());
+        ds.read(read.signal.data());
+
+        HighFive::Group tracking_id_group = read_group.getGroup("tracking_id");
+        std::string exp_start_time = get_string_attribute(tracking_id_group, "exp_start_time");
+        read.flow_cell_id = get_string_attribute(tracking_id_group, "flow_cell_id");
+        read.device_id = get_string_attribute(tracking_id_group, "device_id");
+        read.group_protocol_id = get_string_attribute(tracking_id_group, "group_protocol_id");
+        read.start_time = utils::adjust_time(
+                exp_start_time, static_cast<uint32_t>(start_time / read.sampling_rate));
+        read.fast5_filename = fast5_filename;
+
+        if (!on_read(std::move(read))) {
+            return;
+        }
+    }
+}
+
+}  // namespace dorado
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace dorado {
+
+/// The fields of a FAST5 read which DataLoader turns into a SimplexRead.
+struct Fast5Read {
+    std::string read_id;
+    std::string fast5_filename;
+    // Start of the read, as a timestamp adjusted from the experiment start time.
+    std::string start_time;
+    std::string flow_cell_id;
+    std::string device_id;
+    std::string group_protocol_id;
+    float digitisation = 0;
+    float range = 0;
+    float offset = 0;
+    float sampling_rate = 0;
+    int32_t channel_number = 0;
+    uint32_t mux = 0;
+    uint32_t read_number = 0;
+    std::vector<int16_t> signal;
+};
+
+/** Reads the reads of the FAST5 file at |path| in file order.
+ *
+ *  |want_read| is called with each read id before its signal is decoded, so unwanted reads are
+ *  skipped cheaply. |on_read| receives the decoded reads, and returns false to stop reading.
+ *
+ *  Doesn't depend on torch or logging, so it can run in a forked worker process. Throws on
+ *  malformed files.
+ */
+void read_fast5_file(const std::string& path,
+                     const std::function<bool(const std::string&)>& want_read,
+                     const std::function<bool(Fast5Read&&)>& on_read);
+
+}  // namespace dorado
@@ -1,4 +1,5 @@
 #include "cli/cli.h"
+#include "data_loader/Fast5ProcessPool.h"
 #include "dorado_version.h"
 #include "utils/locale_utils.h"
 #include "utils/log_utils.h"
@@ -63,6 +64,11 @@ int main(int argc, char* argv[]) {
 
     dorado::utils::ensure_user_locale_may_be_set();
 
+    // Hidden from the usage, since it's only run by dorado itself.
+    if (argc > 1 && argv[1] == std::string(dorado::Fast5ProcessPool::WORKER_COMMAND)) {
+        return dorado::Fast5ProcessPool::worker_main(argc - 1, argv + 1);
+    }
+
     const std::map<std::string, entry_ptr> subcommands = {
             {"basecaller", &dorado::basecaller},
             {"duplex", &dorado::duplex},
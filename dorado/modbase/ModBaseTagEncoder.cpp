@@ -0,0 +1,237 @@
+#include "ModBaseTagEncoder.h"
+
+#include "ModBaseContext.h"
+#include "utils/bam_utils.h"
+
+#include <charconv>
+#include <stdexcept>
+
+namespace {
+
+const std::string CARDINAL_BASES = "ACGT";
+
+// Index of a called base in "ACGT", or -1.
+constexpr auto BASE_INDEX = [] {
+    std::array<int8_t, 256> a{};
+    for (auto &v : a) {
+        v = -1;
+    }
+    a['A'] = 0;
+    a['C'] = 1;
+    a['G'] = 2;
+    a['T'] = 3;
+    return a;
+}();
+
+// Bases matched by each IUPAC code, as MotifMatcher expands them. Basecalls have T, not U.
+uint8_t iupac_bits(char code) {
+    constexpr uint8_t A = 1, C = 2, G = 4, T = 8;
+    switch (code) {
+    case 'A':
+        return A;
+    case 'C':
+        return C;
+    case 'G':
+        return G;
+    case 'T':
+    case 'U':
+        return T;
+    case 'R':
+        return A | G;
+    case 'Y':
+        return C | T;
+    case 'S':
+        return G | C;
+    case 'W':
+        return A | T;
+    case 'K':
+        return G | T;
+    case 'M':
+        return A | C;
+    case 'B':
+        return C | G | T;
+    case 'D':
+        return A | G | T;
+    case 'H':
+        return A | C | T;
+    case 'V':
+        return A | C | G;
+    case 'N':
+        return A | C | G | T;
+    default:
+        throw std::runtime_error("Invalid base modification context string.");
+    }
+}
+
+// Swaps A with T and C with G.
+uint8_t complement_bits(uint8_t bits) {
+    return uint8_t(((bits & 1) << 3) | ((bits & 2) << 1) | ((bits & 4) >> 1) | ((bits & 8) >> 3));
+}
+
+}  // namespace
+
+namespace dorado::modbase {
+
+ModBaseTagEncoder::ModBaseTagEncoder(std::vector<std::string> alphabet, std::string context)
+        : m_alphabet(std::move(alphabet)), m_context(std::move(context)) {
+    ModBaseContext context_handler;
+    if (!m_context.empty() && !context_handler.decode(m_context)) {
+        throw std::runtime_error("Invalid base modification context string.");
+    }
+    for (int base = 0; base < 4; ++base) {
+        const auto &motif = context_handler.motif(CARDINAL_BASES[base]);
+        if (motif.empty()) {
+            continue;
+        }
+        const size_t offset = context_handler.motif_offset(CARDINAL_BASES[base]);
+        // Reading the reverse complemented sequence forwards is reading this sequence backwards.
+        auto &forward = m_motifs[base];
+        auto &reverse = m_rc_motifs[base];
+        forward.offset = offset;
+        reverse.offset = motif.size() - 1 - offset;
+        for (size_t i = 0; i < motif.size(); ++i) {
+            forward.allowed.push_back(iupac_bits(motif[i]));
+            reverse.allowed.push_back(complement_bits(iupac_bits(motif[motif.size() - 1 - i])));
+        }
+        m_has_context[base] = motif.size() > 1;
+    }
+
+    // Modifications follow the cardinal base they belong to.
+    int current_base = -1;
+    for (size_t channel = 0; channel < m_alphabet.size(); ++channel) {
+        const auto &name = m_alphabet[channel];
+        if (CARDINAL_BASES.find(name) != std::string::npos) {
+            current_base = name.empty() ? -1 : BASE_INDEX[uint8_t(name[0])];
+            continue;
+        }
+        if (current_base < 0) {
+            continue;
+        }
+        m_valid_codes &= utils::validate_bam_tag_code(name);
+        if (m_groups.empty() || m_groups.back().base != current_base) {
+            m_groups.push_back({current_base, {}});
+        }
+        m_groups.back().channels.push_back(channel);
+        m_base_channels[current_base].push_back(channel);
+    }
+}
+
+bool ModBaseTagEncoder::matches(const std::vector<std::string> &alphabet,
+                                const std::string &context) const {
+    return m_alphabet == alphabet && m_context == context;
+}
+
+bool ModBaseTagEncoder::is_selected(std::string_view seq,
+                                    const std::vector<uint8_t> &probs,
+                                    uint8_t threshold,
+                                    size_t pos,
+                                    int base,
+                                    const Motif &motif) const {
+    if (motif.allowed.empty()) {
+        // Without a motif, a base is called if any of its modifications pass the threshold.
+        const uint8_t *row = probs.data() + pos * m_alphabet.size();
+        for (auto channel : m_base_channels[base]) {
+            if (row[channel] >= threshold) {
+                return true;
+            }
+        }
+        return false;
+    }
+    if (pos < motif.offset || pos - motif.offset + motif.allowed.size() > seq.size()) {
+        return false;
+    }
+    const char *window = seq.data() + pos - motif.offset;
+    for (size_t i = 0; i < motif.allowed.size(); ++i) {
+        const int window_base = BASE_INDEX[uint8_t(window[i])];
+        if (window_base < 0 || !(motif.allowed[i] & (1 << window_base))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ModBaseTagEncoder::append_strand(std::string_view seq,
+                                      const std::vector<uint8_t> &probs,
+                                      bool complement,
+                                      std::string &mm,
+                                      std::vector<uint8_t> &ml) {
+    const size_t num_channels = m_alphabet.size();
+    for (const auto &group : m_groups) {
+        const char base = CARDINAL_BASES[complement ? 3 - group.base : group.base];
+
+        // Positions and skip counts are the same for every modification of this base.
+        m_selected.clear();
+        m_deltas.clear();
+        uint32_t skipped = 0;
+        char number[16];
+        for (size_t pos = 0; pos < seq.size(); ++pos) {
+            if (seq[pos] != base) {
+                continue;
+            }
+            if (!m_mask[pos]) {
+                ++skipped;
+                continue;
+            }
+            m_selected.push_back(uint32_t(pos));
+            const auto end = std::to_chars(number, number + sizeof(number), skipped).ptr;
+            m_deltas += ',';
+            m_deltas.append(number, end);
+            skipped = 0;
+        }
+
+        for (auto channel : group.channels) {
+            mm += base;
+            mm += complement ? '-' : '+';
+            mm += m_alphabet[channel];
+            mm += m_has_context[group.base] ? '?' : '.';
+            mm += m_deltas;
+            mm += ';';
+            for (auto pos : m_selected) {
+                ml.push_back(probs[pos * num_channels + channel]);
+            }
+        }
+    }
+}
+
+bool ModBaseTagEncoder::encode(std::string_view seq,
+                               const std::vector<uint8_t> &probs,
+                               uint8_t threshold,
+                               bool is_duplex,
+                               std::string &mm,
+                               std::vector<uint8_t> &ml) {
+    if (probs.size() != seq.size() * m_alphabet.size()) {
+        throw std::runtime_error(
+                "Mismatch between base_mod_probs size and sequence length * num channels in "
+                "modbase_alphabet!");
+    }
+    mm.clear();
+    ml.clear();
+    if (!m_valid_codes) {
+        return false;
+    }
+
+    // One pass marks every base called on either strand. On the complementary strand a base is
+    // read as its complement, and its motif is matched against the reverse complement.
+    m_mask.resize(seq.size());
+    for (size_t pos = 0; pos < seq.size(); ++pos) {
+        const int base = BASE_INDEX[uint8_t(seq[pos])];
+        if (base < 0) {
+            m_mask[pos] = 0;
+            continue;
+        }
+        bool selected = is_selected(seq, probs, threshold, pos, base, m_motifs[base]);
+        if (!selected && is_duplex) {
+            const int complement = 3 - base;
+            selected = is_selected(seq, probs, threshold, pos, complement, m_rc_motifs[complement]);
+        }
+        m_mask[pos] = selected;
+    }
+
+    append_strand(seq, probs, false, mm, ml);
+    if (is_duplex) {
+        append_strand(seq, probs, true, mm, ml);
+    }
+    return true;
+}
+
+}  // namespace dorado::modbase
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dorado::modbase {
+
+/** Generates the MM and ML tag values for the modified base calls of a read.
+ *
+ *  The context string is decoded once, into a bitmask of allowed bases for each position of each
+ *  motif and of its reverse complement, so a read is checked against it in a single pass over
+ *  the sequence with no regex or reverse complemented copies. Positions are then selected once
+ *  per canonical base and shared by all the modifications of that base.
+ *
+ *  The output matches what ModBaseContext::get_sequence_mask() and update_mask() select, on both
+ *  strands for duplex reads.
+ *
+ *  An encoder keeps scratch buffers between reads, so each thread needs its own.
+ */
+class ModBaseTagEncoder {
+public:
+    /// Throws std::runtime_error if |context| isn't a valid ModBaseContext encoding.
+    ModBaseTagEncoder(std::vector<std::string> alphabet, std::string context);
+
+    /// True if this encoder was made for |alphabet| and |context|.
+    bool matches(const std::vector<std::string>& alphabet, const std::string& context) const;
+
+    /** Writes the MM string to |mm| and the ML probabilities to |ml|, replacing their contents.
+     *
+     *  |probs| holds seq.size() rows of one probability per alphabet channel. For duplex reads,
+     *  the calls on the complementary strand are appended, read off the same rows.
+     *
+     *  @return false if a modification code isn't a valid BAM tag code, in which case no tags
+     *  should be written.
+     */
+    bool encode(std::string_view seq,
+                const std::vector<uint8_t>& probs,
+                uint8_t threshold,
+                bool is_duplex,
+                std::string& mm,
+                std::vector<uint8_t>& ml);
+
+private:
+    // Allowed bases for each position of a motif, as bitmasks with A, C, G, T as bits 0 to 3,
+    // and the position of the canonical base. No positions if the base has no motif.
+    struct Motif {
+        std::vector<uint8_t> allowed;
+        size_t offset = 0;
+    };
+
+    // Modifications of one canonical base, in alphabet order.
+    struct Group {
+        int base;
+        std::vector<size_t> channels;
+    };
+
+    bool is_selected(std::string_view seq,
+                     const std::vector<uint8_t>& probs,
+                     uint8_t threshold,
+                     size_t pos,
+                     int base,
+                     const Motif& motif) const;
+    void append_strand(std::string_view seq,
+                       const std::vector<uint8_t>& probs,
+                       bool complement,
+                       std::string& mm,
+                       std::vector<uint8_t>& ml);
+
+    const std::vector<std::string> m_alphabet;
+    const std::string m_context;
+    std::vector<Group> m_groups;
+    bool m_valid_codes = true;
+
+    std::array<Motif, 4> m_motifs;
+    std::array<Motif, 4> m_rc_motifs;
+    // Bases with a motif longer than the base itself, which MM marks with '?'.
+    std::array<bool, 4> m_has_context{};
+    // Channels of each base's modifications, for the threshold test of bases without a motif.
+    std::array<std::vector<size_t>, 4> m_base_channels;
+
+    // Scratch, reused between reads.
+    std::vector<uint8_t> m_mask;
+    std::vector<uint32_t> m_selected;
+    std::string m_deltas;
+};
+
+}  // namespace dorado::modbase
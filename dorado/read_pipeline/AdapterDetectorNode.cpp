@@ -23,6 +23,7 @@ namespace dorado {
 
 // A Node which encapsulates running adapter and primer detection on each read.
 AdapterDetectorNode::AdapterDetectorNode(int threads) : MessageSink(10000, threads) {
+    enable_batch_input();
     start_input_processing(&AdapterDetectorNode::input_thread_fn, this);
 }
 
@@ -37,6 +38,20 @@ void AdapterDetectorNode::input_thread_fn() {
             }
             process_read(bam_message);
             send_message_to_sink(std::move(bam_message));
+        } else if (std::holds_alternative<BamBatch>(message)) {
+            auto batch = std::get<BamBatch>(std::move(message));
+            BamBatch processed;
+            processed.messages.reserve(batch.messages.size());
+            for (auto& bam_message : batch.messages) {
+                if (bam_message.bam_ptr->core.flag & (BAM_FSUPPLEMENTARY | BAM_FSECONDARY)) {
+                    continue;
+                }
+                process_read(bam_message);
+                processed.messages.push_back(std::move(bam_message));
+            }
+            if (!processed.messages.empty()) {
+                send_message_to_sink(std::move(processed));
+            }
         } else if (std::holds_alternative<SimplexReadPtr>(message)) {
             auto read = std::get<SimplexReadPtr>(std::move(message));
             process_read(*read);
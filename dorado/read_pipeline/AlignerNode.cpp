@@ -61,6 +61,7 @@ AlignerNode::AlignerNode(std::shared_ptr<alignment::IndexFileAccess> index_file_
             m_header_sequences_for_bam_messages.emplace_back(entry.first);
         }
     }
+    enable_batch_input();
     start_input_processing(&AlignerNode::input_thread_fn, this);
 }
 
@@ -122,19 +123,35 @@ void AlignerNode::input_thread_fn() {
         align_read_common(read->read_common, tbuf);
         send_message_to_sink(std::move(read));
     };
+    // Appends the alignments of the record to |aligned|.
+    auto align_record = [this, tbuf](const BamMessage& bam_message,
+                                     std::vector<BamMessage>& aligned) {
+        auto records = alignment::Minimap2Aligner(m_index_for_bam_messages)
+                               .align(bam_message.bam_ptr.get(), tbuf);
+        for (auto& record : records) {
+            if (!m_bed_file_for_bam_messages.filename().empty() &&
+                !(record->core.flag & BAM_FUNMAP)) {
+                auto ref_id = record->core.tid;
+                add_bed_hits_to_record(m_header_sequences_for_bam_messages.at(ref_id),
+                                       record.get());
+            }
+            aligned.push_back(BamMessage{std::move(record), bam_message.client_info});
+        }
+    };
     while (get_input_message(message)) {
         if (std::holds_alternative<BamMessage>(message)) {
-            auto bam_message = std::get<BamMessage>(std::move(message));
-            auto records = alignment::Minimap2Aligner(m_index_for_bam_messages)
-                                   .align(bam_message.bam_ptr.get(), tbuf);
-            for (auto& record : records) {
-                if (!m_bed_file_for_bam_messages.filename().empty() &&
-                    !(record->core.flag & BAM_FUNMAP)) {
-                    auto ref_id = record->core.tid;
-                    add_bed_hits_to_record(m_header_sequences_for_bam_messages.at(ref_id),
-                                           record.get());
-                }
-                send_message_to_sink(BamMessage{std::move(record), bam_message.client_info});
+            std::vector<BamMessage> aligned;
+            align_record(std::get<BamMessage>(message), aligned);
+            for (auto& bam_message : aligned) {
+                send_message_to_sink(std::move(bam_message));
+            }
+        } else if (std::holds_alternative<BamBatch>(message)) {
+            BamBatch aligned;
+            for (const auto& bam_message : std::get<BamBatch>(message).messages) {
+                align_record(bam_message, aligned.messages);
+            }
+            if (!aligned.messages.empty()) {
+                send_message_to_sink(std::move(aligned));
             }
         } else if (std::holds_alternative<SimplexReadPtr>(message)) {
             align_read(std::get<SimplexReadPtr>(std::move(message)));
@@ -47,24 +47,43 @@ const dorado::demux::BarcodingInfo* get_barcoding_info(const dorado::ClientInfo&
 namespace dorado {
 
 BarcodeClassifierNode::BarcodeClassifierNode(int threads) : MessageSink(10000, threads) {
+    enable_batch_input();
     start_input_processing(&BarcodeClassifierNode::input_thread_fn, this);
 }
 
 void BarcodeClassifierNode::input_thread_fn() {
+    // Returns false if the record should be dropped.
+    auto process_record = [this](BamMessage& bam_message) {
+        // If the read is a secondary or supplementary read, ignore it if
+        // client requires read trimming.
+        const auto* barcoding_info = get_barcoding_info(*bam_message.client_info);
+        if (barcoding_info && barcoding_info->trim &&
+            (bam_message.bam_ptr->core.flag & (BAM_FSUPPLEMENTARY | BAM_FSECONDARY))) {
+            return false;
+        }
+        barcode(bam_message.bam_ptr, barcoding_info);
+        return true;
+    };
+
     Message message;
     while (get_input_message(message)) {
         if (std::holds_alternative<BamMessage>(message)) {
             auto bam_message = std::get<BamMessage>(std::move(message));
-            // If the read is a secondary or supplementary read, ignore it if
-            // client requires read trimming.
-            const auto* barcoding_info = get_barcoding_info(*bam_message.client_info);
-            if (barcoding_info && barcoding_info->trim &&
-                (bam_message.bam_ptr->core.flag & (BAM_FSUPPLEMENTARY | BAM_FSECONDARY))) {
-                continue;
+            if (process_record(bam_message)) {
+                send_message_to_sink(std::move(bam_message));
+            }
+        } else if (std::holds_alternative<BamBatch>(message)) {
+            auto batch = std::get<BamBatch>(std::move(message));
+            BamBatch processed;
+            processed.messages.reserve(batch.messages.size());
+            for (auto& bam_message : batch.messages) {
+                if (process_record(bam_message)) {
+                    processed.messages.push_back(std::move(bam_message));
+                }
+            }
+            if (!processed.messages.empty()) {
+                send_message_to_sink(std::move(processed));
             }
-
-            barcode(bam_message.bam_ptr, barcoding_info);
-            send_message_to_sink(std::move(bam_message));
         } else if (std::holds_alternative<SimplexReadPtr>(message)) {
             auto read = std::get<SimplexReadPtr>(std::move(message));
             barcode(*read);
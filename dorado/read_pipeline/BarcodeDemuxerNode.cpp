@@ -6,15 +6,24 @@
 
 #include <htslib/bgzf.h>
 #include <htslib/sam.h>
+#include <htslib/thread_pool.h>
 
+#include <algorithm>
 #include <cassert>
+#include <exception>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
 
 namespace {
 constexpr size_t BAM_BUFFER_SIZE =
         20000000;  // 20 MB per barcode classification. So roughly 2 GB for 96 barcodes.
-}
+// Routing records is cheap next to compressing them, so a few threads are enough.
+constexpr size_t MAX_WRITER_THREADS = 4;
+// Records which can be queued for a file while another thread writes it.
+constexpr size_t MAX_PENDING_RECORDS = 1000;
+}  // namespace
 
 namespace dorado {
 
@@ -23,13 +32,18 @@ BarcodeDemuxerNode::BarcodeDemuxerNode(const std::string& output_dir,
                                        bool write_fastq,
                                        std::unique_ptr<const utils::SampleSheet> sample_sheet,
                                        bool sort_bam)
-        : MessageSink(10000, 1),
+        : MessageSink(10000, int(std::clamp(htslib_threads, size_t(1), MAX_WRITER_THREADS))),
           m_output_dir(output_dir),
           m_htslib_threads(int(htslib_threads)),
+          m_thread_pool(hts_tpool_init(std::max(m_htslib_threads, 1))),
           m_write_fastq(write_fastq),
           m_sort_bam(sort_bam && !write_fastq),
           m_sample_sheet(std::move(sample_sheet)) {
+    if (!m_thread_pool) {
+        throw std::runtime_error("Could not create a thread pool for BAM generation.");
+    }
     std::filesystem::create_directories(m_output_dir);
+    enable_batch_input();
     start_input_processing(&BarcodeDemuxerNode::input_thread_fn, this);
 }
 
@@ -38,19 +52,47 @@ BarcodeDemuxerNode::~BarcodeDemuxerNode() { stop_input_processing(); }
 void BarcodeDemuxerNode::input_thread_fn() {
     Message message;
     while (get_input_message(message)) {
-        auto bam_message = std::move(std::get<BamMessage>(message));
-        write(bam_message.bam_ptr.get());
+        if (std::holds_alternative<BamBatch>(message)) {
+            for (auto& bam_message : std::get<BamBatch>(message).messages) {
+                write(std::move(bam_message.bam_ptr));
+            }
+        } else {
+            write(std::move(std::get<BamMessage>(message).bam_ptr));
+        }
     }
 }
 
+BarcodeDemuxerNode::BarcodeFile& BarcodeDemuxerNode::get_file(const std::string& barcode) {
+    std::lock_guard lock(m_files_mutex);
+    auto& barcode_file = m_files[barcode];
+    if (!barcode_file) {
+        // For new barcodes, create a new HTS file (either fastq or BAM).
+        std::string filename = barcode + (m_write_fastq ? ".fastq" : ".bam");
+        auto filepath = m_output_dir / filename;
+        auto filepath_str = filepath.string();
+
+        auto file = std::make_unique<utils::HtsFile>(
+                filepath_str,
+                m_write_fastq ? utils::HtsFile::OutputMode::FASTQ : utils::HtsFile::OutputMode::BAM,
+                m_htslib_threads, m_sort_bam, m_thread_pool.get());
+        if (m_sort_bam) {
+            file->set_buffer_size(BAM_BUFFER_SIZE);
+        }
+        file->set_header(m_header.get());
+        barcode_file = std::make_unique<BarcodeFile>();
+        barcode_file->file = std::move(file);
+    }
+    return *barcode_file;
+}
+
 // Each barcode is mapped to its own file. Depending
 // on the barcode assigned to each read, the read is
 // written to the corresponding barcode file.
-int BarcodeDemuxerNode::write(bam1_t* const record) {
+void BarcodeDemuxerNode::write(BamPtr record) {
     assert(m_header);
     // Fetch the barcode name.
     std::string bc = "unclassified";
-    auto bam_tag = bam_aux_get(record, "BC");
+    auto bam_tag = bam_aux_get(record.get(), "BC");
     if (bam_tag) {
         bc = std::string(bam_aux2Z(bam_tag));
     }
@@ -60,35 +102,48 @@ int BarcodeDemuxerNode::write(bam1_t* const record) {
         auto alias = m_sample_sheet->get_alias("", "", "", bc);
         if (!alias.empty()) {
             bc = alias;
-            bam_aux_update_str(record, "BC", int(bc.size() + 1), bc.c_str());
+            bam_aux_update_str(record.get(), "BC", int(bc.size() + 1), bc.c_str());
         }
     }
-    // Check of existence of file for that barcode.
-    auto& file = m_files[bc];
-    if (!file) {
-        // For new barcodes, create a new HTS file (either fastq or BAM).
-        std::string filename = bc + (m_write_fastq ? ".fastq" : ".bam");
-        auto filepath = m_output_dir / filename;
-        auto filepath_str = filepath.string();
 
-        file = std::make_unique<utils::HtsFile>(
-                filepath_str,
-                m_write_fastq ? utils::HtsFile::OutputMode::FASTQ : utils::HtsFile::OutputMode::BAM,
-                m_htslib_threads, m_sort_bam);
-        if (m_sort_bam) {
-            file->set_buffer_size(BAM_BUFFER_SIZE);
+    auto& barcode_file = get_file(bc);
+    {
+        std::unique_lock lock(barcode_file.mutex);
+        // A full queue always has a thread draining it, which will make room.
+        barcode_file.pending_taken.wait(lock, [&barcode_file] {
+            return barcode_file.pending.size() < MAX_PENDING_RECORDS;
+        });
+        barcode_file.pending.push_back(std::move(record));
+        if (std::exchange(barcode_file.draining, true)) {
+            // Another thread is writing this file, and will pick up the record.
+            return;
         }
-        file->set_header(m_header.get());
     }
+    drain(barcode_file);
+}
 
-    auto hts_res = file->write(record);
-    if (hts_res < 0) {
-        throw std::runtime_error("Failed to write SAM record, error code " +
-                                 std::to_string(hts_res));
+void BarcodeDemuxerNode::drain(BarcodeFile& barcode_file) {
+    std::vector<BamPtr> records;
+    for (;;) {
+        {
+            std::lock_guard lock(barcode_file.mutex);
+            if (barcode_file.pending.empty()) {
+                barcode_file.draining = false;
+                return;
+            }
+            records.swap(barcode_file.pending);
+        }
+        barcode_file.pending_taken.notify_all();
+        for (auto& record : records) {
+            auto hts_res = barcode_file.file->write(record.get());
+            if (hts_res < 0) {
+                throw std::runtime_error("Failed to write SAM record, error code " +
+                                         std::to_string(hts_res));
+            }
+            m_processed_reads++;
+        }
+        records.clear();
     }
-
-    m_processed_reads++;
-    return hts_res;
 }
 
 void BarcodeDemuxerNode::set_header(const sam_hdr_t* const header) {
@@ -99,18 +154,58 @@ void BarcodeDemuxerNode::set_header(const sam_hdr_t* const header) {
 
 void BarcodeDemuxerNode::finalise_hts_files(
         const utils::HtsFile::ProgressCallback& progress_callback) {
-    const size_t num_files = m_files.size();
-    size_t current_file_idx = 0;
-    for (auto& [bc, hts_file] : m_files) {
-        hts_file->finalise([&](size_t progress) {
-            // Give each file/barcode the same contribution to the total progress.
-            const size_t total_progress = (current_file_idx * 100 + progress) / num_files;
+    std::vector<utils::HtsFile*> files;
+    for (auto& [bc, barcode_file] : m_files) {
+        files.push_back(barcode_file->file.get());
+    }
+    const size_t num_files = files.size();
+
+    // Give each file/barcode the same contribution to the total progress.
+    std::mutex progress_mutex;
+    std::vector<size_t> file_progress(num_files, 0);
+    size_t last_progress = 0;
+    auto update_progress = [&](size_t file_idx, size_t progress) {
+        std::lock_guard lock(progress_mutex);
+        file_progress[file_idx] = progress;
+        size_t total_progress = 0;
+        for (auto p : file_progress) {
+            total_progress += p;
+        }
+        total_progress /= num_files;
+        if (total_progress > last_progress) {
+            last_progress = total_progress;
             progress_callback(total_progress);
-        });
-        ++current_file_idx;
+        }
+    };
+
+    // Each file is sorted and merged on its own thread, with compression in the shared pool.
+    std::atomic<size_t> next_file_idx{0};
+    std::vector<std::exception_ptr> errors(num_files);
+    auto finalise_files = [&] {
+        for (size_t idx = next_file_idx++; idx < num_files; idx = next_file_idx++) {
+            try {
+                files[idx]->finalise([&](size_t progress) { update_progress(idx, progress); });
+            } catch (...) {
+                errors[idx] = std::current_exception();
+            }
+        }
+    };
+    const size_t num_threads = std::min(num_files, size_t(std::max(m_htslib_threads, 1)));
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < num_threads; ++i) {
+        threads.emplace_back(finalise_files);
+    }
+    finalise_files();
+    for (auto& thread : threads) {
+        thread.join();
     }
 
     m_files.clear();
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
     progress_callback(100);
 }
 
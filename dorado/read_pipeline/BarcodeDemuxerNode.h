@@ -6,10 +6,13 @@
 #include "utils/types.h"
 
 #include <atomic>
+#include <condition_variable>
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 struct bam1_t;
 
@@ -19,10 +22,11 @@ namespace utils {
 class SampleSheet;
 }
 
+// Writes each record to the file for its barcode. All the files share one pool of
+// |htslib_threads| for compression, and several input threads route records to them, so the
+// order of records within a file can differ from the order they arrived in.
 class BarcodeDemuxerNode : public MessageSink {
 public:
-    using HtsFiles = std::unordered_map<std::string, std::unique_ptr<utils::HtsFile>>;
-
     BarcodeDemuxerNode(const std::string& output_dir,
                        size_t htslib_threads,
                        bool write_fastq,
@@ -36,20 +40,38 @@ public:
 
     void set_header(const sam_hdr_t* header);
 
-    // Finalisation must occur before destruction of this node.
+    // Finalisation must occur before destruction of this node. Files are sorted and merged
+    // concurrently.
     // Note that this isn't safe to call until after this node has been terminated.
     void finalise_hts_files(const utils::HtsFile::ProgressCallback& progress_callback);
 
 private:
+    // Records queued for a barcode's file. Whichever input thread finds the queue idle writes
+    // it out, so the others can go on routing records rather than wait for the file, unless the
+    // queue is full.
+    struct BarcodeFile {
+        std::mutex mutex;
+        std::condition_variable pending_taken;
+        std::vector<BamPtr> pending;
+        bool draining{false};
+        // Only used by the draining thread.
+        std::unique_ptr<utils::HtsFile> file;
+    };
+
     std::filesystem::path m_output_dir;
     int m_htslib_threads;
     SamHdrPtr m_header;
     std::atomic<int> m_processed_reads{0};
 
-    HtsFiles m_files;
-    std::unique_ptr<std::thread> m_worker;
+    // Shared by every file, so must outlive them.
+    HtsThreadPoolPtr m_thread_pool;
+    std::mutex m_files_mutex;
+    std::unordered_map<std::string, std::unique_ptr<BarcodeFile>> m_files;
+
     void input_thread_fn();
-    int write(bam1_t* record);
+    BarcodeFile& get_file(const std::string& barcode);
+    void write(BamPtr record);
+    void drain(BarcodeFile& barcode_file);
     const bool m_write_fastq;
     const bool m_sort_bam;
     std::unique_ptr<const utils::SampleSheet> m_sample_sheet;
@@ -5,6 +5,8 @@
 #include "models/kits.h"
 #include "read_utils.h"
 #include "stitch.h"
+#include "utils/dev_utils.h"
+#include "utils/math_utils.h"
 #include "utils/stats.h"
 
 #include <ATen/Functions.h>
@@ -35,12 +37,25 @@ struct BasecallerNode::BasecallingChunk : utils::Chunk {
 
     std::shared_ptr<BasecallingRead> owning_read;  // The object that owns us.
     size_t idx_in_read;  // Just for tracking that the chunks don't go out of order.
+    int batch_slot = -1;  // Model input slot this chunk was copied into.
+    // When packed into a slot shared with other chunks, the stride aligned range of samples
+    // of the slot holding this chunk.  packed_size is 0 for unpacked chunks.
+    size_t packed_offset = 0;
+    size_t packed_size = 0;
+};
+
+struct BasecallerNode::PackedSlot {
+    at::Tensor input;   // Model input of the slot being filled, [C, chunk_size].
+    int slot_idx = -1;  // Batch slot being filled, or -1 if none is open.
+    size_t fill = 0;    // Samples of the slot used so far.
 };
 
 struct BasecallerNode::BasecallingRead {
-    Message read;                                              // The read itself.
-    std::vector<std::unique_ptr<utils::Chunk>> called_chunks;  // Vector of basecalled chunks.
-    std::atomic_size_t num_chunks_called;  // Number of chunks which have been basecalled.
+    Message read;  // The read itself.
+    // Stitches called chunks into the read as they arrive.  Chunks of a read can be returned
+    // to any of the working reads manager threads, so access is guarded by stitch_mutex.
+    std::unique_ptr<utils::ChunkStitcher> stitcher;
+    std::mutex stitch_mutex;
 };
 
 size_t BasecallerNode::get_chunk_queue_idx(size_t read_raw_size) {
@@ -99,7 +114,6 @@ void BasecallerNode::input_thread_fn() {
         std::vector<std::unique_ptr<BasecallingChunk>> read_chunks;
         read_chunks.emplace_back(std::make_unique<BasecallingChunk>(
                 working_read, offset, chunk_in_read_idx++, chunk_size));
-        size_t num_chunks = 1;
         auto last_chunk_offset = raw_size - chunk_size;
         auto misalignment = last_chunk_offset % m_model_stride;
         if (misalignment != 0) {
@@ -110,10 +124,14 @@ void BasecallerNode::input_thread_fn() {
             offset = std::min(offset + signal_chunk_step, last_chunk_offset);
             read_chunks.push_back(std::make_unique<BasecallingChunk>(
                     working_read, offset, chunk_in_read_idx++, chunk_size));
-            ++num_chunks;
         }
-        working_read->called_chunks.resize(num_chunks);
-        working_read->num_chunks_called.store(0);
+        std::vector<size_t> chunk_offsets;
+        chunk_offsets.reserve(read_chunks.size());
+        for (const auto &chunk : read_chunks) {
+            chunk_offsets.push_back(chunk->input_offset);
+        }
+        working_read->stitcher = std::make_unique<utils::ChunkStitcher>(
+                std::move(chunk_offsets), chunk_size, int(m_model_stride));
         working_read->read = std::move(message);
 
         // Put the read in the working list
@@ -141,26 +159,154 @@ void BasecallerNode::input_thread_fn() {
 
 void BasecallerNode::basecall_current_batch(int worker_id) {
     NVTX3_FUNC_RANGE();
+    close_packed_slot(worker_id);
+
     auto &model_runner = m_model_runners[worker_id];
     dorado::stats::Timer timer;
-    spdlog::trace("Basecalling batch T={}, N={}, chunks={}, worker={}", model_runner->chunk_size(),
-                  model_runner->batch_size(), m_batched_chunks[worker_id].size(), worker_id);
-    auto decode_results = model_runner->call_chunks(int(m_batched_chunks[worker_id].size()));
+    spdlog::trace("Basecalling batch T={}, N={}, chunks={}, slots={}, worker={}",
+                  model_runner->chunk_size(), model_runner->batch_size(),
+                  m_batched_chunks[worker_id].size(), m_batch_num_slots[worker_id], worker_id);
+    if (model_runner->max_batches_in_flight() > 1) {
+        // The runner calls this batch while the next one is filled.
+        model_runner->submit_chunks(m_batch_num_slots[worker_id]);
+        m_batches_in_flight[worker_id].push_back(std::move(m_batched_chunks[worker_id]));
+    } else {
+        auto decode_results = model_runner->call_chunks(m_batch_num_slots[worker_id]);
+        complete_batch(m_batched_chunks[worker_id], decode_results);
+    }
     m_num_samples_incl_padding += model_runner->chunk_size() * model_runner->batch_size();
     m_call_chunks_ms += timer.GetElapsedMS();
 
-    for (size_t i = 0; i < m_batched_chunks[worker_id].size(); i++) {
-        m_batched_chunks[worker_id][i]->seq = decode_results[i].sequence;
-        m_batched_chunks[worker_id][i]->qstring = decode_results[i].qstring;
-        m_batched_chunks[worker_id][i]->moves = decode_results[i].moves;
+    m_batched_chunks[worker_id].clear();
+    m_batch_num_slots[worker_id] = 0;
+    ++m_num_batches_called;
+
+    // Once the runner can't take another batch, the oldest one's results are needed.
+    if (int(m_batches_in_flight[worker_id].size()) == model_runner->max_batches_in_flight()) {
+        collect_called_batch(worker_id);
     }
+}
 
-    for (auto &complete_chunk : m_batched_chunks[worker_id]) {
+void BasecallerNode::collect_called_batch(int worker_id) {
+    dorado::stats::Timer timer;
+    auto decode_results = m_model_runners[worker_id]->collect_chunks();
+    m_call_chunks_ms += timer.GetElapsedMS();
+    complete_batch(m_batches_in_flight[worker_id].front(), decode_results);
+    m_batches_in_flight[worker_id].pop_front();
+}
+
+void BasecallerNode::complete_batch(std::vector<std::unique_ptr<BasecallingChunk>> &chunks,
+                                    std::vector<basecall::decode::DecodedChunk> &decode_results) {
+    for (auto &chunk : chunks) {
+        auto &decoded = decode_results[chunk->batch_slot];
+        if (chunk->packed_size != 0) {
+            utils::unpack_decoded_chunk(decoded, chunk->packed_offset, chunk->packed_size,
+                                        m_model_stride, *chunk);
+        } else {
+            // Unpacked chunks have their slot to themselves.
+            chunk->seq = std::move(decoded.sequence);
+            chunk->qstring = std::move(decoded.qstring);
+            chunk->moves = std::move(decoded.moves);
+        }
+    }
+
+    for (auto &complete_chunk : chunks) {
         m_processed_chunks.try_push(std::move(complete_chunk));
     }
+}
 
-    m_batched_chunks[worker_id].clear();
-    ++m_num_batches_called;
+void BasecallerNode::add_chunk_to_batch(int worker_id, std::unique_ptr<BasecallingChunk> chunk) {
+    auto &model_runner = m_model_runners[worker_id];
+    const size_t chunk_size = model_runner->chunk_size();
+    const int batch_size = static_cast<int>(model_runner->batch_size());
+
+    // Copy the chunk into the input tensor
+    auto &source_read = chunk->owning_read->read;
+
+    auto &read_common = get_read_common_data(source_read);
+    auto input_slice = read_common.raw_data.index(
+            {Ellipsis, Slice(chunk->input_offset, chunk->input_offset + chunk_size)});
+
+    // Make sure the slice tensor is 2D
+    if (input_slice.ndimension() == 1) {
+        input_slice = input_slice.unsqueeze(0);
+    }
+    size_t slice_size = input_slice.size(1);
+    m_num_samples_in_chunks += slice_size;
+
+    // Only reads shorter than a chunk, which are called as a single chunk, are packed. The
+    // last chunk of a longer read can also come up a little short, but it keeps the repeat
+    // padding so its basecalls don't change, and would fill most of a slot anyway.
+    const bool whole_read = chunk->idx_in_read == 0;
+    if (m_pack_chunks && whole_read && slice_size < chunk_size) {
+        // Short read: place it after the chunks already in the open packed slot if there's
+        // room, so it doesn't occupy (and get padded to) a whole slot.
+        auto &packed_slot = *m_packed_slots[worker_id];
+        const size_t packed_size = utils::pad_to(slice_size, m_model_stride);
+        size_t packed_offset = packed_slot.fill + m_packing_gap;
+        if (packed_slot.slot_idx >= 0 && packed_offset + packed_size > chunk_size) {
+            close_packed_slot(worker_id);
+        }
+        if (packed_slot.slot_idx < 0) {
+            if (m_batch_num_slots[worker_id] == batch_size) {
+                basecall_current_batch(worker_id);
+            }
+            packed_slot.slot_idx = m_batch_num_slots[worker_id]++;
+            packed_slot.input = at::zeros({input_slice.size(0), static_cast<int64_t>(chunk_size)},
+                                          input_slice.options());
+            packed_offset = 0;
+        }
+        packed_slot.input.index({Ellipsis, Slice(packed_offset, packed_offset + slice_size)})
+                .copy_(input_slice);
+        packed_slot.fill = packed_offset + packed_size;
+
+        chunk->batch_slot = packed_slot.slot_idx;
+        chunk->packed_offset = packed_offset;
+        chunk->packed_size = packed_size;
+        m_batched_chunks[worker_id].push_back(std::move(chunk));
+        ++m_num_packed_chunks;
+        return;
+    }
+
+    // repeat-pad any non-full chunks
+    if (slice_size != chunk_size) {
+        auto [n, overhang] = std::div((int)chunk_size, (int)slice_size);
+        input_slice = at::concat({input_slice.repeat({1, n}),
+                                  input_slice.index({Ellipsis, Slice(0, overhang)})},
+                                 1);
+    }
+
+    if (m_batch_num_slots[worker_id] == batch_size) {
+        // Only possible if the last slot is a packed slot with space left.
+        basecall_current_batch(worker_id);
+    }
+
+    // Insert the chunk in the input tensor
+    chunk->batch_slot = m_batch_num_slots[worker_id]++;
+    model_runner->accept_chunk(chunk->batch_slot, input_slice);
+    m_batched_chunks[worker_id].push_back(std::move(chunk));
+}
+
+void BasecallerNode::close_packed_slot(int worker_id) {
+    auto &packed_slot = *m_packed_slots[worker_id];
+    if (packed_slot.slot_idx < 0) {
+        return;
+    }
+    m_model_runners[worker_id]->accept_chunk(packed_slot.slot_idx, packed_slot.input);
+    packed_slot.input = at::Tensor();
+    packed_slot.slot_idx = -1;
+    packed_slot.fill = 0;
+}
+
+bool BasecallerNode::is_batch_full(int worker_id) const {
+    const auto &model_runner = m_model_runners[worker_id];
+    if (m_batch_num_slots[worker_id] < static_cast<int>(model_runner->batch_size())) {
+        return false;
+    }
+    // An open packed slot can still take more short chunks unless it's out of space.
+    const auto &packed_slot = *m_packed_slots[worker_id];
+    return packed_slot.slot_idx < 0 ||
+           packed_slot.fill + m_packing_gap + m_model_stride > model_runner->chunk_size();
 }
 
 void BasecallerNode::working_reads_manager() {
@@ -171,23 +317,33 @@ void BasecallerNode::working_reads_manager() {
         nvtx3::scoped_range loop{"working_reads_manager"};
 
         auto working_read = chunk->owning_read;
-        auto idx_in_read = chunk->idx_in_read;
-        working_read->called_chunks[idx_in_read] = std::move(chunk);
-        auto num_chunks_called = ++working_read->num_chunks_called;
-        if (num_chunks_called == working_read->called_chunks.size()) {
+        bool all_chunks_called = false;
+        {
+            std::lock_guard stitch_lock(working_read->stitch_mutex);
+            auto &stitcher = *working_read->stitcher;
+            const auto pending_bytes_before = int64_t(stitcher.pending_bytes());
+            all_chunks_called = stitcher.add_chunk(chunk->idx_in_read, *chunk);
+            m_working_reads_pending_chunk_bytes +=
+                    int64_t(stitcher.pending_bytes()) - pending_bytes_before;
+        }
+        // The stitcher has taken the called results, so release the rest of the chunk now.
+        chunk.reset();
+
+        if (all_chunks_called) {
             // Finalise the read.
             auto source_read = std::move(working_read->read);
 
             ReadCommon &read_common_data = get_read_common_data(source_read);
 
-            // model_stride is needed by the basecall server and stitch_chunks.
+            // model_stride is needed by the basecall server and the stitcher.
             read_common_data.model_stride = m_model_runners[0]->config().stride;
 
             // qbias/qscale are expected by the basecall server.
             read_common_data.model_q_bias = m_model_runners[0]->config().qbias;
             read_common_data.model_q_scale = m_model_runners[0]->config().qscale;
 
-            utils::stitch_chunks(read_common_data, working_read->called_chunks);
+            working_read->stitcher->finalise(read_common_data);
+            working_read->stitcher.reset();
             read_common_data.model_name = m_model_name;
             read_common_data.mean_qscore_start_pos = m_mean_qscore_start_pos;
             read_common_data.pre_trim_seq_length = read_common_data.seq.length();
@@ -203,9 +359,6 @@ void BasecallerNode::working_reads_manager() {
             m_num_bases_processed += read_common_data.seq.length();
             m_num_samples_processed += read_common_data.get_raw_data_samples();
 
-            // Chunks have ownership of the working read, so destroy them to avoid a leak.
-            working_read->called_chunks.clear();
-
             // Do not trim R9.4.1 data to avoid changes to legacy products
             // Check here to avoid adding models lib as a dependency of utils
             if (read_common_data.chemistry != models::Chemistry::DNA_R9_4_1_E8) {
@@ -242,8 +395,6 @@ void BasecallerNode::basecall_worker_thread(int worker_id) {
     at::InferenceMode inference_mode_guard;
 
     auto last_chunk_reserve_time = std::chrono::system_clock::now();
-    const size_t batch_size = m_model_runners[worker_id]->batch_size();
-    const size_t chunk_size = m_model_runners[worker_id]->chunk_size();
     const int batch_timeout_ms = m_model_runners[worker_id]->batch_timeout_ms();
     const int chunk_queue_idx = worker_id % int(m_chunk_in_queues.size());
     while (true) {
@@ -264,45 +415,20 @@ void BasecallerNode::basecall_worker_thread(int worker_id) {
                 // get scores for whatever chunks are available.
                 basecall_current_batch(worker_id);
             }
+            // No more chunks are coming for now, so don't hold back batches already called.
+            while (!m_batches_in_flight[worker_id].empty()) {
+                collect_called_batch(worker_id);
+            }
 
             last_chunk_reserve_time = std::chrono::system_clock::now();
             continue;
         }
 
         // There's chunks to get_scores, so let's add them to our input tensor
-        // FIXME -- it should not be possible to for this condition to be untrue.
-        if (m_batched_chunks[worker_id].size() != batch_size) {
-            // Copy the chunk into the input tensor
-            auto &source_read = chunk->owning_read->read;
-
-            auto &read_common = get_read_common_data(source_read);
-            auto input_slice = read_common.raw_data.index(
-                    {Ellipsis, Slice(chunk->input_offset, chunk->input_offset + chunk_size)});
-
-            // Make sure the slice tensor is 2D
-            if (input_slice.ndimension() == 1) {
-                input_slice = input_slice.unsqueeze(0);
-            }
-            size_t slice_size = input_slice.size(1);
-
-            // repeat-pad any non-full chunks
-            if (slice_size != chunk_size) {
-                auto [n, overhang] = std::div((int)chunk_size, (int)slice_size);
-                input_slice = at::concat({input_slice.repeat({1, n}),
-                                          input_slice.index({Ellipsis, Slice(0, overhang)})},
-                                         1);
-            }
-
-            // Insert the chunk in the input tensor
-            m_model_runners[worker_id]->accept_chunk(
-                    static_cast<int>(m_batched_chunks[worker_id].size()), input_slice);
-
-            m_batched_chunks[worker_id].push_back(std::move(chunk));
-
-            last_chunk_reserve_time = std::chrono::system_clock::now();
-        }
+        add_chunk_to_batch(worker_id, std::move(chunk));
+        last_chunk_reserve_time = std::chrono::system_clock::now();
 
-        if (m_batched_chunks[worker_id].size() == batch_size) {
+        if (is_batch_full(worker_id)) {
             // Input tensor is full, let's get_scores.
             basecall_current_batch(worker_id);
         }
@@ -311,6 +437,9 @@ void BasecallerNode::basecall_worker_thread(int worker_id) {
     if (!m_batched_chunks[worker_id].empty()) {
         basecall_current_batch(worker_id);
     }
+    while (!m_batches_in_flight[worker_id].empty()) {
+        collect_called_batch(worker_id);
+    }
 
     // Reduce the count of active runner threads.  If this was the last active
     // thread also send termination signal to sink
@@ -358,6 +487,21 @@ BasecallerNode::BasecallerNode(std::vector<basecall::RunnerPtr> model_runners,
     // Setup worker state
     const size_t num_workers = m_model_runners.size();
     m_batched_chunks.resize(num_workers);
+    m_batches_in_flight.resize(num_workers);
+    m_batch_num_slots.resize(num_workers, 0);
+    for (size_t i = 0; i < num_workers; ++i) {
+        m_packed_slots.push_back(std::make_unique<PackedSlot>());
+    }
+
+    // Packing relies on the model input being a plain signal, so isn't used for duplex.
+    m_pack_chunks = utils::get_dev_opt<bool>("pack_chunks", false) &&
+                    !basecall::is_duplex_model(m_model_runners.front()->config());
+    m_packing_gap = utils::pad_to(
+            static_cast<size_t>(utils::get_dev_opt<int>("pack_chunks_gap", int(m_overlap))),
+            m_model_stride);
+    if (m_pack_chunks) {
+        spdlog::debug("BasecallerNode packing short chunks, gap {} samples", m_packing_gap);
+    }
 
     for (auto &runner_ptr : m_model_runners) {
         // m_model_runners is effectively a 3D array with dimensions
@@ -441,9 +585,19 @@ stats::NamedStats BasecallerNode::sample_stats() const {
     stats["called_reads_pushed"] = double(m_called_reads_pushed);
     stats["working_reads_items"] = double(m_working_reads_size);
     stats["working_reads_signal_mb"] = double(m_working_reads_signal_bytes) / double((1024 * 1024));
+    stats["working_reads_pending_chunks_mb"] =
+            double(m_working_reads_pending_chunk_bytes) / double((1024 * 1024));
     stats["bases_processed"] = double(m_num_bases_processed);
     stats["samples_processed"] = double(m_num_samples_processed);
     stats["samples_incl_padding"] = double(m_num_samples_incl_padding);
+    stats["samples_in_chunks"] = double(m_num_samples_in_chunks);
+    stats["packed_chunks"] = double(m_num_packed_chunks);
+    if (m_num_samples_incl_padding > 0) {
+        // Fraction of model input that wasn't read signal, i.e. padding and empty batch slots.
+        const double signal_fraction =
+                double(m_num_samples_in_chunks) / double(m_num_samples_incl_padding);
+        stats["padding_fraction"] = std::max(0.0, 1.0 - signal_fraction);
+    }
     return stats;
 }
 
@@ -7,6 +7,7 @@
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -19,11 +20,15 @@ namespace dorado {
 namespace basecall {
 class ModelRunnerBase;
 using RunnerPtr = std::unique_ptr<ModelRunnerBase>;
+namespace decode {
+struct DecodedChunk;
+}
 }  // namespace basecall
 
 class BasecallerNode : public MessageSink {
     struct BasecallingRead;
     struct BasecallingChunk;
+    struct PackedSlot;
 
 public:
     // Chunk size and overlap are in raw samples
@@ -48,6 +53,18 @@ private:
     void basecall_worker_thread(int worker_id);
     // Basecall batch of chunks
     void basecall_current_batch(int worker_id);
+    // Waits for the worker's oldest batch in flight, for runners which pipeline batches.
+    void collect_called_batch(int worker_id);
+    // Hands the decoded results to their chunks, and passes the chunks on for stitching.
+    void complete_batch(std::vector<std::unique_ptr<BasecallingChunk>> &chunks,
+                        std::vector<basecall::decode::DecodedChunk> &decode_results);
+    // Copy a chunk into the next slot of the worker's batch, or pack it into a slot shared
+    // with other short chunks.
+    void add_chunk_to_batch(int worker_id, std::unique_ptr<BasecallingChunk> chunk);
+    // Hands the worker's partially filled packed slot, if any, to its model runner.
+    void close_packed_slot(int worker_id);
+    // Returns true if the worker's batch has no room for further chunks.
+    bool is_batch_full(int worker_id) const;
     // Construct complete reads
     void working_reads_manager();
 
@@ -85,6 +102,19 @@ private:
 
     // If we go multi-threaded, there will be one of these batches per thread
     std::vector<std::vector<std::unique_ptr<BasecallingChunk>>> m_batched_chunks;
+    // Number of model input slots used by each worker's batch.  With chunk packing several
+    // chunks can share a slot, so this can be less than the number of batched chunks.
+    std::vector<int> m_batch_num_slots;
+    // Batches each worker has submitted to a pipelining runner, oldest first.
+    std::vector<std::deque<std::vector<std::unique_ptr<BasecallingChunk>>>> m_batches_in_flight;
+
+    // Chunk packing: short reads which only need part of a model chunk are concatenated into a
+    // single model chunk, separated by m_packing_gap samples of zeros, rather than each being
+    // repeat-padded to a full chunk.  Decoded slots are split back into per-read chunks before
+    // stitching.  Enabled with the "pack_chunks" dev option, simplex only.
+    bool m_pack_chunks = false;
+    size_t m_packing_gap = 0;
+    std::vector<std::unique_ptr<PackedSlot>> m_packed_slots;
 
     utils::AsyncQueue<std::unique_ptr<BasecallingChunk>> m_processed_chunks;
 
@@ -107,7 +137,11 @@ private:
     std::atomic<int64_t> m_num_bases_processed = 0;
     std::atomic<int64_t> m_num_samples_processed = 0;
     std::atomic<int64_t> m_num_samples_incl_padding = 0;
+    std::atomic<int64_t> m_num_samples_in_chunks = 0;
+    std::atomic<int64_t> m_num_packed_chunks = 0;
     std::atomic<int64_t> m_working_reads_signal_bytes = 0;
+    // Called chunk results held by working reads until their preceding chunks are called.
+    std::atomic<int64_t> m_working_reads_pending_chunk_bytes = 0;
 };
 
 }  // namespace dorado
@@ -2,22 +2,39 @@
 
 #include "read_pipeline/DefaultClientInfo.h"
 #include "read_pipeline/ReadPipeline.h"
+#include "read_pipeline/ReadPool.h"
+#include "utils/AsyncQueue.h"
+#include "utils/PostCondition.h"
 #include "utils/types.h"
 
 #include <htslib/sam.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <exception>
 #include <filesystem>
+#include <mutex>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
+namespace {
+
+// Records are decoded and sent to the pipeline in batches of this many, and this many batches are
+// decoded ahead. Batches are small enough to spread across a node's threads.
+constexpr size_t RECORDS_PER_BATCH = 100;
+constexpr size_t PREFETCH_BATCHES = 40;
+
+}  // namespace
+
 namespace dorado {
 
-HtsReader::HtsReader(const std::string& filename,
-                     std::optional<std::unordered_set<std::string>> read_list)
+HtsReader::HtsReader(const std::string& filename, std::optional<utils::ReadIdSet> read_list)
         : m_client_info(std::make_shared<DefaultClientInfo>()), m_read_list(std::move(read_list)) {
     m_file = hts_open(filename.c_str(), "r");
     if (!m_file) {
@@ -41,6 +58,17 @@ HtsReader::~HtsReader() {
     hts_close(m_file);
 }
 
+void HtsReader::enable_threads(int threads) {
+    if (threads <= 0) {
+        return;
+    }
+    if (hts_set_threads(m_file, threads) < 0) {
+        throw std::runtime_error("Could not enable multi threading for reading " +
+                                 std::string(m_file->fn));
+    }
+    m_prefetch = true;
+}
+
 void HtsReader::set_client_info(std::shared_ptr<ClientInfo> client_info) {
     m_client_info = std::move(client_info);
 }
@@ -56,21 +84,33 @@ bool HtsReader::has_tag(const char* tagname) {
     return static_cast<bool>(tag);
 }
 
+bool HtsReader::is_in_read_list(const bam1_t* rec) const {
+    if (!m_read_list) {
+        return true;
+    }
+    // The qname is stored NUL padded, so its length is known without scanning it.
+    const auto qname_length = size_t(rec->core.l_qname - rec->core.l_extranul - 1);
+    return m_read_list->contains(std::string_view(bam_get_qname(rec), qname_length));
+}
+
+void HtsReader::push_record(Pipeline& pipeline, BamPtr rec) {
+    if (m_record_mutator) {
+        m_record_mutator(rec);
+    }
+    pipeline.push_message(BamMessage{std::move(rec), m_client_info});
+}
+
 std::size_t HtsReader::read(Pipeline& pipeline, std::size_t max_reads) {
+    if (m_prefetch) {
+        return read_prefetched(pipeline, max_reads);
+    }
+
     std::size_t num_reads = 0;
     while (this->read()) {
-        if (m_read_list) {
-            std::string read_id = bam_get_qname(record.get());
-            if (m_read_list->find(read_id) == m_read_list->end()) {
-                continue;
-            }
-        }
-        if (m_record_mutator) {
-            m_record_mutator(record);
+        if (!is_in_read_list(record.get())) {
+            continue;
         }
-
-        BamMessage bam_message{BamPtr(bam_dup1(record.get())), m_client_info};
-        pipeline.push_message(std::move(bam_message));
+        push_record(pipeline, BamPtr(bam_dup1(record.get())));
         ++num_reads;
         if (max_reads > 0 && num_reads >= max_reads) {
             break;
@@ -83,6 +123,93 @@ std::size_t HtsReader::read(Pipeline& pipeline, std::size_t max_reads) {
     return num_reads;
 }
 
+// Records are decoded straight into the bam1_t which is sent on, so there's no copy. Batch
+// vectors are handed back once emptied, and so is the record of any read not in the read list.
+std::size_t HtsReader::read_prefetched(Pipeline& pipeline, std::size_t max_reads) {
+    using Batch = std::vector<BamPtr>;
+    utils::AsyncQueue<Batch> decoded_batches(PREFETCH_BATCHES);
+    std::mutex free_batches_mutex;
+    std::vector<Batch> free_batches;
+
+    std::exception_ptr decode_error;
+    std::thread decode_thread([&] {
+        try {
+            BamPtr spare_record;
+            bool at_end = false;
+            while (!at_end) {
+                Batch batch;
+                {
+                    std::lock_guard lock(free_batches_mutex);
+                    if (!free_batches.empty()) {
+                        batch = std::move(free_batches.back());
+                        free_batches.pop_back();
+                    }
+                }
+                batch.reserve(RECORDS_PER_BATCH);
+                while (batch.size() < RECORDS_PER_BATCH) {
+                    if (!spare_record) {
+                        spare_record.reset(bam_init1());
+                    }
+                    if (sam_read1(m_file, header, spare_record.get()) < 0) {
+                        at_end = true;
+                        break;
+                    }
+                    if (is_in_read_list(spare_record.get())) {
+                        batch.push_back(std::move(spare_record));
+                    }
+                }
+                if (!batch.empty() && decoded_batches.try_push(std::move(batch)) !=
+                                              utils::AsyncQueueStatus::Success) {
+                    // The reader has stopped early.
+                    break;
+                }
+            }
+        } catch (...) {
+            decode_error = std::current_exception();
+        }
+        decoded_batches.terminate();
+    });
+
+    std::size_t num_reads = 0;
+    {
+        // Also stops the decoding thread if pushing to the pipeline throws.
+        auto stop_decoding = utils::PostCondition([&] {
+            decoded_batches.terminate();
+            decode_thread.join();
+        });
+        Batch batch;
+        while ((max_reads == 0 || num_reads < max_reads) &&
+               decoded_batches.try_pop(batch) == utils::AsyncQueueStatus::Success) {
+            if (max_reads > 0) {
+                batch.resize(std::min(batch.size(), max_reads - num_reads));
+            }
+            BamBatch bam_batch;
+            bam_batch.messages.reserve(batch.size());
+            for (auto& rec : batch) {
+                if (m_record_mutator) {
+                    m_record_mutator(rec);
+                }
+                bam_batch.messages.push_back(BamMessage{std::move(rec), m_client_info});
+            }
+            pipeline.push_message(std::move(bam_batch));
+
+            const auto prev_num_reads = std::exchange(num_reads, num_reads + batch.size());
+            if (num_reads / 50000 != prev_num_reads / 50000) {
+                spdlog::debug("Processed {} reads", num_reads);
+            }
+            batch.clear();
+            std::lock_guard lock(free_batches_mutex);
+            free_batches.push_back(std::move(batch));
+        }
+    }
+    if (decode_error) {
+        std::rethrow_exception(decode_error);
+    }
+
+    spdlog::debug("Total reads processed: {}", num_reads);
+    return num_reads;
+}
+
 ReadMap read_bam(const std::string& filename, const std::unordered_set<std::string>& read_ids) {
     HtsReader reader(filename, std::nullopt);
 
@@ -108,7 +235,7 @@ ReadMap read_bam(const std::string& filename, const std::unordered_set<std::stri
             nucleotides[i] = seq_nt16_str[bam_seqi(sequence, i)];
         }
 
-        auto tmp_read = std::make_unique<SimplexRead>();
+        auto tmp_read = ReadPool::instance().acquire();
         tmp_read->read_common.read_id = read_id;
         tmp_read->read_common.seq = std::string(nucleotides.begin(), nucleotides.end());
         tmp_read->read_common.qstring = std::string(qualities.begin(), qualities.end());
@@ -118,7 +245,7 @@ ReadMap read_bam(const std::string& filename, const std::unordered_set<std::stri
     return reads;
 }
 
-std::unordered_set<std::string> fetch_read_ids(const std::string& filename) {
+utils::ReadIdSet fetch_read_ids(const std::string& filename) {
     if (filename.empty()) {
         return {};
     }
@@ -129,12 +256,11 @@ std::unordered_set<std::string> fetch_read_ids(const std::string& filename) {
     auto initial_hts_log_level = hts_get_log_level();
     hts_set_log_level(HTS_LOG_OFF);
 
-    std::unordered_set<std::string> read_ids;
+    utils::ReadIdSet read_ids;
     HtsReader reader(filename, std::nullopt);
     try {
         while (reader.read()) {
-            std::string read_id = bam_get_qname(reader.record);
-            read_ids.insert(read_id);
+            read_ids.insert(bam_get_qname(reader.record));
         }
     } catch (std::exception&) {
         // Do nothing.
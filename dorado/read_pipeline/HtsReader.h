@@ -2,6 +2,7 @@
 
 #include "read_pipeline/ClientInfo.h"
 #include "read_pipeline/ReadPipeline.h"
+#include "utils/read_id_set.h"
 #include "utils/stats.h"
 #include "utils/types.h"
 
@@ -22,13 +23,18 @@ class Pipeline;
 
 class HtsReader {
 public:
-    HtsReader(const std::string& filename,
-              std::optional<std::unordered_set<std::string>> read_list);
+    HtsReader(const std::string& filename, std::optional<utils::ReadIdSet> read_list);
     ~HtsReader();
     bool read();
 
+    // Decompresses BGZF input on a pool of |threads|, for either way of reading. Also has
+    // read(Pipeline&, ...) decode records on a background thread, ahead of the pipeline, and
+    // send them on as BamBatch messages. Call before reading any records.
+    void enable_threads(int threads);
+
     // If reading directly into a pipeline need to set the client info on the messages
     void set_client_info(std::shared_ptr<ClientInfo> client_info);
+    // Pushes the records in the read list, if one was given, into |pipeline|.
     std::size_t read(Pipeline& pipeline, std::size_t max_reads);
     template <typename T>
     T get_tag(const char* tagname);
@@ -41,11 +47,16 @@ public:
     sam_hdr_t* header{nullptr};
 
 private:
+    bool is_in_read_list(const bam1_t* rec) const;
+    void push_record(Pipeline& pipeline, BamPtr rec);
+    std::size_t read_prefetched(Pipeline& pipeline, std::size_t max_reads);
+
     htsFile* m_file{nullptr};
+    bool m_prefetch{false};
     std::shared_ptr<ClientInfo> m_client_info;
 
     std::function<void(BamPtr&)> m_record_mutator{};
-    std::optional<std::unordered_set<std::string>> m_read_list;
+    std::optional<utils::ReadIdSet> m_read_list;
 };
 
 template <typename T>
@@ -94,6 +105,6 @@ ReadMap read_bam(const std::string& filename, const std::unordered_set<std::stri
  * @param filename The path to the input HTS file.
  * @return An unordered set with read ids.
  */
-std::unordered_set<std::string> fetch_read_ids(const std::string& filename);
+utils::ReadIdSet fetch_read_ids(const std::string& filename);
 
 }  // namespace dorado
@@ -22,6 +22,7 @@ HtsWriter::HtsWriter(utils::HtsFile& file, std::string gpu_names)
     if (!m_gpu_names.empty()) {
         m_gpu_names = "gpu:" + m_gpu_names;
     }
+    enable_batch_input();
     start_input_processing(&HtsWriter::input_thread_fn, this);
 }
 
@@ -41,59 +42,71 @@ OutputMode HtsWriter::get_output_mode(const std::string& mode) {
 void HtsWriter::input_thread_fn() {
     Message message;
     while (get_input_message(message)) {
-        if (!std::holds_alternative<BamMessage>(message)) {
-            continue;
-        }
-
-        auto bam_message = std::move(std::get<BamMessage>(message));
-        BamPtr aln = std::move(bam_message.bam_ptr);
-
-        if (m_file.get_output_mode() == utils::HtsFile::OutputMode::FASTQ) {
-            if (!m_gpu_names.empty()) {
-                bam_aux_append(aln.get(), "DS", 'Z', int(m_gpu_names.length() + 1),
-                               (uint8_t*)m_gpu_names.c_str());
+        if (std::holds_alternative<BamMessage>(message)) {
+            write_message(std::get<BamMessage>(message));
+        } else if (std::holds_alternative<BamBatch>(message)) {
+            for (auto& bam_message : std::get<BamBatch>(message).messages) {
+                write_message(bam_message);
             }
         }
+    }
+}
 
-        auto res = write(aln.get());
-        if (res < 0) {
-            throw std::runtime_error("Failed to write SAM record, error code " +
-                                     std::to_string(res));
-        }
+void HtsWriter::write_message(BamMessage& bam_message) {
+    BamPtr aln = std::move(bam_message.bam_ptr);
 
-        // For the purpose of estimating write count, we ignore duplex reads
-        int64_t dx_tag = 0;
-        auto tag_str = bam_aux_get(aln.get(), "dx");
-        if (tag_str) {
-            dx_tag = bam_aux2i(tag_str);
+    if (m_file.get_output_mode() == utils::HtsFile::OutputMode::FASTQ) {
+        if (!m_gpu_names.empty()) {
+            bam_aux_append(aln.get(), "DS", 'Z', int(m_gpu_names.length() + 1),
+                           (uint8_t*)m_gpu_names.c_str());
         }
+    }
 
-        bool ignore_read_id = dx_tag == 1;
+    auto res = write(aln.get());
+    if (res < 0) {
+        throw std::runtime_error("Failed to write SAM record, error code " + std::to_string(res));
+    }
+    track_read_id(aln.get());
+    record_trace_written(bam_message.trace);
+}
 
-        if (ignore_read_id) {
-            // Read is a duplex read.
-            m_duplex_reads_written++;
-        } else {
-            std::string read_id;
-
-            // If read is a split read, use the parent read id
-            // to track write count since we don't know a priori
-            // how many split reads will be generated.
-            auto pid_tag = bam_aux_get(aln.get(), "pi");
-            if (pid_tag) {
-                read_id = std::string(bam_aux2Z(pid_tag));
-                m_split_reads_written++;
-            } else {
-                read_id = bam_get_qname(aln.get());
-            }
+void HtsWriter::track_read_id(const bam1_t* record) {
+    // For the purpose of estimating write count, we ignore duplex reads
+    int64_t dx_tag = 0;
+    auto tag_str = bam_aux_get(record, "dx");
+    if (tag_str) {
+        dx_tag = bam_aux2i(tag_str);
+    }
 
-            m_processed_read_ids.add(std::move(read_id));
+    bool ignore_read_id = dx_tag == 1;
+
+    if (ignore_read_id) {
+        // Read is a duplex read.
+        m_duplex_reads_written++;
+    } else {
+        std::string_view read_id;
+
+        // If read is a split read, use the parent read id
+        // to track write count since we don't know a priori
+        // how many split reads will be generated.
+        auto pid_tag = bam_aux_get(record, "pi");
+        if (pid_tag) {
+            read_id = bam_aux2Z(pid_tag);
+            m_split_reads_written++;
+        } else {
+            read_id = bam_get_qname(record);
         }
+
+        m_processed_read_ids.add(read_id);
     }
 }
 
-int HtsWriter::write(const bam1_t* const record) {
-    // track stats
+void HtsWriter::count_copied_record(const bam1_t* record) {
+    count_record(record);
+    track_read_id(record);
+}
+
+void HtsWriter::count_record(const bam1_t* record) {
     m_total++;
     if (record->core.flag & BAM_FUNMAP) {
         m_unmapped++;
@@ -105,6 +118,11 @@ int HtsWriter::write(const bam1_t* const record) {
         m_supplementary++;
     }
     m_primary = m_total - m_secondary - m_supplementary - m_unmapped;
+}
+
+int HtsWriter::write(const bam1_t* const record) {
+    // track stats
+    count_record(record);
 
     // Verify that the MN tag, if it exists, and the sequence length are in sync.
     if (auto tag = bam_aux_get(record, "MN"); tag != nullptr) {
@@ -119,6 +137,8 @@ int HtsWriter::write(const bam1_t* const record) {
 stats::NamedStats HtsWriter::sample_stats() const {
     auto stats = stats::from_obj(m_work_queue);
     stats["unique_simplex_reads_written"] = static_cast<double>(m_processed_read_ids.size());
+    stats["processed_read_ids_mb"] =
+            static_cast<double>(m_processed_read_ids.memory_bytes()) / (1024.0 * 1024.0);
     stats["duplex_reads_written"] = static_cast<double>(m_duplex_reads_written.load());
     stats["split_reads_written"] = static_cast<double>(m_split_reads_written.load());
     return stats;
@@ -128,9 +148,12 @@ void HtsWriter::terminate(const FlushOptions&) { stop_input_processing(); }
 
 std::size_t HtsWriter::ProcessedReadIds::size() const { return m_threadsafe_count_of_reads; }
 
-void HtsWriter::ProcessedReadIds::add(std::string read_id) {
-    read_ids.insert(std::move(read_id));
+std::size_t HtsWriter::ProcessedReadIds::memory_bytes() const { return m_threadsafe_memory_bytes; }
+
+void HtsWriter::ProcessedReadIds::add(std::string_view read_id) {
+    read_ids.insert(read_id);
     m_threadsafe_count_of_reads = read_ids.size();
+    m_threadsafe_memory_bytes = read_ids.memory_bytes();
 }
 
 }  // namespace dorado
@@ -1,6 +1,7 @@
 #pragma once
 #include "read_pipeline/ReadPipeline.h"
 #include "utils/hts_file.h"
+#include "utils/read_id_set.h"
 #include "utils/stats.h"
 
 #include <atomic>
@@ -8,8 +9,8 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <thread>
-#include <unordered_set>
 
 struct bam1_t;
 
@@ -25,6 +26,9 @@ public:
     void restart() override { start_input_processing(&HtsWriter::input_thread_fn, this); }
 
     int write(const bam1_t* record);
+    // Accounts for a record which was copied into the file without going through write().
+    void count_copied_record(const bam1_t* record);
+    utils::HtsFile& get_file() { return m_file; }
     size_t get_total() const { return m_total; }
     size_t get_primary() const { return m_primary; }
     size_t get_unmapped() const { return m_unmapped; }
@@ -43,6 +47,9 @@ private:
     std::string m_gpu_names{};
 
     void input_thread_fn();
+    void write_message(BamMessage& bam_message);
+    void count_record(const bam1_t* record);
+    void track_read_id(const bam1_t* record);
     std::atomic<int> m_duplex_reads_written{0};
     std::atomic<int> m_split_reads_written{0};
 
@@ -50,15 +57,18 @@ private:
     //  single writer thread calling add()
     //  many threads may concurrently call size().
     class ProcessedReadIds {
-        std::unordered_set<std::string> read_ids;
+        utils::ReadIdSet read_ids;
         std::atomic<std::size_t> m_threadsafe_count_of_reads{};
+        std::atomic<std::size_t> m_threadsafe_memory_bytes{};
 
     public:
         // Thread safe access to count of unique read-ids
         std::size_t size() const;
+        // Thread safe access to the memory used to track the read-ids
+        std::size_t memory_bytes() const;
 
         // Not thread safe for concurrent calls.
-        void add(std::string read_id);
+        void add(std::string_view read_id);
     } m_processed_read_ids;
 };
 
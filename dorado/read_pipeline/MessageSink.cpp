@@ -8,10 +8,15 @@ MessageSink::MessageSink(size_t max_messages, int num_input_threads)
         : m_work_queue(max_messages), m_num_input_threads(num_input_threads) {}
 
 void MessageSink::push_message_internal(Message &&message) {
+    if (ReadTracer::is_enabled()) {
+        ReadTracer::instance().record(message, trace_node_id(), ReadTrace::Event::QUEUED);
+    }
 #ifndef NDEBUG
     const auto status =
 #endif
-            m_work_queue.try_push(std::move(message));
+            (is_batch_message(message) && !m_accepts_batches)
+                    ? m_work_queue.try_push_all(split_batch_message(std::move(message)))
+                    : m_work_queue.try_push(std::move(message));
     // try_push will fail if the sink has been told to terminate.
     // We do not expect to be pushing reads from this source if that is the case.
     assert(status == utils::AsyncQueueStatus::Success);
@@ -19,6 +24,15 @@ void MessageSink::push_message_internal(Message &&message) {
 
 void MessageSink::add_sink(MessageSink &sink) { m_sinks.push_back(std::ref(sink)); }
 
+uint16_t MessageSink::trace_node_id() {
+    int node_id = m_trace_node_id.load(std::memory_order_relaxed);
+    if (node_id < 0) {
+        node_id = ReadTracer::instance().node_id(get_name());
+        m_trace_node_id.store(node_id, std::memory_order_relaxed);
+    }
+    return uint16_t(node_id);
+}
+
 // Mark the input queue as terminating, and stop input processing threads.
 void MessageSink::stop_input_processing() {
     terminate_input_queue();
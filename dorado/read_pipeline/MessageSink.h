@@ -1,5 +1,6 @@
 #pragma once
 
+#include "read_pipeline/ReadTracer.h"
 #include "read_pipeline/flush_options.h"
 #include "read_pipeline/messages.h"
 #include "utils/AsyncQueue.h"
@@ -56,6 +57,10 @@ protected:
     // Allows inputs again.
     void start_input_queue() { m_work_queue.restart(); }
 
+    // Has BamBatch messages queued as they are, for nodes which handle them.
+    // Otherwise their contents are queued as separate messages.
+    void enable_batch_input() { m_accepts_batches = true; }
+
     // Sends message to the designated sink.
     template <typename Msg>
     void send_message_to_sink(int sink_index, Msg&& message) {
@@ -75,7 +80,20 @@ protected:
     // If terminating, returns false.
     bool get_input_message(Message& message) {
         auto status = m_work_queue.try_pop(message);
-        return status == utils::AsyncQueueStatus::Success;
+        if (status != utils::AsyncQueueStatus::Success) {
+            return false;
+        }
+        if (ReadTracer::is_enabled()) {
+            ReadTracer::instance().record(message, trace_node_id(), ReadTrace::Event::STARTED);
+        }
+        return true;
+    }
+
+    // Stamps the trace of a sampled read whose records this node has written out.
+    void record_trace_written(const std::shared_ptr<ReadTrace>& trace) {
+        if (trace) {
+            ReadTracer::instance().record(*trace, trace_node_id(), ReadTrace::Event::WRITTEN);
+        }
     }
 
     // Queue of work items for this node.
@@ -119,6 +137,12 @@ private:
 
     void push_message_internal(Message&& message);
 
+    bool m_accepts_batches{false};
+
+    // This node's id in read traces, looked up by name the first time it's needed.
+    uint16_t trace_node_id();
+    std::atomic<int> m_trace_node_id{-1};
+
     // Input processing threads.
     const int m_num_input_threads;
     std::vector<std::thread> m_input_threads;
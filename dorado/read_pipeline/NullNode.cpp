@@ -1,11 +1,14 @@
 #include "NullNode.h"
 
+#include "read_pipeline/ReadPool.h"
+
 namespace dorado {
 
 void NullNode::input_thread_fn() {
     Message message;
     while (get_input_message(message)) {
-        // Do nothing with the popped message.
+        // Do nothing with the popped message, other than handing reads back for reuse.
+        ReadPool::instance().release(std::move(message));
     }
 }
 
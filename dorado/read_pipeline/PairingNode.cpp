@@ -1,6 +1,8 @@
 #include "PairingNode.h"
 
 #include "ClientInfo.h"
+#include "basecall/CRFModelConfig.h"
+#include "utils/dev_utils.h"
 #include "utils/sequence_utils.h"
 
 #include <minimap.h>
@@ -8,6 +10,7 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <limits>
 
@@ -18,7 +21,24 @@ const int kMinSeqLength = 500;
 const float kMinSimplexQScore = 8.f;
 
 size_t read_signal_bytes(const dorado::SimplexRead& read) {
-    return read.read_common.raw_data.nbytes();
+    return read.read_common.get_raw_data_bytes();
+}
+
+// The shift and scale ScalerNode normalised the signal with, which map it back to the int16
+// samples it came from. Scaling other than pA has them stored converted to pA.
+std::pair<float, float> signal_normalisation(const dorado::SimplexRead& read) {
+    const auto& read_common = read.read_common;
+    if (read_common.scaling_method == to_string(dorado::basecall::ScalingStrategy::PA) ||
+        read.scaling == 0) {
+        return {read_common.shift, read_common.scale};
+    }
+    return {read_common.shift / read.scaling - read.offset, read_common.scale / read.scaling};
+}
+
+int64_t elapsed_us(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                 start)
+            .count();
 }
 
 // There are 4 different cases to consider when checking for adjacent reads -
@@ -161,6 +181,42 @@ PairingNode::PairingResult PairingNode::is_within_alignment_criteria(
     return pair_result;
 }
 
+void PairingNode::compress_signal(SimplexRead& read) {
+    if (!m_compress_cached_signal) {
+        return;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const size_t uncompressed_bytes = read.read_common.raw_data.nbytes();
+    const auto [shift, scale] = signal_normalisation(read);
+    read.read_common.compress_raw_data(shift, scale);
+    if (read.read_common.compressed_raw_data) {
+        m_signal_compression_us += elapsed_us(start);
+        m_signal_bytes_before_compression += uncompressed_bytes;
+        m_signal_bytes_after_compression += read.read_common.get_raw_data_bytes();
+    }
+}
+
+void PairingNode::decompress_signal(SimplexRead& read) {
+    if (read.read_common.compressed_raw_data) {
+        const auto start = std::chrono::steady_clock::now();
+        read.read_common.decompress_raw_data();
+        m_signal_decompression_us += elapsed_us(start);
+    }
+}
+
+ReadPair::ReadData PairingNode::make_read_data(const SimplexRead& read,
+                                               uint64_t seq_start,
+                                               uint64_t seq_end) {
+    // Other threads may be evaluating the same cached read, so the copy is decompressed rather
+    // than the read.
+    const auto start = std::chrono::steady_clock::now();
+    auto read_data = ReadPair::ReadData::from_read(read, seq_start, seq_end);
+    if (read.read_common.compressed_raw_data) {
+        m_signal_decompression_us += elapsed_us(start);
+    }
+    return read_data;
+}
+
 void PairingNode::pair_list_worker_thread(int tid) {
     Message message;
     while (get_input_message(message)) {
@@ -199,6 +255,14 @@ void PairingNode::pair_list_worker_thread(int tid) {
         if (partner_found) {
             std::unique_lock<std::mutex> read_cache_lock(m_read_cache_mutex);
             auto partner_read_itr = m_read_cache.find(partner_id);
+            if (partner_read_itr == m_read_cache.end() && m_compress_cached_signal) {
+                // The read is about to be cached, so compress it without holding up the other
+                // workers. Its partner may arrive meanwhile, so the cache is checked again.
+                read_cache_lock.unlock();
+                compress_signal(*read);
+                read_cache_lock.lock();
+                partner_read_itr = m_read_cache.find(partner_id);
+            }
             if (partner_read_itr == m_read_cache.end()) {
                 // Partner is not in the read cache
                 auto read_id = read->read_common.read_id;
@@ -226,9 +290,8 @@ void PairingNode::pair_list_worker_thread(int tid) {
                         *template_read, *complement_read, delta, false, tid);
                 if (is_pair) {
                     ReadPair read_pair;
-                    read_pair.template_read = ReadPair::ReadData::from_read(*template_read, qs, qe);
-                    read_pair.complement_read =
-                            ReadPair::ReadData::from_read(*complement_read, rs, re);
+                    read_pair.template_read = make_read_data(*template_read, qs, qe);
+                    read_pair.complement_read = make_read_data(*complement_read, rs, re);
 
                     template_read->is_duplex_parent = true;
                     complement_read->is_duplex_parent = true;
@@ -264,6 +327,7 @@ void PairingNode::pair_generating_worker_thread(int tid) {
                 for (auto& read_ptr : reads_list) {
                     // Push each read message
                     m_cache_signal_bytes -= read_signal_bytes(*read_ptr);
+                    decompress_signal(*read_ptr);
                     send_message_to_sink(std::move(read_ptr));
                 }
             }
@@ -281,6 +345,7 @@ void PairingNode::pair_generating_worker_thread(int tid) {
         nvtx3::scoped_range loop{nvtx_id};
         // If this message isn't a read, we'll get a bad_variant_access exception.
         auto read = std::get<SimplexReadPtr>(std::move(message));
+        compress_signal(*read);
 
         int channel = read->read_common.attributes.channel_number;
         std::string run_id = read->read_common.run_id;
@@ -359,8 +424,8 @@ void PairingNode::pair_generating_worker_thread(int tid) {
                         is_within_time_and_length_criteria(*read_ptr, *later_read, tid);
                 if (is_pair) {
                     ReadPair pair;
-                    pair.template_read = ReadPair::ReadData::from_read(*read_ptr, qs, qe);
-                    pair.complement_read = ReadPair::ReadData::from_read(*later_read, rs, re);
+                    pair.template_read = make_read_data(*read_ptr, qs, qe);
+                    pair.complement_read = make_read_data(*later_read, rs, re);
 
                     read_ptr->is_duplex_parent = true;
                     later_read->is_duplex_parent = true;
@@ -374,8 +439,8 @@ void PairingNode::pair_generating_worker_thread(int tid) {
                         is_within_time_and_length_criteria(*earlier_read, *read_ptr, tid);
                 if (is_pair) {
                     ReadPair pair;
-                    pair.template_read = ReadPair::ReadData::from_read(*earlier_read, qs, qe);
-                    pair.complement_read = ReadPair::ReadData::from_read(*read_ptr, rs, re);
+                    pair.template_read = make_read_data(*earlier_read, qs, qe);
+                    pair.complement_read = make_read_data(*read_ptr, rs, re);
 
                     earlier_read->is_duplex_parent = true;
                     read_ptr->is_duplex_parent = true;
@@ -414,6 +479,7 @@ void PairingNode::pair_generating_worker_thread(int tid) {
             }
             if (ok_to_clear) {
                 auto read_handle = m_reads_to_clear.extract(*to_clear_itr++);
+                decompress_signal(*read_handle.value());
                 send_message_to_sink(std::move(read_handle.value()));
             } else {
                 ++to_clear_itr;
@@ -433,6 +499,7 @@ void PairingNode::pair_generating_worker_thread(int tid) {
 
                     for (auto& read_ptr : reads_list) {
                         m_cache_signal_bytes -= read_signal_bytes(*read_ptr);
+                        decompress_signal(*read_ptr);
                         // Push each read message
                         send_message_to_sink(std::move(read_ptr));
                     }
@@ -484,6 +551,7 @@ PairingNode::PairingNode(DuplexPairingParameters pairing_params,
 }
 
 void PairingNode::start_threads() {
+    m_compress_cached_signal = utils::get_dev_opt<bool>("compress_pairing_cache", false);
     m_tbufs.reserve(m_num_worker_threads);
     for (int i = 0; i < m_num_worker_threads; i++) {
         m_tbufs.push_back(MmTbufPtr(mm_tbuf_init()));
@@ -521,6 +589,13 @@ stats::NamedStats PairingNode::sample_stats() const {
     stats["overlap_accepted_pairs"] = m_overlap_accepted_pairs.load();
     stats["cached_signal_mb"] =
             static_cast<double>(m_cache_signal_bytes) / static_cast<double>(1024 * 1024);
+    if (m_signal_bytes_after_compression > 0) {
+        stats["signal_compression_ratio"] =
+                static_cast<double>(m_signal_bytes_before_compression) /
+                static_cast<double>(m_signal_bytes_after_compression);
+    }
+    stats["signal_compression_ms"] = static_cast<double>(m_signal_compression_us) / 1000.0;
+    stats["signal_decompression_ms"] = static_cast<double>(m_signal_decompression_us) / 1000.0;
     return stats;
 }
 
@@ -116,6 +116,15 @@ private:
                                                bool allow_rejection,
                                                int tid);
 
+    // Reads waiting for a pairing decision can hold their signal compressed, which is enabled
+    // with the "compress_pairing_cache" dev option. The signal is decompressed when a pair is
+    // made from the read, or the read leaves the cache.
+    void compress_signal(SimplexRead& read);
+    void decompress_signal(SimplexRead& read);
+    ReadPair::ReadData make_read_data(const SimplexRead& read,
+                                      uint64_t seq_start,
+                                      uint64_t seq_end);
+
     // Store the minimap2 buffers used for mapping. One buffer per thread.
     std::vector<MmTbufPtr> m_tbufs;
 
@@ -128,6 +137,12 @@ private:
     std::atomic<int> m_early_accepted_pairs{0};
     std::atomic<int> m_overlap_accepted_pairs{0};
     std::atomic<size_t> m_cache_signal_bytes{0};
+
+    bool m_compress_cached_signal = false;
+    std::atomic<size_t> m_signal_bytes_before_compression{0};
+    std::atomic<size_t> m_signal_bytes_after_compression{0};
+    std::atomic<int64_t> m_signal_compression_us{0};
+    std::atomic<int64_t> m_signal_decompression_us{0};
 };
 
 }  // namespace dorado
@@ -0,0 +1,131 @@
+#include "ReadPool.h"
+
+#include "utils/dev_utils.h"
+
+#include <new>
+#include <string>
+#include <utility>
+
+namespace {
+
+// Moves the (cleared) allocation of |from| into |to|, which is expected to be freshly constructed.
+template <typename Container>
+void recycle_buffer(Container& from, Container& to) {
+    from.clear();
+    std::swap(from, to);
+}
+
+void reset_read_common(dorado::ReadCommon& read_common) {
+    dorado::ReadCommon fresh{};
+    recycle_buffer(read_common.read_id, fresh.read_id);
+    recycle_buffer(read_common.seq, fresh.seq);
+    recycle_buffer(read_common.qstring, fresh.qstring);
+    recycle_buffer(read_common.moves, fresh.moves);
+    recycle_buffer(read_common.base_mod_probs, fresh.base_mod_probs);
+    recycle_buffer(read_common.run_id, fresh.run_id);
+    recycle_buffer(read_common.flowcell_id, fresh.flowcell_id);
+    recycle_buffer(read_common.position_id, fresh.position_id);
+    recycle_buffer(read_common.experiment_id, fresh.experiment_id);
+    recycle_buffer(read_common.model_name, fresh.model_name);
+    recycle_buffer(read_common.attributes.start_time, fresh.attributes.start_time);
+    recycle_buffer(read_common.attributes.fast5_filename, fresh.attributes.fast5_filename);
+    recycle_buffer(read_common.alignment_results, fresh.alignment_results);
+    recycle_buffer(read_common.barcode, fresh.barcode);
+    recycle_buffer(read_common.scaling_method, fresh.scaling_method);
+    recycle_buffer(read_common.parent_read_id, fresh.parent_read_id);
+    // Everything else, including the signal tensor and shared state, is released here.
+    read_common = std::move(fresh);
+}
+
+}  // namespace
+
+namespace dorado {
+
+namespace utils {
+
+void reset_read(SimplexRead& read) {
+    // Moved out and back in so their buffers survive the reconstruction below.
+    ReadCommon read_common = std::move(read.read_common);
+    reset_read_common(read_common);
+    std::string prev_read = std::move(read.prev_read);
+    std::string next_read = std::move(read.next_read);
+
+    // The atomic members make SimplexRead unassignable, so it's rebuilt in place instead,
+    // which resets every other field, including any added later.
+    read.~SimplexRead();
+    new (&read) SimplexRead();
+
+    read.read_common = std::move(read_common);
+    recycle_buffer(prev_read, read.prev_read);
+    recycle_buffer(next_read, read.next_read);
+}
+
+}  // namespace utils
+
+ReadPool::ReadPool(size_t max_pooled_reads) : m_max_pooled_reads(max_pooled_reads) {}
+
+ReadPool& ReadPool::instance() {
+    static ReadPool pool(utils::get_dev_opt<size_t>("read_pool_size", 0));
+    return pool;
+}
+
+SimplexReadPtr ReadPool::acquire() {
+    ++m_num_acquired;
+    {
+        std::lock_guard lock(m_mutex);
+        if (!m_pooled_reads.empty()) {
+            auto read = std::move(m_pooled_reads.back());
+            m_pooled_reads.pop_back();
+            ++m_num_reused;
+            return read;
+        }
+    }
+    return std::make_unique<SimplexRead>();
+}
+
+void ReadPool::release(SimplexReadPtr read) {
+    if (!read) {
+        return;
+    }
+    ++m_num_released;
+    if (m_max_pooled_reads == 0) {
+        ++m_num_discarded;
+        return;
+    }
+
+    // Reset outside the lock: this is where the signal and other shared state get freed.
+    utils::reset_read(*read);
+
+    std::lock_guard lock(m_mutex);
+    if (m_pooled_reads.size() >= m_max_pooled_reads) {
+        ++m_num_discarded;
+        return;
+    }
+    m_pooled_reads.push_back(std::move(read));
+}
+
+void ReadPool::release(Message&& message) {
+    if (std::holds_alternative<SimplexReadPtr>(message)) {
+        release(std::get<SimplexReadPtr>(std::move(message)));
+    }
+}
+
+size_t ReadPool::size() const {
+    std::lock_guard lock(m_mutex);
+    return m_pooled_reads.size();
+}
+
+stats::NamedStats ReadPool::sample_stats() const {
+    stats::NamedStats stats;
+    const auto num_acquired = m_num_acquired.load();
+    const auto num_reused = m_num_reused.load();
+    stats["reads_acquired"] = double(num_acquired);
+    stats["reads_reused"] = double(num_reused);
+    stats["reads_released"] = double(m_num_released.load());
+    stats["reads_discarded"] = double(m_num_discarded.load());
+    stats["pooled_reads"] = double(size());
+    stats["reuse_fraction"] = num_acquired > 0 ? double(num_reused) / double(num_acquired) : 0.0;
+    return stats;
+}
+
+}  // namespace dorado
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "read_pipeline/messages.h"
+#include "utils/stats.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dorado {
+
+// Free list of SimplexRead objects which have left the pipeline.
+// Released reads have their fields reset, but the string and vector members keep their
+// allocations so that reads drawn from the pool can be filled in without going back to the
+// allocator for every member of every read.
+// A pool with a capacity of 0 is disabled: acquire() allocates and release() frees.
+class ReadPool {
+public:
+    explicit ReadPool(size_t max_pooled_reads);
+
+    // Process-wide pool shared by the loaders and the terminal nodes of the pipeline.
+    // Its capacity is given by the "read_pool_size" dev option, and it is disabled by default.
+    static ReadPool& instance();
+
+    // Returns a read in its default state, reusing a pooled one if available.
+    SimplexReadPtr acquire();
+
+    // Resets the read and keeps it for reuse, or frees it if the pool is full.
+    void release(SimplexReadPtr read);
+
+    // Releases the read held by the message, if it holds a simplex read.
+    void release(Message&& message);
+
+    // Changing the capacity does not evict reads already in the pool.
+    void set_max_pooled_reads(size_t max_pooled_reads) { m_max_pooled_reads = max_pooled_reads; }
+    size_t size() const;
+
+    std::string get_name() const { return "ReadPool"; }
+    stats::NamedStats sample_stats() const;
+
+private:
+    std::atomic<size_t> m_max_pooled_reads;
+
+    mutable std::mutex m_mutex;
+    std::vector<SimplexReadPtr> m_pooled_reads;
+
+    std::atomic<int64_t> m_num_acquired = 0;
+    std::atomic<int64_t> m_num_reused = 0;
+    std::atomic<int64_t> m_num_released = 0;
+    std::atomic<int64_t> m_num_discarded = 0;
+};
+
+namespace utils {
+
+// Returns the read to its default-constructed state, keeping the capacity of its buffers.
+void reset_read(SimplexRead& read);
+
+}  // namespace utils
+
+}  // namespace dorado
@@ -1,10 +1,12 @@
 #include "ReadToBamTypeNode.h"
 
+#include "read_pipeline/ReadPool.h"
 #include "utils/SampleSheet.h"
 
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <chrono>
 
 namespace dorado {
 
@@ -39,8 +41,16 @@ void ReadToBamTypeNode::input_thread_fn() {
         auto alns = read_common_data.extract_sam_lines(m_emit_moves, m_modbase_threshold,
                                                        is_duplex_parent);
         for (auto& aln : alns) {
-            send_message_to_sink(BamMessage{std::move(aln), read_common_data.client_info});
+            send_message_to_sink(BamMessage{std::move(aln), read_common_data.client_info,
+                                            read_common_data.trace});
         }
+        if (read_common_data.file_arrival_time) {
+            m_file_arrival_latency.add(std::chrono::steady_clock::now() -
+                                       *read_common_data.file_arrival_time);
+        }
+
+        // The read itself goes no further than this node.
+        ReadPool::instance().release(std::move(message));
     }
 }
 
@@ -57,6 +67,10 @@ ReadToBamTypeNode::ReadToBamTypeNode(bool emit_moves,
     start_input_processing(&ReadToBamTypeNode::input_thread_fn, this);
 }
 
-stats::NamedStats ReadToBamTypeNode::sample_stats() const { return stats::from_obj(m_work_queue); }
+stats::NamedStats ReadToBamTypeNode::sample_stats() const {
+    auto stats = stats::from_obj(m_work_queue);
+    m_file_arrival_latency.report(stats, "file_arrival_latency");
+    return stats;
+}
 
 }  // namespace dorado
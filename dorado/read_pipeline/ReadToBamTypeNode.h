@@ -33,6 +33,9 @@ private:
     bool m_emit_moves;
     uint8_t m_modbase_threshold;
     std::unique_ptr<const utils::SampleSheet> m_sample_sheet;
+
+    // Time from a read's file arriving in a watched directory to its records being output.
+    stats::LatencyHistogram m_file_arrival_latency;
 };
 
 }  // namespace dorado
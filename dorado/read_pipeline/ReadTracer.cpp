@@ -0,0 +1,222 @@
+#include "ReadTracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+#include <variant>
+
+namespace {
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+}
+
+std::string json_string(const std::string& str) {
+    std::string quoted = "\"";
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + '"';
+}
+
+}  // namespace
+
+namespace dorado {
+
+std::atomic<bool> ReadTracer::s_enabled{false};
+
+ReadTracer::ReadTracer() : m_node_names{"Dataloader"} {}
+
+ReadTracer& ReadTracer::instance() {
+    static ReadTracer tracer;
+    return tracer;
+}
+
+void ReadTracer::configure(double fraction, size_t max_kept_traces) {
+    m_fraction = std::clamp(fraction, 0.0, 1.0);
+    m_max_kept_traces = max_kept_traces;
+    s_enabled = fraction > 0;
+}
+
+std::shared_ptr<ReadTrace> ReadTracer::start_trace(const std::string& read_id) {
+    const double fraction = m_fraction.load(std::memory_order_relaxed);
+    if (fraction <= 0) {
+        return nullptr;
+    }
+    // Every 1/fraction-th read, rather than a random sample, so runs are comparable.
+    const uint64_t read_index = m_reads_seen++;
+    if (uint64_t(double(read_index + 1) * fraction) == uint64_t(double(read_index) * fraction)) {
+        return nullptr;
+    }
+
+    auto trace = std::make_shared<ReadTrace>(read_id);
+    trace->m_stamps.push_back({now_ns(), LOADER_NODE, ReadTrace::Event::STARTED});
+    std::lock_guard lock(m_mutex);
+    if (m_kept_traces.size() < m_max_kept_traces) {
+        m_kept_traces.push_back(trace);
+    }
+    return trace;
+}
+
+uint16_t ReadTracer::node_id(const std::string& name) {
+    std::lock_guard lock(m_mutex);
+    auto it = std::find(m_node_names.begin(), m_node_names.end(), name);
+    if (it == m_node_names.end()) {
+        if (m_node_names.size() == MAX_NODES) {
+            return uint16_t(MAX_NODES - 1);
+        }
+        it = m_node_names.insert(m_node_names.end(), name);
+    }
+    return uint16_t(it - m_node_names.begin());
+}
+
+void ReadTracer::record(const Message& message, uint16_t node, ReadTrace::Event event) {
+    if (std::holds_alternative<BamBatch>(message)) {
+        for (const auto& bam_message : std::get<BamBatch>(message).messages) {
+            if (bam_message.trace) {
+                record(*bam_message.trace, node, event);
+            }
+        }
+        return;
+    }
+
+    ReadTrace* traces[2] = {nullptr, nullptr};
+    if (is_read_message(message)) {
+        traces[0] = get_read_common_data(message).trace.get();
+    } else if (std::holds_alternative<BamMessage>(message)) {
+        traces[0] = std::get<BamMessage>(message).trace.get();
+    } else if (std::holds_alternative<ReadPair>(message)) {
+        const auto& read_pair = std::get<ReadPair>(message);
+        traces[0] = read_pair.template_read.read_common.trace.get();
+        traces[1] = read_pair.complement_read.read_common.trace.get();
+    }
+
+    if (traces[0]) {
+        record(*traces[0], node, event);
+    }
+    if (traces[1] && traces[1] != traces[0]) {
+        record(*traces[1], node, event);
+    }
+}
+
+void ReadTracer::record(ReadTrace& trace, uint16_t node, ReadTrace::Event event) {
+    using Event = ReadTrace::Event;
+    const int64_t time_ns = now_ns();
+    auto since = [time_ns](const ReadTrace::Stamp& stamp) {
+        return std::chrono::nanoseconds(time_ns - stamp.time_ns);
+    };
+
+    std::lock_guard lock(trace.m_mutex);
+    auto& stamps = trace.m_stamps;
+    auto find_last = [&stamps](auto predicate) -> const ReadTrace::Stamp* {
+        auto it = std::find_if(stamps.rbegin(), stamps.rend(), predicate);
+        return it == stamps.rend() ? nullptr : &*it;
+    };
+
+    switch (event) {
+    case Event::QUEUED:
+        // The node which sent the read on is the last one to have started it.
+        if (auto* started = find_last([](const auto& s) { return s.event == Event::STARTED; })) {
+            m_latencies[started->node].processing.add(since(*started));
+        }
+        break;
+    case Event::STARTED:
+        if (auto* queued = find_last([node](const auto& s) {
+                return s.event == Event::QUEUED && s.node == node;
+            })) {
+            m_latencies[node].queued.add(since(*queued));
+        }
+        break;
+    case Event::WRITTEN:
+        if (auto* started = find_last([node](const auto& s) {
+                return s.event == Event::STARTED && s.node == node;
+            })) {
+            m_latencies[node].processing.add(since(*started));
+        }
+        m_end_to_end.add(since(stamps.front()));
+        break;
+    }
+    stamps.push_back({time_ns, node, event});
+}
+
+void ReadTracer::write_chrome_trace(const std::filesystem::path& path) const {
+    std::vector<std::shared_ptr<ReadTrace>> traces;
+    std::vector<std::string> node_names;
+    {
+        std::lock_guard lock(m_mutex);
+        traces = m_kept_traces;
+        node_names = m_node_names;
+    }
+
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Failed to open read trace file " + path.string());
+    }
+
+    int64_t epoch_ns = std::numeric_limits<int64_t>::max();
+    for (const auto& trace : traces) {
+        std::lock_guard lock(trace->m_mutex);
+        epoch_ns = std::min(epoch_ns, trace->m_stamps.front().time_ns);
+    }
+
+    // Timestamps are in microseconds.
+    out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+    const char* separator = "\n";
+    for (size_t i = 0; i < traces.size(); ++i) {
+        std::vector<ReadTrace::Stamp> stamps;
+        {
+            std::lock_guard lock(traces[i]->m_mutex);
+            stamps = traces[i]->m_stamps;
+        }
+        const size_t tid = i + 1;
+        out << separator << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << tid
+            << R"(,"args":{"name":)" << json_string(traces[i]->m_read_id) << "}}";
+        separator = ",\n";
+
+        // Each stamp starts a span which runs to the next.
+        for (size_t j = 1; j < stamps.size(); ++j) {
+            const auto& from = stamps[j - 1];
+            if (from.event == ReadTrace::Event::WRITTEN) {
+                continue;
+            }
+            std::string name = node_names.at(from.node);
+            if (from.event == ReadTrace::Event::QUEUED) {
+                name = "queued for " + name;
+            }
+            out << separator << R"({"name":)" << json_string(name)
+                << R"(,"cat":"read","ph":"X","pid":1,"tid":)" << tid
+                << R"(,"ts":)" << double(from.time_ns - epoch_ns) / 1000
+                << R"(,"dur":)" << double(stamps[j].time_ns - from.time_ns) / 1000 << "}";
+        }
+    }
+    out << "\n]}\n";
+    if (!out) {
+        throw std::runtime_error("Failed to write read trace file " + path.string());
+    }
+}
+
+stats::NamedStats ReadTracer::sample_stats() const {
+    std::vector<std::string> node_names;
+    {
+        std::lock_guard lock(m_mutex);
+        node_names = m_node_names;
+    }
+
+    stats::NamedStats stats;
+    for (size_t node = 0; node < node_names.size(); ++node) {
+        m_latencies[node].queued.report(stats, node_names[node] + "_queued");
+        m_latencies[node].processing.report(stats, node_names[node] + "_processing");
+    }
+    m_end_to_end.report(stats, "end_to_end");
+    return stats;
+}
+
+}  // namespace dorado
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "read_pipeline/messages.h"
+#include "utils/stats.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dorado {
+
+// When a sampled read reached each stage of the pipeline. The copies and subreads of a read
+// share its trace, so stamps are taken under a lock.
+class ReadTrace {
+public:
+    enum class Event : uint8_t {
+        QUEUED,   // Pushed onto a node's input queue.
+        STARTED,  // Taken off the queue by the node.
+        WRITTEN,  // Written to an output file by the node.
+    };
+
+    struct Stamp {
+        int64_t time_ns;  // steady_clock
+        uint16_t node;    // See ReadTracer::node_id().
+        Event event;
+    };
+
+    explicit ReadTrace(std::string read_id) : m_read_id(std::move(read_id)) {}
+
+private:
+    friend class ReadTracer;
+
+    const std::string m_read_id;
+    std::mutex m_mutex;
+    std::vector<Stamp> m_stamps;
+};
+
+/** Follows a sample of reads through the pipeline, for finding where their latency goes.
+ *
+ *  The loader starts a trace for each sampled read, and MessageSink stamps it as the read is
+ *  queued at and taken up by each node, until it's written out. Time queued at and spent in
+ *  each node is collected in histograms reported by sample_stats(), and the stamps of the
+ *  first traces can be written out as a Chrome trace, viewable in Perfetto.
+ *
+ *  Disabled by default, in which case each message costs one relaxed atomic load.
+ */
+class ReadTracer {
+public:
+    static ReadTracer& instance();
+
+    static bool is_enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    /// Traces |fraction| of the reads started from then on, keeping the stamps of the first
+    /// |max_kept_traces| for write_chrome_trace(). A fraction of 0 disables tracing.
+    void configure(double fraction, size_t max_kept_traces);
+
+    /// Returns a trace for the read if it's sampled, or null.
+    std::shared_ptr<ReadTrace> start_trace(const std::string& read_id);
+
+    /// The id of the node called |name| in stamps.
+    uint16_t node_id(const std::string& name);
+
+    /// Stamps |event| at |node| on each trace held by |message|.
+    void record(const Message& message, uint16_t node, ReadTrace::Event event);
+    void record(ReadTrace& trace, uint16_t node, ReadTrace::Event event);
+
+    /// Writes the kept traces in Chrome's trace event format, one row per read. Throws
+    /// std::runtime_error if the file can't be written.
+    void write_chrome_trace(const std::filesystem::path& path) const;
+
+    std::string get_name() const { return "ReadTracer"; }
+    // <node>_queued_* and <node>_processing_* percentiles, and end_to_end_* from a read's
+    // trace starting to its records being written.
+    stats::NamedStats sample_stats() const;
+
+private:
+    ReadTracer();
+
+    // Beyond this many, nodes share the last id.
+    static constexpr size_t MAX_NODES = 64;
+    // The loader, which starts traces.
+    static constexpr uint16_t LOADER_NODE = 0;
+
+    static std::atomic<bool> s_enabled;
+
+    std::atomic<double> m_fraction{0};
+    std::atomic<size_t> m_max_kept_traces{0};
+    std::atomic<uint64_t> m_reads_seen{0};
+
+    mutable std::mutex m_mutex;
+    std::vector<std::string> m_node_names;
+    std::vector<std::shared_ptr<ReadTrace>> m_kept_traces;
+
+    struct NodeLatencies {
+        stats::LatencyHistogram queued;
+        stats::LatencyHistogram processing;
+    };
+    std::array<NodeLatencies, MAX_NODES> m_latencies;
+    stats::LatencyHistogram m_end_to_end;
+};
+
+}  // namespace dorado
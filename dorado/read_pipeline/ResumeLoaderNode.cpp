@@ -2,14 +2,66 @@
 
 #include "DefaultClientInfo.h"
 #include "HtsReader.h"
+#include "HtsWriter.h"
 #include "utils/tty_utils.h"
+#include "utils/types.h"
 
+#include <htslib/bgzf.h>
+#include <htslib/hts.h>
 #include <htslib/sam.h>
 #include <indicators/indeterminate_progress_bar.hpp>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <filesystem>
+#include <fstream>
 #include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Size of the chunks complete BGZF blocks are copied in.
+constexpr size_t BLOCK_COPY_CHUNK_SIZE = 4 << 20;
+
+struct BgzfBlockInfo {
+    int64_t compressed_size;
+    uint32_t uncompressed_size;
+};
+
+// Reads the sizes of the BGZF block starting at |offset| from its header and footer.
+BgzfBlockInfo read_bgzf_block_info(std::ifstream& file, int64_t offset) {
+    // Gzip header with the BGZF extra subfield, ending with the block size minus 1.
+    constexpr std::array<uint8_t, 4> gzip_magic{31, 139, 8, 4};
+    std::array<uint8_t, 18> header{};
+    file.seekg(offset);
+    file.read(reinterpret_cast<char*>(header.data()), header.size());
+    if (!file || !std::equal(gzip_magic.begin(), gzip_magic.end(), header.begin()) ||
+        header[12] != 'B' || header[13] != 'C') {
+        throw std::runtime_error("Invalid BGZF block at offset " + std::to_string(offset));
+    }
+    const int64_t compressed_size = (int64_t(header[16]) | (int64_t(header[17]) << 8)) + 1;
+
+    // The footer is the CRC32 and then the uncompressed size.
+    std::array<uint8_t, 4> isize{};
+    file.seekg(offset + compressed_size - int64_t(isize.size()));
+    file.read(reinterpret_cast<char*>(isize.data()), isize.size());
+    if (!file) {
+        throw std::runtime_error("Truncated BGZF block at offset " + std::to_string(offset));
+    }
+    const uint32_t uncompressed_size = uint32_t(isize[0]) | (uint32_t(isize[1]) << 8) |
+                                       (uint32_t(isize[2]) << 16) | (uint32_t(isize[3]) << 24);
+    return {compressed_size, uncompressed_size};
+}
+
+int64_t block_address(int64_t virtual_offset) { return virtual_offset >> 16; }
+uint32_t block_offset(int64_t virtual_offset) { return uint32_t(virtual_offset & 0xffff); }
+
+}  // namespace
 
 namespace dorado {
 
@@ -33,46 +85,149 @@ void ResumeLoaderNode::copy_completed_reads() {
     // routed to a file, the IndeterminateProgressBar just spams the file
     // with dots.
     bool is_safe_to_log = utils::is_fd_tty(stderr);
+    size_t num_records = 0;
+    auto on_record = [&] {
+        if (is_safe_to_log && ++num_records % 100 == 0) {
+            bar.tick();
+        }
+    };
 
     // Turn off logging for warnings.
     auto initial_hts_log_level = hts_get_log_level();
     hts_set_log_level(HTS_LOG_OFF);
 
-    HtsReader reader(m_resume_file, std::nullopt);
     spdlog::info("Resuming from file {}...", m_resume_file);
 
+    auto* writer = dynamic_cast<HtsWriter*>(&m_sink);
+    if (!writer || !copy_completed_blocks(*writer, on_record)) {
+        copy_completed_records(on_record);
+    }
+    std::cerr << "\r";
+    spdlog::info("> {} original read ids found in resume file.", m_processed_read_ids.size());
+
+    hts_set_log_level(initial_hts_log_level);
+}
+
+void ResumeLoaderNode::add_processed_read_id(const bam1_t* record) {
+    // If a split read is found, use the parent read id to
+    // resume basecalling since that's the read id found in
+    // the raw dataset.
+    std::string_view read_id;
+    auto pid_tag = bam_aux_get(record, "pi");
+    if (pid_tag) {
+        read_id = bam_aux2Z(pid_tag);
+    } else {
+        read_id = bam_get_qname(record);
+    }
+    m_processed_read_ids.insert(read_id);
+}
+
+void ResumeLoaderNode::copy_completed_records(const std::function<void()>& on_record) {
+    HtsReader reader(m_resume_file, std::nullopt);
+
     auto client_info = std::make_shared<DefaultClientInfo>();
     // Iterate over all reads and write to sink.
     try {
         while (reader.read()) {
-            std::string read_id;
-            // If a split read is found, use the parent read id to
-            // resume basecalling since that's the read id found in
-            // the raw dataset.
-            auto pid_tag = bam_aux_get(reader.record.get(), "pi");
-            if (pid_tag) {
-                read_id = std::string(bam_aux2Z(pid_tag));
-            } else {
-                read_id = bam_get_qname(reader.record);
-            }
-            m_processed_read_ids.insert(read_id);
+            add_processed_read_id(reader.record.get());
             m_sink.push_message(BamMessage{BamPtr(bam_dup1(reader.record.get())), client_info});
-            if (is_safe_to_log && m_processed_read_ids.size() % 100 == 0) {
-                bar.tick();
-            }
+            on_record();
         }
     } catch (std::exception&) {
         // Exception implies the reader could not read
         // the last record. We take this to be the end of
         // properly formatted records.
     }
-    std::cerr << "\r";
-    spdlog::info("> {} original read ids found in resume file.", m_processed_read_ids.size());
+}
 
-    hts_set_log_level(initial_hts_log_level);
+bool ResumeLoaderNode::copy_completed_blocks(HtsWriter& writer,
+                                             const std::function<void()>& on_record) {
+    auto& output = writer.get_file();
+    if (!output.can_write_bgzf_blocks()) {
+        return false;
+    }
+    HtsFilePtr scan_file(hts_open(m_resume_file.c_str(), "r"));
+    if (!scan_file) {
+        return false;
+    }
+    const htsFormat* format = hts_get_format(scan_file.get());
+    if (format->format != bam || format->compression != bgzf) {
+        return false;
+    }
+
+    // Decompression dominates the scan, so it's spread over all the cores. Records are only
+    // decoded to find their read ids and where the last complete one ends.
+    const int scan_threads = int(std::max(1u, std::thread::hardware_concurrency()));
+    hts_set_threads(scan_file.get(), scan_threads);
+    SamHdrPtr header(sam_hdr_read(scan_file.get()));
+    if (!header) {
+        return false;
+    }
+    BGZF* scan_bgzf = scan_file->fp.bgzf;
+    const int64_t records_begin = bgzf_tell(scan_bgzf);
+    int64_t records_end = records_begin;
+    BamPtr record(bam_init1());
+    while (bam_read1(scan_bgzf, record.get()) >= 0) {
+        add_processed_read_id(record.get());
+        writer.count_copied_record(record.get());
+        records_end = bgzf_tell(scan_bgzf);
+        on_record();
+    }
+    scan_file.reset();
+    if (records_end == records_begin) {
+        return true;
+    }
+
+    // Whole blocks are copied straight from the file. Records in the blocks shared with the
+    // header or with a truncated record are decompressed and written through the output's own
+    // compression.
+    HtsFilePtr decode_file(hts_open(m_resume_file.c_str(), "r"));
+    std::ifstream raw_file(m_resume_file, std::ios::binary);
+    if (!decode_file || !raw_file) {
+        throw std::runtime_error("Could not reopen resume file " + m_resume_file);
+    }
+    std::vector<char> buffer;
+    auto reencode = [&](int64_t virtual_offset, size_t size) {
+        if (size == 0) {
+            return;
+        }
+        buffer.resize(size);
+        if (bgzf_seek(decode_file->fp.bgzf, virtual_offset, SEEK_SET) < 0 ||
+            bgzf_read(decode_file->fp.bgzf, buffer.data(), size) != ssize_t(size) ||
+            output.write_encoded_records(buffer.data(), size) < 0) {
+            throw std::runtime_error("Failed to copy records from resume file " + m_resume_file);
+        }
+    };
+
+    int64_t copy_begin = block_address(records_begin);
+    const int64_t copy_end = block_address(records_end);
+    if (copy_begin == copy_end) {
+        reencode(records_begin, block_offset(records_end) - block_offset(records_begin));
+        return true;
+    }
+    if (block_offset(records_begin) != 0) {
+        const auto first_block = read_bgzf_block_info(raw_file, copy_begin);
+        reencode(records_begin, first_block.uncompressed_size - block_offset(records_begin));
+        copy_begin += first_block.compressed_size;
+    }
+
+    raw_file.clear();
+    raw_file.seekg(copy_begin);
+    buffer.resize(BLOCK_COPY_CHUNK_SIZE);
+    for (int64_t pos = copy_begin; pos < copy_end;) {
+        const auto chunk = size_t(std::min(int64_t(buffer.size()), copy_end - pos));
+        if (!raw_file.read(buffer.data(), chunk) ||
+            output.write_bgzf_blocks(buffer.data(), chunk) < 0) {
+            throw std::runtime_error("Failed to copy blocks from resume file " + m_resume_file);
+        }
+        pos += chunk;
+    }
+
+    reencode(copy_end << 16, block_offset(records_end));
+    return true;
 }
 
-std::unordered_set<std::string> ResumeLoaderNode::get_processed_read_ids() const {
+utils::ReadIdSet ResumeLoaderNode::get_processed_read_ids() const {
     return m_processed_read_ids;
 }
 
@@ -1,24 +1,37 @@
 #pragma once
 
 #include "read_pipeline/MessageSink.h"
+#include "utils/read_id_set.h"
 
+#include <functional>
 #include <string>
-#include <unordered_set>
+
+struct bam1_t;
 
 namespace dorado {
 
+class HtsWriter;
+
 class ResumeLoaderNode {
 public:
     ResumeLoaderNode(MessageSink& sink, const std::string& resume_file);
     ~ResumeLoaderNode() = default;
+    // Writes the fully written records of the resume file to the sink. If the sink is an
+    // HtsWriter writing BAM and the resume file is a BAM, the compressed blocks are copied as they
+    // are, and only the blocks at either end of the records are recompressed.
     void copy_completed_reads();
-    std::unordered_set<std::string> get_processed_read_ids() const;
+    utils::ReadIdSet get_processed_read_ids() const;
 
 private:
+    // Returns false, having written nothing, if the blocks can't be copied.
+    bool copy_completed_blocks(HtsWriter& writer, const std::function<void()>& on_record);
+    void copy_completed_records(const std::function<void()>& on_record);
+    void add_processed_read_id(const bam1_t* record);
+
     MessageSink& m_sink;
     std::string m_resume_file;
 
-    std::unordered_set<std::string> m_processed_read_ids;
+    utils::ReadIdSet m_processed_read_ids;
 };
 
 }  // namespace dorado
@@ -27,28 +27,54 @@ using Slice = at::indexing::Slice;
 
 namespace {
 
-std::pair<float, float> med_mad(const at::Tensor& x) {
+std::pair<float, float> med_mad(const dorado::utils::SignalHistogram& histogram) {
     // See https://en.wikipedia.org/wiki/Median_absolute_deviation
     //  (specifically the "Relation to standard deviation" section)
     constexpr float factor = 1.4826f;
     //Calculate signal median and median absolute deviation
-    auto med = x.median();
-    auto mad = at::median(at::abs(x - med)) * factor + EPS;
-    return {med.item<float>(), mad.item<float>()};
+    const auto med = histogram.median();
+    const auto mad = static_cast<float>(histogram.median_abs_deviation(med)) * factor + EPS;
+    return {static_cast<float>(med), mad};
 }
 
 std::pair<float, float> normalisation(const dorado::basecall::QuantileScalingParams& params,
-                                      const at::Tensor& x) {
+                                      const dorado::utils::SignalHistogram& histogram) {
     // Calculate shift and scale factors for normalisation.
-    auto quantiles =
-            dorado::utils::quantile_counting(x, at::tensor({params.quantile_a, params.quantile_b}));
-    float q_a = quantiles[0].item<float>();
-    float q_b = quantiles[1].item<float>();
+    float q_a = histogram.quantile(params.quantile_a);
+    float q_b = histogram.quantile(params.quantile_b);
     float shift = std::max(10.0f, params.shift_multiplier * (q_a + q_b));
     float scale = std::max(1.0f, params.scale_multiplier * (q_b - q_a));
     return {shift, scale};
 }
 
+// Converts the int16 signal to the float16 (x - shift) / scale form the model consumes, in a
+// single pass.  The signal is overwritten in place if nothing else references its storage.
+// Returns the number of bytes allocated.
+size_t normalise_signal(at::Tensor& signal, float shift, float scale) {
+    assert(signal.dtype() == at::kShort);
+    size_t bytes_allocated = 0;
+    if (!signal.is_contiguous()) {
+        signal = signal.contiguous();
+        bytes_allocated += signal.nbytes();
+    }
+
+    const auto* const src = signal.data_ptr<int16_t>();
+    const auto count = static_cast<size_t>(signal.numel());
+    if (signal.use_count() == 1 && signal.storage().use_count() == 1) {
+        // int16 and float16 are the same size, so each output overwrites its own input.
+        auto* const dest = reinterpret_cast<c10::Half*>(signal.data_ptr<int16_t>());
+        dorado::utils::normalise_i16_to_f16(dest, src, count, shift, scale);
+        signal = signal.view(at::ScalarType::Half);
+    } else {
+        auto normalised = at::empty_like(signal, signal.options().dtype(at::ScalarType::Half));
+        dorado::utils::normalise_i16_to_f16(normalised.data_ptr<c10::Half>(), src, count, shift,
+                                            scale);
+        bytes_allocated += normalised.nbytes();
+        signal = std::move(normalised);
+    }
+    return bytes_allocated;
+}
+
 using SampleType = dorado::basecall::SampleType;
 using ScalingStrategy = dorado::basecall::ScalingStrategy;
 using SignalNormalisationParams = dorado::basecall::SignalNormalisationParams;
@@ -124,6 +150,9 @@ namespace dorado {
 void ScalerNode::input_thread_fn() {
     at::InferenceMode inference_mode_guard;
 
+    // Reused for every read handled by this thread.
+    utils::SignalHistogram histogram;
+
     Message message;
     while (get_input_message(message)) {
         // If this message isn't a Simplex read, just forward it to the sink.
@@ -133,6 +162,8 @@ void ScalerNode::input_thread_fn() {
         }
 
         auto read = std::get<SimplexReadPtr>(std::move(message));
+        const auto scaling_start = std::chrono::steady_clock::now();
+        size_t bytes_allocated = 0;
 
         bool is_rna_model =
                 (m_model_type == SampleType::RNA002 || m_model_type == SampleType::RNA004);
@@ -179,6 +210,8 @@ void ScalerNode::input_thread_fn() {
 
         assert(read->read_common.raw_data.dtype() == at::kShort);
 
+        // raw_data comes from DataLoader with dtype int16.  We send it on as float16 after
+        // shifting/scaling.
         float scale = 1.0f;
         float shift = 0.0f;
 
@@ -200,9 +233,7 @@ void ScalerNode::input_thread_fn() {
                 shift = -1.f * read->offset;
             }
 
-            read->read_common.raw_data =
-                    ((read->read_common.raw_data.to(at::kFloat) - shift) / scale)
-                            .to(at::ScalarType::Half);
+            bytes_allocated += normalise_signal(read->read_common.raw_data, shift, scale);
 
             read->read_common.scale = scale;
             read->read_common.shift = shift;
@@ -210,16 +241,21 @@ void ScalerNode::input_thread_fn() {
             // Ignore the RNA adapter. If this is DNA or we've already trimmed the adapter, this will be zero
             auto scaling_data = read->read_common.raw_data.index(
                     {Slice(read->read_common.rna_adapter_end_signal_pos, at::indexing::None)});
-            std::tie(shift, scale) =
-                    m_scaling_params.strategy == ScalingStrategy::QUANTILE
-                            ? normalisation(m_scaling_params.quantile, scaling_data)
-                            : med_mad(scaling_data);
+            if (!scaling_data.is_contiguous()) {
+                scaling_data = scaling_data.contiguous();
+                bytes_allocated += scaling_data.nbytes();
+            }
+            const auto histogram_capacity = histogram.capacity_bytes();
+            histogram.build(scaling_data.data_ptr<int16_t>(),
+                            static_cast<size_t>(scaling_data.numel()));
+            bytes_allocated += histogram.capacity_bytes() - histogram_capacity;
+            scaling_data = at::Tensor();
 
-            // raw_data comes from DataLoader with dtype int16.  We send it on as float16 after
-            // shifting/scaling in float32 form.
-            read->read_common.raw_data =
-                    ((read->read_common.raw_data.to(at::kFloat) - shift) / scale)
-                            .to(at::ScalarType::Half);
+            std::tie(shift, scale) = m_scaling_params.strategy == ScalingStrategy::QUANTILE
+                                             ? normalisation(m_scaling_params.quantile, histogram)
+                                             : med_mad(histogram);
+
+            bytes_allocated += normalise_signal(read->read_common.raw_data, shift, scale);
             // move the shift and scale into pA.
             read->read_common.scale = read->scaling * scale;
             read->read_common.shift = read->scaling * (shift + read->offset);
@@ -249,6 +285,12 @@ void ScalerNode::input_thread_fn() {
 
         read->read_common.num_trimmed_samples = trim_start;
 
+        const auto scaling_time = std::chrono::steady_clock::now() - scaling_start;
+        m_scaling_time_us +=
+                std::chrono::duration_cast<std::chrono::microseconds>(scaling_time).count();
+        m_scaling_bytes_allocated += bytes_allocated;
+        ++m_num_reads_scaled;
+
         spdlog::trace("ScalerNode: {} shift: {} scale: {} trim: {}", read->read_common.read_id,
                       shift, scale, trim_start);
 
@@ -257,6 +299,20 @@ void ScalerNode::input_thread_fn() {
     }
 }
 
+stats::NamedStats ScalerNode::sample_stats() const {
+    auto stats = stats::from_obj(m_work_queue);
+    const double num_reads = double(m_num_reads_scaled.load());
+    stats["reads_scaled"] = num_reads;
+    stats["scaling_time_ms"] = double(m_scaling_time_us.load()) / 1000.0;
+    stats["scaling_bytes_allocated"] = double(m_scaling_bytes_allocated.load());
+    if (num_reads > 0) {
+        stats["scaling_time_us_per_read"] = double(m_scaling_time_us.load()) / num_reads;
+        stats["scaling_bytes_allocated_per_read"] =
+                double(m_scaling_bytes_allocated.load()) / num_reads;
+    }
+    return stats;
+}
+
 ScalerNode::ScalerNode(const SignalNormalisationParams& config,
                        SampleType model_type,
                        bool trim_rna_adapter,
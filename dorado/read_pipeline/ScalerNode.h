@@ -6,6 +6,7 @@
 #include "utils/trim_rapid_adapter.h"
 
 #include <atomic>
+#include <cstdint>
 #include <string>
 
 namespace dorado {
@@ -20,7 +21,7 @@ public:
                size_t max_reads);
     ~ScalerNode() { stop_input_processing(); }
     std::string get_name() const override { return "ScalerNode"; }
-    stats::NamedStats sample_stats() const override { return stats::from_obj(m_work_queue); }
+    stats::NamedStats sample_stats() const override;
     void terminate(const FlushOptions&) override { stop_input_processing(); }
     void restart() override { start_input_processing(&ScalerNode::input_thread_fn, this); }
 
@@ -34,6 +35,12 @@ private:
 
     // A flag to warn only once if the basecall model and read SampleType differ
     std::atomic<bool> m_log_once_inconsistent_read_model{true};
+
+    // Time spent trimming and normalising reads, and bytes of signal-sized buffers allocated
+    // while doing so.
+    std::atomic<int64_t> m_num_reads_scaled{0};
+    std::atomic<int64_t> m_scaling_time_us{0};
+    std::atomic<int64_t> m_scaling_bytes_allocated{0};
 };
 
 }  // namespace dorado
@@ -0,0 +1,225 @@
+#include "ShardedHtsWriter.h"
+
+#include "read_pipeline/ReadPipeline.h"
+
+#include <htslib/sam.h>
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+namespace {
+
+constexpr size_t BAM_BUFFER_SIZE = 100000000;  // 100 MB per shard, when sorting.
+
+}  // namespace
+
+namespace dorado {
+
+using OutputMode = utils::HtsFile::OutputMode;
+
+ShardedHtsWriter::ShardedHtsWriter(Options options)
+        : MessageSink(10000, int(std::max(options.num_shards, size_t(1)))),
+          m_options(std::move(options)),
+          m_gpu_names(m_options.gpu_names.empty() ? "" : "gpu:" + m_options.gpu_names),
+          m_output_dir(m_options.output_dir),
+          m_shards(std::max(m_options.num_shards, size_t(1))) {
+    if (m_options.output_dir.empty()) {
+        throw std::runtime_error("ShardedHtsWriter requires an output directory.");
+    }
+    std::filesystem::create_directories(m_output_dir);
+    enable_batch_input();
+    start_input_processing(&ShardedHtsWriter::input_thread_fn, this);
+}
+
+ShardedHtsWriter::~ShardedHtsWriter() { stop_input_processing(); }
+
+void ShardedHtsWriter::restart() {
+    m_next_shard = 0;
+    start_input_processing(&ShardedHtsWriter::input_thread_fn, this);
+}
+
+void ShardedHtsWriter::input_thread_fn() {
+    const size_t shard_idx = m_next_shard++;
+    assert(shard_idx < m_shards.size());
+
+    Message message;
+    while (get_input_message(message)) {
+        if (std::holds_alternative<BamMessage>(message)) {
+            auto& bam_message = std::get<BamMessage>(message);
+            write(shard_idx, bam_message.bam_ptr.get());
+            record_trace_written(bam_message.trace);
+        } else if (std::holds_alternative<BamBatch>(message)) {
+            for (auto& bam_message : std::get<BamBatch>(message).messages) {
+                write(shard_idx, bam_message.bam_ptr.get());
+                record_trace_written(bam_message.trace);
+            }
+        }
+    }
+}
+
+std::string ShardedHtsWriter::file_extension() const {
+    switch (m_options.output_mode) {
+    case OutputMode::FASTQ:
+        return ".fastq";
+    case OutputMode::FASTA:
+        return ".fasta";
+    case OutputMode::SAM:
+        return ".sam";
+    default:
+        return ".bam";
+    }
+}
+
+bool ShardedHtsWriter::needs_rollover(const Shard& shard) const {
+    if (!shard.file) {
+        return false;
+    }
+    return (m_options.max_reads_per_file > 0 &&
+            shard.num_reads >= m_options.max_reads_per_file) ||
+           (m_options.max_bytes_per_file > 0 && shard.num_bytes >= m_options.max_bytes_per_file);
+}
+
+void ShardedHtsWriter::open_file(size_t shard_idx) {
+    assert(m_header);
+    auto& shard = m_shards[shard_idx];
+
+    // e.g. calls_002_0013.bam for the 14th file of the 3rd shard.
+    std::ostringstream filename;
+    filename << m_options.file_prefix << '_' << std::setfill('0') << std::setw(3) << shard_idx
+             << '_' << std::setw(4) << shard.part << file_extension();
+    shard.path = m_output_dir / filename.str();
+
+    const bool sort_bam = m_options.sort_bam && m_options.output_mode == OutputMode::BAM;
+    shard.file = std::make_unique<utils::HtsFile>(shard.path.string(), m_options.output_mode,
+                                                  m_options.htslib_threads_per_shard, sort_bam);
+    if (sort_bam) {
+        shard.file->set_buffer_size(BAM_BUFFER_SIZE);
+    }
+    shard.file->set_header(m_header.get());
+    shard.num_reads = 0;
+    shard.num_bytes = 0;
+}
+
+void ShardedHtsWriter::close_file(size_t shard_idx,
+                                  const utils::HtsFile::ProgressCallback& progress_callback) {
+    auto& shard = m_shards[shard_idx];
+    if (!shard.file) {
+        return;
+    }
+    shard.file->finalise(progress_callback);
+    shard.file.reset();
+    {
+        std::lock_guard lock(m_manifest_mutex);
+        m_manifest.push_back({shard.path, shard_idx, shard.part, shard.num_reads});
+    }
+    ++shard.part;
+}
+
+void ShardedHtsWriter::write(size_t shard_idx, bam1_t* const record) {
+    auto& shard = m_shards[shard_idx];
+    if (needs_rollover(shard)) {
+        // Sorted BAM output is merged here, on this shard's thread.
+        close_file(shard_idx, [](size_t) { /* noop */ });
+        ++m_files_rolled_over;
+    }
+    if (!shard.file) {
+        open_file(shard_idx);
+    }
+
+    if (m_options.output_mode == OutputMode::FASTQ && !m_gpu_names.empty()) {
+        bam_aux_append(record, "DS", 'Z', int(m_gpu_names.length() + 1),
+                       (uint8_t*)m_gpu_names.c_str());
+    }
+
+    auto hts_res = shard.file->write(record);
+    if (hts_res < 0) {
+        throw std::runtime_error("Failed to write SAM record, error code " +
+                                 std::to_string(hts_res));
+    }
+
+    ++shard.num_reads;
+    shard.num_bytes += sizeof(bam1_core_t) + size_t(record->l_data);
+    ++m_records_written;
+    count_read(record);
+}
+
+// Mirrors HtsWriter, so progress reporting works the same for either writer.
+void ShardedHtsWriter::count_read(bam1_t* const record) {
+    auto dx_tag = bam_aux_get(record, "dx");
+    if (dx_tag && bam_aux2i(dx_tag) == 1) {
+        ++m_duplex_reads_written;
+        return;
+    }
+
+    // Split reads are tracked by their parent read id.
+    auto pid_tag = bam_aux_get(record, "pi");
+    const char* read_id = pid_tag ? bam_aux2Z(pid_tag) : bam_get_qname(record);
+
+    std::lock_guard lock(m_read_ids_mutex);
+    m_processed_read_ids.insert(read_id);
+    m_unique_simplex_reads_written = m_processed_read_ids.size();
+}
+
+void ShardedHtsWriter::set_header(const sam_hdr_t* const header) {
+    if (header) {
+        m_header.reset(sam_hdr_dup(header));
+    }
+}
+
+void ShardedHtsWriter::finalise_hts_files(
+        const utils::HtsFile::ProgressCallback& progress_callback) {
+    const size_t num_shards = m_shards.size();
+    for (size_t shard_idx = 0; shard_idx < num_shards; ++shard_idx) {
+        close_file(shard_idx, [&](size_t progress) {
+            // Give each shard the same contribution to the total progress.
+            progress_callback((shard_idx * 100 + progress) / num_shards);
+        });
+    }
+
+    std::lock_guard lock(m_manifest_mutex);
+    std::sort(m_manifest.begin(), m_manifest.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tie(lhs.shard, lhs.part) < std::tie(rhs.shard, rhs.part);
+    });
+
+    const auto manifest_path = m_output_dir / MANIFEST_FILENAME;
+    std::ofstream manifest(manifest_path);
+    if (!manifest) {
+        throw std::runtime_error("Could not open shard manifest: " + manifest_path.string());
+    }
+    manifest << "filename\tshard\tpart\tnum_records\n";
+    for (const auto& entry : m_manifest) {
+        manifest << entry.path.filename().string() << '\t' << entry.shard << '\t' << entry.part
+                 << '\t' << entry.num_reads << '\n';
+    }
+
+    progress_callback(100);
+}
+
+std::vector<std::filesystem::path> ShardedHtsWriter::get_output_files() const {
+    std::lock_guard lock(m_manifest_mutex);
+    std::vector<std::filesystem::path> files;
+    files.reserve(m_manifest.size());
+    for (const auto& entry : m_manifest) {
+        files.push_back(entry.path);
+    }
+    return files;
+}
+
+stats::NamedStats ShardedHtsWriter::sample_stats() const {
+    auto stats = stats::from_obj(m_work_queue);
+    stats["unique_simplex_reads_written"] = double(m_unique_simplex_reads_written.load());
+    stats["duplex_reads_written"] = double(m_duplex_reads_written.load());
+    stats["records_written"] = double(m_records_written.load());
+    stats["files_rolled_over"] = double(m_files_rolled_over.load());
+    return stats;
+}
+
+void ShardedHtsWriter::terminate(const FlushOptions&) { stop_input_processing(); }
+
+}  // namespace dorado
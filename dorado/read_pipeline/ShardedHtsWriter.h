@@ -0,0 +1,108 @@
+#pragma once
+
+#include "read_pipeline/MessageSink.h"
+#include "utils/hts_file.h"
+#include "utils/read_id_set.h"
+#include "utils/stats.h"
+#include "utils/types.h"
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct bam1_t;
+
+namespace dorado {
+
+// Writes records to a set of shard files in an output directory, one writer thread (and BGZF
+// thread pool) per shard, so output isn't limited by a single compression thread.
+//
+// Each shard rolls over to a new file once it reaches the configured read count or size, and a
+// manifest listing every file written is created in the output directory on finalisation.
+// Which shard a record ends up in depends only on which writer thread picks it up.
+class ShardedHtsWriter : public MessageSink {
+public:
+    struct Options {
+        std::string output_dir;
+        std::string file_prefix{"calls"};
+        size_t num_shards{1};
+        // htslib threads used for compressing each shard.
+        size_t htslib_threads_per_shard{1};
+        utils::HtsFile::OutputMode output_mode{utils::HtsFile::OutputMode::BAM};
+        bool sort_bam{false};
+        // Start a new file once a shard's current file has this many reads. 0 for no limit.
+        size_t max_reads_per_file{0};
+        // Start a new file once a shard's current file has this many bytes of uncompressed record
+        // data, so compressed BAM files come out smaller than this. 0 for no limit.
+        size_t max_bytes_per_file{0};
+        std::string gpu_names;
+    };
+
+    static constexpr const char* MANIFEST_FILENAME = "shard_manifest.tsv";
+
+    explicit ShardedHtsWriter(Options options);
+    ~ShardedHtsWriter();
+    std::string get_name() const override { return "ShardedHtsWriter"; }
+    stats::NamedStats sample_stats() const override;
+    void terminate(const FlushOptions&) override;
+    void restart() override;
+
+    void set_header(const sam_hdr_t* header);
+
+    // Finalises every open file and writes the manifest.
+    // Finalisation must occur before destruction of this node.
+    // Note that this isn't safe to call until after this node has been terminated.
+    void finalise_hts_files(const utils::HtsFile::ProgressCallback& progress_callback);
+
+    // Every file written, in manifest order. Only complete after finalise_hts_files().
+    std::vector<std::filesystem::path> get_output_files() const;
+
+private:
+    struct Shard {
+        std::unique_ptr<utils::HtsFile> file;
+        std::filesystem::path path;
+        size_t part{0};
+        size_t num_reads{0};
+        size_t num_bytes{0};
+    };
+
+    struct ManifestEntry {
+        std::filesystem::path path;
+        size_t shard;
+        size_t part;
+        size_t num_reads;
+    };
+
+    void input_thread_fn();
+    void write(size_t shard_idx, bam1_t* record);
+    void open_file(size_t shard_idx);
+    void close_file(size_t shard_idx, const utils::HtsFile::ProgressCallback& progress_callback);
+    bool needs_rollover(const Shard& shard) const;
+    std::string file_extension() const;
+    void count_read(bam1_t* record);
+
+    const Options m_options;
+    const std::string m_gpu_names;
+    std::filesystem::path m_output_dir;
+    SamHdrPtr m_header;
+
+    // Each input thread claims one shard when it starts.
+    std::atomic<size_t> m_next_shard{0};
+    std::vector<Shard> m_shards;
+
+    mutable std::mutex m_manifest_mutex;
+    std::vector<ManifestEntry> m_manifest;
+
+    // Split reads from the same parent can land in different shards, so this is shared.
+    std::mutex m_read_ids_mutex;
+    utils::ReadIdSet m_processed_read_ids;
+    std::atomic<size_t> m_unique_simplex_reads_written{0};
+    std::atomic<size_t> m_duplex_reads_written{0};
+    std::atomic<size_t> m_records_written{0};
+    std::atomic<size_t> m_files_rolled_over{0};
+};
+
+}  // namespace dorado
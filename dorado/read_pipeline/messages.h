@@ -6,9 +6,11 @@
 #include <ATen/core/TensorBody.h>
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <variant>
@@ -32,10 +34,18 @@ struct Attributes {
 }  // namespace details
 
 class ClientInfo;
+class ReadTrace;
+
+namespace utils {
+class BamRecordBuilder;
+class CompressedSignal;
+}  // namespace utils
 
 class ReadCommon {
 public:
     at::Tensor raw_data;  // Loaded from source file
+    // Holds the signal in place of raw_data while it's compressed. See compress_raw_data().
+    std::shared_ptr<const utils::CompressedSignal> compressed_raw_data;
 
     int model_stride{-1};  // The down sampling factor of the model
 
@@ -93,10 +103,24 @@ public:
     // Number of samples which have been trimmed from the raw read.
     uint64_t num_trimmed_samples = 0;
 
+    // When the file holding the read was completed, for reads loaded by watching a directory.
+    std::optional<std::chrono::steady_clock::time_point> file_arrival_time;
+
+    // Set if the read is sampled by ReadTracer. Shared with copies and subreads of the read.
+    std::shared_ptr<ReadTrace> trace;
+
     bool is_duplex{false};
 
     size_t get_raw_data_samples() const { return is_duplex ? raw_data.size(1) : raw_data.size(0); }
 
+    // Swaps raw_data for a compressed copy, for a read which is held for a while without its
+    // signal being used, and back again. |shift| and |scale| are what the signal was normalised
+    // with. Signals which can't be compressed are left as they are.
+    void compress_raw_data(float shift, float scale);
+    void decompress_raw_data();
+    // Bytes held by the signal, whether it's compressed or not.
+    size_t get_raw_data_bytes() const;
+
     // `True` if the basecall model is an RNA model
     bool is_rna_model{false};
 
@@ -124,9 +148,18 @@ public:
     float model_q_scale{0.0f};
 
 private:
-    void generate_duplex_read_tags(bam1_t*) const;
-    void generate_read_tags(bam1_t* aln, bool emit_moves, bool is_duplex_parent) const;
-    void generate_modbase_tags(bam1_t* aln, uint8_t threshold) const;
+    // String and array tag values are written to the caller's storage, which must outlive the
+    // builder's build() call.
+    void generate_duplex_read_tags(utils::BamRecordBuilder& builder,
+                                   const std::string& read_group) const;
+    void generate_read_tags(utils::BamRecordBuilder& builder,
+                            bool emit_moves,
+                            bool is_duplex_parent,
+                            const std::string& read_group) const;
+    void generate_modbase_tags(utils::BamRecordBuilder& builder,
+                               uint8_t threshold,
+                               std::string& modbase_string,
+                               std::vector<uint8_t>& modbase_prob) const;
     std::string generate_read_group() const;
 };
 
@@ -208,6 +241,16 @@ class BamMessage {
 public:
     BamPtr bam_ptr;
     std::shared_ptr<ClientInfo> client_info;
+    // The trace of the read the record came from, if it's sampled.
+    std::shared_ptr<ReadTrace> trace{};
+};
+
+// Records passed between nodes as a single message, so the queueing cost of a hop is paid once
+// per batch rather than once per record. Nodes which don't take batches are sent the records
+// one by one, see MessageSink::enable_batch_input().
+class BamBatch {
+public:
+    std::vector<BamMessage> messages;
 };
 
 struct Overlap {
@@ -281,16 +324,22 @@ struct CorrectionAlignments {
 // - a BamMessage object, composite class holding a BamPtr (which represents a raw BAM alignment record) and ClientInfo
 // - a ReadPair object, which represents a pair of reads for duplex calling
 // - a CorrectionAlignments, which holds alignment information per read to be corrected
+// - a BamBatch, which holds several BamMessages
 // To add more message types, simply add them to the list of types in the std::variant.
 using Message = std::variant<SimplexReadPtr,
                              BamMessage,
                              ReadPair,
                              CacheFlushMessage,
                              DuplexReadPtr,
-                             CorrectionAlignments>;
+                             CorrectionAlignments,
+                             BamBatch>;
 
 bool is_read_message(const Message& message);
 
+bool is_batch_message(const Message& message);
+// Splits a batch message into a message for each of its records.
+std::vector<Message> split_batch_message(Message&& message);
+
 ReadCommon& get_read_common_data(Message& message);
 const ReadCommon& get_read_common_data(const Message& message);
 
@@ -55,6 +55,7 @@ auto get_num_reads_written(const stats::NamedStats& stats) {
     };
 
     return size_t_stat("HtsWriter.unique_simplex_reads_written") +
+           size_t_stat("ShardedHtsWriter.unique_simplex_reads_written") +
            size_t_stat("BarcodeDemuxerNode.demuxed_reads_written");
 }
 
@@ -1,13 +1,33 @@
 #include "stitch.h"
 
 #include "ReadPipeline.h"
+#include "basecall/decode/Decoder.h"
 #include "utils/math_utils.h"
 
 #include <algorithm>
 #include <cassert>
+#include <numeric>
+#include <stdexcept>
 
 namespace dorado::utils {
 
+void unpack_decoded_chunk(const basecall::decode::DecodedChunk& decoded,
+                          size_t offset,
+                          size_t size,
+                          size_t stride,
+                          Chunk& chunk) {
+    assert(offset % stride == 0 && size % stride == 0);
+    assert((offset + size) / stride <= decoded.moves.size());
+    const auto moves_begin = std::next(decoded.moves.begin(), offset / stride);
+    const auto moves_end = std::next(moves_begin, size / stride);
+    const auto bases_begin = std::accumulate(decoded.moves.begin(), moves_begin, size_t(0));
+    const auto num_bases = std::accumulate(moves_begin, moves_end, size_t(0));
+    chunk.moves.assign(moves_begin, moves_end);
+    chunk.seq = decoded.sequence.substr(bases_begin, num_bases);
+    chunk.qstring = decoded.qstring.substr(bases_begin, num_bases);
+    chunk.raw_chunk_size = size;
+}
+
 void stitch_chunks(ReadCommon& read_common,
                    const std::vector<std::unique_ptr<Chunk>>& called_chunks) {
     assert(static_cast<int>(div_round_closest(called_chunks[0]->raw_chunk_size,
@@ -86,4 +106,125 @@ void stitch_chunks(ReadCommon& read_common,
     }
 }
 
+ChunkStitcher::ChunkStitcher(std::vector<size_t> chunk_offsets,
+                             size_t chunk_size,
+                             int model_stride)
+        : m_chunk_offsets(std::move(chunk_offsets)),
+          m_chunk_size(chunk_size),
+          m_model_stride(model_stride),
+          m_pending(m_chunk_offsets.size()) {}
+
+ChunkStitcher::Segment ChunkStitcher::trim_chunk(size_t chunk_idx, Chunk& chunk) const {
+    assert(static_cast<int>(div_round_closest(chunk.raw_chunk_size, chunk.moves.size())) ==
+           m_model_stride);
+    const size_t num_chunks = m_chunk_offsets.size();
+
+    // Half of each overlap (rounded down) is taken from the end of the earlier chunk, and the
+    // remainder from the start of the later one, as in stitch_chunks.
+    auto overlap_down_sampled = [this](size_t idx) {
+        const auto overlap = int((m_chunk_size + m_chunk_offsets[idx]) - m_chunk_offsets[idx + 1]);
+        assert(overlap % m_model_stride == 0);
+        return overlap / m_model_stride;
+    };
+    int mid_point_front = 0;
+    if (chunk_idx > 0) {
+        const int prev_overlap = overlap_down_sampled(chunk_idx - 1);
+        mid_point_front = prev_overlap - prev_overlap / 2;
+    }
+
+    Segment segment;
+    const int start_pos = std::accumulate(chunk.moves.begin(),
+                                          std::next(chunk.moves.begin(), mid_point_front), 0);
+    if (chunk_idx + 1 < num_chunks) {
+        const int mid_point_rear = overlap_down_sampled(chunk_idx) / 2;
+        const int bases_to_trim =
+                std::accumulate(std::prev(chunk.moves.end(), mid_point_rear), chunk.moves.end(), 0);
+        const int end_pos = int(chunk.seq.size()) - bases_to_trim;
+        chunk.moves.erase(std::prev(chunk.moves.end(), mid_point_rear), chunk.moves.end());
+        chunk.seq.erase(end_pos);
+        chunk.qstring.erase(end_pos);
+    }
+    // Single chunk reads are trimmed to the read length in finalise().
+    chunk.moves.erase(chunk.moves.begin(), std::next(chunk.moves.begin(), mid_point_front));
+    chunk.seq.erase(0, start_pos);
+    chunk.qstring.erase(0, start_pos);
+
+    segment.seq = std::move(chunk.seq);
+    segment.qstring = std::move(chunk.qstring);
+    segment.moves = std::move(chunk.moves);
+    return segment;
+}
+
+void ChunkStitcher::append(Segment& segment) {
+    if (m_num_appended == 0) {
+        m_seq = std::move(segment.seq);
+        m_qstring = std::move(segment.qstring);
+        m_moves = std::move(segment.moves);
+    } else {
+        m_seq += segment.seq;
+        m_qstring += segment.qstring;
+        m_moves.insert(m_moves.end(), segment.moves.begin(), segment.moves.end());
+    }
+    ++m_num_appended;
+}
+
+bool ChunkStitcher::add_chunk(size_t chunk_idx, Chunk& chunk) {
+    if (chunk_idx >= m_pending.size() || chunk_idx < m_num_appended || m_pending[chunk_idx]) {
+        throw std::runtime_error("ChunkStitcher: unexpected chunk index " +
+                                 std::to_string(chunk_idx));
+    }
+    auto segment = trim_chunk(chunk_idx, chunk);
+    ++m_num_added;
+
+    if (chunk_idx != m_num_appended) {
+        // Hold onto it until its predecessors arrive.
+        m_pending_bytes += segment.num_bytes();
+        m_pending[chunk_idx] = std::move(segment);
+        return m_num_added == m_pending.size();
+    }
+
+    append(segment);
+    // Flush any chunks that were waiting on this one.
+    while (m_num_appended < m_pending.size() && m_pending[m_num_appended]) {
+        auto& pending = *m_pending[m_num_appended];
+        m_pending_bytes -= pending.num_bytes();
+        append(pending);
+        m_pending[m_num_appended - 1].reset();
+    }
+    return m_num_added == m_pending.size();
+}
+
+void ChunkStitcher::finalise(ReadCommon& read_common) {
+    if (m_num_appended != m_pending.size()) {
+        throw std::runtime_error("ChunkStitcher: finalising incomplete read " +
+                                 read_common.read_id);
+    }
+
+    if (m_pending.size() == 1) {
+        // shorten the sequence, qstring & moves where the read is shorter than chunksize
+        int last_index_in_moves_to_keep =
+                int(read_common.get_raw_data_samples() / read_common.model_stride);
+        m_moves.resize(last_index_in_moves_to_keep);
+        int end = std::accumulate(m_moves.begin(), m_moves.end(), 0);
+        m_seq.resize(std::min(m_seq.size(), size_t(end)));
+        m_qstring.resize(std::min(m_qstring.size(), size_t(end)));
+    }
+
+    read_common.seq = std::move(m_seq);
+    read_common.qstring = std::move(m_qstring);
+    read_common.moves = std::move(m_moves);
+
+    // remove partial stride overhang
+    if (static_cast<int>(read_common.moves.size()) >
+        static_cast<int>(read_common.get_raw_data_samples() / read_common.model_stride)) {
+        if (read_common.moves.back() == 1) {
+            read_common.seq.pop_back();
+            read_common.qstring.pop_back();
+        }
+        read_common.moves.pop_back();
+        assert(size_t(std::accumulate(read_common.moves.begin(), read_common.moves.end(), 0)) ==
+               read_common.seq.size());
+    }
+}
+
 }  // namespace dorado::utils
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -8,6 +11,10 @@ namespace dorado {
 class ReadCommon;
 }  // namespace dorado
 
+namespace dorado::basecall::decode {
+struct DecodedChunk;
+}  // namespace dorado::basecall::decode
+
 namespace dorado::utils {
 
 // A single chunk
@@ -23,8 +30,65 @@ struct Chunk {
     std::vector<uint8_t> moves;  // For stitching.
 };
 
+// Copies the part of a decoded model chunk covering samples [offset, offset + size) of the
+// model input into chunk, as though it had been called on its own.  offset and size must be
+// multiples of the model stride.
+void unpack_decoded_chunk(const basecall::decode::DecodedChunk& decoded,
+                          size_t offset,
+                          size_t size,
+                          size_t stride,
+                          Chunk& chunk);
+
 // Given a read and its unstitched chunks, stitch the chunks (accounting for overlap) and assign basecalled read and
 // qstring to Read
 void stitch_chunks(ReadCommon& read, const std::vector<std::unique_ptr<Chunk>>& called_chunks);
 
+// Stitches the chunks of a read as they are called, giving the same result as stitch_chunks.
+// Each chunk is trimmed to its share of the overlaps with its neighbours as soon as it is
+// added, and appended to the stitched read once all preceding chunks have been, so only
+// chunks called out of order are held onto.
+// Not thread safe.
+class ChunkStitcher {
+public:
+    // chunk_offsets are the input offsets of every chunk of the read, in order.
+    ChunkStitcher(std::vector<size_t> chunk_offsets, size_t chunk_size, int model_stride);
+
+    // Takes the results of the called chunk with the given index, which must not have been
+    // added before.  Returns true once every chunk of the read has been added.
+    bool add_chunk(size_t chunk_idx, Chunk& chunk);
+
+    // Moves the stitched seq, qstring and moves into the read.  All chunks must have been added.
+    void finalise(ReadCommon& read);
+
+    // Bytes of trimmed chunk results waiting for preceding chunks to be added.
+    size_t pending_bytes() const { return m_pending_bytes; }
+
+private:
+    struct Segment {
+        std::string seq;
+        std::string qstring;
+        std::vector<uint8_t> moves;
+
+        size_t num_bytes() const { return seq.size() + qstring.size() + moves.size(); }
+    };
+
+    Segment trim_chunk(size_t chunk_idx, Chunk& chunk) const;
+    void append(Segment& segment);
+
+    const std::vector<size_t> m_chunk_offsets;
+    const size_t m_chunk_size;
+    const int m_model_stride;
+
+    // Trimmed chunks which arrived before their predecessors.
+    std::vector<std::optional<Segment>> m_pending;
+    size_t m_pending_bytes = 0;
+    // Number of chunks added, and number of those appended to the stitched read.
+    size_t m_num_added = 0;
+    size_t m_num_appended = 0;
+
+    std::string m_seq;
+    std::string m_qstring;
+    std::vector<uint8_t> m_moves;
+};
+
 }  // namespace dorado::utils
@@ -8,7 +8,6 @@
 #include "utils/sequence_utils.h"
 #include "utils/uuid_utils.h"
 
-#include <ATen/TensorIndexing.h>
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
@@ -121,7 +120,6 @@ float qscore_mean(const std::string& qstring, splitter::PosRange r) {
 
 struct DuplexReadSplitter::ExtRead {
     SimplexReadPtr read;
-    at::Tensor data_as_float32;
     std::vector<uint64_t> move_sums;
     splitter::PosRanges possible_pore_regions;
 };
@@ -132,7 +130,6 @@ DuplexReadSplitter::ExtRead DuplexReadSplitter::create_ext_read(SimplexReadPtr r
     ext_read.move_sums = utils::move_cum_sums(ext_read.read->read_common.moves);
     assert(!ext_read.move_sums.empty());
     assert(ext_read.move_sums.back() == ext_read.read->read_common.seq.length());
-    ext_read.data_as_float32 = ext_read.read->read_common.raw_data.to(at::kFloat);
     ext_read.possible_pore_regions = possible_pore_regions(ext_read);
     return ext_read;
 }
@@ -140,9 +137,9 @@ DuplexReadSplitter::ExtRead DuplexReadSplitter::create_ext_read(SimplexReadPtr r
 PosRanges DuplexReadSplitter::possible_pore_regions(const DuplexReadSplitter::ExtRead& read) const {
     spdlog::trace("Analyzing signal in read {}", read.read->read_common.read_id);
 
-    auto pore_sample_ranges =
-            detect_pore_signal<float>(read.data_as_float32, m_settings.pore_thr,
-                                      m_settings.pore_cl_dist, m_settings.expect_pore_prefix);
+    auto pore_sample_ranges = detect_pore_signal_16bit(read.read->read_common.raw_data,
+                                                       m_settings.pore_thr, m_settings.pore_cl_dist,
+                                                       m_settings.expect_pore_prefix);
 
     std::vector<std::pair<float, PosRange>> candidate_regions;
     for (auto pore_sample_range : pore_sample_ranges) {
@@ -315,9 +312,9 @@ PosRanges DuplexReadSplitter::find_muA_adapter_spikes(const ExtRead& read) const
         const auto spike_search_begin_s =
                 from_basespace(adapter_match.first - max_spike_adapter_dist);
         const auto spike_search_end_s = from_basespace(muA_range.first);
-        const auto search_span = read.data_as_float32.index(
-                {at::indexing::Slice(spike_search_begin_s, spike_search_end_s)});
-        const auto spike_peak_s = spike_search_begin_s + search_span.argmax().item().toLong();
+        const auto spike_peak_s = argmax_16bit(read.read->read_common.raw_data,
+                                               static_cast<uint64_t>(spike_search_begin_s),
+                                               static_cast<uint64_t>(spike_search_end_s));
         // Convert back to base space.
         const auto spike_begin = to_basespace(spike_peak_s);
         const auto spike_end = spike_begin + 5;
@@ -2,9 +2,15 @@
 
 #include "read_pipeline/ReadPipeline.h"
 #include "read_pipeline/read_utils.h"
+#include "utils/simd.h"
 #include "utils/time_utils.h"
 
 #include <ATen/TensorIndexing.h>
+#include <c10/util/Half.h>
+
+#include <array>
+#include <cmath>
+#include <stdexcept>
 
 namespace dorado::splitter {
 namespace {
@@ -23,6 +29,145 @@ __attribute__((optimize("O0")))
         subread->read_common.parent_read_id = read.read_common.read_id;
     }
 }
+
+// View of a 1D signal tensor holding 16 bit samples, either int16 or float16.
+struct RawSignal16 {
+    const int16_t* data;
+    uint64_t size;
+    bool is_half;
+};
+
+RawSignal16 raw_signal_16bit(const at::Tensor& signal) {
+    const auto dtype = signal.scalar_type();
+    if (dtype != at::kShort && dtype != at::kHalf) {
+        throw std::runtime_error("Expected int16 or float16 signal");
+    }
+    if (signal.dim() != 1 || !signal.is_contiguous()) {
+        throw std::runtime_error("Expected contiguous 1D signal");
+    }
+    return {static_cast<const int16_t*>(signal.data_ptr()), uint64_t(signal.size(0)),
+            dtype == at::kHalf};
+}
+
+// Maps a 16 bit sample onto an int16 key whose signed integer ordering matches the ordering of
+// the sample values. int16 samples are their own key.  Float16 is sign-magnitude, so the
+// magnitude bits of negative values are flipped to make larger magnitudes compare lower.
+inline int16_t ordered_key(int16_t bits, bool is_half) {
+    if (is_half && bits < 0) {
+        return static_cast<int16_t>(bits ^ 0x7fff);
+    }
+    return bits;
+}
+
+float sample_value(int16_t bits, bool is_half) {
+    if (is_half) {
+        return static_cast<float>(c10::Half(static_cast<uint16_t>(bits), c10::Half::from_bits()));
+    }
+    return static_cast<float>(bits);
+}
+
+// Returns the largest key whose sample value is <= threshold, so that for any sample
+// (value > threshold) <=> (key > threshold_key).
+int16_t threshold_key(float threshold, bool is_half) {
+    if (is_half) {
+        const c10::Half threshold_half(threshold);
+        auto key = ordered_key(static_cast<int16_t>(threshold_half.x), true);
+        if (static_cast<float>(threshold_half) > threshold) {
+            // Rounded up on conversion, so step down to the previous representable value.
+            --key;
+        }
+        return key;
+    }
+    return static_cast<int16_t>(std::clamp(std::floor(threshold),
+                                            float(std::numeric_limits<int16_t>::min()),
+                                            float(std::numeric_limits<int16_t>::max())));
+}
+
+// Returns the index of the first sample in [begin, end) whose key is above key_thr, or end.
+#if ENABLE_AVX2_IMPL
+__attribute__((target("default")))
+#endif
+uint64_t
+find_next_above(const int16_t* data, uint64_t begin, uint64_t end, int16_t key_thr, bool is_half) {
+    for (uint64_t i = begin; i < end; ++i) {
+        if (ordered_key(data[i], is_half) > key_thr) {
+            return i;
+        }
+    }
+    return end;
+}
+
+#if ENABLE_AVX2_IMPL
+// AVX2 implementation which tests 16 samples per iteration.  Pore signal is rare, so almost all
+// of the signal is skipped by the vectorised loop.
+__attribute__((target("avx2"))) uint64_t
+find_next_above(const int16_t* data, uint64_t begin, uint64_t end, int16_t key_thr, bool is_half) {
+    static constexpr uint64_t kUnroll = 16;
+    const __m256i key_thr_v = _mm256_set1_epi16(key_thr);
+    const __m256i flip_bits = _mm256_set1_epi16(is_half ? 0x7fff : 0);
+
+    uint64_t i = begin;
+    for (; i + kUnroll <= end; i += kUnroll) {
+        const __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        // Arithmetic shift of the sign bit selects the lanes holding negative values.
+        const __m256i keys = _mm256_xor_si256(
+                bits, _mm256_and_si256(_mm256_srai_epi16(bits, 15), flip_bits));
+        const auto mask = static_cast<uint32_t>(
+                _mm256_movemask_epi8(_mm256_cmpgt_epi16(keys, key_thr_v)));
+        if (mask != 0) {
+            // Each 16 bit lane contributes 2 bits to the byte mask.
+            return i + __builtin_ctz(mask) / 2;
+        }
+    }
+    for (; i < end; ++i) {
+        if (ordered_key(data[i], is_half) > key_thr) {
+            return i;
+        }
+    }
+    return end;
+}
+#endif
+
+// Returns the maximal key of the samples in [begin, end), which must be non-empty.
+#if ENABLE_AVX2_IMPL
+__attribute__((target("default")))
+#endif
+int16_t
+max_key(const int16_t* data, uint64_t begin, uint64_t end, bool is_half) {
+    int16_t result = std::numeric_limits<int16_t>::min();
+    for (uint64_t i = begin; i < end; ++i) {
+        result = std::max(result, ordered_key(data[i], is_half));
+    }
+    return result;
+}
+
+#if ENABLE_AVX2_IMPL
+__attribute__((target("avx2"))) int16_t max_key(const int16_t* data,
+                                                uint64_t begin,
+                                                uint64_t end,
+                                                bool is_half) {
+    static constexpr uint64_t kUnroll = 16;
+    const __m256i flip_bits = _mm256_set1_epi16(is_half ? 0x7fff : 0);
+    __m256i max_v = _mm256_set1_epi16(std::numeric_limits<int16_t>::min());
+
+    uint64_t i = begin;
+    for (; i + kUnroll <= end; i += kUnroll) {
+        const __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i keys = _mm256_xor_si256(
+                bits, _mm256_and_si256(_mm256_srai_epi16(bits, 15), flip_bits));
+        max_v = _mm256_max_epi16(max_v, keys);
+    }
+
+    std::array<int16_t, kUnroll> lanes;
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes.data()), max_v);
+    int16_t result = *std::max_element(lanes.begin(), lanes.end());
+    for (; i < end; ++i) {
+        result = std::max(result, ordered_key(data[i], is_half));
+    }
+    return result;
+}
+#endif
+
 }  // namespace
 
 SimplexReadPtr subread(const SimplexRead& read,
@@ -100,4 +245,65 @@ PosRanges merge_ranges(const PosRanges& ranges, uint64_t merge_dist) {
     return merged;
 }
 
+SampleRanges<float> detect_pore_signal_16bit(const at::Tensor& signal,
+                                             float threshold,
+                                             uint64_t cluster_dist,
+                                             uint64_t ignore_prefix) {
+    const auto raw = raw_signal_16bit(signal);
+    const auto key_thr = threshold_key(threshold, raw.is_half);
+    auto next_above = [&](uint64_t from) {
+        return find_next_above(raw.data, from, raw.size, key_thr, raw.is_half);
+    };
+
+    SampleRanges<float> ans;
+    int64_t cl_start = -1;
+    int64_t cl_end = -1;
+
+    int16_t cl_max_key = std::numeric_limits<int16_t>::min();
+    int64_t cl_argmax = -1;
+    for (auto i = next_above(ignore_prefix); i < raw.size; i = next_above(i + 1)) {
+        //check if we need to start new cluster
+        if (cl_end == -1 || i > uint64_t(cl_end) + cluster_dist) {
+            //report previous cluster
+            if (cl_end != -1) {
+                assert(cl_start != -1);
+                ans.emplace_back(cl_start, cl_end, cl_argmax,
+                                 sample_value(raw.data[cl_argmax], raw.is_half));
+            }
+            cl_start = i;
+            cl_max_key = std::numeric_limits<int16_t>::min();
+        }
+        const auto key = ordered_key(raw.data[i], raw.is_half);
+        if (key >= cl_max_key) {
+            cl_max_key = key;
+            cl_argmax = i;
+        }
+        cl_end = i + 1;
+    }
+    //report last cluster
+    if (cl_end != -1) {
+        assert(cl_start != -1);
+        assert(uint64_t(cl_start) < raw.size && uint64_t(cl_end) <= raw.size);
+        ans.emplace_back(cl_start, cl_end, cl_argmax,
+                         sample_value(raw.data[cl_argmax], raw.is_half));
+    }
+
+    return ans;
+}
+
+uint64_t argmax_16bit(const at::Tensor& signal, uint64_t begin, uint64_t end) {
+    const auto raw = raw_signal_16bit(signal);
+    end = std::min(end, raw.size);
+    if (begin >= end) {
+        throw std::runtime_error("argmax_16bit: empty sample range");
+    }
+
+    const auto max_sample_key = max_key(raw.data, begin, end, raw.is_half);
+    if (max_sample_key == std::numeric_limits<int16_t>::min()) {
+        return begin;
+    }
+    // The first sample above (max - 1) is the first one equal to the max.
+    return find_next_above(raw.data, begin, end, int16_t(max_sample_key - 1), raw.is_half);
+}
+
 }  // namespace dorado::splitter
@@ -89,4 +89,16 @@ SampleRanges<T> detect_pore_signal(const at::Tensor& signal,
     return ans;
 }
 
+// Equivalent of detect_pore_signal<float>() which scans the raw 16 bit signal buffer directly
+// (dtype int16, or float16 as produced by ScalerNode) rather than requiring a float32 copy of
+// the whole signal. Samples below the threshold are skipped 16 at a time where AVX2 is available.
+SampleRanges<float> detect_pore_signal_16bit(const at::Tensor& signal,
+                                             float threshold,
+                                             uint64_t cluster_dist,
+                                             uint64_t ignore_prefix);
+
+// Returns the index of the first maximal sample of the 16 bit signal within [begin, end),
+// matching at::argmax() on the corresponding float32 signal.
+uint64_t argmax_16bit(const at::Tensor& signal, uint64_t begin, uint64_t end);
+
 }  // namespace dorado::splitter
@@ -73,9 +73,12 @@ void SummaryData::set_fields(FieldFlags flags) {
     m_field_flags = flags;
 }
 
+void SummaryData::set_threads(int threads) { m_threads = threads; }
+
 bool SummaryData::process_file(const std::string& filename, std::ostream& writer) {
     SigIntHandler sig_handler;
     HtsReader reader(filename, std::nullopt);
+    reader.enable_threads(m_threads);
     m_field_flags = GENERAL_FIELDS | BARCODING_FIELDS;
     if (reader.is_aligned) {
         m_field_flags |= ALIGNMENT_FIELDS;
@@ -103,6 +106,7 @@ bool SummaryData::process_tree(const std::string& folder, std::ostream& writer)
     write_header(writer);
     for (const auto& read_file : files) {
         HtsReader reader(read_file, std::nullopt);
+        reader.enable_threads(m_threads);
         auto read_group_exp_start_time = utils::get_read_group_info(reader.header, "DT");
         bool ok = write_rows_from_reader(reader, writer, read_group_exp_start_time);
         if (!ok) {
@@ -21,6 +21,8 @@ public:
 
     void set_separator(char s);
     void set_fields(FieldFlags flags);
+    /// Threads to decompress BGZF input with. 0, the default, decompresses on the calling thread.
+    void set_threads(int threads);
 
     /// This will automatically set the fields based on the contents of the file.
     bool process_file(const std::string& filename, std::ostream& writer);
@@ -36,6 +38,7 @@ private:
 
     char m_separator{'\t'};
     FieldFlags m_field_flags{};
+    int m_threads{0};
 
     void write_header(std::ostream& writer);
     bool write_rows_from_reader(HtsReader& reader,
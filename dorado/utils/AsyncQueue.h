@@ -8,6 +8,7 @@
 #include <queue>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace dorado::utils {
 
@@ -138,6 +139,35 @@ public:
         return AsyncQueueStatus::Success;
     }
 
+    // Adds all of |items| to the queue, in order, taking the lock once for as many as there's
+    // space for rather than once per item.
+    // If the queue is full, blocks until there is space or terminate() is called.
+    // If terminate() was called, the items not yet added are dropped and
+    // AsyncQueueStatus::Terminate is returned.
+    AsyncQueueStatus try_push_all(std::vector<Item>&& items) {
+        size_t num_added = 0;
+        while (num_added < items.size()) {
+            std::unique_lock lock(m_mutex);
+            m_not_full_cv.wait(lock,
+                               [this] { return m_items.size() < m_capacity || m_terminate; });
+            if (m_terminate) {
+                return AsyncQueueStatus::Terminate;
+            }
+
+            const size_t num_to_add =
+                    std::min(items.size() - num_added, m_capacity - m_items.size());
+            for (size_t i = 0; i < num_to_add; ++i) {
+                m_items.push(std::move(items[num_added++]));
+            }
+            m_num_pushes += num_to_add;
+
+            // Several items may now be available.
+            lock.unlock();
+            m_not_empty_cv.notify_all();
+        }
+        return AsyncQueueStatus::Success;
+    }
+
     // Obtains the next item in the queue, potentially timing out.
     // If queue is empty:
     // If timeout is reached, but we are not terminating, returns AsyncQueueStatus::Timeout.
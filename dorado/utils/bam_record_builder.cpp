@@ -0,0 +1,162 @@
+#include "bam_record_builder.h"
+
+#include <htslib/hts_endian.h>
+#include <htslib/sam.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Tag name and type, as written by bam_aux_append().
+constexpr size_t TAG_HEADER_SIZE = 3;
+// Array subtype and element count, as written by bam_aux_update_array().
+constexpr size_t ARRAY_HEADER_SIZE = 5;
+
+}  // namespace
+
+namespace dorado::utils {
+
+BamRecordBuilder::BamRecordBuilder() {
+    // Enough for every tag we write for a read.
+    m_tags.reserve(24);
+}
+
+BamRecordBuilder::Tag& BamRecordBuilder::add_tag(const char* tag, char type) {
+    auto& entry = m_tags.emplace_back();
+    entry.name[0] = tag[0];
+    entry.name[1] = tag[1];
+    entry.type = type;
+    entry.subtype = 0;
+    entry.first = 0;
+    entry.has_first = false;
+    entry.data = nullptr;
+    entry.size = 0;
+    return entry;
+}
+
+void BamRecordBuilder::add_int_tag(const char* tag, int32_t value) {
+    auto& entry = add_tag(tag, 'i');
+    std::memcpy(entry.value, &value, sizeof(value));
+    m_aux_size += TAG_HEADER_SIZE + sizeof(value);
+}
+
+void BamRecordBuilder::add_uint_tag(const char* tag, uint32_t value) {
+    // Written as 'i' to match how these tags have always been emitted.
+    auto& entry = add_tag(tag, 'i');
+    std::memcpy(entry.value, &value, sizeof(value));
+    m_aux_size += TAG_HEADER_SIZE + sizeof(value);
+}
+
+void BamRecordBuilder::add_float_tag(const char* tag, float value) {
+    auto& entry = add_tag(tag, 'f');
+    std::memcpy(entry.value, &value, sizeof(value));
+    m_aux_size += TAG_HEADER_SIZE + sizeof(value);
+}
+
+void BamRecordBuilder::add_string_tag(const char* tag, std::string_view value) {
+    auto& entry = add_tag(tag, 'Z');
+    entry.data = reinterpret_cast<const uint8_t*>(value.data());
+    entry.size = value.size();
+    m_aux_size += TAG_HEADER_SIZE + value.size() + 1;
+}
+
+void BamRecordBuilder::add_byte_array_tag(const char* tag,
+                                          char subtype,
+                                          const uint8_t* data,
+                                          size_t count) {
+    if (subtype != 'c' && subtype != 'C') {
+        throw std::runtime_error(std::string("Unsupported byte array subtype: ") + subtype);
+    }
+    auto& entry = add_tag(tag, 'B');
+    entry.subtype = subtype;
+    entry.data = data;
+    entry.size = count;
+    m_aux_size += TAG_HEADER_SIZE + ARRAY_HEADER_SIZE + count;
+}
+
+void BamRecordBuilder::add_byte_array_tag(const char* tag,
+                                          char subtype,
+                                          uint8_t first,
+                                          const uint8_t* data,
+                                          size_t count) {
+    add_byte_array_tag(tag, subtype, data, count);
+    auto& entry = m_tags.back();
+    entry.first = first;
+    entry.has_first = true;
+    m_aux_size += 1;
+}
+
+uint8_t* BamRecordBuilder::write_tag(const Tag& tag, uint8_t* dest) {
+    *dest++ = tag.name[0];
+    *dest++ = tag.name[1];
+    *dest++ = tag.type;
+    switch (tag.type) {
+    case 'i':
+    case 'f':
+        std::memcpy(dest, tag.value, sizeof(tag.value));
+        return dest + sizeof(tag.value);
+    case 'Z':
+        if (tag.size > 0) {
+            std::memcpy(dest, tag.data, tag.size);
+        }
+        dest[tag.size] = '\0';
+        return dest + tag.size + 1;
+    default: {
+        const uint32_t count = uint32_t(tag.size + (tag.has_first ? 1 : 0));
+        *dest++ = tag.subtype;
+        u32_to_le(count, dest);
+        dest += sizeof(count);
+        if (tag.has_first) {
+            *dest++ = tag.first;
+        }
+        if (tag.size > 0) {
+            std::memcpy(dest, tag.data, tag.size);
+        }
+        return dest + tag.size;
+    }
+    }
+}
+
+BamPtr BamRecordBuilder::build(std::string_view read_id,
+                               std::string_view seq,
+                               std::string_view qstring,
+                               BamPtr recycled) {
+    if (seq.size() != qstring.size()) {
+        throw std::runtime_error("Sequence and qstring lengths differ for read " +
+                                 std::string(read_id));
+    }
+
+    BamPtr record = recycled ? std::move(recycled) : BamPtr(bam_init1());
+    const uint32_t flags = 4;     // 4 = UNMAPPED
+    const int leftmost_pos = -1;  // UNMAPPED - will be written as 0
+    const int map_q = 0;          // UNMAPPED
+    const int next_pos = -1;      // UNMAPPED - will be written as 0
+
+    // Reserves room for the aux data, so appending the tags below never reallocates.
+    // Qualities are filled in afterwards, straight from the qstring.
+    if (bam_set1(record.get(), read_id.size(), read_id.data(), uint16_t(flags), -1, leftmost_pos,
+                 uint8_t(map_q), 0, nullptr, -1, next_pos, 0, seq.size(), seq.data(), nullptr,
+                 m_aux_size) < 0) {
+        throw std::runtime_error("Failed to create BAM record for read " + std::string(read_id));
+    }
+
+    uint8_t* qual = bam_get_qual(record.get());
+    for (size_t i = 0; i < qstring.size(); ++i) {
+        qual[i] = uint8_t(qstring[i] - 33);
+    }
+
+    uint8_t* const aux_begin = record->data + record->l_data;
+    uint8_t* aux_end = aux_begin;
+    for (const auto& tag : m_tags) {
+        aux_end = write_tag(tag, aux_end);
+    }
+    record->l_data += int(aux_end - aux_begin);
+
+    m_tags.clear();
+    m_aux_size = 0;
+    return record;
+}
+
+}  // namespace dorado::utils
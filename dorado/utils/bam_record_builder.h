@@ -0,0 +1,69 @@
+#pragma once
+
+#include "types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace dorado::utils {
+
+// Builds an unmapped BAM record together with its aux tags using a single allocation.
+//
+// Tags are queued with the add_*_tag() calls and only written by build(), which sizes the record
+// for the read name, sequence, qualities and every queued tag before encoding them in one pass.
+// The resulting record is byte-identical to one made by bam_set1() followed by bam_aux_append()
+// / bam_aux_update_array() for each tag in the order they were added.
+//
+// String and array tags refer to the caller's data, which must stay alive until build() returns.
+class BamRecordBuilder {
+public:
+    BamRecordBuilder();
+
+    void add_int_tag(const char* tag, int32_t value);
+    void add_uint_tag(const char* tag, uint32_t value);
+    void add_float_tag(const char* tag, float value);
+    // Written with a trailing NUL, as for 'Z' tags.
+    void add_string_tag(const char* tag, std::string_view value);
+    // Byte array ('B' tag with subtype 'c' or 'C'). If |first| is given it is written ahead of
+    // |data|, e.g. for the stride that leads the move table.
+    void add_byte_array_tag(const char* tag, char subtype, const uint8_t* data, size_t count);
+    void add_byte_array_tag(const char* tag,
+                            char subtype,
+                            uint8_t first,
+                            const uint8_t* data,
+                            size_t count);
+
+    // Size in bytes of the aux data queued so far.
+    size_t aux_size() const { return m_aux_size; }
+
+    // Builds the unmapped record, reusing |recycled| if given. |qstring| is phred+33 encoded.
+    // Queued tags are cleared so the builder can be reused.
+    BamPtr build(std::string_view read_id,
+                 std::string_view seq,
+                 std::string_view qstring,
+                 BamPtr recycled = nullptr);
+
+private:
+    struct Tag {
+        char name[2];
+        char type;
+        char subtype;
+        // Scalar payload, stored inline.
+        uint8_t value[4];
+        // Leading array element, if has_first is set.
+        uint8_t first;
+        bool has_first;
+        const uint8_t* data;
+        size_t size;  // Bytes of |data|
+    };
+
+    Tag& add_tag(const char* tag, char type);
+    static uint8_t* write_tag(const Tag& tag, uint8_t* dest);
+
+    std::vector<Tag> m_tags;
+    size_t m_aux_size = 0;
+};
+
+}  // namespace dorado::utils
@@ -4,8 +4,8 @@
 #include <optional>
 
 namespace dorado::utils {
-std::optional<std::unordered_set<std::string>> load_read_list(const std::string& read_list) {
-    std::unordered_set<std::string> read_ids;
+std::optional<ReadIdSet> load_read_list(const std::string& read_list) {
+    ReadIdSet read_ids;
 
     if (read_list == "") {
         return {};
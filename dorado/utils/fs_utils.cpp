@@ -1,6 +1,8 @@
+#include "fs_utils.h"
 
 #include <spdlog/spdlog.h>
 
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <optional>
@@ -8,6 +10,7 @@
 #include <set>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
 
 namespace fs = std::filesystem;
 
@@ -84,4 +87,34 @@ void clean_temporary_models(const std::set<std::filesystem::path>& paths) {
     }
 }
 
-}  // namespace dorado::utils
\ No newline at end of file
+std::vector<fs::directory_entry> fetch_directory_entries(const fs::path& path, bool recursive) {
+    std::vector<fs::directory_entry> entries;
+
+    if (fs::is_directory(path)) {
+        if (recursive) {
+            for (const auto& entry : fs::recursive_directory_iterator(path)) {
+                entries.push_back(entry);
+            }
+        } else {
+            for (const auto& entry : fs::directory_iterator(path)) {
+                entries.push_back(entry);
+            }
+        }
+    } else {
+        entries.push_back(fs::directory_entry(path));
+    }
+
+    return entries;
+}
+
+fs::path get_user_data_dir() {
+#ifdef _WIN32
+    const char* home = std::getenv("USERPROFILE");
+#else
+    const char* home = std::getenv("HOME");
+#endif
+    const fs::path base = home ? home : fs::temp_directory_path();
+    return base / ".dorado";
+}
+
+}  // namespace dorado::utils
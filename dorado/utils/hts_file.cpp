@@ -16,6 +16,14 @@ namespace {
 
 constexpr size_t MINIMUM_BUFFER_SIZE = 100000ul;  // The smallest allowed buffer size is 100 KB.
 
+int enable_bgzf_threads(BGZF* bgzf, int threads, hts_tpool* thread_pool) {
+    if (thread_pool) {
+        // A queue size of 0 lets htslib size it to the pool.
+        return bgzf_thread_pool(bgzf, thread_pool, 0);
+    }
+    return bgzf_mt(bgzf, threads, 128);
+}
+
 }  // namespace
 
 bool compare_headers(const dorado::SamHdrPtr& header1, const dorado::SamHdrPtr& header2) {
@@ -47,9 +55,14 @@ struct HtsFile::ProgressUpdater {
     }
 };
 
-HtsFile::HtsFile(const std::string& filename, OutputMode mode, size_t threads, bool sort_bam)
+HtsFile::HtsFile(const std::string& filename,
+                 OutputMode mode,
+                 size_t threads,
+                 bool sort_bam,
+                 hts_tpool* thread_pool)
         : m_filename(filename),
           m_threads(int(threads)),
+          m_thread_pool(thread_pool),
           m_finalise_is_noop(true),
           m_sort_bam(sort_bam),
           m_mode(mode) {
@@ -93,7 +106,7 @@ HtsFile::HtsFile(const std::string& filename, OutputMode mode, size_t threads, b
         }
 
         if (m_file->format.compression == bgzf) {
-            auto res = bgzf_mt(m_file->fp.bgzf, m_threads, 128);
+            auto res = enable_bgzf_threads(m_file->fp.bgzf, m_threads, m_thread_pool);
             if (res < 0) {
                 throw std::runtime_error("Could not enable multi threading for BAM generation.");
             }
@@ -139,7 +152,7 @@ void HtsFile::flush_temp_file(const bam1_t* last_record) {
     m_temp_files.push_back(tempfilename);
     m_file.reset(hts_open(tempfilename.c_str(), "wb"));
     if (m_file->format.compression == bgzf) {
-        auto res = bgzf_mt(m_file->fp.bgzf, m_threads, 128);
+        auto res = enable_bgzf_threads(m_file->fp.bgzf, m_threads, m_thread_pool);
         if (res < 0) {
             throw std::runtime_error("Could not enable multi threading for BAM generation.");
         }
@@ -259,6 +272,26 @@ int HtsFile::write(const bam1_t* record) {
     return 0;
 }
 
+bool HtsFile::can_write_bgzf_blocks() const {
+    return m_finalise_is_noop && m_file && m_file->format.compression == bgzf &&
+           (m_mode == OutputMode::BAM || m_mode == OutputMode::UBAM);
+}
+
+int HtsFile::write_bgzf_blocks(const void* data, size_t size) {
+    assert(can_write_bgzf_blocks());
+    // Flushing also waits for the compression threads to write out everything queued, so the
+    // blocks can't be interleaved with their output.
+    if (bgzf_flush(m_file->fp.bgzf) < 0) {
+        return -1;
+    }
+    return bgzf_raw_write(m_file->fp.bgzf, data, size) == ssize_t(size) ? 0 : -1;
+}
+
+int HtsFile::write_encoded_records(const void* data, size_t size) {
+    assert(can_write_bgzf_blocks());
+    return bgzf_write(m_file->fp.bgzf, data, size) == ssize_t(size) ? 0 : -1;
+}
+
 int HtsFile::write_to_file(const bam1_t* record) {
     // FIXME -- HtsFile is constructed in a state where attempting to write
     // will segfault, since set_header has to have been called
@@ -310,7 +343,7 @@ bool HtsFile::merge_temp_files(ProgressUpdater& update_progress) const {
     SamHdrPtr header{};
     for (size_t i = 0; i < num_temp_files; ++i) {
         in_files[i].reset(hts_open(m_temp_files[i].c_str(), "rb"));
-        if (bgzf_mt(in_files[i]->fp.bgzf, m_threads, 128) < 0) {
+        if (enable_bgzf_threads(in_files[i]->fp.bgzf, m_threads, m_thread_pool) < 0) {
             spdlog::error("Could not enable multi threading for BAM reading.");
             return false;
         }
@@ -338,7 +371,7 @@ bool HtsFile::merge_temp_files(ProgressUpdater& update_progress) const {
 
     // Open the output file, and write the header.
     HtsFilePtr out_file(hts_open(m_filename.c_str(), "wb"));
-    if (bgzf_mt(out_file->fp.bgzf, m_threads, 128) < 0) {
+    if (enable_bgzf_threads(out_file->fp.bgzf, m_threads, m_thread_pool) < 0) {
         spdlog::error("Could not enable multi threading for BAM generation.");
         return false;
     }
@@ -21,7 +21,13 @@ public:
 
     using ProgressCallback = std::function<void(size_t percentage)>;
 
-    HtsFile(const std::string& filename, OutputMode mode, size_t threads, bool sort_bam);
+    // BGZF compression uses |thread_pool| if given, which must outlive the file. Otherwise the
+    // file gets its own pool of |threads|.
+    HtsFile(const std::string& filename,
+            OutputMode mode,
+            size_t threads,
+            bool sort_bam,
+            hts_tpool* thread_pool = nullptr);
     ~HtsFile();
     HtsFile(const HtsFile&) = delete;
     HtsFile& operator=(const HtsFile&) = delete;
@@ -36,12 +42,21 @@ public:
 
     OutputMode get_output_mode() const { return m_mode; }
 
+    // True if records are written straight to a BGZF compressed BAM file, so compressed blocks
+    // taken from another BAM file can be written as they are.
+    bool can_write_bgzf_blocks() const;
+    // Ends the current BGZF block, then writes |size| bytes of complete BGZF blocks unchanged.
+    int write_bgzf_blocks(const void* data, size_t size);
+    // Writes |size| bytes of already encoded BAM records, which are compressed as usual.
+    int write_encoded_records(const void* data, size_t size);
+
 private:
     std::string m_filename;
     HtsFilePtr m_file;
     SamHdrPtr m_header;
     size_t m_num_records{0};
     int m_threads{0};
+    hts_tpool* const m_thread_pool;
     bool m_finalised{false};
     bool m_finalise_is_noop;
     bool m_sort_bam;
@@ -4,12 +4,16 @@
 #include <windows.h>
 #elif defined(__linux__)
 #include <sys/sysinfo.h>
+#include <unistd.h>
 #elif defined(__APPLE__)
 #include <mach/mach.h>
 #include <sys/sysctl.h>
 #endif
 
 #include <array>
+#include <fstream>
+#include <limits>
+#include <string>
 
 namespace dorado::utils {
 
@@ -74,4 +78,68 @@ size_t total_host_memory_GB() {
 #endif
 }
 
+size_t process_memory_bytes() {
+#if defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    size_t total_pages = 0, resident_pages = 0;
+    if (!(statm >> total_pages >> resident_pages)) {
+        return 0;
+    }
+    return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) !=
+        KERN_SUCCESS) {
+        return 0;
+    }
+    return static_cast<size_t>(info.resident_size);
+
+#else
+    return 0;
+#endif
+}
+
+size_t peak_process_memory_bytes() {
+#if defined(__linux__)
+    // VmHWM is reset by reset_peak_process_memory(), unlike getrusage()'s ru_maxrss.
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    while (status >> key) {
+        if (key == "VmHWM:") {
+            size_t peak_kB = 0;
+            status >> peak_kB;
+            return peak_kB * 1024;
+        }
+        status.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    return 0;
+
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) !=
+        KERN_SUCCESS) {
+        return 0;
+    }
+    return static_cast<size_t>(info.resident_size_max);
+
+#else
+    return 0;
+#endif
+}
+
+bool reset_peak_process_memory() {
+#if defined(__linux__)
+    // Writing 5 resets the peak RSS (Linux 4.0+). This can be disallowed, e.g. in containers.
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    clear_refs.flush();
+    return clear_refs.good();
+#else
+    return false;
+#endif
+}
+
 }  // namespace dorado::utils
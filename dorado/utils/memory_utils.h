@@ -8,4 +8,13 @@ inline constexpr size_t BYTES_PER_GB{1024 * 1024 * 1024};
 size_t available_host_memory_GB();
 size_t total_host_memory_GB();
 
+// Resident memory of this process in bytes, or 0 if unknown.
+size_t process_memory_bytes();
+// Peak resident memory of this process in bytes since the last call to
+// reset_peak_process_memory(), or 0 if unknown.
+size_t peak_process_memory_bytes();
+// Restarts peak tracking from the current resident memory. Returns false if this isn't possible
+// on this platform, in which case the peak covers the whole lifetime of the process.
+bool reset_peak_process_memory();
+
 }  // namespace dorado::utils
@@ -0,0 +1,187 @@
+#include "read_id_set.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr size_t UUID_STRING_LEN = 36;
+constexpr size_t UUID_BYTES = 16;
+constexpr size_t MIN_SLOTS = 16;
+
+// Returns the value of a lowercase hex digit, or -1.
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+uint64_t hash_key(uint64_t hi, uint64_t lo) {
+    // UUID4s are mostly random already, this just mixes both halves into the bits we use.
+    uint64_t h = (hi ^ ((lo << 32) | (lo >> 32))) * 0x9E3779B97F4A7C15ull;
+    return h ^ (h >> 29);
+}
+
+}  // namespace
+
+namespace dorado::utils {
+
+ReadIdSet::ReadIdSet(std::initializer_list<std::string_view> read_ids) {
+    for (auto read_id : read_ids) {
+        insert(read_id);
+    }
+}
+
+bool ReadIdSet::parse_uuid(std::string_view read_id, Key& key) {
+    if (read_id.size() != UUID_STRING_LEN || read_id[8] != '-' || read_id[13] != '-' ||
+        read_id[18] != '-' || read_id[23] != '-') {
+        return false;
+    }
+    uint8_t bytes[UUID_BYTES];
+    size_t byte_idx = 0;
+    for (size_t i = 0; i < UUID_STRING_LEN; i += 2) {
+        if (i == 8 || i == 13 || i == 18 || i == 23) {
+            // Skip the dash, the next byte starts one character later.
+            ++i;
+        }
+        const int high = hex_value(read_id[i]);
+        const int low = hex_value(read_id[i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        bytes[byte_idx++] = uint8_t((high << 4) | low);
+    }
+    key = key_from_bytes(bytes);
+    return true;
+}
+
+ReadIdSet::Key ReadIdSet::key_from_bytes(const uint8_t* uuid_bytes) {
+    Key key;
+    std::memcpy(&key.hi, uuid_bytes, sizeof(key.hi));
+    std::memcpy(&key.lo, uuid_bytes + sizeof(key.hi), sizeof(key.lo));
+    return key;
+}
+
+bool ReadIdSet::insert(std::string_view read_id) {
+    Key key;
+    if (parse_uuid(read_id, key)) {
+        return insert_key(key);
+    }
+    const bool inserted = m_other_ids.emplace(read_id).second;
+    if (inserted) {
+        // Node (next pointer and cached hash) plus string storage.
+        m_other_ids_bytes += sizeof(std::string) + 2 * sizeof(void*) + read_id.size() + 1;
+    }
+    return inserted;
+}
+
+bool ReadIdSet::contains(std::string_view read_id) const {
+    Key key;
+    if (parse_uuid(read_id, key)) {
+        return contains_key(key);
+    }
+    // Heterogeneous lookup isn't available for unordered_set before C++20.
+    return !m_other_ids.empty() && m_other_ids.count(std::string(read_id)) > 0;
+}
+
+bool ReadIdSet::contains(const uint8_t* uuid_bytes) const {
+    return contains_key(key_from_bytes(uuid_bytes));
+}
+
+bool ReadIdSet::contains_key(const Key& key) const {
+    if (key.hi == 0 && key.lo == 0) {
+        return m_contains_nil;
+    }
+    if (m_slots.empty()) {
+        return false;
+    }
+    const size_t mask = m_slots.size() - 1;
+    for (size_t idx = hash_key(key.hi, key.lo) & mask;; idx = (idx + 1) & mask) {
+        const auto& slot = m_slots[idx];
+        if (slot == key) {
+            return true;
+        }
+        if (slot.hi == 0 && slot.lo == 0) {
+            return false;
+        }
+    }
+}
+
+bool ReadIdSet::insert_key(const Key& key) {
+    if (key.hi == 0 && key.lo == 0) {
+        const bool inserted = !m_contains_nil;
+        m_contains_nil = true;
+        return inserted;
+    }
+    // Keep the load factor at or below 3/4.
+    if ((m_num_uuids + 1) * 4 > m_slots.size() * 3) {
+        rehash(std::max(MIN_SLOTS, m_slots.size() * 2));
+    }
+    const size_t mask = m_slots.size() - 1;
+    for (size_t idx = hash_key(key.hi, key.lo) & mask;; idx = (idx + 1) & mask) {
+        auto& slot = m_slots[idx];
+        if (slot == key) {
+            return false;
+        }
+        if (slot.hi == 0 && slot.lo == 0) {
+            slot = key;
+            ++m_num_uuids;
+            return true;
+        }
+    }
+}
+
+void ReadIdSet::rehash(size_t num_slots) {
+    std::vector<Key> old_slots(num_slots, Key{0, 0});
+    std::swap(old_slots, m_slots);
+    const size_t mask = m_slots.size() - 1;
+    for (const auto& key : old_slots) {
+        if (key.hi == 0 && key.lo == 0) {
+            continue;
+        }
+        size_t idx = hash_key(key.hi, key.lo) & mask;
+        while (m_slots[idx].hi != 0 || m_slots[idx].lo != 0) {
+            idx = (idx + 1) & mask;
+        }
+        m_slots[idx] = key;
+    }
+}
+
+void ReadIdSet::reserve(size_t num_read_ids) {
+    size_t num_slots = std::max(MIN_SLOTS, m_slots.size());
+    while (num_read_ids * 4 > num_slots * 3) {
+        num_slots *= 2;
+    }
+    if (num_slots != m_slots.size()) {
+        rehash(num_slots);
+    }
+}
+
+size_t ReadIdSet::difference_size(const ReadIdSet& other) const {
+    size_t num_missing = 0;
+    for (const auto& key : m_slots) {
+        if ((key.hi != 0 || key.lo != 0) && !other.contains_key(key)) {
+            ++num_missing;
+        }
+    }
+    if (m_contains_nil && !other.m_contains_nil) {
+        ++num_missing;
+    }
+    for (const auto& read_id : m_other_ids) {
+        if (other.m_other_ids.count(read_id) == 0) {
+            ++num_missing;
+        }
+    }
+    return num_missing;
+}
+
+size_t ReadIdSet::memory_bytes() const {
+    return m_slots.capacity() * sizeof(Key) + m_other_ids.bucket_count() * sizeof(void*) +
+           m_other_ids_bytes;
+}
+
+}  // namespace dorado::utils
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace dorado::utils {
+
+// Set of read IDs, for tracking which reads have been written or should be loaded.
+//
+// Read IDs in canonical UUID form (lowercase hex, 8-4-4-4-12) are stored as 16 byte keys in an
+// open addressing table, which is a fraction of the size of a std::unordered_set<std::string>
+// holding the same IDs. Anything else is kept as a string in a fallback set, so arbitrary read
+// names behave exactly as before.
+//
+// Not thread safe for concurrent modification. Concurrent lookups are fine.
+class ReadIdSet {
+public:
+    ReadIdSet() = default;
+    ReadIdSet(std::initializer_list<std::string_view> read_ids);
+
+    // Returns true if the read ID was not already present.
+    bool insert(std::string_view read_id);
+
+    bool contains(std::string_view read_id) const;
+    // Lookup by the 16 byte binary form of a UUID read ID, as stored in POD5 files.
+    bool contains(const uint8_t* uuid_bytes) const;
+    size_t count(std::string_view read_id) const { return contains(read_id) ? 1 : 0; }
+
+    size_t size() const { return m_num_uuids + (m_contains_nil ? 1 : 0) + m_other_ids.size(); }
+    bool empty() const { return size() == 0; }
+
+    // Makes room for |num_read_ids| UUID read IDs without rehashing.
+    void reserve(size_t num_read_ids);
+
+    // Number of read IDs in this set which are not in |other|.
+    size_t difference_size(const ReadIdSet& other) const;
+
+    // Approximate heap usage, for stats and benchmarking. Constant time.
+    size_t memory_bytes() const;
+
+private:
+    struct Key {
+        uint64_t hi;
+        uint64_t lo;
+        bool operator==(const Key& other) const { return hi == other.hi && lo == other.lo; }
+    };
+
+    static bool parse_uuid(std::string_view read_id, Key& key);
+    static Key key_from_bytes(const uint8_t* uuid_bytes);
+
+    bool contains_key(const Key& key) const;
+    bool insert_key(const Key& key);
+    void rehash(size_t num_slots);
+
+    // All zero keys mark empty slots, so the nil UUID is tracked separately.
+    std::vector<Key> m_slots;
+    size_t m_num_uuids = 0;
+    bool m_contains_nil = false;
+    std::unordered_set<std::string> m_other_ids;
+    size_t m_other_ids_bytes = 0;
+};
+
+}  // namespace dorado::utils
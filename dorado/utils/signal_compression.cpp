@@ -0,0 +1,162 @@
+#include "signal_compression.h"
+
+#include "tensor_utils.h"
+
+#include <ATen/Functions.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Positive values get the top bit set, negative values have all their bits flipped, so that
+// unsigned comparison of the results matches comparison of the float16 values.
+uint16_t order_half_bits(uint16_t bits) {
+    return (bits & 0x8000) ? uint16_t(~bits) : uint16_t(bits | 0x8000);
+}
+
+uint16_t unorder_half_bits(uint16_t ordered) {
+    return (ordered & 0x8000) ? uint16_t(ordered & 0x7fff) : uint16_t(~ordered);
+}
+
+}  // namespace
+
+namespace dorado::utils {
+
+std::vector<uint8_t> compress_samples(const uint16_t* samples, std::size_t num_samples) {
+    const std::size_t control_bytes = (num_samples + 7) / 8;
+    std::vector<uint8_t> compressed(control_bytes + 2 * num_samples);
+    uint8_t* const control = compressed.data();
+    uint8_t* data = compressed.data() + control_bytes;
+
+    uint16_t previous = 0;
+    for (std::size_t i = 0; i < num_samples; ++i) {
+        // Differences wrap, so any pair of samples round trips.
+        const auto delta = int16_t(uint16_t(samples[i] - previous));
+        previous = samples[i];
+        const auto zigzag = uint16_t(uint16_t(delta << 1) ^ uint16_t(delta >> 15));
+        *data++ = uint8_t(zigzag);
+        if (zigzag > 0xff) {
+            control[i / 8] |= uint8_t(1 << (i % 8));
+            *data++ = uint8_t(zigzag >> 8);
+        }
+    }
+    compressed.resize(std::size_t(data - compressed.data()));
+    compressed.shrink_to_fit();
+    return compressed;
+}
+
+void decompress_samples(const std::vector<uint8_t>& compressed,
+                        uint16_t* samples,
+                        std::size_t num_samples) {
+    const std::size_t control_bytes = (num_samples + 7) / 8;
+    if (compressed.size() < control_bytes + num_samples) {
+        throw std::runtime_error("Compressed signal is too short");
+    }
+    const uint8_t* const control = compressed.data();
+    const uint8_t* data = compressed.data() + control_bytes;
+    const uint8_t* const end = compressed.data() + compressed.size();
+
+    uint16_t previous = 0;
+    for (std::size_t i = 0; i < num_samples; ++i) {
+        uint16_t zigzag = *data++;
+        if (control[i / 8] & (1 << (i % 8))) {
+            if (data == end) {
+                throw std::runtime_error("Compressed signal is too short");
+            }
+            zigzag |= uint16_t(*data++ << 8);
+        }
+        const auto delta = uint16_t((zigzag >> 1) ^ uint16_t(-(zigzag & 1)));
+        previous = uint16_t(previous + delta);
+        samples[i] = previous;
+    }
+    if (data != end) {
+        throw std::runtime_error("Compressed signal has trailing data");
+    }
+}
+
+bool CompressedSignal::can_compress(const at::Tensor& signal) {
+    return signal.defined() && signal.device().is_cpu() &&
+           (signal.scalar_type() == at::kShort || signal.scalar_type() == at::kHalf);
+}
+
+CompressedSignal::CompressedSignal(const at::Tensor& signal)
+        : m_sizes(signal.sizes().vec()),
+          m_dtype(signal.scalar_type()),
+          m_num_samples(std::size_t(signal.numel())) {
+    if (!can_compress(signal)) {
+        throw std::runtime_error("Only int16 and float16 CPU signals can be compressed");
+    }
+    const auto contiguous = signal.contiguous();
+    const auto* samples = static_cast<const uint16_t*>(contiguous.data_ptr());
+    if (m_dtype == at::kHalf) {
+        std::vector<uint16_t> ordered(m_num_samples);
+        for (std::size_t i = 0; i < m_num_samples; ++i) {
+            ordered[i] = order_half_bits(samples[i]);
+        }
+        m_data = compress_samples(ordered.data(), m_num_samples);
+    } else {
+        m_data = compress_samples(samples, m_num_samples);
+    }
+}
+
+CompressedSignal::CompressedSignal(const at::Tensor& signal, float shift, float scale)
+        : m_sizes(signal.sizes().vec()),
+          m_dtype(signal.scalar_type()),
+          m_num_samples(std::size_t(signal.numel())),
+          m_normalised(true),
+          m_shift(shift),
+          m_scale(scale) {
+    if (!can_compress(signal) || m_dtype != at::kHalf || !std::isfinite(shift) ||
+        !std::isfinite(scale) || scale == 0) {
+        *this = CompressedSignal(signal);
+        return;
+    }
+    const auto contiguous = signal.contiguous();
+    const auto* half_samples = static_cast<const c10::Half*>(contiguous.data_ptr());
+
+    std::vector<int16_t> levels(m_num_samples);
+    for (std::size_t i = 0; i < m_num_samples; ++i) {
+        const float level = std::nearbyint(float(half_samples[i]) * scale + shift);
+        levels[i] = std::isnan(level) ? int16_t(0) : int16_t(std::clamp(level, -32768.f, 32767.f));
+    }
+
+    std::vector<c10::Half> predicted(m_num_samples);
+    normalise_i16_to_f16(predicted.data(), levels.data(), m_num_samples, shift, scale);
+    const auto* bits = static_cast<const uint16_t*>(contiguous.data_ptr());
+    const auto* predicted_bits = reinterpret_cast<const uint16_t*>(predicted.data());
+    for (std::size_t i = 0; i < m_num_samples; ++i) {
+        if (bits[i] != predicted_bits[i]) {
+            m_exceptions.emplace_back(uint32_t(i), bits[i]);
+        }
+    }
+    if (m_exceptions.size() > m_num_samples / 16) {
+        // The signal wasn't normalised with these parameters.
+        *this = CompressedSignal(signal);
+        return;
+    }
+    m_data = compress_samples(reinterpret_cast<const uint16_t*>(levels.data()), m_num_samples);
+}
+
+at::Tensor CompressedSignal::decompress() const {
+    auto signal = at::empty(m_sizes, at::TensorOptions().dtype(m_dtype));
+    auto* samples = static_cast<uint16_t*>(signal.data_ptr());
+    decompress_samples(m_data, samples, m_num_samples);
+    if (m_normalised) {
+        // int16 and float16 are the same size, so each sample is normalised in place.
+        normalise_i16_to_f16(reinterpret_cast<c10::Half*>(samples),
+                             reinterpret_cast<const int16_t*>(samples), m_num_samples, m_shift,
+                             m_scale);
+        for (const auto& [index, sample_bits] : m_exceptions) {
+            samples[index] = sample_bits;
+        }
+    } else if (m_dtype == at::kHalf) {
+        for (std::size_t i = 0; i < m_num_samples; ++i) {
+            samples[i] = unorder_half_bits(samples[i]);
+        }
+    }
+    return signal;
+}
+
+}  // namespace dorado::utils
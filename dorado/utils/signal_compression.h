@@ -0,0 +1,57 @@
+#pragma once
+
+#include <ATen/core/TensorBody.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace dorado::utils {
+
+// Lossless compression of 16 bit samples. Each sample is stored as the zigzag encoded difference
+// from the one before, in one byte if that fits and two otherwise, after a bitmask with a bit
+// per sample saying which.
+std::vector<uint8_t> compress_samples(const uint16_t* samples, std::size_t num_samples);
+// Throws std::runtime_error if |compressed| doesn't hold exactly |num_samples| samples.
+void decompress_samples(const std::vector<uint8_t>& compressed,
+                        uint16_t* samples,
+                        std::size_t num_samples);
+
+// An int16 or float16 CPU signal tensor held compressed with compress_samples().
+class CompressedSignal {
+public:
+    // Whether |signal| has a type that can be compressed.
+    static bool can_compress(const at::Tensor& signal);
+
+    // float16 bit patterns are mapped to integers in the order of their values, so neighbouring
+    // samples still differ by small amounts.
+    explicit CompressedSignal(const at::Tensor& signal);
+    // For a float16 signal normalised from int16 samples with normalise_i16_to_f16(), which is
+    // stored as those samples. Any sample which |shift| and |scale| don't reproduce exactly is
+    // stored as it is.
+    CompressedSignal(const at::Tensor& signal, float shift, float scale);
+
+    at::Tensor decompress() const;
+
+    // Bytes of the compressed signal, and of the tensor it came from.
+    std::size_t nbytes() const {
+        return m_data.size() + m_exceptions.size() * sizeof(m_exceptions[0]);
+    }
+    std::size_t uncompressed_nbytes() const { return m_num_samples * sizeof(uint16_t); }
+
+private:
+    std::vector<uint8_t> m_data;
+    std::vector<int64_t> m_sizes;
+    at::ScalarType m_dtype;
+    std::size_t m_num_samples;
+
+    // Set if m_data holds the int16 samples a float16 signal was normalised from.
+    bool m_normalised = false;
+    float m_shift = 0;
+    float m_scale = 1;
+    // Index and bit pattern of each float16 sample the normalisation doesn't reproduce.
+    std::vector<std::pair<uint32_t, uint16_t>> m_exceptions;
+};
+
+}  // namespace dorado::utils
@@ -1,5 +1,7 @@
 #include "stats.h"
 
+#include <algorithm>
+#include <cmath>
 #include <ostream>
 #include <set>
 
@@ -105,4 +107,74 @@ void StatsSampler::sampling_thread_fn() {
     }
 }
 
-}  // namespace dorado::stats
\ No newline at end of file
+size_t LatencyHistogram::bucket_index(uint64_t us) {
+    constexpr uint64_t sub_buckets = uint64_t(1) << SUB_BUCKET_BITS;
+    if (us < 2 * sub_buckets) {
+        return size_t(us);
+    }
+    int msb = 0;
+    while ((us >> (msb + 1)) != 0) {
+        ++msb;
+    }
+    const int shift = msb - SUB_BUCKET_BITS;
+    return size_t(shift + 1) * sub_buckets + size_t((us >> shift) & (sub_buckets - 1));
+}
+
+double LatencyHistogram::bucket_midpoint_us(size_t index) {
+    constexpr size_t sub_buckets = size_t(1) << SUB_BUCKET_BITS;
+    if (index < 2 * sub_buckets) {
+        return double(index);
+    }
+    const int shift = int(index / sub_buckets) - 1;
+    const uint64_t lower = uint64_t(sub_buckets + index % sub_buckets) << shift;
+    const uint64_t width = uint64_t(1) << shift;
+    return double(lower) + double(width - 1) / 2;
+}
+
+void LatencyHistogram::add(std::chrono::steady_clock::duration latency) {
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    m_buckets[bucket_index(uint64_t(std::max<int64_t>(us, 0)))].fetch_add(
+            1, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const {
+    uint64_t total = 0;
+    for (const auto& bucket : m_buckets) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+double LatencyHistogram::percentile_ms(double fraction) const {
+    std::array<uint64_t, NUM_BUCKETS> counts;
+    uint64_t total = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    const auto rank = std::max(uint64_t(1), uint64_t(std::ceil(fraction * double(total))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return bucket_midpoint_us(i) / 1000.0;
+        }
+    }
+    return bucket_midpoint_us(counts.size() - 1) / 1000.0;
+}
+
+void LatencyHistogram::report(NamedStats& stats, const std::string& prefix) const {
+    const auto total = count();
+    if (total == 0) {
+        return;
+    }
+    stats[prefix + "_count"] = double(total);
+    stats[prefix + "_p50_ms"] = percentile_ms(0.5);
+    stats[prefix + "_p90_ms"] = percentile_ms(0.9);
+    stats[prefix + "_p99_ms"] = percentile_ms(0.99);
+}
+
+}  // namespace dorado::stats
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <functional>
@@ -78,6 +79,27 @@ NamedStats from_obj(const T& obj) {
     return prefixed_stats;
 }
 
+// Counts durations for reporting percentiles of latencies. Buckets are an eighth of a power of 2
+// wide, so percentiles are within about 6%. Thread-safe.
+class LatencyHistogram {
+public:
+    void add(std::chrono::steady_clock::duration latency);
+    uint64_t count() const;
+    // The latency which |fraction| of those added are at or below, in ms, or 0 if none were added.
+    double percentile_ms(double fraction) const;
+    // Adds <prefix>_count, and the 50th, 90th and 99th percentiles as <prefix>_p50_ms etc.
+    void report(NamedStats& stats, const std::string& prefix) const;
+
+private:
+    // Microseconds, in 8 buckets per power of 2.
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr int NUM_BUCKETS = 64 << SUB_BUCKET_BITS;
+    static size_t bucket_index(uint64_t us);
+    static double bucket_midpoint_us(size_t index);
+
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> m_buckets{};
+};
+
 // Minimal timer object to facilitate recording time spans.
 // Starts a clock when constructed which can be queried in ms subsequently.
 class Timer {
@@ -5,10 +5,15 @@
 #include <torch/csrc/jit/serialization/pickle.h>
 #include <torch/torch.h>
 
+#include <algorithm>
+#include <cassert>
 #include <cstddef>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <limits>
 #include <sstream>
+#include <stdexcept>
 #include <vector>
 
 namespace {
@@ -65,6 +70,54 @@ __attribute__((target("avx2,f16c"))) void convert_f32_to_f16_impl(c10::Half* con
 }
 #endif
 
+#if ENABLE_AVX2_IMPL
+__attribute__((target("default")))
+#endif
+void normalise_i16_to_f16_impl(c10::Half* const dest,
+                               const int16_t* const src,
+                               std::size_t count,
+                               float shift,
+                               float scale) {
+    // Same arithmetic as ((x.to(kFloat) - shift) / scale).to(kHalf), one element at a time.
+    // Each element is read before it is written, so dest may alias src.
+    for (std::size_t i = 0; i < count; ++i) {
+        dest[i] = c10::Half((static_cast<float>(src[i]) - shift) / scale);
+    }
+}
+
+#if ENABLE_AVX2_IMPL
+__attribute__((target("avx2,f16c"))) void normalise_i16_to_f16_impl(c10::Half* const dest,
+                                                                    const int16_t* const src,
+                                                                    std::size_t count,
+                                                                    float shift,
+                                                                    float scale) {
+    // Unroll to AVX register size: 8 floats.
+    static constexpr size_t kUnroll = 8;
+
+    // Matches torch behaviour.
+    const int kRoundNearestEven = 0;
+
+    const __m256 shift_v = _mm256_set1_ps(shift);
+    const __m256 scale_v = _mm256_set1_ps(scale);
+
+    // Main vectorised loop: 8 samples per iteration.  The 8 int16 inputs occupy exactly the
+    // 16 bytes that the float16 outputs are written to, and are loaded first.
+    size_t i = 0;
+    for (; i + kUnroll <= count; i += kUnroll) {
+        const __m128i elems_i16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m256 elems_f32 = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(elems_i16));
+        const __m256 normalised = _mm256_div_ps(_mm256_sub_ps(elems_f32, shift_v), scale_v);
+        const __m128i elems_f16 = _mm256_cvtps_ph(normalised, kRoundNearestEven);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), elems_f16);
+    }
+
+    // Final 0-7 samples.
+    for (; i < count; ++i) {
+        dest[i] = c10::Half((static_cast<float>(src[i]) - shift) / scale);
+    }
+}
+#endif
+
 }  // namespace
 
 namespace dorado::utils {
@@ -138,6 +191,69 @@ at::Tensor quantile_counting(const at::Tensor& t, const at::Tensor& q) {
     return res;
 }
 
+void SignalHistogram::build(const int16_t* const data, std::size_t count) {
+    if (count == 0) {
+        throw std::runtime_error("SignalHistogram: empty signal");
+    }
+
+    // A min/max pre-pass lets the count buffer be sized once for the whole signal.
+    const auto [min_it, max_it] = std::minmax_element(data, data + count);
+    m_min = *min_it;
+    m_max = *max_it;
+    const auto range = std::size_t(m_max - m_min + 1);
+    // The buffer only ever grows, so its allocation is reused across signals.
+    if (range > m_counts.size()) {
+        m_counts.resize(range);
+    }
+    std::fill(m_counts.begin(), m_counts.begin() + range, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        ++m_counts[data[i] - m_min];
+    }
+    m_num_samples = count;
+}
+
+int16_t SignalHistogram::value_at_rank(std::size_t rank) const {
+    assert(rank < m_num_samples);
+    std::size_t cumulative = 0;
+    for (int32_t value = m_min; value <= m_max; ++value) {
+        cumulative += m_counts[value - m_min];
+        if (cumulative > rank) {
+            return static_cast<int16_t>(value);
+        }
+    }
+    return static_cast<int16_t>(m_max);
+}
+
+int16_t SignalHistogram::quantile(float q) const {
+    // Same rank computation as quantile_counting.
+    const int threshold = int(q * (m_num_samples - 1));
+    return value_at_rank(std::size_t(std::max(threshold, 0)));
+}
+
+int16_t SignalHistogram::median() const { return value_at_rank((m_num_samples - 1) / 2); }
+
+int32_t SignalHistogram::median_abs_deviation(int16_t centre) const {
+    // Count samples by their distance from centre, in increasing order of distance.
+    const std::size_t rank = (m_num_samples - 1) / 2;
+    const int32_t max_dist = std::max(std::abs(m_max - centre), std::abs(centre - m_min));
+    std::size_t cumulative = count_at(centre);
+    for (int32_t dist = 1; cumulative <= rank && dist <= max_dist; ++dist) {
+        cumulative += count_at(centre + dist) + count_at(centre - dist);
+        if (cumulative > rank) {
+            return dist;
+        }
+    }
+    return 0;
+}
+
+void normalise_i16_to_f16(c10::Half* const dest,
+                          const int16_t* const src,
+                          std::size_t count,
+                          float shift,
+                          float scale) {
+    return normalise_i16_to_f16_impl(dest, src, count, shift, scale);
+}
+
 // Multiversioned function dispatch doesn't work across the dorado_lib linking
 // boundary.  Without this wrapper, AVX machines still only execute the default
 // version.
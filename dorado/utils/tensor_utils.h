@@ -3,6 +3,7 @@
 #include <ATen/core/TensorBody.h>
 
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <string>
 #include <vector>
@@ -25,6 +26,46 @@ at::Tensor quantile(const at::Tensor& t, const at::Tensor& q);
 // Only `interpolation='lower'` is currently implemented.
 at::Tensor quantile_counting(const at::Tensor& t, const at::Tensor& q);
 
+// Histogram of int16 sample values, built with a single counting pass over a signal, from
+// which order statistics can be read without sorting or full-length temporaries.
+// The count buffer is retained across build() calls, so one instance per thread avoids
+// per-signal allocations.
+class SignalHistogram {
+public:
+    // Replaces the histogram contents with the counts of the count samples at data.
+    void build(const int16_t* data, std::size_t count);
+
+    // Value of the sample with the given rank in sorted order.
+    int16_t value_at_rank(std::size_t rank) const;
+    // q-th quantile, matching quantile_counting (interpolation='lower').
+    int16_t quantile(float q) const;
+    // Lower median, matching at::median.
+    int16_t median() const;
+    // Lower median of |x - centre|, matching at::median(at::abs(x - centre)).
+    int32_t median_abs_deviation(int16_t centre) const;
+
+    // Bytes currently held by the count buffer.
+    std::size_t capacity_bytes() const { return m_counts.capacity() * sizeof(uint32_t); }
+
+private:
+    int32_t count_at(int32_t value) const {
+        return (value < m_min || value > m_max) ? 0 : int32_t(m_counts[value - m_min]);
+    }
+
+    std::vector<uint32_t> m_counts;
+    std::size_t m_num_samples = 0;
+    int32_t m_min = 0;
+    int32_t m_max = -1;
+};
+
+// Writes (x - shift) / scale as float16 for each of the count int16 samples at src.
+// dest may alias src, in which case the signal is normalised in place.
+void normalise_i16_to_f16(c10::Half* dest,
+                          const int16_t* src,
+                          std::size_t count,
+                          float shift,
+                          float scale);
+
 // Converts count float elements pointed to by src to half precision, with
 // the result pointed to by dest.
 void convert_f32_to_f16(c10::Half* dest, const float* src, std::size_t count);
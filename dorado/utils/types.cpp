@@ -1,6 +1,7 @@
 #include "types.h"
 
 #include <htslib/sam.h>
+#include <htslib/thread_pool.h>
 #include <minimap.h>
 #include <spdlog/spdlog.h>
 
@@ -20,6 +21,12 @@ void HtsFileDestructor::operator()(htsFile* hts_file) {
     }
 }
 
+void HtsThreadPoolDestructor::operator()(hts_tpool* pool) {
+    if (pool) {
+        hts_tpool_destroy(pool);
+    }
+}
+
 KString::KString() : m_data(std::make_unique<kstring_t>()) { *m_data = {0, 0, nullptr}; }
 
 KString::KString(size_t n) : m_data(std::make_unique<kstring_t>()) {
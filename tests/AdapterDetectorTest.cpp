@@ -14,9 +14,11 @@
 #include <catch2/catch.hpp>
 #include <htslib/sam.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <filesystem>
 #include <string>
+#include <utility>
 #include <vector>
 
 #define TEST_GROUP "[adapter_detect]"
@@ -432,3 +434,33 @@ TEST_CASE(
         }
     }
 }
+
+TEST_CASE("AdapterDetectorNode: check batches drop secondary and supplementary records",
+          TEST_GROUP) {
+    auto client_info = std::make_shared<dorado::DefaultClientInfo>();
+    client_info->contexts().register_context<const dorado::demux::AdapterInfo>(
+            std::make_shared<const dorado::demux::AdapterInfo>(
+                    dorado::demux::AdapterInfo{true, true, std::nullopt}));
+    const auto test_file =
+            fs::path(get_data_dir("barcode_demux/single_end")) / "SQK-RBK114-96_BC01.fastq";
+    auto add_node = [](dorado::PipelineDescriptor& pipeline_desc, dorado::NodeHandle sink) {
+        pipeline_desc.add_node<AdapterDetectorNode>({sink}, 8);
+    };
+
+    auto records = ReadRecordsWithAlignmentCopies(test_file.string(), client_info);
+    std::vector<std::pair<std::string, uint16_t>> expected;
+    for (const auto& bam_message : records) {
+        const bam1_t* record = bam_message.bam_ptr.get();
+        if (!(record->core.flag & (BAM_FSUPPLEMENTARY | BAM_FSECONDARY))) {
+            expected.emplace_back(bam_get_qname(record), record->core.flag);
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+    REQUIRE(!expected.empty());
+
+    auto single_output = ProcessBamRecords(add_node, std::move(records), false);
+    auto batch_output = ProcessBamRecords(
+            add_node, ReadRecordsWithAlignmentCopies(test_file.string(), client_info), true);
+    CHECK(single_output == expected);
+    CHECK(batch_output == single_output);
+}
@@ -632,3 +632,34 @@ TEST_CASE_METHOD(AlignerNodeTestFixture,
     }
     CHECK_THAT(bam_aux2Z(bam_aux_get(supplementary_rec, "SA")), Equals("read3,1,+,999M899S,0,0;"));
 }
+
+TEST_CASE("AlignerTest: Check batches of secondary and supplementary records are realigned",
+          TEST_GROUP) {
+    fs::path aligner_test_dir = fs::path(get_aligner_data_dir());
+    auto ref = aligner_test_dir / "supplementary_aln_target.fa";
+    auto query = aligner_test_dir / "supplementary_aln_query.fa";
+
+    auto options = dorado::alignment::dflt_options;
+    options.kmer_size = options.window_size = 15;
+    options.index_batch_size = 1'000'000'000ull;
+
+    auto client_info = std::make_shared<dorado::DefaultClientInfo>();
+    auto alignment_info = std::make_shared<dorado::alignment::AlignmentInfo>();
+    alignment_info->minimap_options = options;
+    alignment_info->reference_file = ref.string();
+    client_info->contexts().register_context<const dorado::alignment::AlignmentInfo>(
+            alignment_info);
+    auto add_node = [&](dorado::PipelineDescriptor& pipeline_desc, dorado::NodeHandle sink) {
+        auto index_file_access = std::make_shared<dorado::alignment::IndexFileAccess>();
+        pipeline_desc.add_node<dorado::AlignerNode>({sink}, index_file_access, ref.string(), "",
+                                                    options, 10);
+    };
+
+    // Input flags don't affect alignment, so each copy of a record is aligned like the original.
+    auto single_output = ProcessBamRecords(
+            add_node, ReadRecordsWithAlignmentCopies(query.string(), client_info), false);
+    auto batch_output = ProcessBamRecords(
+            add_node, ReadRecordsWithAlignmentCopies(query.string(), client_info), true);
+    REQUIRE(single_output.size() == 6);
+    CHECK(batch_output == single_output);
+}
@@ -9,6 +9,7 @@
 #include <iostream>
 #include <numeric>
 #include <thread>
+#include <vector>
 
 using dorado::utils::AsyncQueue;
 using dorado::utils::AsyncQueueStatus;
@@ -140,4 +141,33 @@ TEST_CASE(TEST_GROUP ": process_and_pop_n") {
     std::iota(expected.begin(), expected.end(), 0);
     CHECK(popped_items == expected);
     CHECK(queue.size() == 0);
-}
\ No newline at end of file
+}
+
+TEST_CASE(TEST_GROUP ": try_push_all beyond capacity") {
+    const int capacity = 3;
+    const int n = 10;
+    AsyncQueue<int> queue(capacity);
+
+    std::vector<int> popped_items;
+    std::thread consumer([&queue, &popped_items] {
+        int val = -1;
+        while (queue.try_pop(val) == AsyncQueueStatus::Success) {
+            popped_items.push_back(val);
+        }
+    });
+
+    std::vector<int> items(n);
+    std::iota(items.begin(), items.end(), 0);
+    const auto expected = items;
+    CHECK(queue.try_push_all(std::move(items)) == AsyncQueueStatus::Success);
+    queue.terminate();
+    consumer.join();
+    CHECK(popped_items == expected);
+}
+
+TEST_CASE(TEST_GROUP ": try_push_all fails if terminating") {
+    AsyncQueue<int> queue(1);
+    queue.terminate();
+    CHECK(queue.try_push_all({1, 2}) == AsyncQueueStatus::Terminate);
+    CHECK(queue.size() == 0);
+}
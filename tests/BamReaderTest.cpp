@@ -2,12 +2,15 @@
 #include "TestUtils.h"
 #include "read_pipeline/HtsReader.h"
 #include "utils/bam_utils.h"
+#include "utils/hts_file.h"
 
 #include <catch2/catch.hpp>
 #include <htslib/sam.h>
 
 #include <filesystem>
+#include <string>
 #include <unordered_set>
+#include <vector>
 
 #define TEST_GROUP "[bam_utils][hts_reader]"
 
@@ -106,6 +109,88 @@ TEST_CASE("HtsReaderTest: fetch_read_ids API w/ SAM", TEST_GROUP) {
                                                       "60588a89-f191-414e-b444-ad0815b7d9c9"};
 
     auto read_set = dorado::fetch_read_ids(sam.string());
-    CHECK(read_set.find("d7500028-dfcc-4404-b636-13edae804c55") != read_set.end());
-    CHECK(read_set.find("60588a89-f191-414e-b444-ad0815b7d9c9") != read_set.end());
+    CHECK(read_set.contains("d7500028-dfcc-4404-b636-13edae804c55"));
+    CHECK(read_set.contains("60588a89-f191-414e-b444-ad0815b7d9c9"));
+}
+
+TEST_CASE("HtsReaderTest: Read SAM to sink with threads", TEST_GROUP) {
+    fs::path aligner_test_dir = fs::path(get_data_dir("bam_reader"));
+    auto sam = aligner_test_dir / "small.sam";
+
+    const bool use_read_list = GENERATE(false, true);
+    const size_t max_reads = GENERATE(0, 3);
+    CAPTURE(use_read_list, max_reads);
+    std::optional<dorado::utils::ReadIdSet> read_list;
+    size_t expected_reads = 11;
+    if (use_read_list) {
+        // 5 records for the first, 1 for the second.
+        read_list = dorado::utils::ReadIdSet{"d7500028-dfcc-4404-b636-13edae804c55",
+                                             "60588a89-f191-414e-b444-ad0815b7d9c9"};
+        expected_reads = 6;
+    }
+    if (max_reads > 0) {
+        expected_reads = max_reads;
+    }
+
+    dorado::PipelineDescriptor pipeline_desc;
+    std::vector<dorado::Message> bam_records;
+    pipeline_desc.add_node<MessageSinkToVector>({}, 100, bam_records);
+    auto pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
+
+    dorado::HtsReader reader(sam.string(), read_list);
+    reader.enable_threads(2);
+    size_t num_mutated = 0;
+    reader.set_record_mutator([&num_mutated](dorado::BamPtr&) { ++num_mutated; });
+    CHECK(reader.read(*pipeline, max_reads) == expected_reads);
+    pipeline.reset();
+    CHECK(bam_records.size() == expected_reads);
+    CHECK(num_mutated == expected_reads);
+    if (use_read_list) {
+        for (auto& record : ConvertMessages<dorado::BamMessage>(std::move(bam_records))) {
+            CHECK(read_list->contains(bam_get_qname(record.bam_ptr.get())));
+        }
+    }
+}
+
+TEST_CASE("HtsReaderTest: Read BAM to sink with threads keeps record order", TEST_GROUP) {
+    fs::path aligner_test_dir = fs::path(get_data_dir("bam_reader"));
+    auto sam = aligner_test_dir / "small.sam";
+    auto tmp_dir = make_temp_dir("hts_reader_test");
+    auto bam = tmp_dir.m_path / "repeated.bam";
+
+    // Enough records for several batches.
+    std::vector<std::string> written_ids;
+    {
+        dorado::HtsReader reader(sam.string(), std::nullopt);
+        std::vector<dorado::BamPtr> records;
+        while (reader.read()) {
+            records.emplace_back(bam_dup1(reader.record.get()));
+        }
+        dorado::utils::HtsFile file(bam.string(), dorado::utils::HtsFile::OutputMode::BAM, 2,
+                                    false);
+        file.set_header(reader.header);
+        for (int i = 0; i < 500; ++i) {
+            for (auto& record : records) {
+                REQUIRE(file.write(record.get()) >= 0);
+                written_ids.push_back(bam_get_qname(record.get()));
+            }
+        }
+        file.finalise([](size_t) { /* noop */ });
+    }
+
+    dorado::PipelineDescriptor pipeline_desc;
+    std::vector<dorado::Message> bam_records;
+    pipeline_desc.add_node<MessageSinkToVector>({}, 100, bam_records);
+    auto pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
+
+    dorado::HtsReader reader(bam.string(), std::nullopt);
+    reader.enable_threads(4);
+    CHECK(reader.read(*pipeline, 0) == written_ids.size());
+    pipeline.reset();
+
+    std::vector<std::string> read_ids;
+    for (auto& record : ConvertMessages<dorado::BamMessage>(std::move(bam_records))) {
+        read_ids.push_back(bam_get_qname(record.bam_ptr.get()));
+    }
+    CHECK(read_ids == written_ids);
 }
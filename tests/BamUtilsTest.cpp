@@ -1,11 +1,13 @@
 #include "TestUtils.h"
 #include "read_pipeline/HtsReader.h"
+#include "utils/bam_record_builder.h"
 #include "utils/bam_utils.h"
 #include "utils/barcode_kits.h"
 
 #include <catch2/catch.hpp>
 #include <htslib/sam.h>
 
+#include <cstring>
 #include <filesystem>
 #include <numeric>
 #include <optional>
@@ -290,3 +292,69 @@ TEST_CASE("BamUtilsTest: Remove all alignment tags", TEST_GROUP) {
 
     CHECK(bam_aux_first(record) == nullptr);
 }
+
+TEST_CASE("BamUtilsTest: BamRecordBuilder matches incremental tag appends", TEST_GROUP) {
+    const std::string read_id = "read_0";
+    const std::string seq = "ACGTACGTTGCA";
+    const std::string qstring = "!&.-&.&.-&.(";
+    const std::string start_time = "2017-04-29T09:10:04Z";
+    const std::vector<uint8_t> moves = {1, 0, 1, 1, 0, 0, 1};
+    const std::vector<uint8_t> probs = {255, 3, 128};
+    const float qs = 14.5f;
+    const int32_t ch = 42;
+    const uint32_t sp = 1234;
+    const uint8_t stride = 5;
+
+    // Reference record, built the way extract_sam_lines used to build it.
+    BamPtr expected(bam_init1());
+    std::vector<uint8_t> qscore;
+    for (auto c : qstring) {
+        qscore.push_back(uint8_t(c - 33));
+    }
+    bam_set1(expected.get(), read_id.length(), read_id.c_str(), 4, -1, -1, 0, 0, nullptr, -1, -1,
+             0, seq.length(), seq.c_str(), (char *)qscore.data(), 0);
+    bam_aux_append(expected.get(), "qs", 'f', sizeof(qs), (uint8_t *)&qs);
+    bam_aux_append(expected.get(), "ch", 'i', sizeof(ch), (uint8_t *)&ch);
+    bam_aux_append(expected.get(), "st", 'Z', int(start_time.length() + 1),
+                   (uint8_t *)start_time.c_str());
+    bam_aux_append(expected.get(), "sp", 'i', sizeof(sp), (uint8_t *)&sp);
+    std::vector<uint8_t> mv{stride};
+    mv.insert(mv.end(), moves.begin(), moves.end());
+    bam_aux_update_array(expected.get(), "mv", 'c', int(mv.size()), mv.data());
+    bam_aux_update_array(expected.get(), "ML", 'C', int(probs.size()), (uint8_t *)probs.data());
+
+    utils::BamRecordBuilder builder;
+    builder.add_float_tag("qs", qs);
+    builder.add_int_tag("ch", ch);
+    builder.add_string_tag("st", start_time);
+    builder.add_uint_tag("sp", sp);
+    builder.add_byte_array_tag("mv", 'c', stride, moves.data(), moves.size());
+    builder.add_byte_array_tag("ML", 'C', probs.data(), probs.size());
+    const auto aux_size = builder.aux_size();
+
+    auto recycle = GENERATE(false, true);
+    CAPTURE(recycle);
+    BamPtr recycled;
+    if (recycle) {
+        // A record with different contents, to make sure nothing of it survives.
+        recycled = BamPtr(bam_init1());
+        bam_set1(recycled.get(), 3, "old", 0, -1, -1, 0, 0, nullptr, -1, -1, 0, 4, "TTTT", nullptr,
+                 0);
+        const int32_t old_tag = 7;
+        bam_aux_append(recycled.get(), "xx", 'i', sizeof(old_tag), (uint8_t *)&old_tag);
+    }
+    auto record = builder.build(read_id, seq, qstring, std::move(recycled));
+    CHECK(builder.aux_size() == 0);
+
+    REQUIRE(record->l_data == expected->l_data);
+    CHECK(size_t(bam_get_l_aux(record.get())) == aux_size);
+    CHECK(std::memcmp(record->data, expected->data, expected->l_data) == 0);
+    CHECK(record->core.flag == expected->core.flag);
+    CHECK(record->core.tid == expected->core.tid);
+    CHECK(record->core.pos == expected->core.pos);
+    CHECK(record->core.l_qseq == expected->core.l_qseq);
+    CHECK(record->core.l_qname == expected->core.l_qname);
+    CHECK(record->core.l_extranul == expected->core.l_extranul);
+    CHECK(bam_aux2f(bam_aux_get(record.get(), "qs")) == qs);
+    CHECK(bam_aux_get(record.get(), "xx") == nullptr);
+}
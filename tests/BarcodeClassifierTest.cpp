@@ -14,9 +14,11 @@
 #include <catch2/catch.hpp>
 #include <htslib/sam.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <filesystem>
 #include <string>
+#include <utility>
 #include <vector>
 
 #define TEST_GROUP "[barcode_demux]"
@@ -515,4 +517,38 @@ TEST_CASE(
             "Either custom kit must include kit arrangement or a kit name needs to be passed in.");
 }
 
+TEST_CASE("BarcodeClassifierNode: check batches drop secondary and supplementary records",
+          TEST_GROUP) {
+    const bool trim_barcodes = GENERATE(true, false);
+    CAPTURE(trim_barcodes);
+
+    auto client_info = std::make_shared<DefaultClientInfo>();
+    client_info->contexts().register_context<const demux::BarcodingInfo>(
+            create_barcoding_info({"SQK-RBK114-96"}, false, trim_barcodes, std::nullopt,
+                                  std::nullopt, std::nullopt));
+    const auto test_file =
+            fs::path(get_data_dir("barcode_demux/single_end")) / "SQK-RBK114-96_BC01.fastq";
+    auto add_node = [](PipelineDescriptor& pipeline_desc, NodeHandle sink) {
+        pipeline_desc.add_node<BarcodeClassifierNode>({sink}, 8);
+    };
+
+    // Secondary and supplementary records are only dropped when trimming.
+    auto records = ReadRecordsWithAlignmentCopies(test_file.string(), client_info);
+    std::vector<std::pair<std::string, uint16_t>> expected;
+    for (const auto& bam_message : records) {
+        const bam1_t* record = bam_message.bam_ptr.get();
+        if (!trim_barcodes || !(record->core.flag & (BAM_FSUPPLEMENTARY | BAM_FSECONDARY))) {
+            expected.emplace_back(bam_get_qname(record), record->core.flag);
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+    REQUIRE(!expected.empty());
+
+    auto single_output = ProcessBamRecords(add_node, std::move(records), false);
+    auto batch_output = ProcessBamRecords(
+            add_node, ReadRecordsWithAlignmentCopies(test_file.string(), client_info), true);
+    CHECK(single_output == expected);
+    CHECK(batch_output == single_output);
+}
+
 }  // namespace dorado::barcode_classifier_test
@@ -87,3 +87,52 @@ TEST_CASE("BarcodeDemuxerNode: check correct output files are created", TEST_GRO
         }
     }
 }
+
+TEST_CASE("BarcodeDemuxerNode: every record is written to its barcode's file", TEST_GROUP) {
+    const bool sort_bam = GENERATE(false, true);
+    CAPTURE(sort_bam);
+    auto tmp_dir = make_temp_dir("dorado_demuxer");
+
+    const std::vector<std::string> barcodes = {"bc01", "bc02", "bc03", "bc04", "unclassified"};
+    const size_t records_per_barcode = 500;
+    {
+        dorado::PipelineDescriptor pipeline_desc;
+        auto demuxer = pipeline_desc.add_node<BarcodeDemuxerNode>({}, tmp_dir.m_path.string(), 8,
+                                                                  false, nullptr, sort_bam);
+        auto pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
+
+        SamHdrPtr hdr(sam_hdr_init());
+        sam_hdr_add_line(hdr.get(), "SQ", "ID", "foo", "LN", "100", "SN", "ref", NULL);
+        auto& demux_writer_ref = dynamic_cast<BarcodeDemuxerNode&>(pipeline->get_node_ref(demuxer));
+        demux_writer_ref.set_header(hdr.get());
+
+        // Interleave the barcodes, so the writer threads contend for each file.
+        auto client_info = std::make_shared<dorado::DefaultClientInfo>();
+        for (size_t i = 0; i < records_per_barcode; ++i) {
+            for (const auto& bc : barcodes) {
+                for (auto& rec : create_bam_reader(bc)) {
+                    pipeline->push_message(BamMessage{std::move(rec), client_info});
+                }
+            }
+        }
+        pipeline->terminate(DefaultFlushOptions());
+
+        size_t last_progress = 0;
+        demux_writer_ref.finalise_hts_files([&last_progress](size_t progress) {
+            CHECK(progress >= last_progress);
+            last_progress = progress;
+        });
+        CHECK(last_progress == 100);
+    }
+
+    for (const auto& bc : barcodes) {
+        CAPTURE(bc);
+        HtsReader reader((tmp_dir.m_path / (bc + ".bam")).string(), std::nullopt);
+        size_t num_records = 0;
+        while (reader.read()) {
+            CHECK(reader.get_tag<std::string>("BC") == bc);
+            ++num_records;
+        }
+        CHECK(num_records == records_per_barcode);
+    }
+}
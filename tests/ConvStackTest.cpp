@@ -0,0 +1,76 @@
+#include "basecall/CRFModelConfig.h"
+#include "basecall/nn/CRFModel.h"
+
+#include <torch/torch.h>
+// Catch2 must come after torch since both define CHECK()
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+#define TEST_GROUP "[conv_stack]"
+
+using namespace dorado::basecall;
+using namespace dorado::basecall::nn;
+
+namespace {
+
+// Layouts of the v4 hac and v5 sup conv stacks.
+std::vector<ConvParams> hac_convs() {
+    return {{1, 16, 5, 1, Activation::SWISH},
+            {16, 16, 5, 1, Activation::SWISH},
+            {16, 384, 19, 6, Activation::TANH}};
+}
+
+std::vector<ConvParams> sup_convs() {
+    return {{1, 64, 5, 1, Activation::SWISH},
+            {64, 64, 5, 1, Activation::SWISH},
+            {64, 128, 9, 3, Activation::SWISH},
+            {128, 128, 9, 2, Activation::SWISH},
+            {128, 512, 5, 2, Activation::SWISH_CLAMP}};
+}
+
+}  // namespace
+
+TEST_CASE("ConvStack: CPU engine matches torch", TEST_GROUP) {
+    torch::NoGradGuard no_grad;
+    torch::manual_seed(0);
+    const bool sup = GENERATE(false, true);
+    CAPTURE(sup);
+
+    ConvStack stack(sup ? sup_convs() : hac_convs());
+    // Chunk sizes which are and aren't a multiple of the total stride, on either side of the
+    // im2col block size.
+    for (int64_t T : {1200, 1000, 1999}) {
+        CAPTURE(T);
+        const auto x = torch::randn({3, 1, T});
+        const auto expected = stack->forward_torch(x);
+        const auto actual = stack->forward_cpu(x);
+        REQUIRE(actual.sizes() == expected.sizes());
+        CHECK(actual.is_contiguous());
+        CHECK(torch::allclose(actual, expected, 1e-4, 1e-5));
+    }
+}
+
+TEST_CASE("ConvStack: CPU engine output is owned by the caller", TEST_GROUP) {
+    torch::NoGradGuard no_grad;
+    torch::manual_seed(1);
+    ConvStack stack(hac_convs());
+
+    const auto x1 = torch::randn({2, 1, 600});
+    const auto first = stack->forward_cpu(x1);
+    const auto first_copy = first.clone();
+    // A second call reuses the workspaces, which mustn't change the first output.
+    stack->forward_cpu(torch::randn({2, 1, 600}));
+    CHECK(torch::equal(first, first_copy));
+}
+
+TEST_CASE("ConvStack: CPU engine reads non-contiguous input", TEST_GROUP) {
+    torch::NoGradGuard no_grad;
+    torch::manual_seed(2);
+    ConvStack stack(std::vector<ConvParams>{{2, 8, 5, 1, Activation::SWISH},
+                                            {8, 16, 3, 2, Activation::TANH}});
+
+    const auto x = torch::randn({4, 300, 2}).transpose(1, 2);
+    REQUIRE(!x.is_contiguous());
+    CHECK(torch::allclose(stack->forward_cpu(x), stack->forward_torch(x), 1e-4, 1e-5));
+}
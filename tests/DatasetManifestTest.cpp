@@ -0,0 +1,143 @@
+#include "data_loader/DatasetManifest.h"
+
+#include "TestUtils.h"
+#include "data_loader/DataLoader.h"
+#include "utils/PostCondition.h"
+#include "utils/dev_utils.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#define CUT_TAG "[DatasetManifest]"
+
+namespace fs = std::filesystem;
+using dorado::DatasetManifest;
+
+namespace {
+
+// A copy of the single read POD5 file in a directory of its own, so no other test has scanned it.
+fs::path copy_single_pod5(const fs::path& dir) {
+    const auto path = dir / "reads.pod5";
+    fs::copy_file(get_single_pod5_file_path(), path);
+    return path;
+}
+
+}  // namespace
+
+TEST_CASE(CUT_TAG ": one pass collects what the dataset queries need", CUT_TAG) {
+    const auto data_path = get_data_dir("multi_read_pod5");
+    const auto cache_dir = make_temp_dir("manifest_cache");
+
+    const auto manifest = DatasetManifest::get(data_path, false, true, cache_dir.m_path);
+    REQUIRE(manifest->files().size() == 1);
+    const auto& file = manifest->files().front();
+    CHECK(file.scanned);
+    CHECK_FALSE(file.is_fast5);
+    CHECK(int(file.num_reads) == dorado::DataLoader::get_num_reads(data_path, std::nullopt, {},
+                                                                   false));
+    CHECK(file.sample_rate == dorado::DataLoader::get_sample_rate(data_path, false));
+    CHECK_FALSE(file.run_infos.empty());
+    CHECK(file.has_channel_reads);
+    CHECK(file.channel_reads.size() == file.num_reads);
+
+    SECTION("channel reads are only returned when requested") {
+        const auto summary = DatasetManifest::get(data_path, false, false, cache_dir.m_path);
+        REQUIRE(summary->files().size() == 1);
+        CHECK(summary->files().front().num_reads == file.num_reads);
+        CHECK(summary->files().front().channel_reads.empty());
+    }
+}
+
+TEST_CASE(CUT_TAG ": cache round trip", CUT_TAG) {
+    const auto data_dir = make_temp_dir("manifest_data");
+    const auto cache_dir = make_temp_dir("manifest_cache");
+    copy_single_pod5(data_dir.m_path);
+    const bool cache_channel_reads = GENERATE(false, true);
+    CAPTURE(cache_channel_reads);
+    dorado::utils::details::g_dev_options["manifest_cache_channel_reads"] = {
+            cache_channel_reads ? 1.0 : 0.0, false};
+    auto restore_dev_options = dorado::utils::PostCondition(
+            [] { dorado::utils::details::g_dev_options.erase("manifest_cache_channel_reads"); });
+
+    const auto manifest = DatasetManifest::get(data_dir.m_path, false, true, cache_dir.m_path);
+    const auto path = DatasetManifest::cache_path(cache_dir.m_path, data_dir.m_path, false);
+    REQUIRE(fs::exists(path));
+
+    const auto cached = DatasetManifest::load(path);
+    REQUIRE(cached.size() == 1);
+    const auto& expected = manifest->files().front();
+    const auto& file = cached.front();
+    CHECK(fs::equivalent(file.path, expected.path));
+    CHECK(file.size == expected.size);
+    CHECK(file.mtime == expected.mtime);
+    CHECK(file.num_reads == expected.num_reads);
+    CHECK(file.sample_rate == expected.sample_rate);
+    REQUIRE(file.run_infos.size() == expected.run_infos.size());
+    CHECK(file.run_infos.front().acquisition_id == expected.run_infos.front().acquisition_id);
+    CHECK(file.run_infos.front().sequencing_kit == expected.run_infos.front().sequencing_kit);
+    // Channel reads are only cached when asked for.
+    CHECK(file.has_channel_reads == cache_channel_reads);
+    if (!cache_channel_reads) {
+        CHECK(file.channel_reads.empty());
+        return;
+    }
+    REQUIRE(file.channel_reads.size() == expected.channel_reads.size());
+    CHECK(file.channel_reads.front().read_id == expected.channel_reads.front().read_id);
+    CHECK(file.channel_reads.front().read_number == expected.channel_reads.front().read_number);
+}
+
+TEST_CASE(CUT_TAG ": unchanged files are served from the cache", CUT_TAG) {
+    const auto data_dir = make_temp_dir("manifest_data");
+    const auto cache_dir = make_temp_dir("manifest_cache");
+    const auto pod5_path = copy_single_pod5(data_dir.m_path);
+    const auto path = DatasetManifest::cache_path(cache_dir.m_path, data_dir.m_path, false);
+
+    // A cache entry whose contents can't have come from scanning the file.
+    dorado::DatasetFile file;
+    file.path = pod5_path.string();
+    file.size = fs::file_size(pod5_path);
+    file.mtime = fs::last_write_time(pod5_path).time_since_epoch().count();
+    file.scanned = true;
+    file.num_reads = 42;
+    file.sample_rate = 1234;
+    REQUIRE(DatasetManifest::save(path, {file}));
+
+    auto manifest = DatasetManifest::get(data_dir.m_path, false, false, cache_dir.m_path);
+    REQUIRE(manifest->files().size() == 1);
+    CHECK(manifest->files().front().num_reads == 42);
+    CHECK(manifest->files().front().sample_rate == 1234);
+
+    SECTION("modified files are scanned again") {
+        fs::last_write_time(pod5_path, fs::last_write_time(pod5_path) + std::chrono::hours(1));
+        manifest = DatasetManifest::get(data_dir.m_path, false, false, cache_dir.m_path);
+        REQUIRE(manifest->files().size() == 1);
+        CHECK(manifest->files().front().num_reads == 1);
+        CHECK(manifest->files().front().sample_rate == 4000);
+        CHECK(DatasetManifest::load(path).front().num_reads == 1);
+    }
+    SECTION("channel reads not in the cache are scanned") {
+        manifest = DatasetManifest::get(data_dir.m_path, false, true, cache_dir.m_path);
+        REQUIRE(manifest->files().size() == 1);
+        CHECK(manifest->files().front().num_reads == 1);
+        CHECK(manifest->files().front().channel_reads.size() == 1);
+    }
+}
+
+TEST_CASE(CUT_TAG ": invalid caches are ignored", CUT_TAG) {
+    const auto data_dir = make_temp_dir("manifest_data");
+    const auto cache_dir = make_temp_dir("manifest_cache");
+    copy_single_pod5(data_dir.m_path);
+    const auto path = DatasetManifest::cache_path(cache_dir.m_path, data_dir.m_path, false);
+    fs::create_directories(path.parent_path());
+    std::ofstream(path, std::ios::binary) << "DORMNFST garbage";
+
+    CHECK(DatasetManifest::load(path).empty());
+    const auto manifest = DatasetManifest::get(data_dir.m_path, false, false, cache_dir.m_path);
+    REQUIRE(manifest->files().size() == 1);
+    CHECK(manifest->files().front().num_reads == 1);
+    // Replaced by a valid cache.
+    CHECK(DatasetManifest::load(path).size() == 1);
+}
@@ -8,6 +8,7 @@
 #include "read_pipeline/SubreadTaggerNode.h"
 #include "splitter/DuplexReadSplitter.h"
 #include "splitter/ReadSplitter.h"
+#include "splitter/splitter_utils.h"
 
 #include <torch/torch.h>
 // Catch2 must come after torch since both define CHECK()
@@ -15,6 +16,7 @@
 
 #include <algorithm>
 #include <filesystem>
+#include <utility>
 #include <vector>
 
 #define TEST_GROUP "[DuplexSplitTest]"
@@ -249,3 +251,52 @@ TEST_CASE("Test split where only one subread is generated", TEST_GROUP) {
     const auto &read_common = get_read_common_data(messages[0]);
     CHECK(read_common.parent_read_id != read_common.read_id);
 }
+
+TEST_CASE("16 bit pore signal detection matches float32", TEST_GROUP) {
+    const auto read = make_read();
+    const auto &raw_data = read->read_common.raw_data;
+    REQUIRE(raw_data.dtype() == at::ScalarType::Half);
+    const auto data_as_float32 = raw_data.to(at::kFloat);
+
+    const dorado::splitter::DuplexSplitSettings settings(false);
+    const auto ranges_16bit = dorado::splitter::detect_pore_signal_16bit(
+            raw_data, settings.pore_thr, settings.pore_cl_dist, settings.expect_pore_prefix);
+    const auto ranges_float = dorado::splitter::detect_pore_signal<float>(
+            data_as_float32, settings.pore_thr, settings.pore_cl_dist, settings.expect_pore_prefix);
+
+    REQUIRE(!ranges_float.empty());
+    REQUIRE(ranges_16bit.size() == ranges_float.size());
+    for (size_t i = 0; i < ranges_float.size(); ++i) {
+        CAPTURE(i);
+        CHECK(ranges_16bit[i].start_sample == ranges_float[i].start_sample);
+        CHECK(ranges_16bit[i].end_sample == ranges_float[i].end_sample);
+        CHECK(ranges_16bit[i].argmax_sample == ranges_float[i].argmax_sample);
+        CHECK(ranges_16bit[i].max_val == ranges_float[i].max_val);
+    }
+
+    // The same signal as int16 should also give the same answer as the scalar path.
+    const auto data_as_int16 = (data_as_float32 * 100).to(at::kShort);
+    const auto int16_ranges_16bit =
+            dorado::splitter::detect_pore_signal_16bit(data_as_int16, 240, 500, 0);
+    const auto int16_ranges = dorado::splitter::detect_pore_signal<int16_t>(data_as_int16,
+                                                                           int16_t(240), 500, 0);
+    REQUIRE(int16_ranges_16bit.size() == int16_ranges.size());
+    for (size_t i = 0; i < int16_ranges.size(); ++i) {
+        CAPTURE(i);
+        CHECK(int16_ranges_16bit[i].start_sample == int16_ranges[i].start_sample);
+        CHECK(int16_ranges_16bit[i].end_sample == int16_ranges[i].end_sample);
+        CHECK(int16_ranges_16bit[i].argmax_sample == int16_ranges[i].argmax_sample);
+    }
+
+    // argmax over arbitrary ranges, including ones with a ragged SIMD tail.
+    for (const auto &[begin, end] : {std::pair<int64_t, int64_t>{0, 1},
+                                     {3, 20},
+                                     {100, 1117},
+                                     {5000, 70001},
+                                     {0, raw_data.size(0)}}) {
+        CAPTURE(begin, end);
+        const auto span = data_as_float32.index({at::indexing::Slice(begin, end)});
+        const auto expected = begin + span.argmax().item<int64_t>();
+        CHECK(dorado::splitter::argmax_16bit(raw_data, begin, end) == uint64_t(expected));
+    }
+}
@@ -1,8 +1,12 @@
 #include "MessageSinkUtils.h"
 #include "TestUtils.h"
 #include "data_loader/DataLoader.h"
+#include "data_loader/Fast5ProcessPool.h"
 #include "read_pipeline/ReadPipeline.h"
+#include "utils/PostCondition.h"
+#include "utils/dev_utils.h"
 
+#include <ATen/Functions.h>
 #include <catch2/catch.hpp>
 
 #include <memory>
@@ -16,7 +20,7 @@ TEST_CASE(TEST_GROUP "Test loading single-read Fast5 files") {
 }
 
 TEST_CASE(TEST_GROUP "Test loading single-read Fast5 file, empty read list") {
-    auto read_list = std::unordered_set<std::string>();
+    auto read_list = dorado::utils::ReadIdSet();
     CHECK(CountSinkReads(get_fast5_data_dir(), "cpu", 1, 0, read_list, {}) == 0);
 }
 
@@ -25,13 +29,13 @@ TEST_CASE(TEST_GROUP "Test loading single-read Fast5 file, no read list") {
 }
 
 TEST_CASE(TEST_GROUP "Test loading single-read Fast5 file, mismatched read list") {
-    auto read_list = std::unordered_set<std::string>{"read_1"};
+    auto read_list = dorado::utils::ReadIdSet{"read_1"};
     CHECK(CountSinkReads(get_fast5_data_dir(), "cpu", 1, 0, read_list, {}) == 0);
 }
 
 TEST_CASE(TEST_GROUP "Test loading single-read Fast5 file, matched read list") {
     // read present in Fast5 file
-    auto read_list = std::unordered_set<std::string>{"59097f00-0f1c-4fac-aea2-3c23d79b0a58"};
+    auto read_list = dorado::utils::ReadIdSet{"59097f00-0f1c-4fac-aea2-3c23d79b0a58"};
     CHECK(CountSinkReads(get_fast5_data_dir(), "cpu", 1, 0, read_list, {}) == 1);
 }
 
@@ -43,11 +47,11 @@ TEST_CASE(TEST_GROUP "Test calculating number of reads from fast5, read ids list
     }
 
     SECTION("fast5 file and read ids with 0 reads") {
-        auto read_list = std::unordered_set<std::string>();
+        auto read_list = dorado::utils::ReadIdSet();
         CHECK(dorado::DataLoader::get_num_reads(data_path, read_list, {}, false) == 0);
     }
     SECTION("fast5 file and read ids with 2 reads") {
-        auto read_list = std::unordered_set<std::string>();
+        auto read_list = dorado::utils::ReadIdSet();
         read_list.insert("1");
         read_list.insert("2");
         CHECK(dorado::DataLoader::get_num_reads(data_path, read_list, {}, false) == 1);
@@ -58,3 +62,44 @@ TEST_CASE(TEST_GROUP "Find sample rate from fast5") {
     auto data_path = get_fast5_data_dir();
     CHECK(dorado::DataLoader::get_sample_rate(data_path, false) == 6024);
 }
+
+TEST_CASE(TEST_GROUP "Reads loaded by worker processes match reads loaded in-process") {
+    if (!dorado::Fast5ProcessPool::is_supported()) {
+        return;
+    }
+
+    auto load = [](size_t num_workers) {
+        dorado::utils::details::g_dev_options["fast5_worker_processes"] = {double(num_workers),
+                                                                              false};
+        auto restore = dorado::utils::PostCondition(
+                [] { dorado::utils::details::g_dev_options.erase("fast5_worker_processes"); });
+
+        dorado::PipelineDescriptor pipeline_desc;
+        std::vector<dorado::Message> messages;
+        pipeline_desc.add_node<MessageSinkToVector>({}, 100, messages);
+        auto pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
+        dorado::DataLoader loader(*pipeline, "cpu", 1, 0, std::nullopt, {});
+        loader.load_reads(get_fast5_data_dir(), false, dorado::ReadOrder::UNRESTRICTED);
+        pipeline.reset();
+        return ConvertMessages<dorado::SimplexReadPtr>(std::move(messages));
+    };
+
+    auto expected = load(0);
+    auto actual = load(2);
+    REQUIRE(expected.size() == 1);
+    REQUIRE(actual.size() == expected.size());
+
+    const auto& expected_read = expected[0]->read_common;
+    const auto& actual_read = actual[0]->read_common;
+    CHECK(actual_read.read_id == expected_read.read_id);
+    CHECK(actual_read.sample_rate == expected_read.sample_rate);
+    CHECK(actual_read.attributes.channel_number == expected_read.attributes.channel_number);
+    CHECK(actual_read.attributes.mux == expected_read.attributes.mux);
+    CHECK(actual_read.attributes.read_number == expected_read.attributes.read_number);
+    CHECK(actual_read.attributes.start_time == expected_read.attributes.start_time);
+    CHECK(actual_read.attributes.fast5_filename == expected_read.attributes.fast5_filename);
+    CHECK(actual_read.flowcell_id == expected_read.flowcell_id);
+    CHECK(actual[0]->scaling == expected[0]->scaling);
+    CHECK(actual[0]->offset == expected[0]->offset);
+    CHECK(at::equal(actual_read.raw_data, expected_read.raw_data));
+}
@@ -0,0 +1,59 @@
+#include "utils/memory_utils.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#define CUT_TAG "[MemoryUtils]"
+#define DEFINE_TEST(name) TEST_CASE(CUT_TAG " " name, CUT_TAG)
+
+using namespace dorado::utils;
+
+DEFINE_TEST("process memory is within host memory") {
+    const size_t resident_bytes = process_memory_bytes();
+    if (resident_bytes == 0) {
+        // Not supported on this platform.
+        CHECK(peak_process_memory_bytes() == 0);
+        return;
+    }
+    CHECK(resident_bytes <= (total_host_memory_GB() + 1) * BYTES_PER_GB);
+    CHECK(peak_process_memory_bytes() >= resident_bytes);
+}
+
+DEFINE_TEST("peak process memory tracks allocations") {
+    const bool can_reset = reset_peak_process_memory();
+    const size_t start_resident_bytes = process_memory_bytes();
+    const size_t start_peak_bytes = peak_process_memory_bytes();
+    if (start_resident_bytes == 0 || start_peak_bytes == 0) {
+        return;
+    }
+
+    // Touch every page so that it's resident.
+    constexpr size_t allocation_bytes = 256 * 1024 * 1024;
+    size_t peak_with_allocation_bytes = 0;
+    {
+        std::vector<char> allocation(allocation_bytes);
+        std::fill(allocation.begin(), allocation.end(), char(1));
+        const size_t resident_bytes = process_memory_bytes();
+        CHECK(resident_bytes >= start_resident_bytes + allocation_bytes / 2);
+        peak_with_allocation_bytes = peak_process_memory_bytes();
+        CHECK(peak_with_allocation_bytes >= resident_bytes);
+        CHECK(allocation.back() == 1);
+    }
+
+    // The peak still covers the allocation once it's released. The kernel's RSS counters are
+    // batched per thread, so the peak can be a few pages off the resident figure read above.
+    CHECK(peak_with_allocation_bytes >= start_peak_bytes);
+    CHECK(peak_process_memory_bytes() >= start_resident_bytes + allocation_bytes / 2);
+
+    // Until it's reset.
+    if (can_reset) {
+        REQUIRE(reset_peak_process_memory());
+        const size_t resident_bytes = process_memory_bytes();
+        const size_t peak_bytes = peak_process_memory_bytes();
+        CHECK(peak_bytes < peak_with_allocation_bytes);
+        CHECK(peak_bytes >= resident_bytes);
+    }
+}
@@ -1,15 +1,27 @@
 #pragma once
 
 #include "data_loader/DataLoader.h"
+#include "read_pipeline/HtsReader.h"
 #include "read_pipeline/ReadPipeline.h"
 
+#include <htslib/sam.h>
+
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 class MessageSinkToVector : public dorado::MessageSink {
 public:
-    MessageSinkToVector(size_t max_messages, std::vector<dorado::Message>& messages)
+    MessageSinkToVector(size_t max_messages,
+                        std::vector<dorado::Message>& messages,
+                        bool accept_batches = false)
             : MessageSink(max_messages, 0), m_messages(messages) {
+        if (accept_batches) {
+            enable_batch_input();
+        }
         start_threads();
     }
     ~MessageSinkToVector() { terminate_impl(); }
@@ -54,12 +66,58 @@ std::vector<T> ConvertMessages(std::vector<dorado::Message>&& messages) {
     return converted_messages;
 }
 
+// Reads the records in |filename|, each followed by a secondary and a supplementary copy of it.
+inline std::vector<dorado::BamMessage> ReadRecordsWithAlignmentCopies(
+        const std::string& filename,
+        const std::shared_ptr<dorado::ClientInfo>& client_info) {
+    std::vector<dorado::BamMessage> records;
+    dorado::HtsReader reader(filename, std::nullopt);
+    while (reader.read()) {
+        for (uint16_t flag : {0, BAM_FSECONDARY, BAM_FSUPPLEMENTARY}) {
+            dorado::BamPtr record(bam_dup1(reader.record.get()));
+            record->core.flag |= flag;
+            records.push_back(dorado::BamMessage{std::move(record), client_info});
+        }
+    }
+    return records;
+}
+
+// Pushes |records| through the node added by |add_node|, either as a single BamBatch or one
+// message at a time, and returns the sorted read id and flag of each record it outputs.
+template <typename AddNode>
+std::vector<std::pair<std::string, uint16_t>> ProcessBamRecords(
+        const AddNode& add_node,
+        std::vector<dorado::BamMessage> records,
+        bool as_batch) {
+    dorado::PipelineDescriptor pipeline_desc;
+    std::vector<dorado::Message> messages;
+    auto sink = pipeline_desc.add_node<MessageSinkToVector>({}, 100, messages);
+    add_node(pipeline_desc, sink);
+    auto pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
+    if (as_batch) {
+        pipeline->push_message(dorado::BamBatch{std::move(records)});
+    } else {
+        for (auto& record : records) {
+            pipeline->push_message(std::move(record));
+        }
+    }
+    pipeline.reset();
+
+    std::vector<std::pair<std::string, uint16_t>> output;
+    for (auto& bam_message : ConvertMessages<dorado::BamMessage>(std::move(messages))) {
+        const bam1_t* record = bam_message.bam_ptr.get();
+        output.emplace_back(bam_get_qname(record), record->core.flag);
+    }
+    std::sort(output.begin(), output.end());
+    return output;
+}
+
 inline size_t CountSinkReads(const std::filesystem::path& data_path,
                              const std::string& device,
                              size_t num_worker_threads,
                              size_t max_reads,
-                             std::optional<std::unordered_set<std::string>> read_list,
-                             std::unordered_set<std::string> read_ignore_list) {
+                             std::optional<dorado::utils::ReadIdSet> read_list,
+                             dorado::utils::ReadIdSet read_ignore_list) {
     dorado::PipelineDescriptor pipeline_desc;
     std::vector<dorado::Message> messages;
     pipeline_desc.add_node<MessageSinkToVector>({}, 100, messages);
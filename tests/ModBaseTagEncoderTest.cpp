@@ -0,0 +1,131 @@
+#include "modbase/ModBaseTagEncoder.h"
+
+#include "modbase/ModBaseContext.h"
+#include "utils/sequence_utils.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#define TEST_GROUP "[modbase_tag_encoder]"
+
+using dorado::modbase::ModBaseContext;
+using dorado::modbase::ModBaseTagEncoder;
+
+namespace {
+
+// The MM string and ML values as built from ModBaseContext's sequence masks, with the reverse
+// complemented sequence and reversed probabilities for the complementary strand of duplex reads.
+std::pair<std::string, std::vector<uint8_t>> reference_tags(
+        const std::string &seq,
+        const std::vector<std::string> &alphabet,
+        const std::string &context,
+        const std::vector<uint8_t> &probs,
+        uint8_t threshold,
+        bool is_duplex) {
+    const size_t num_channels = alphabet.size();
+    ModBaseContext context_handler;
+    if (!context.empty()) {
+        REQUIRE(context_handler.decode(context));
+    }
+    auto mask = context_handler.get_sequence_mask(seq);
+    context_handler.update_mask(mask, seq, alphabet, probs, threshold);
+    if (is_duplex) {
+        const auto rc_seq = dorado::utils::reverse_complement(seq);
+        std::vector<uint8_t> rc_probs(probs.size());
+        for (size_t i = 0; i < seq.size(); ++i) {
+            std::copy_n(probs.begin() + (seq.size() - 1 - i) * num_channels, num_channels,
+                        rc_probs.begin() + i * num_channels);
+        }
+        auto rc_mask = context_handler.get_sequence_mask(rc_seq);
+        context_handler.update_mask(rc_mask, rc_seq, alphabet, rc_probs, threshold);
+        for (size_t i = 0; i < seq.size(); ++i) {
+            mask[i] = mask[i] || rc_mask[seq.size() - 1 - i];
+        }
+    }
+
+    std::string mm;
+    std::vector<uint8_t> ml;
+    for (int strand = 0; strand < (is_duplex ? 2 : 1); ++strand) {
+        char cardinal = 0;
+        for (size_t channel = 0; channel < num_channels; ++channel) {
+            if (alphabet[channel].size() == 1 &&
+                std::string("ACGT").find(alphabet[channel]) != std::string::npos) {
+                cardinal = alphabet[channel][0];
+                continue;
+            }
+            const char base = strand ? dorado::utils::complement_table[cardinal] : cardinal;
+            mm += std::string(1, base) + (strand ? "-" : "+") + alphabet[channel];
+            mm += context_handler.motif(cardinal).size() > 1 ? "?" : ".";
+            int skipped = 0;
+            for (size_t i = 0; i < seq.size(); ++i) {
+                if (seq[i] != base) {
+                    continue;
+                }
+                if (mask[i]) {
+                    mm += "," + std::to_string(skipped);
+                    ml.push_back(probs[i * num_channels + channel]);
+                    skipped = 0;
+                } else {
+                    ++skipped;
+                }
+            }
+            mm += ";";
+        }
+    }
+    return {mm, ml};
+}
+
+}  // namespace
+
+TEST_CASE("ModBaseTagEncoder: matches context masks", TEST_GROUP) {
+    const auto [alphabet, context] = GENERATE(
+            std::make_pair(std::vector<std::string>{"A", "C", "m", "h", "G", "T"}, "_:XG:_:_"),
+            std::make_pair(std::vector<std::string>{"A", "C", "m", "h", "G", "T"}, ""),
+            std::make_pair(std::vector<std::string>{"A", "a", "C", "m", "G", "T"}, "DRXCH:_:_:_"),
+            std::make_pair(std::vector<std::string>{"A", "a", "C", "m", "G", "T"}, "X:CXG:_:_"),
+            std::make_pair(std::vector<std::string>{"A", "C", "17802", "G", "T"}, "_:_:_:TXN"));
+    const bool is_duplex = GENERATE(false, true);
+    CAPTURE(context, is_duplex);
+
+    std::mt19937 rng(42);
+    ModBaseTagEncoder encoder(alphabet, context);
+    std::string mm;
+    std::vector<uint8_t> ml;
+    for (int trial = 0; trial < 50; ++trial) {
+        std::string seq(1 + rng() % 100, 'A');
+        for (auto &base : seq) {
+            // Some reads have bases which are never called.
+            base = "ACGTN"[rng() % (trial % 3 == 0 ? 5 : 4)];
+        }
+        std::vector<uint8_t> probs(seq.size() * alphabet.size());
+        for (auto &prob : probs) {
+            prob = uint8_t(rng());
+        }
+        const auto threshold = uint8_t(rng());
+        CAPTURE(seq, threshold);
+
+        REQUIRE(encoder.encode(seq, probs, threshold, is_duplex, mm, ml));
+        const auto [expected_mm, expected_ml] =
+                reference_tags(seq, alphabet, context, probs, threshold, is_duplex);
+        CHECK(mm == expected_mm);
+        CHECK(ml == expected_ml);
+    }
+}
+
+TEST_CASE("ModBaseTagEncoder: invalid input", TEST_GROUP) {
+    CHECK_THROWS_AS(ModBaseTagEncoder({"A", "C", "m", "G", "T"}, "_:XG:_"), std::runtime_error);
+
+    std::string mm = "stale";
+    std::vector<uint8_t> ml{1};
+    ModBaseTagEncoder encoder({"A", "C", "5mC", "G", "T"}, "_:XG:_:_");
+    CHECK_FALSE(encoder.encode("ACGT", std::vector<uint8_t>(20, 255), 0, false, mm, ml));
+    CHECK(mm.empty());
+    CHECK(ml.empty());
+
+    CHECK_THROWS_AS(encoder.encode("ACGT", std::vector<uint8_t>(8, 255), 0, false, mm, ml),
+                    std::runtime_error);
+}
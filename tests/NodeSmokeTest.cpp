@@ -2,6 +2,8 @@
 #include "TestUtils.h"
 #include "api/runner_creation.h"
 #include "basecall/CRFModelConfig.h"
+#include "basecall/ModelRunner.h"
+#include "basecall/crf_utils.h"
 #include "demux/adapter_info.h"
 #include "demux/barcoding_info.h"
 #include "models/models.h"
@@ -16,7 +18,10 @@
 #include "read_pipeline/ReadFilterNode.h"
 #include "read_pipeline/ReadToBamTypeNode.h"
 #include "read_pipeline/ScalerNode.h"
+#include "utils/PostCondition.h"
 #include "utils/SampleSheet.h"
+#include "utils/dev_utils.h"
+#include "utils/memory_utils.h"
 #include "utils/parameters.h"
 #include "utils/trim_rapid_adapter.h"
 
@@ -32,9 +37,11 @@
 #include <catch2/catch.hpp>
 
 #include <algorithm>
+#include <cstdint>
 #include <filesystem>
 #include <functional>
 #include <random>
+#include <thread>
 
 #ifndef _WIN32
 #include <unistd.h>
@@ -179,9 +186,23 @@ DEFINE_TEST(NodeSmokeTestRead, "BasecallerNode") {
     auto pipeline_restart = GENERATE(false, true);
     CAPTURE(pipeline_restart);
     auto model_name = GENERATE("dna_r10.4.1_e8.2_400bps_fast@v4.2.0", "rna004_130bps_fast@v3.0.1");
+    auto pack_chunks = GENERATE(false, true);
+    CAPTURE(pack_chunks);
+    // Only CPU runners pipeline their batches.
+    auto cpu_pipeline_stages = GENERATE(1, 2);
+    CAPTURE(cpu_pipeline_stages);
 
     set_pipeline_restart(pipeline_restart);
 
+    // The test reads are all shorter than a chunk, so will be packed together when enabled.
+    dorado::utils::details::g_dev_options["pack_chunks"] = {pack_chunks ? 1.0 : 0.0, false};
+    dorado::utils::details::g_dev_options["cpu_pipeline_stages"] = {double(cpu_pipeline_stages),
+                                                                    false};
+    auto restore_dev_options = dorado::utils::PostCondition([] {
+        dorado::utils::details::g_dev_options.erase("pack_chunks");
+        dorado::utils::details::g_dev_options.erase("cpu_pipeline_stages");
+    });
+
     // BasecallerNode will skip reads that have already been basecalled.
     set_read_mutator([](dorado::SimplexReadPtr& read) { read->read_common.seq.clear(); });
 
@@ -228,6 +249,145 @@ DEFINE_TEST(NodeSmokeTestRead, "BasecallerNode") {
                                            1000, "BasecallerNode", 0);
 }
 
+namespace {
+
+// Loads the config of a downloaded model for CPU calling, with a small batch since that's slow.
+dorado::basecall::CRFModelConfig load_cpu_model_config(const TempDir& model_dir,
+                                                       const std::string& model_name) {
+    auto model_config = dorado::basecall::load_crf_model_config(model_dir.m_path / model_name);
+    model_config.basecaller.set_batch_size(8);
+    model_config.normalise_basecaller_params();
+    return model_config;
+}
+
+// Fills the first |num_chunks| slots of the batch with random signal, which is the same for
+// every runner given the same |seed|.
+void accept_random_chunks(dorado::basecall::ModelRunner& runner, int num_chunks, uint64_t seed) {
+    at::manual_seed(seed);
+    for (int i = 0; i < num_chunks; ++i) {
+        runner.accept_chunk(i, at::randn({int64_t(runner.config().num_features),
+                                          int64_t(runner.chunk_size())}));
+    }
+}
+
+// Calls a full batch of random signal, which is the same for every runner.
+std::vector<dorado::basecall::decode::DecodedChunk> call_random_chunks(
+        dorado::basecall::ModelRunner& runner) {
+    const int num_chunks = int(runner.batch_size());
+    accept_random_chunks(runner, num_chunks, 42);
+    return runner.call_chunks(num_chunks);
+}
+
+void check_same_calls(const std::vector<dorado::basecall::decode::DecodedChunk>& calls,
+                      const std::vector<dorado::basecall::decode::DecodedChunk>& expected) {
+    REQUIRE(calls.size() == expected.size());
+    for (size_t i = 0; i < calls.size(); ++i) {
+        CAPTURE(i);
+        CHECK(calls[i].sequence == expected[i].sequence);
+        CHECK(calls[i].qstring == expected[i].qstring);
+        CHECK(calls[i].moves == expected[i].moves);
+    }
+}
+
+}  // namespace
+
+TEST_CASE("SmokeTest: ModelRunners sharing a module match separately loaded ones", "[SmokeTest]") {
+    const std::string model_name = "dna_r10.4.1_e8.2_400bps_fast@v4.2.0";
+    const auto model_dir = download_model(model_name);
+    const auto model_config = load_cpu_model_config(model_dir, model_name);
+
+    // The first runner's probe batch gets the module ready to be shared.
+    dorado::basecall::ModelRunner first_runner(model_config, "cpu");
+    first_runner.measure_working_memory();
+    dorado::basecall::ModelRunner shared_runner(model_config, "cpu", first_runner.module());
+    dorado::basecall::ModelRunner separate_runner(model_config, "cpu");
+    CHECK(shared_runner.module().ptr() == first_runner.module().ptr());
+    CHECK(separate_runner.module().ptr() != first_runner.module().ptr());
+
+    const auto expected = call_random_chunks(separate_runner);
+    check_same_calls(call_random_chunks(first_runner), expected);
+    check_same_calls(call_random_chunks(shared_runner), expected);
+}
+
+TEST_CASE("SmokeTest: Pipelined ModelRunner matches unpipelined calls", "[SmokeTest]") {
+    const std::string model_name = "dna_r10.4.1_e8.2_400bps_fast@v4.2.0";
+    const auto model_dir = download_model(model_name);
+    const auto model_config = load_cpu_model_config(model_dir, model_name);
+
+    dorado::basecall::ModelRunner runner(model_config, "cpu");
+    dorado::basecall::ModelRunner pipelined_runner(model_config, "cpu");
+    pipelined_runner.set_num_pipeline_stages(2);
+    CHECK(runner.max_batches_in_flight() == 1);
+    REQUIRE(pipelined_runner.max_batches_in_flight() == 2);
+
+    // Each batch has different signal, and the last is partial.
+    const int batch_size = int(runner.batch_size());
+    const std::vector<int> batch_num_chunks{batch_size, batch_size, batch_size / 2};
+    std::vector<std::vector<dorado::basecall::decode::DecodedChunk>> expected;
+    for (size_t i = 0; i < batch_num_chunks.size(); ++i) {
+        accept_random_chunks(runner, batch_num_chunks[i], i);
+        expected.push_back(runner.call_chunks(batch_num_chunks[i]));
+    }
+
+    // Each batch's forward pass runs while the one before it is decoded.
+    std::vector<std::vector<dorado::basecall::decode::DecodedChunk>> pipelined;
+    for (size_t i = 0; i < batch_num_chunks.size(); ++i) {
+        accept_random_chunks(pipelined_runner, batch_num_chunks[i], i);
+        pipelined_runner.submit_chunks(batch_num_chunks[i]);
+        if (i > 0) {
+            pipelined.push_back(pipelined_runner.collect_chunks());
+        }
+    }
+    pipelined.push_back(pipelined_runner.collect_chunks());
+    CHECK_THROWS(pipelined_runner.collect_chunks());
+
+    REQUIRE(pipelined.size() == expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        CAPTURE(i);
+        check_same_calls(pipelined[i], expected[i]);
+    }
+
+    const auto stats = pipelined_runner.sample_stats();
+    CHECK(stats.at("batches_called") == double(batch_num_chunks.size()));
+    CHECK(stats.at("forward_decode_overlap") > 0.0);
+    CHECK(runner.sample_stats().count("forward_decode_overlap") == 0);
+}
+
+TEST_CASE("SmokeTest: CPU runner count comes from the measured working memory", "[SmokeTest]") {
+    const std::string model_name = "dna_r10.4.1_e8.2_400bps_fast@v4.2.0";
+    const auto model_dir = download_model(model_name);
+    const auto model_config = load_cpu_model_config(model_dir, model_name);
+
+    dorado::basecall::ModelRunner runner(model_config, "cpu");
+    const size_t working_memory = runner.measure_working_memory();
+    if (working_memory == 0) {
+        SKIP("Can't measure working memory on this platform");
+    }
+    // The runner's input buffer alone is a lower bound.
+    CHECK(working_memory >= runner.batch_size() * runner.chunk_size() *
+                                    size_t(model_config.num_features) * sizeof(float));
+
+    const float memory_fraction = 0.5f;
+    auto expected_num_runners = [&](size_t available_GB) {
+        const auto num_runners =
+                static_cast<size_t>(double(available_GB) * dorado::utils::BYTES_PER_GB *
+                                    memory_fraction / double(working_memory));
+        return std::clamp(num_runners, size_t(1), size_t(std::thread::hardware_concurrency()));
+    };
+
+    // Available memory can change between calls, so allow for it either side.
+    const auto expected_before = expected_num_runners(dorado::utils::available_host_memory_GB());
+    const auto num_runners = dorado::basecall::auto_calculate_num_runners(
+            model_config, memory_fraction, working_memory);
+    const auto expected_after = expected_num_runners(dorado::utils::available_host_memory_GB());
+    CHECK(num_runners >= std::min(expected_before, expected_after));
+    CHECK(num_runners <= std::max(expected_before, expected_after));
+
+    // Without a measurement, the per-model estimate is used.
+    CHECK(dorado::basecall::auto_calculate_num_runners(model_config, memory_fraction, 0) ==
+          dorado::basecall::auto_calculate_num_runners(model_config, memory_fraction));
+}
+
 DEFINE_TEST(NodeSmokeTestRead, "ModBaseCallerNode") {
     auto gpu = GENERATE(true, false);
     CAPTURE(gpu);
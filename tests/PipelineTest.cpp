@@ -3,6 +3,11 @@
 #include "read_pipeline/ReadPipeline.h"
 
 #include <catch2/catch.hpp>
+#include <htslib/sam.h>
+
+#include <string>
+#include <variant>
+#include <vector>
 
 #define TEST_GROUP "[Pipeline]"
 
@@ -187,4 +192,38 @@ TEST_CASE("TerminateRestart", TEST_GROUP) {
     pipeline->push_message(std::make_unique<dorado::SimplexRead>());
     pipeline.reset();
     CHECK(messages.size() == 2);
-}
\ No newline at end of file
+}
+
+// Test batches are split up for nodes which don't take them.
+TEST_CASE("BatchSplitting", TEST_GROUP) {
+    const size_t batch_size = 5;
+    const bool accept_batches = GENERATE(false, true);
+    CAPTURE(accept_batches);
+
+    PipelineDescriptor pipeline_desc;
+    std::vector<dorado::Message> messages;
+    pipeline_desc.add_node<MessageSinkToVector>({}, 100, messages, accept_batches);
+    auto pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
+    REQUIRE(pipeline != nullptr);
+
+    dorado::BamBatch batch;
+    std::vector<const bam1_t*> records;
+    for (size_t i = 0; i < batch_size; ++i) {
+        batch.messages.push_back(dorado::BamMessage{dorado::BamPtr(bam_init1()), nullptr});
+        records.push_back(batch.messages.back().bam_ptr.get());
+    }
+    pipeline->push_message(std::move(batch));
+    pipeline.reset();
+
+    if (accept_batches) {
+        REQUIRE(messages.size() == 1);
+        REQUIRE(std::holds_alternative<dorado::BamBatch>(messages[0]));
+        CHECK(std::get<dorado::BamBatch>(messages[0]).messages.size() == batch_size);
+    } else {
+        auto bam_messages = ConvertMessages<dorado::BamMessage>(std::move(messages));
+        REQUIRE(bam_messages.size() == batch_size);
+        for (size_t i = 0; i < batch_size; ++i) {
+            CHECK(bam_messages[i].bam_ptr.get() == records[i]);
+        }
+    }
+}
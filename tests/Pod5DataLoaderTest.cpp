@@ -1,19 +1,31 @@
 #include "MessageSinkUtils.h"
 #include "TestUtils.h"
 #include "data_loader/DataLoader.h"
+#include "data_loader/DirectoryWatcher.h"
 #include "read_pipeline/ReadPipeline.h"
+#include "utils/PostCondition.h"
+#include "utils/dev_utils.h"
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
 #define TEST_GROUP "Pod5DataLoaderTest: "
 
 TEST_CASE(TEST_GROUP "Test loading single-read POD5 file from data dir, empty read list") {
-    auto read_list = std::unordered_set<std::string>();
+    auto read_list = dorado::utils::ReadIdSet();
     CHECK(CountSinkReads(get_pod5_data_dir(), "cpu", 1, 0, read_list, {}) == 0);
 }
 
 TEST_CASE(TEST_GROUP "Test loading single-read POD5 file from single file path, empty read list") {
-    auto read_list = std::unordered_set<std::string>();
+    auto read_list = dorado::utils::ReadIdSet();
     CHECK(CountSinkReads(get_single_pod5_file_path(), "cpu", 1, 0, read_list, {}) == 0);
 }
 
@@ -26,24 +38,24 @@ TEST_CASE(TEST_GROUP "Test loading single-read POD5 file from single file path,
 }
 
 TEST_CASE(TEST_GROUP "Test loading single-read POD5 file from data dir, mismatched read list") {
-    auto read_list = std::unordered_set<std::string>{"read_1"};
+    auto read_list = dorado::utils::ReadIdSet{"read_1"};
     CHECK(CountSinkReads(get_pod5_data_dir(), "cpu", 1, 0, read_list, {}) == 0);
 }
 
 TEST_CASE(TEST_GROUP
           "Test loading single-read POD5 file from single file path, mismatched read list") {
-    auto read_list = std::unordered_set<std::string>{"read_1"};
+    auto read_list = dorado::utils::ReadIdSet{"read_1"};
     CHECK(CountSinkReads(get_single_pod5_file_path(), "cpu", 1, 0, read_list, {}) == 0);
 }
 
 TEST_CASE(TEST_GROUP "Test loading single-read POD5 file from data dir, matched read list") {
-    auto read_list = std::unordered_set<std::string>{"002bd127-db82-436f-b828-28567c3d505d"};
+    auto read_list = dorado::utils::ReadIdSet{"002bd127-db82-436f-b828-28567c3d505d"};
     CHECK(CountSinkReads(get_pod5_data_dir(), "cpu", 1, 0, read_list, {}) == 1);
 }
 
 TEST_CASE(TEST_GROUP
           "Test loading single-read POD5 file from single file path, matched read list") {
-    auto read_list = std::unordered_set<std::string>{"002bd127-db82-436f-b828-28567c3d505d"};
+    auto read_list = dorado::utils::ReadIdSet{"002bd127-db82-436f-b828-28567c3d505d"};
     CHECK(CountSinkReads(get_single_pod5_file_path(), "cpu", 1, 0, read_list, {}) == 1);
 }
 
@@ -55,11 +67,11 @@ TEST_CASE(TEST_GROUP "Test calculating number of reads from pod5, read ids list.
     }
 
     SECTION("pod5 file and read ids with 0 reads") {
-        auto read_list = std::unordered_set<std::string>();
+        auto read_list = dorado::utils::ReadIdSet();
         CHECK(dorado::DataLoader::get_num_reads(data_path, read_list, {}, false) == 0);
     }
     SECTION("pod5 file and read ids with 2 reads") {
-        auto read_list = std::unordered_set<std::string>();
+        auto read_list = dorado::utils::ReadIdSet();
         read_list.insert("1");
         read_list.insert("2");
         CHECK(dorado::DataLoader::get_num_reads(data_path, read_list, {}, false) == 1);
@@ -101,11 +113,43 @@ TEST_CASE(TEST_GROUP "Load data sorted by channel id.") {
     }
 }
 
+TEST_CASE(TEST_GROUP "Channel order doesn't depend on how many channels are loaded at once.") {
+    auto data_path = get_data_dir("pod5/dna_r10.4.1_e8.2_400bps_5khz");
+
+    auto load_read_ids = [&data_path] {
+        dorado::PipelineDescriptor pipeline_desc;
+        std::vector<dorado::Message> messages;
+        pipeline_desc.add_node<MessageSinkToVector>({}, 100, messages);
+        auto pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
+
+        dorado::DataLoader loader(*pipeline, "cpu", 2, 0, std::nullopt, {});
+        loader.load_reads(data_path, false, dorado::ReadOrder::BY_CHANNEL);
+        pipeline.reset();
+        std::vector<std::pair<int, std::string>> read_ids;
+        for (auto & read : ConvertMessages<dorado::SimplexReadPtr>(std::move(messages))) {
+            read_ids.emplace_back(read->read_common.attributes.channel_number,
+                                  read->read_common.read_id);
+        }
+        return read_ids;
+    };
+
+    const auto all_channels = load_read_ids();
+    REQUIRE(all_channels.size() > 1);
+    CHECK(std::is_sorted(all_channels.begin(), all_channels.end(),
+                         [](auto & a, auto & b) { return a.first < b.first; }));
+
+    // Every channel is loaded in a pass of its own.
+    dorado::utils::details::g_dev_options["channel_group_samples"] = {1.0, false};
+    auto restore_dev_options = dorado::utils::PostCondition(
+            [] { dorado::utils::details::g_dev_options.erase("channel_group_samples"); });
+    CHECK(load_read_ids() == all_channels);
+}
+
 TEST_CASE(TEST_GROUP "Test loading POD5 file with read ignore list") {
     auto data_path = get_data_dir("multi_read_pod5");
 
     SECTION("read ignore list with 1 read") {
-        auto read_ignore_list = std::unordered_set<std::string>();
+        auto read_ignore_list = dorado::utils::ReadIdSet();
         read_ignore_list.insert("0007f755-bc82-432c-82be-76220b107ec5");  // read present in POD5
 
         CHECK(dorado::DataLoader::get_num_reads(data_path, std::nullopt, read_ignore_list, false) ==
@@ -114,9 +158,9 @@ TEST_CASE(TEST_GROUP "Test loading POD5 file with read ignore list") {
     }
 
     SECTION("same read in read_ids and ignore list") {
-        auto read_list = std::unordered_set<std::string>();
+        auto read_list = dorado::utils::ReadIdSet();
         read_list.insert("0007f755-bc82-432c-82be-76220b107ec5");  // read present in POD5
-        auto read_ignore_list = std::unordered_set<std::string>();
+        auto read_ignore_list = dorado::utils::ReadIdSet();
         read_ignore_list.insert("0007f755-bc82-432c-82be-76220b107ec5");  // read present in POD5
 
         CHECK(dorado::DataLoader::get_num_reads(data_path, read_list, read_ignore_list, false) ==
@@ -153,3 +197,93 @@ TEST_CASE(TEST_GROUP "Test correct previous and next read ids when loaded by cha
         next_read_id = (*i)->read_common.read_id;
     }
 }
+
+TEST_CASE(TEST_GROUP "Watching a directory loads POD5 files as they arrive") {
+    if (!dorado::DirectoryWatcher::is_supported()) {
+        return;
+    }
+    auto temp_dir = dorado::tests::make_temp_dir("pod5_watch_test");
+    // Present before watching starts.
+    std::filesystem::copy_file(get_single_pod5_file_path(), temp_dir.m_path / "first.pod5");
+
+    dorado::PipelineDescriptor pipeline_desc;
+    std::vector<dorado::Message> messages;
+    pipeline_desc.add_node<MessageSinkToVector>({}, 100, messages);
+    auto pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
+    dorado::DataLoader loader(*pipeline, "cpu", 1, 0, std::nullopt, {});
+
+    std::thread writer([&temp_dir] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        // Written under a temporary name and moved into place, as acquisition software does.
+        const auto temp_path = temp_dir.m_path / "second.pod5.tmp";
+        std::filesystem::copy_file(get_data_dir("multi_read_pod5") / "filtered.pod5", temp_path);
+        std::filesystem::rename(temp_path, temp_dir.m_path / "second.pod5");
+        std::ofstream(temp_dir.m_path / "STOP");
+    });
+    loader.watch_reads(temp_dir.m_path, {std::chrono::seconds(30), "STOP"});
+    writer.join();
+    pipeline.reset();
+
+    auto reads = ConvertMessages<dorado::SimplexReadPtr>(std::move(messages));
+    auto num_arrived = std::count_if(reads.begin(), reads.end(), [](const auto& read) {
+        return read->read_common.file_arrival_time.has_value();
+    });
+    CHECK(reads.size() == 5);
+    CHECK(num_arrived == 4);
+}
+
+TEST_CASE(TEST_GROUP "Watching a directory loads a file once its writer finishes it") {
+    if (!dorado::DirectoryWatcher::is_supported()) {
+        return;
+    }
+    auto temp_dir = dorado::tests::make_temp_dir("pod5_watch_test");
+    const auto path = temp_dir.m_path / "partial.pod5";
+    std::ifstream source(get_data_dir("multi_read_pod5") / "filtered.pod5", std::ios::binary);
+    const std::string contents(std::istreambuf_iterator<char>(source), {});
+    // Half written, and so can't be opened, when watching starts.
+    std::ofstream(path, std::ios::binary) << contents.substr(0, contents.size() / 2);
+
+    dorado::PipelineDescriptor pipeline_desc;
+    std::vector<dorado::Message> messages;
+    pipeline_desc.add_node<MessageSinkToVector>({}, 100, messages);
+    auto pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
+    dorado::DataLoader loader(*pipeline, "cpu", 1, 0, std::nullopt, {});
+
+    std::thread writer([&temp_dir, &path, &contents] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::ofstream(path, std::ios::binary) << contents;
+        std::ofstream(temp_dir.m_path / "STOP");
+    });
+    loader.watch_reads(temp_dir.m_path, {std::chrono::seconds(30), "STOP"});
+    writer.join();
+    pipeline.reset();
+
+    CHECK(ConvertMessages<dorado::SimplexReadPtr>(std::move(messages)).size() == 4);
+}
+
+TEST_CASE(TEST_GROUP "Watching a directory stops") {
+    if (!dorado::DirectoryWatcher::is_supported()) {
+        return;
+    }
+    auto temp_dir = dorado::tests::make_temp_dir("pod5_watch_test");
+
+    dorado::PipelineDescriptor pipeline_desc;
+    std::vector<dorado::Message> messages;
+    pipeline_desc.add_node<MessageSinkToVector>({}, 100, messages);
+    auto pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
+    dorado::DataLoader loader(*pipeline, "cpu", 1, 0, std::nullopt, {});
+
+    SECTION("after the idle timeout") {
+        loader.watch_reads(temp_dir.m_path, {std::chrono::milliseconds(100), ""});
+    }
+    SECTION("when stop_watching() is called") {
+        std::thread stopper([&loader] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            loader.stop_watching();
+        });
+        loader.watch_reads(temp_dir.m_path, {});
+        stopper.join();
+    }
+    pipeline.reset();
+    CHECK(messages.empty());
+}
@@ -0,0 +1,106 @@
+#include "basecall/nn/CRFModel.h"
+#include "basecall/nn/QuantizedLSTM.h"
+
+#include <torch/torch.h>
+// Catch2 must come after torch since both define CHECK()
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#define TEST_GROUP "[quantized_lstm]"
+
+using namespace dorado::basecall::nn;
+
+TEST_CASE("QuantizedLSTM: int8 GEMM is exact", TEST_GROUP) {
+    torch::manual_seed(0);
+    // Sizes which aren't multiples of the packing, to exercise the padding.
+    const int in_features = GENERATE(3, 96, 130);
+    const int out_features = GENERATE(8, 384);
+    const int num_rows = 5;
+    CAPTURE(in_features, out_features);
+
+    const auto weight = torch::randn({out_features, in_features});
+    const QuantizedWeights quantized(weight);
+    REQUIRE(quantized.padded_in % 4 == 0);
+    REQUIRE(quantized.padded_out % 32 == 0);
+
+    std::vector<int8_t> in(size_t(num_rows) * quantized.padded_in, 0);
+    for (int m = 0; m < num_rows; ++m) {
+        for (int k = 0; k < in_features; ++k) {
+            in[m * quantized.padded_in + k] = int8_t((m * 31 + k * 7) % 255 - 127);
+        }
+    }
+    std::vector<int32_t> out(size_t(num_rows) * quantized.padded_out);
+    gemm_s8(in.data(), num_rows, quantized, out.data());
+
+    for (int m = 0; m < num_rows; ++m) {
+        for (int n = 0; n < out_features; ++n) {
+            int32_t expected = 0;
+            for (int k = 0; k < in_features; ++k) {
+                const int8_t w = quantized.packed[(size_t(k / 4) * quantized.padded_out + n) * 4 +
+                                                  k % 4];
+                expected += int32_t(in[m * quantized.padded_in + k]) * w;
+            }
+            CHECK(out[m * quantized.padded_out + n] == expected);
+        }
+    }
+}
+
+TEST_CASE("QuantizedLSTM: int8 stack matches fp32 stack", TEST_GROUP) {
+    torch::NoGradGuard no_grad;
+    torch::manual_seed(1);
+    // Fast and HAC layer sizes.
+    const int layer_size = GENERATE(96, 384);
+    CAPTURE(layer_size);
+
+    LSTMStack stack(5, layer_size);
+    stack->eval();
+    const auto x = torch::randn({3, 100, layer_size});
+    const auto expected = stack->forward(x);
+
+    stack->quantize_for_cpu();
+    const auto actual = stack->forward(x);
+    REQUIRE(actual.sizes() == expected.sizes());
+
+    const auto error = (actual - expected).abs();
+    CHECK(error.max().item<float>() < 0.05f);
+    CHECK(error.mean().item<float>() < 0.005f);
+}
+
+TEST_CASE("QuantizedLSTM: layer matches fp32 LSTM at every timestep", TEST_GROUP) {
+    torch::NoGradGuard no_grad;
+    torch::manual_seed(2);
+    const int layer_size = GENERATE(96, 384);
+    const bool reverse = GENERATE(false, true);
+    // Not a multiple of the 32 step time block, so the final block is a partial one.
+    const int T = 45;
+    CAPTURE(layer_size, reverse);
+
+    auto lstm = torch::nn::LSTM(torch::nn::LSTMOptions(layer_size, layer_size).batch_first(true));
+    lstm->eval();
+    const auto &params = lstm->named_parameters();
+    const QuantizedLSTMLayer layer(params["weight_ih_l0"], params["weight_hh_l0"],
+                                   params["bias_ih_l0"], params["bias_hh_l0"], reverse);
+
+    const auto x = torch::randn({2, T, layer_size});
+    const auto expected = reverse ? std::get<0>(lstm->forward(x.flip(1))).flip(1)
+                                  : std::get<0>(lstm->forward(x));
+    const auto actual = layer.forward(x);
+    REQUIRE(actual.sizes() == expected.sizes());
+
+    const auto error = (actual - expected).abs();
+    for (int t = 0; t < T; ++t) {
+        CAPTURE(t);
+        CHECK(error.select(1, t).max().item<float>() < 0.02f);
+    }
+}
+
+TEST_CASE("QuantizedLSTM: rejects mismatched input", TEST_GROUP) {
+    const auto lstm = torch::nn::LSTM(torch::nn::LSTMOptions(16, 16).batch_first(true));
+    const auto &params = lstm->named_parameters();
+    const QuantizedLSTMLayer layer(params["weight_ih_l0"], params["weight_hh_l0"],
+                                   params["bias_ih_l0"], params["bias_hh_l0"], false);
+    CHECK(layer.forward(torch::zeros({2, 4, 16})).sizes() == at::IntArrayRef{2, 4, 16});
+    CHECK_THROWS_AS(layer.forward(torch::zeros({2, 4, 8})), std::runtime_error);
+}
@@ -0,0 +1,88 @@
+#include "utils/read_id_set.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_set>
+
+#define TEST_GROUP "[ReadIdSetTest]"
+
+using dorado::utils::ReadIdSet;
+
+namespace {
+
+std::string random_uuid(std::mt19937_64 &gen) {
+    const char *hex = "0123456789abcdef";
+    std::string uuid(36, '-');
+    for (size_t i = 0; i < uuid.size(); ++i) {
+        if (i != 8 && i != 13 && i != 18 && i != 23) {
+            uuid[i] = hex[gen() % 16];
+        }
+    }
+    return uuid;
+}
+
+}  // namespace
+
+TEST_CASE(TEST_GROUP ": UUID and other read IDs", TEST_GROUP) {
+    ReadIdSet read_ids{"002bd127-db82-436f-b828-28567c3d505d", "read_1"};
+    CHECK(read_ids.size() == 2);
+    CHECK(read_ids.contains("002bd127-db82-436f-b828-28567c3d505d"));
+    CHECK(read_ids.contains("read_1"));
+    CHECK(read_ids.count("read_2") == 0);
+    // Uppercase IDs aren't the same read ID.
+    CHECK(!read_ids.contains("002BD127-DB82-436F-B828-28567C3D505D"));
+    CHECK(read_ids.insert("002BD127-DB82-436F-B828-28567C3D505D"));
+    CHECK(!read_ids.insert("read_1"));
+    CHECK(read_ids.size() == 3);
+
+    // The nil UUID is a valid key too.
+    const std::string nil_uuid = "00000000-0000-0000-0000-000000000000";
+    CHECK(!read_ids.contains(nil_uuid));
+    CHECK(read_ids.insert(nil_uuid));
+    CHECK(read_ids.contains(nil_uuid));
+    CHECK(read_ids.size() == 4);
+
+    // Lookup by the binary form of the UUID.
+    const uint8_t uuid_bytes[16] = {0x00, 0x2b, 0xd1, 0x27, 0xdb, 0x82, 0x43, 0x6f,
+                                    0xb8, 0x28, 0x28, 0x56, 0x7c, 0x3d, 0x50, 0x5d};
+    CHECK(read_ids.contains(uuid_bytes));
+    const uint8_t other_bytes[16] = {0x00, 0x2b, 0xd1, 0x27, 0xdb, 0x82, 0x43, 0x6f,
+                                     0xb8, 0x28, 0x28, 0x56, 0x7c, 0x3d, 0x50, 0x5e};
+    CHECK(!read_ids.contains(other_bytes));
+}
+
+TEST_CASE(TEST_GROUP ": Matches unordered_set", TEST_GROUP) {
+    std::mt19937_64 gen(42);
+    ReadIdSet read_ids;
+    std::unordered_set<std::string> expected;
+    auto reserve = GENERATE(false, true);
+    if (reserve) {
+        read_ids.reserve(10000);
+    }
+    for (int i = 0; i < 10000; ++i) {
+        auto read_id = (i % 10 == 0) ? "read_" + std::to_string(gen() % 500) : random_uuid(gen);
+        CHECK(read_ids.insert(read_id) == expected.insert(read_id).second);
+    }
+    REQUIRE(read_ids.size() == expected.size());
+    for (const auto &read_id : expected) {
+        CHECK(read_ids.contains(read_id));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        auto read_id = random_uuid(gen);
+        CHECK(read_ids.contains(read_id) == (expected.count(read_id) > 0));
+    }
+
+    // Every other read ID, including some of the non-UUID ones.
+    ReadIdSet half;
+    size_t idx = 0;
+    for (const auto &read_id : expected) {
+        if (idx++ % 2 == 0) {
+            half.insert(read_id);
+        }
+    }
+    CHECK(read_ids.difference_size(half) == expected.size() - half.size());
+    CHECK(half.difference_size(read_ids) == 0);
+}
@@ -0,0 +1,68 @@
+#include "read_pipeline/ReadPool.h"
+
+#include <ATen/Functions.h>
+#include <catch2/catch.hpp>
+
+#define TEST_GROUP "[ReadPoolTest]"
+
+TEST_CASE(TEST_GROUP ": Released reads are reset and reused", TEST_GROUP) {
+    dorado::ReadPool pool(2);
+
+    auto read = pool.acquire();
+    read->read_common.read_id = "read_with_a_long_enough_id_to_avoid_small_string_storage";
+    read->read_common.seq = std::string(1000, 'A');
+    read->read_common.moves.assign(5000, 1);
+    read->read_common.raw_data = at::empty(4000);
+    read->read_common.model_stride = 5;
+    read->read_common.attributes.channel_number = 12;
+    read->is_duplex_parent = true;
+    read->start_sample = 100;
+    read->next_read = "next";
+    const auto seq_capacity = read->read_common.seq.capacity();
+    const auto moves_capacity = read->read_common.moves.capacity();
+    const auto* const raw_read = read.get();
+
+    pool.release(std::move(read));
+    CHECK(pool.size() == 1);
+
+    auto reused = pool.acquire();
+    CHECK(pool.size() == 0);
+    REQUIRE(reused.get() == raw_read);
+    CHECK(reused->read_common.read_id.empty());
+    CHECK(reused->read_common.seq.empty());
+    CHECK(reused->read_common.moves.empty());
+    CHECK(!reused->read_common.raw_data.defined());
+    CHECK(reused->read_common.model_stride == -1);
+    CHECK(reused->read_common.attributes.channel_number == -1);
+    CHECK(!reused->is_duplex_parent);
+    CHECK(reused->start_sample == 0);
+    CHECK(reused->next_read.empty());
+    CHECK(reused->read_common.seq.capacity() == seq_capacity);
+    CHECK(reused->read_common.moves.capacity() == moves_capacity);
+
+    auto stats = pool.sample_stats();
+    CHECK(stats.at("reads_acquired") == 2);
+    CHECK(stats.at("reads_reused") == 1);
+    CHECK(stats.at("reads_released") == 1);
+}
+
+TEST_CASE(TEST_GROUP ": Pool keeps at most its capacity", TEST_GROUP) {
+    auto capacity = GENERATE(size_t(0), size_t(1), size_t(3));
+    CAPTURE(capacity);
+    dorado::ReadPool pool(capacity);
+
+    std::vector<dorado::SimplexReadPtr> reads;
+    for (int i = 0; i < 5; ++i) {
+        reads.push_back(pool.acquire());
+    }
+    for (auto& read : reads) {
+        pool.release(std::move(read));
+    }
+    // Messages which aren't simplex reads are ignored.
+    pool.release(dorado::Message(dorado::CacheFlushMessage{}));
+
+    CHECK(pool.size() == capacity);
+    auto stats = pool.sample_stats();
+    CHECK(stats.at("reads_released") == 5);
+    CHECK(stats.at("reads_discarded") == double(5 - capacity));
+}
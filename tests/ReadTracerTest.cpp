@@ -0,0 +1,66 @@
+#include "TestUtils.h"
+#include "read_pipeline/ReadTracer.h"
+#include "utils/PostCondition.h"
+
+#include <catch2/catch.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <variant>
+
+#define TEST_GROUP "[ReadTracerTest]"
+
+using dorado::ReadTrace;
+using dorado::ReadTracer;
+
+TEST_CASE(TEST_GROUP ": Disabled by default", TEST_GROUP) {
+    CHECK_FALSE(ReadTracer::is_enabled());
+    CHECK(ReadTracer::instance().start_trace("read") == nullptr);
+}
+
+TEST_CASE(TEST_GROUP ": Samples the given fraction of reads", TEST_GROUP) {
+    auto& tracer = ReadTracer::instance();
+    auto reset_tracer = dorado::utils::PostCondition([&tracer] { tracer.configure(0, 0); });
+
+    tracer.configure(0.25, 0);
+    CHECK(ReadTracer::is_enabled());
+    int num_traced = 0;
+    for (int i = 0; i < 100; ++i) {
+        num_traced += tracer.start_trace("read_" + std::to_string(i)) != nullptr;
+    }
+    CHECK(num_traced == 25);
+}
+
+TEST_CASE(TEST_GROUP ": Stamps make stats and a Chrome trace", TEST_GROUP) {
+    auto& tracer = ReadTracer::instance();
+    auto reset_tracer = dorado::utils::PostCondition([&tracer] { tracer.configure(0, 0); });
+    tracer.configure(1, 10);
+
+    auto trace = tracer.start_trace("read_\"quoted\"");
+    REQUIRE(trace != nullptr);
+    const auto node = tracer.node_id("TracedNode");
+    CHECK(tracer.node_id("TracedNode") == node);
+
+    dorado::Message message = dorado::BamMessage{};
+    std::get<dorado::BamMessage>(message).trace = trace;
+    tracer.record(message, node, ReadTrace::Event::QUEUED);
+    tracer.record(message, node, ReadTrace::Event::STARTED);
+    tracer.record(*trace, node, ReadTrace::Event::WRITTEN);
+
+    const auto stats = tracer.sample_stats();
+    CHECK(stats.at("TracedNode_queued_count") >= 1);
+    CHECK(stats.at("TracedNode_processing_count") >= 1);
+    CHECK(stats.at("end_to_end_count") >= 1);
+    CHECK(stats.count("end_to_end_p99_ms") == 1);
+
+    auto temp_dir = dorado::tests::make_temp_dir("read_tracer_test");
+    const auto path = temp_dir.m_path / "trace.json";
+    tracer.write_chrome_trace(path);
+    std::ifstream file(path);
+    const std::string json(std::istreambuf_iterator<char>(file), {});
+    CHECK(json.rfind("{\"traceEvents\":[", 0) == 0);
+    CHECK(json.find(R"("name":"read_\"quoted\"")") != std::string::npos);
+    CHECK(json.find(R"("name":"queued for TracedNode")") != std::string::npos);
+    CHECK(json.find(R"("name":"TracedNode")") != std::string::npos);
+}
@@ -1,13 +1,36 @@
 #include "MessageSinkUtils.h"
 #include "TestUtils.h"
+#include "read_pipeline/HtsReader.h"
+#include "read_pipeline/HtsWriter.h"
 #include "read_pipeline/ResumeLoaderNode.h"
+#include "utils/hts_file.h"
+#include "utils/types.h"
 
 #include <catch2/catch.hpp>
+#include <htslib/sam.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
 
 #define TEST_GROUP "[read_pipeline][ResumeLoaderNode]"
 
 namespace fs = std::filesystem;
 
+namespace {
+
+// The parent read id of every record which can be read from |path|.
+std::vector<std::string> read_parent_ids(const fs::path& path) {
+    std::vector<std::string> read_ids;
+    dorado::HtsReader reader(path.string(), std::nullopt);
+    while (reader.read()) {
+        read_ids.push_back(reader.get_tag<std::string>("pi"));
+    }
+    return read_ids;
+}
+
+}  // namespace
+
 TEST_CASE(TEST_GROUP) {
     std::vector<dorado::Message> messages;
     MessageSinkToVector sink(100, messages);
@@ -22,3 +45,57 @@ TEST_CASE(TEST_GROUP) {
     CHECK(read_ids.count("002bd127-db82-436f-b828-28567c3d505d") == 1);
     CHECK(read_ids.count("ccccdddd-db82-436f-b828-28567c3d505d") == 1);
 }
+
+TEST_CASE(TEST_GROUP " Copies BGZF blocks of a BAM into a BAM writer") {
+    auto temp_dir = dorado::tests::make_temp_dir("resume_loader_blocks");
+    const auto resume_bam = temp_dir.m_path / "resume.bam";
+    const auto out_bam = temp_dir.m_path / "out.bam";
+
+    // Write enough copies of the records to fill several BGZF blocks, each with its own parent
+    // read id.
+    const auto sam = fs::path(get_data_dir("resume_loader")) / "basecall.sam";
+    dorado::HtsReader reader(sam.string(), std::nullopt);
+    std::vector<dorado::BamPtr> records;
+    while (reader.read()) {
+        records.emplace_back(bam_dup1(reader.record.get()));
+    }
+    {
+        dorado::utils::HtsFile file(resume_bam.string(), dorado::utils::HtsFile::OutputMode::BAM,
+                                    2, false);
+        file.set_header(reader.header);
+        for (int i = 0; i < 1000; ++i) {
+            for (const auto& record : records) {
+                dorado::BamPtr copy(bam_dup1(record.get()));
+                const auto parent_id = "parent-" + std::to_string(i);
+                bam_aux_update_str(copy.get(), "pi", int(parent_id.size() + 1), parent_id.c_str());
+                REQUIRE(file.write(copy.get()) >= 0);
+            }
+        }
+        file.finalise([](size_t) {});
+    }
+
+    SECTION("Complete file") {}
+    SECTION("Truncated file") {
+        fs::resize_file(resume_bam, fs::file_size(resume_bam) * 2 / 3);
+    }
+    const auto expected_ids = read_parent_ids(resume_bam);
+    REQUIRE(!expected_ids.empty());
+
+    {
+        dorado::utils::HtsFile file(out_bam.string(), dorado::utils::HtsFile::OutputMode::BAM, 2,
+                                    false);
+        file.set_header(reader.header);
+        dorado::HtsWriter writer(file, "");
+        dorado::ResumeLoaderNode loader(writer, resume_bam.string());
+        loader.copy_completed_reads();
+        writer.terminate(dorado::DefaultFlushOptions());
+        file.finalise([](size_t) {});
+
+        const auto read_ids = loader.get_processed_read_ids();
+        CHECK(read_ids.size() == (expected_ids.size() + 1) / 2);
+        CHECK(read_ids.count(expected_ids.back()) == 1);
+        CHECK(writer.get_total() == expected_ids.size());
+    }
+
+    CHECK(read_parent_ids(out_bam) == expected_ids);
+}
@@ -0,0 +1,130 @@
+#include "read_pipeline/ShardedHtsWriter.h"
+
+#include "TestUtils.h"
+#include "read_pipeline/HtsReader.h"
+#include "utils/hts_file.h"
+#include "utils/stats.h"
+
+#include <catch2/catch.hpp>
+#include <htslib/sam.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define TEST_GROUP "[sharded_hts_writer]"
+
+namespace fs = std::filesystem;
+using namespace dorado;
+using utils::HtsFile;
+
+namespace {
+
+struct ShardedOutput {
+    size_t num_records_in{0};
+    stats::NamedStats stats;
+    std::vector<fs::path> files;
+};
+
+ShardedOutput write_shards(const fs::path& output_dir,
+                           size_t num_shards,
+                           HtsFile::OutputMode mode,
+                           size_t max_reads_per_file) {
+    HtsReader reader((fs::path(get_data_dir("bam_reader")) / "small.sam").string(), std::nullopt);
+
+    ShardedHtsWriter::Options options;
+    options.output_dir = output_dir.string();
+    options.num_shards = num_shards;
+    options.output_mode = mode;
+    options.max_reads_per_file = max_reads_per_file;
+
+    PipelineDescriptor pipeline_desc;
+    auto writer = pipeline_desc.add_node<ShardedHtsWriter>({}, options);
+    auto pipeline = Pipeline::create(std::move(pipeline_desc), nullptr);
+    auto& writer_ref = dynamic_cast<ShardedHtsWriter&>(pipeline->get_node_ref(writer));
+    writer_ref.set_header(reader.header);
+
+    ShardedOutput output;
+    output.num_records_in = reader.read(*pipeline, 1000);
+    pipeline->terminate(DefaultFlushOptions());
+    output.stats = writer_ref.sample_stats();
+    writer_ref.finalise_hts_files([](size_t) { /* noop */ });
+    output.files = writer_ref.get_output_files();
+    return output;
+}
+
+size_t count_records(const fs::path& file) {
+    HtsReader reader(file.string(), std::nullopt);
+    size_t num_records = 0;
+    while (reader.read()) {
+        ++num_records;
+    }
+    return num_records;
+}
+
+}  // namespace
+
+TEST_CASE("ShardedHtsWriter: records are split across rolled over files", TEST_GROUP) {
+    auto tmp_dir = make_temp_dir("sharded_writer");
+    const size_t num_shards = GENERATE(1, 3);
+    CAPTURE(num_shards);
+
+    auto output = write_shards(tmp_dir.m_path, num_shards, HtsFile::OutputMode::BAM, 2);
+    REQUIRE(output.num_records_in > 2);
+
+    size_t num_records_out = 0;
+    for (const auto& file : output.files) {
+        CAPTURE(file);
+        REQUIRE(fs::exists(file));
+        CHECK(file.extension() == ".bam");
+        const size_t num_records = count_records(file);
+        CHECK(num_records > 0);
+        CHECK(num_records <= 2);
+        num_records_out += num_records;
+    }
+    CHECK(num_records_out == output.num_records_in);
+    CHECK(output.stats.at("records_written") == output.num_records_in);
+    CHECK(output.stats.at("unique_simplex_reads_written") == 6);
+}
+
+TEST_CASE("ShardedHtsWriter: manifest lists every file", TEST_GROUP) {
+    auto tmp_dir = make_temp_dir("sharded_writer");
+    auto output = write_shards(tmp_dir.m_path, 2, HtsFile::OutputMode::FASTQ, 3);
+
+    std::ifstream manifest(tmp_dir.m_path / ShardedHtsWriter::MANIFEST_FILENAME);
+    REQUIRE(manifest);
+    std::string line;
+    std::getline(manifest, line);
+    CHECK(line == "filename\tshard\tpart\tnum_records");
+
+    std::vector<fs::path> listed_files;
+    size_t num_records_listed = 0;
+    while (std::getline(manifest, line)) {
+        const auto filename = line.substr(0, line.find('\t'));
+        listed_files.push_back(tmp_dir.m_path / filename);
+        num_records_listed += std::stoul(line.substr(line.rfind('\t') + 1));
+        CHECK(fs::path(filename).extension() == ".fastq");
+    }
+    CHECK(listed_files == output.files);
+    CHECK(num_records_listed == output.num_records_in);
+}
+
+TEST_CASE("ShardedHtsWriter: no files without records", TEST_GROUP) {
+    auto tmp_dir = make_temp_dir("sharded_writer");
+    {
+        ShardedHtsWriter::Options options;
+        options.output_dir = tmp_dir.m_path.string();
+        options.num_shards = 4;
+        ShardedHtsWriter writer(options);
+        writer.terminate(DefaultFlushOptions());
+        writer.finalise_hts_files([](size_t) { /* noop */ });
+        CHECK(writer.get_output_files().empty());
+    }
+    CHECK(fs::exists(tmp_dir.m_path / ShardedHtsWriter::MANIFEST_FILENAME));
+}
+
+TEST_CASE("ShardedHtsWriter: requires an output directory", TEST_GROUP) {
+    ShardedHtsWriter::Options options;
+    CHECK_THROWS_AS(ShardedHtsWriter(options), std::runtime_error);
+}
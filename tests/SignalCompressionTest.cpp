@@ -0,0 +1,128 @@
+#include "read_pipeline/messages.h"
+#include "utils/signal_compression.h"
+#include "utils/tensor_utils.h"
+
+#include <ATen/ATen.h>
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#define TEST_GROUP "[signal_compression]"
+
+using namespace dorado::utils;
+
+namespace {
+
+// Samples stepping between levels with some noise, like a nanopore signal.
+std::vector<int16_t> make_samples(std::size_t num_samples) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> levels(300.f, 500.f);
+    std::normal_distribution<float> noise(0.f, 8.f);
+    std::vector<int16_t> samples(num_samples);
+    float level = 0;
+    for (std::size_t i = 0; i < num_samples; ++i) {
+        if (i % 10 == 0) {
+            level = levels(rng);
+        }
+        samples[i] = static_cast<int16_t>(level + noise(rng));
+    }
+    return samples;
+}
+
+at::Tensor make_i16_signal(const std::vector<int16_t>& samples) {
+    return at::tensor(samples, at::TensorOptions().dtype(at::kShort));
+}
+
+at::Tensor make_f16_signal(const std::vector<int16_t>& samples, float shift, float scale) {
+    auto signal = at::empty({static_cast<int64_t>(samples.size())}, at::kHalf);
+    normalise_i16_to_f16(signal.data_ptr<c10::Half>(), samples.data(), samples.size(), shift,
+                         scale);
+    return signal;
+}
+
+// Compares bit patterns, so NaN samples compare equal.
+bool same_bits(const at::Tensor& a, const at::Tensor& b) {
+    return a.scalar_type() == b.scalar_type() && a.sizes() == b.sizes() &&
+           at::equal(a.view(at::kShort), b.view(at::kShort));
+}
+
+}  // namespace
+
+TEST_CASE(TEST_GROUP ": Samples round trip", TEST_GROUP) {
+    const std::vector<uint16_t> samples{0, 1, 0, 65535, 0, 32768, 32767, 100, 355, 99};
+    const auto compressed = compress_samples(samples.data(), samples.size());
+    std::vector<uint16_t> decompressed(samples.size());
+    decompress_samples(compressed, decompressed.data(), decompressed.size());
+    CHECK(decompressed == samples);
+}
+
+TEST_CASE(TEST_GROUP ": Corrupt data throws", TEST_GROUP) {
+    const auto samples = make_samples(100);
+    const auto* data = reinterpret_cast<const uint16_t*>(samples.data());
+    auto compressed = compress_samples(data, samples.size());
+    std::vector<uint16_t> decompressed(samples.size());
+
+    SECTION("Truncated") {
+        compressed.pop_back();
+        CHECK_THROWS_AS(decompress_samples(compressed, decompressed.data(), samples.size()),
+                        std::runtime_error);
+    }
+    SECTION("Trailing bytes") {
+        compressed.push_back(0);
+        CHECK_THROWS_AS(decompress_samples(compressed, decompressed.data(), samples.size()),
+                        std::runtime_error);
+    }
+}
+
+TEST_CASE(TEST_GROUP ": int16 signal round trips", TEST_GROUP) {
+    const auto signal = make_i16_signal(make_samples(10000));
+    REQUIRE(CompressedSignal::can_compress(signal));
+    const CompressedSignal compressed(signal);
+    CHECK(compressed.uncompressed_nbytes() == signal.nbytes());
+    CHECK(compressed.nbytes() < signal.nbytes());
+    CHECK(same_bits(compressed.decompress(), signal));
+}
+
+TEST_CASE(TEST_GROUP ": float16 signal round trips", TEST_GROUP) {
+    const float shift = 380.3f;
+    const float scale = 55.7f;
+    auto signal = make_f16_signal(make_samples(10000), shift, scale);
+    // A sample the normalisation can't reproduce.
+    signal[17] = std::numeric_limits<float>::quiet_NaN();
+
+    SECTION("Without normalisation") {
+        const CompressedSignal compressed(signal);
+        CHECK(same_bits(compressed.decompress(), signal));
+    }
+    SECTION("With the normalisation it was made with") {
+        const CompressedSignal compressed(signal, shift, scale);
+        CHECK(same_bits(compressed.decompress(), signal));
+        CHECK(compressed.nbytes() < CompressedSignal(signal).nbytes());
+    }
+    SECTION("With the wrong normalisation") {
+        const CompressedSignal compressed(signal, 0.f, 1.f);
+        CHECK(same_bits(compressed.decompress(), signal));
+        CHECK(compressed.nbytes() <= signal.nbytes());
+    }
+}
+
+TEST_CASE(TEST_GROUP ": Read signal compresses in place", TEST_GROUP) {
+    const float shift = 380.3f;
+    const float scale = 55.7f;
+    dorado::ReadCommon read_common;
+    read_common.raw_data = make_f16_signal(make_samples(10000), shift, scale);
+    const auto signal = read_common.raw_data.clone();
+
+    read_common.compress_raw_data(shift, scale);
+    CHECK_FALSE(read_common.raw_data.defined());
+    REQUIRE(read_common.compressed_raw_data);
+    CHECK(read_common.get_raw_data_bytes() < signal.nbytes());
+
+    read_common.decompress_raw_data();
+    CHECK_FALSE(read_common.compressed_raw_data);
+    CHECK(same_bits(read_common.raw_data, signal));
+}
@@ -1,10 +1,13 @@
 #include "read_pipeline/stitch.h"
 
+#include "basecall/decode/Decoder.h"
 #include "read_pipeline/ReadPipeline.h"
 #include "utils/math_utils.h"
 
 #include <catch2/catch.hpp>
 
+#include <tuple>
+
 #define TEST_GROUP "[utils]"
 
 // clang-format off
@@ -39,10 +42,12 @@ A        C        G     T     C           G        C     G  T           C
 1, 0, 0, 1, 0, 0, 1, 0, 1, 0, 1, 0, 0, 0, 1, 0, 0, 1, 0, 1, 1, 0, 0, 0, 1, 0, 0, 1, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0, 0, 0, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0
 */
 // clang-format on
-TEST_CASE("Test stitch_chunks", TEST_GROUP) {
-    constexpr size_t CHUNK_SIZE = 10;
-    constexpr size_t OVERLAP = 3;
+namespace {
 
+constexpr size_t CHUNK_SIZE = 10;
+constexpr size_t OVERLAP = 3;
+
+std::vector<std::unique_ptr<dorado::utils::Chunk>> make_called_chunks() {
     std::vector<std::unique_ptr<dorado::utils::Chunk>> called_chunks;
 
     size_t offset = 0;
@@ -64,19 +69,89 @@ TEST_CASE("Test stitch_chunks", TEST_GROUP) {
         chunk->moves = MOVES[chunk_idx];
         called_chunks.push_back(std::move(chunk));
     }
+    return called_chunks;
+}
+
+const std::string expected_sequence = "ACGTCGCGTCGTCGTCCGT";
+const std::string expected_qstring = "!&.-&.&.-&.-&.-&&.-";
+const std::vector<uint8_t> expected_moves = {1, 0, 0, 1, 0, 0, 1, 0, 1, 0, 1, 0, 0, 0, 1, 0, 0,
+                                             1, 0, 1, 1, 0, 0, 0, 1, 0, 0, 1, 0, 1, 0, 1, 0, 0,
+                                             1, 0, 1, 0, 0, 0, 0, 1, 0, 1, 0, 0, 1, 0, 1};
+
+}  // namespace
+
+TEST_CASE("Test stitch_chunks", TEST_GROUP) {
+    auto called_chunks = make_called_chunks();
 
     dorado::ReadCommon read_common;
     read_common.model_stride = static_cast<int>(dorado::utils::div_round_closest(
             called_chunks[0]->raw_chunk_size, called_chunks[0]->moves.size()));
     REQUIRE_NOTHROW(dorado::utils::stitch_chunks(read_common, called_chunks));
 
-    const std::string expected_sequence = "ACGTCGCGTCGTCGTCCGT";
-    const std::string expected_qstring = "!&.-&.&.-&.-&.-&&.-";
-    const std::vector<uint8_t> expected_moves = {1, 0, 0, 1, 0, 0, 1, 0, 1, 0, 1, 0, 0, 0, 1, 0, 0,
-                                                 1, 0, 1, 1, 0, 0, 0, 1, 0, 0, 1, 0, 1, 0, 1, 0, 0,
-                                                 1, 0, 1, 0, 0, 0, 0, 1, 0, 1, 0, 0, 1, 0, 1};
+    REQUIRE(read_common.seq == expected_sequence);
+    REQUIRE(read_common.qstring == expected_qstring);
+    REQUIRE(read_common.moves == expected_moves);
+}
+
+TEST_CASE("Test ChunkStitcher matches stitch_chunks in any order", TEST_GROUP) {
+    auto order = GENERATE(std::vector<size_t>{0, 1, 2, 3, 4, 5, 6},
+                          std::vector<size_t>{6, 5, 4, 3, 2, 1, 0},
+                          std::vector<size_t>{3, 0, 6, 1, 5, 2, 4});
+    CAPTURE(order);
+
+    auto called_chunks = make_called_chunks();
+    REQUIRE(called_chunks.size() == order.size());
+    const int model_stride = static_cast<int>(dorado::utils::div_round_closest(
+            called_chunks[0]->raw_chunk_size, called_chunks[0]->moves.size()));
+
+    std::vector<size_t> chunk_offsets;
+    for (const auto &chunk : called_chunks) {
+        chunk_offsets.push_back(chunk->input_offset);
+    }
+    dorado::utils::ChunkStitcher stitcher(chunk_offsets, CHUNK_SIZE, model_stride);
+
+    for (size_t i = 0; i < order.size(); ++i) {
+        const bool complete = stitcher.add_chunk(order[i], *called_chunks[order[i]]);
+        CHECK(complete == (i + 1 == order.size()));
+    }
+    CHECK(stitcher.pending_bytes() == 0);
+
+    dorado::ReadCommon read_common;
+    read_common.model_stride = model_stride;
+    REQUIRE_NOTHROW(stitcher.finalise(read_common));
 
     REQUIRE(read_common.seq == expected_sequence);
     REQUIRE(read_common.qstring == expected_qstring);
     REQUIRE(read_common.moves == expected_moves);
 }
+
+TEST_CASE("Test unpack_decoded_chunk matches chunks called on their own", TEST_GROUP) {
+    constexpr size_t stride = 2;
+    // Two reads as they decode alone, which BasecallerNode packs into one slot with a gap.
+    const dorado::basecall::decode::DecodedChunk first{"ACG", "!&.", {1, 0, 1, 1, 0}};
+    const dorado::basecall::decode::DecodedChunk second{"TTA", "-.&", {0, 1, 0, 0, 1, 1}};
+    const size_t gap_moves = 2;
+
+    dorado::basecall::decode::DecodedChunk packed;
+    packed.sequence = first.sequence + second.sequence;
+    packed.qstring = first.qstring + second.qstring;
+    packed.moves = first.moves;
+    packed.moves.resize(packed.moves.size() + gap_moves, 0);
+    packed.moves.insert(packed.moves.end(), second.moves.begin(), second.moves.end());
+
+    const size_t first_size = first.moves.size() * stride;
+    const size_t second_offset = first_size + gap_moves * stride;
+    const size_t second_size = second.moves.size() * stride;
+    // The whole slot, as for a chunk which had its slot to itself.
+    for (const auto &[expected, offset, size] :
+         {std::tuple{first, size_t(0), first_size}, std::tuple{second, second_offset, second_size},
+          std::tuple{packed, size_t(0), packed.moves.size() * stride}}) {
+        CAPTURE(offset, size);
+        dorado::utils::Chunk chunk(0, 0);
+        dorado::utils::unpack_decoded_chunk(packed, offset, size, stride, chunk);
+        CHECK(chunk.seq == expected.sequence);
+        CHECK(chunk.qstring == expected.qstring);
+        CHECK(chunk.moves == expected.moves);
+        CHECK(chunk.raw_chunk_size == size);
+    }
+}
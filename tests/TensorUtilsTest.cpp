@@ -6,6 +6,7 @@
 
 #include <cstdlib>
 #include <random>
+#include <tuple>
 
 #define CUT_TAG "[TensorUtils]"
 
@@ -59,6 +60,54 @@ TEST_CASE(CUT_TAG ": test quantiles_counting", CUT_TAG) {
     REQUIRE(torch::equal(computed, expected));
 }
 
+TEST_CASE(CUT_TAG ": SignalHistogram order statistics", CUT_TAG) {
+    torch::manual_seed(42);
+
+    dorado::utils::SignalHistogram histogram;
+    // Reuse the histogram across signals with differing ranges, including negative values.
+    for (auto [low, high, size] : {std::tuple{0, 2047, 1000}, std::tuple{-500, 3000, 4001},
+                                   std::tuple{100, 101, 7}, std::tuple{-20, 20, 1}}) {
+        CAPTURE(low, high, size);
+        const auto in = torch::randint(low, high, size).to(torch::kI16);
+        histogram.build(in.data_ptr<int16_t>(), size);
+
+        const auto q = torch::tensor({0.2, 0.9}, {torch::kFloat});
+        const auto expected_q = dorado::utils::quantile_counting(in, q);
+        CHECK(histogram.quantile(0.2f) == expected_q[0].item<int16_t>());
+        CHECK(histogram.quantile(0.9f) == expected_q[1].item<int16_t>());
+
+        const auto med = in.median();
+        CHECK(histogram.median() == med.item<int16_t>());
+        const auto expected_mad = torch::median(torch::abs(in - med));
+        CHECK(histogram.median_abs_deviation(histogram.median()) ==
+              expected_mad.item<int16_t>());
+    }
+}
+
+TEST_CASE(CUT_TAG ": normalise_i16_to_f16", CUT_TAG) {
+    torch::manual_seed(42);
+    srand(42);
+
+    for (int i = 0; i < 10; ++i) {
+        const int num_elems = rand() % 100;
+        const float shift = 400.f + float(rand() % 100);
+        const float scale = 90.f + float(rand() % 20) / 7.f;
+        const auto elems_i16 = torch::randint(-500, 3000, {num_elems}).to(torch::kI16);
+        const auto expected = ((elems_i16.to(torch::kFloat) - shift) / scale).to(torch::kHalf);
+
+        auto converted = torch::zeros({num_elems}, torch::kHalf);
+        dorado::utils::normalise_i16_to_f16(converted.data_ptr<c10::Half>(),
+                                            elems_i16.data_ptr<int16_t>(), num_elems, shift, scale);
+        CHECK(torch::equal(expected, converted));
+
+        // In place.
+        auto in_place = elems_i16.clone();
+        dorado::utils::normalise_i16_to_f16(reinterpret_cast<c10::Half *>(in_place.data_ptr()),
+                                            in_place.data_ptr<int16_t>(), num_elems, shift, scale);
+        CHECK(torch::equal(expected, in_place.view(torch::kHalf)));
+    }
+}
+
 TEST_CASE(CUT_TAG ": convert_f32_to_f16", CUT_TAG) {
     torch::manual_seed(42);
     srand(42);
@@ -0,0 +1,117 @@
+#include "basecall/TuningProfile.h"
+
+#include "TestUtils.h"
+#include "basecall/CRFModelConfig.h"
+
+#include <catch2/catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <optional>
+
+#define CUT_TAG "[TuningProfile]"
+
+namespace fs = std::filesystem;
+using namespace dorado::basecall;
+using dorado::tests::get_data_dir;
+using dorado::tests::make_temp_dir;
+
+namespace {
+
+TuningProfile make_profile() {
+    TuningProfile profile;
+    profile.model = "dna_r10.4.1_e8.2_400bps_hac@v4.3.0";
+    profile.host = tuning_host_id();
+    profile.chunk_size = 4998;
+    profile.batch_size = 64;
+    profile.num_runners = 3;
+    profile.decode_threads = 2;
+    profile.samples_per_second = 123456.5;
+    profile.peak_memory_bytes = size_t(5) << 30;
+    return profile;
+}
+
+}  // namespace
+
+TEST_CASE(CUT_TAG ": save and load round trip", CUT_TAG) {
+    const auto tmp_dir = make_temp_dir("tuning_profile");
+    const auto profile = make_profile();
+
+    const auto path = save_tuning_profile(profile, tmp_dir.m_path);
+    CHECK(path == tuning_profile_path(tmp_dir.m_path, profile.model, profile.host));
+    CHECK(fs::exists(path));
+
+    const auto loaded = load_tuning_profile(tmp_dir.m_path, profile.model, profile.host);
+    REQUIRE(loaded.has_value());
+    CHECK(loaded->model == profile.model);
+    CHECK(loaded->host == profile.host);
+    CHECK(loaded->chunk_size == profile.chunk_size);
+    CHECK(loaded->batch_size == profile.batch_size);
+    CHECK(loaded->num_runners == profile.num_runners);
+    CHECK(loaded->decode_threads == profile.decode_threads);
+    CHECK(loaded->samples_per_second == Approx(profile.samples_per_second));
+    CHECK(loaded->peak_memory_bytes == profile.peak_memory_bytes);
+}
+
+TEST_CASE(CUT_TAG ": profiles are keyed by model and host", CUT_TAG) {
+    const auto tmp_dir = make_temp_dir("tuning_profile");
+    const auto profile = make_profile();
+    save_tuning_profile(profile, tmp_dir.m_path);
+
+    CHECK_FALSE(load_tuning_profile(tmp_dir.m_path, "dna_r10.4.1_e8.2_400bps_sup@v4.3.0",
+                                    profile.host)
+                        .has_value());
+    CHECK_FALSE(load_tuning_profile(tmp_dir.m_path, profile.model, "other_host").has_value());
+}
+
+TEST_CASE(CUT_TAG ": invalid profiles are ignored", CUT_TAG) {
+    const auto tmp_dir = make_temp_dir("tuning_profile");
+    const auto path = tuning_profile_path(tmp_dir.m_path, "model", "host");
+    fs::create_directories(path.parent_path());
+
+    SECTION("malformed") {
+        std::ofstream(path) << "[tuning\nchunksize = ";
+        CHECK_FALSE(load_tuning_profile(tmp_dir.m_path, "model", "host").has_value());
+    }
+    SECTION("zero batch size") {
+        std::ofstream(path) << "[tuning]\nmodel = \"model\"\nhost = \"host\"\nchunksize = 6000\n"
+                               "batchsize = 0\nrunners = 1\ndecode_threads = 1\n"
+                               "samples_per_second = 1.0\npeak_memory_bytes = 1\n";
+        CHECK_FALSE(load_tuning_profile(tmp_dir.m_path, "model", "host").has_value());
+    }
+}
+
+TEST_CASE(CUT_TAG ": applied profile is below CLI arguments", CUT_TAG) {
+    const fs::path model_path =
+            fs::path(get_data_dir("model_configs/dna_r10.4.1_e8.2_400bps_hac@v4.3.0"));
+    auto config = load_crf_model_config(model_path);
+    config.normalise_basecaller_params();
+    CHECK(tuning_model_name(config) == "dna_r10.4.1_e8.2_400bps_hac@v4.3.0");
+
+    auto profile = make_profile();
+    profile.chunk_size = 5000;
+
+    SECTION("replaces defaults") {
+        // As the basecaller sets it when no batch size is given.
+        config.basecaller.update(BasecallerParams::Priority::CONFIG, std::nullopt, std::nullopt,
+                                 128);
+        apply_tuning_profile(profile, config);
+        // Normalised to the model stride.
+        CHECK(config.basecaller.chunk_size() == 4998);
+        CHECK(config.basecaller.batch_size() == 64);
+        CHECK(config.has_normalised_basecaller_params());
+    }
+    SECTION("keeps CLI arguments") {
+        config.basecaller.update(BasecallerParams::Priority::CLI_ARG, 6000, std::nullopt, 32);
+        apply_tuning_profile(profile, config);
+        CHECK(config.basecaller.chunk_size() == 6000);
+        CHECK(config.basecaller.batch_size() == 32);
+    }
+    SECTION("keeps chunks longer than the overlap") {
+        profile.chunk_size = config.basecaller.overlap();
+        const int chunk_size = config.basecaller.chunk_size();
+        apply_tuning_profile(profile, config);
+        CHECK(config.basecaller.chunk_size() == chunk_size);
+        CHECK(config.basecaller.batch_size() == 64);
+    }
+}
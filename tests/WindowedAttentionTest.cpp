@@ -0,0 +1,51 @@
+#include "basecall/nn/TxModel.h"
+#include "basecall/nn/WindowedAttention.h"
+
+#include <torch/torch.h>
+// Catch2 must come after torch since both define CHECK()
+#include <catch2/catch.hpp>
+
+#include <utility>
+
+#define TEST_GROUP "[windowed_attention]"
+
+using namespace dorado::basecall::nn;
+
+TEST_CASE("WindowedAttention: matches masked attention", TEST_GROUP) {
+    torch::NoGradGuard no_grad;
+    torch::manual_seed(0);
+    const auto options = at::TensorOptions().dtype(torch::kFloat).device(c10::kCPU);
+
+    // The v5 window, an asymmetric window and a window wider than T.
+    const auto attn_window = GENERATE(std::make_pair(127, 128), std::make_pair(5, 17),
+                                      std::make_pair(500, 500));
+    CAPTURE(attn_window.first, attn_window.second);
+    const int64_t N = 2, T = 150, nhead = 4, head_dim = 16;
+
+    MultiHeadAttention mha(int(nhead * head_dim), int(nhead), false, true, attn_window, options);
+    auto qkv = torch::randn({N, T, 3, nhead, head_dim}, options);
+
+    auto buffers = mha->rotary_emb->named_buffers();
+    const auto actual =
+            windowed_attention_cpu(qkv, buffers["cos_freqs"], buffers["sin_freqs"], attn_window);
+
+    // Reference: rotary embedding into [3, N, H, T, D], then dense attention with the window mask.
+    const auto rotated = mha->rotary_emb(qkv);
+    const auto mask = mha->build_attn_window_mask(T);
+    const auto expected =
+            scaled_dot_product_attention_naive(rotated[0], rotated[1], rotated[2], mask)
+                    .transpose(1, 2)
+                    .reshape({N, T, nhead * head_dim});
+
+    REQUIRE(actual.sizes() == expected.sizes());
+    CHECK(torch::allclose(actual, expected, 1e-4, 1e-5));
+}
+
+TEST_CASE("WindowedAttention: rejects unexpected input", TEST_GROUP) {
+    const auto table = torch::zeros({8, 4});
+    CHECK_THROWS_AS(windowed_attention_cpu(torch::zeros({2, 8, 2, 1, 8}), table, table, {1, 1}),
+                    std::runtime_error);
+    // Rotary tables shorter than the sequence.
+    CHECK_THROWS_AS(windowed_attention_cpu(torch::zeros({2, 16, 3, 1, 8}), table, table, {1, 1}),
+                    std::runtime_error);
+}
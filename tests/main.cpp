@@ -8,7 +8,24 @@
 // Catch2 must come after torch since both define CHECK()
 #include <catch2/catch.hpp>
 
+#ifdef __APPLE__
+#include <TargetConditionals.h>
+#endif
+
+#if !(defined(TARGET_OS_IPHONE) && TARGET_OS_IPHONE)
+#include "data_loader/Fast5ProcessPool.h"
+
+#include <string>
+#endif
+
 int main(int argc, char* argv[]) {
+#if !(defined(TARGET_OS_IPHONE) && TARGET_OS_IPHONE)
+    // FAST5 worker processes are started from this executable.
+    if (argc > 1 && argv[1] == std::string(dorado::Fast5ProcessPool::WORKER_COMMAND)) {
+        return dorado::Fast5ProcessPool::worker_main(argc - 1, argv + 1);
+    }
+#endif
+
     // global setup...
 
     dorado::utils::ensure_user_locale_may_be_set();